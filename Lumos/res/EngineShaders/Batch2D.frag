@@ -1,6 +1,12 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 #extension GL_ARB_shading_language_420pack : enable
+#ifdef BINDLESS
+#extension GL_EXT_nonuniform_qualifier : enable
+#define MAX_TEXTURES 256
+#else
+#define MAX_TEXTURES 16
+#endif
 layout (location = 0) out vec4 color;
 
 layout (location = 0) in DATA
@@ -11,14 +17,16 @@ layout (location = 0) in DATA
 	vec4 color;
 } fs_in;
 
-layout(set = 1, binding = 0) uniform sampler2D textures[16];
+layout(set = 1, binding = 0) uniform sampler2D textures[MAX_TEXTURES];
 
 void main()
 {
 	vec4 texColor = fs_in.color;
     if (fs_in.tid > 0.0)
     {
-        
+#ifdef BINDLESS
+        texColor *= texture(textures[nonuniformEXT(int(fs_in.tid - 0.5))], fs_in.uv);
+#else
     switch(int(fs_in.tid - 0.5))
     {
         case 0: texColor *= texture(textures[0], fs_in.uv); break;
@@ -54,6 +62,7 @@ void main()
 //        case 30: texColor *= texture(textures[30], fs_in.uv); break;
 //        case 31: texColor *= texture(textures[31], fs_in.uv); break;
     }
+#endif
     }
                                     
 	color = texColor;
@@ -0,0 +1,7 @@
+#shader vertex
+CompiledSPV/Batch2DInstanced.vert.spv
+#shader end
+
+#shader fragment
+CompiledSPV/Batch2D.frag.spv
+#shader end
@@ -0,0 +1,36 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+// Corner of the unit quad, the rest is per sprite
+layout (location = 0) in vec2 corner;
+
+// Sprite to world 2x3 transform in xyz, world z in row0.w and texture index in row1.w
+layout (location = 1) in vec4 instanceRow0;
+layout (location = 2) in vec4 instanceRow1;
+// Texture coordinates at corners (0, 0) and (1, 1)
+layout (location = 3) in vec4 instanceUV;
+layout (location = 4) in vec4 instanceColour;
+
+layout(set = 0,binding = 0) uniform UniformBufferObject
+{
+	mat4 projView;
+} ubo;
+
+layout (location = 0) out DATA
+{
+	vec3 position;
+	vec2 uv;
+	float tid;
+	vec4 color;
+} vs_out;
+
+void main()
+{
+	vec3 position = vec3(dot(instanceRow0.xy, corner) + instanceRow0.z, dot(instanceRow1.xy, corner) + instanceRow1.z, instanceRow0.w);
+	gl_Position = vec4(position, 1.0) * ubo.projView;
+	vs_out.position = position;
+	vs_out.uv = mix(instanceUV.xy, instanceUV.zw, corner);
+	vs_out.tid = instanceRow1.w;
+	vs_out.color = instanceColour;
+}
\ No newline at end of file
@@ -9,6 +9,17 @@ cd "$(dirname "$0")"
 /VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V DeferredColour.vert -o /CompiledSPV/DeferredColour.vert.spv
 /VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V DeferredColour.frag -o /CompiledSPV/DeferredColour.frag.spv
 
+/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V Shadow.vert -o /CompiledSPV/Shadow.vert.spv
+/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V Shadow.frag -o /CompiledSPV/Shadow.frag.spv
+
 /VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V DeferredLight.vert -o /CompiledSPV/DeferredLight.vert.spv
 /VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V DeferredLight.frag -o /CompiledSPV/DeferredLight.frag.spv
 
+/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V -DGBUFFER_COMPACT DeferredColour.frag -o /CompiledSPV/DeferredColourCompact.frag.spv
+/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V -DGBUFFER_COMPACT DeferredLight.frag -o /CompiledSPV/DeferredLightCompact.frag.spv
+/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V -DBINDLESS Batch2D.frag -o /CompiledSPV/Batch2DBindless.frag.spv
+/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V -DLIGHT_STORAGE_BUFFERS DeferredLight.frag -o /CompiledSPV/DeferredLightStorage.frag.spv
+/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V -DGBUFFER_COMPACT -DLIGHT_STORAGE_BUFFERS DeferredLight.frag -o /CompiledSPV/DeferredLightCompactStorage.frag.spv
+
+/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V Batch2DInstanced.vert -o /CompiledSPV/Batch2DInstanced.vert.spv
+
@@ -8,13 +8,19 @@ echo $COMPILER
 
 DSTDIR=compiledSPV
 
+# --force rebuilds every stage, checkouts give sources and binaries the same dates
+FORCE=0
+if [ "$1" = "--force" ]; then
+    FORCE=1
+fi
+
 for SRC in *.vert *.frag *.comp; do
 
     if [ -e $SRC ]
     then
         OUT="compiledSPV/$(echo "$SRC" | sed "s/\.frag$/.frag/" | sed "s/\.vert$/.vert/" | sed "s/\.comp$/.comp/").spv"
 
-        if [ -e $OUT ]
+        if [ -e $OUT ] && [ $FORCE -eq 0 ]
         then    
             # if output exists
             # don't re-compile if existing binary is newer than source file
@@ -35,4 +41,16 @@ for SRC in *.vert *.frag *.comp; do
     fi
 done
 
+# Variants built from the same source with defines
+echo "Compiling G-buffer compact variants"
+$COMPILER -V -DGBUFFER_COMPACT DeferredColour.frag -o "$DSTDIR/DeferredColourCompact.frag.spv"
+$COMPILER -V -DGBUFFER_COMPACT DeferredLight.frag -o "$DSTDIR/DeferredLightCompact.frag.spv"
+$COMPILER -V -DBINDLESS Batch2D.frag -o "$DSTDIR/Batch2DBindless.frag.spv"
+$COMPILER -V -DLIGHT_STORAGE_BUFFERS DeferredLight.frag -o "$DSTDIR/DeferredLightStorage.frag.spv"
+$COMPILER -V -DGBUFFER_COMPACT -DLIGHT_STORAGE_BUFFERS DeferredLight.frag -o "$DSTDIR/DeferredLightCompactStorage.frag.spv"
+
+# Always rebuilt, the committed binary can be newer than its source
+echo "Compiling instanced 2D vertex shader"
+$COMPILER -V Batch2DInstanced.vert -o "$DSTDIR/Batch2DInstanced.vert.spv"
+
 echo "Finished Compiling Shaders"
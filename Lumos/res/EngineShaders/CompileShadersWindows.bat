@@ -7,6 +7,10 @@ dir=$(cd -P -- "$(dirname -- "${BASH_SOURCE[0]}")" && pwd -P)
 set COMPILER=C:/VulkanSDK/1.1.148.1/Bin/glslangValidator.exe
 set DSTDIR=CompiledSPV
 
+rem /force rebuilds every stage, checkouts give sources and binaries the same dates
+set FORCE=0
+if /I "%~1"=="/force" set FORCE=1
+
 echo Compiling Shaders to spv
 
 if not exist "%DSTDIR%" (
@@ -27,12 +31,28 @@ for %%f in (*.vert *.frag *.comp) do (
   call :getModifiedDate "!DST!"
   set DST_DATE=!DATE_MODIFIED!
 
-  if "!SRC_DATE!" gtr "!DST_DATE!" (
+  set BUILD=!FORCE!
+  if "!SRC_DATE!" gtr "!DST_DATE!" set BUILD=1
+
+  if "!BUILD!"=="1" (
     echo Compiling
     %COMPILER% -V "!SRC!" -o "!DST!"
 
   )
 )
+
+rem Variants built from the same source with defines
+echo Compiling G-buffer compact variants
+%COMPILER% -V -DGBUFFER_COMPACT DeferredColour.frag -o "%DSTDIR%\DeferredColourCompact.frag.spv"
+%COMPILER% -V -DGBUFFER_COMPACT DeferredLight.frag -o "%DSTDIR%\DeferredLightCompact.frag.spv"
+%COMPILER% -V -DBINDLESS Batch2D.frag -o "%DSTDIR%\Batch2DBindless.frag.spv"
+%COMPILER% -V -DLIGHT_STORAGE_BUFFERS DeferredLight.frag -o "%DSTDIR%\DeferredLightStorage.frag.spv"
+%COMPILER% -V -DGBUFFER_COMPACT -DLIGHT_STORAGE_BUFFERS DeferredLight.frag -o "%DSTDIR%\DeferredLightCompactStorage.frag.spv"
+
+rem Always rebuilt, the committed binary can be newer than its source
+echo Compiling instanced 2D vertex shader
+%COMPILER% -V Batch2DInstanced.vert -o "%DSTDIR%\Batch2DInstanced.vert.spv"
+
 pause
 endlocal
 goto :EOF
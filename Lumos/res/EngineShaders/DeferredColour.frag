@@ -31,10 +31,17 @@ layout(set = 1,binding = 6) uniform UniformMaterialData
 	float padding;
 } materialProperties;
 
+// GBUFFER_COMPACT builds the variant for GBufferLayout::Compact, see GBuffer.h for what each target holds
+#ifdef GBUFFER_COMPACT
+layout(location = 0) out vec4 outColor;
+layout(location = 1) out vec2 outNormal;
+layout(location = 2) out vec4 outPBR;
+#else
 layout(location = 0) out vec4 outColor;
 layout(location = 1) out vec4 outPosition;
 layout(location = 2) out vec4 outNormal;
 layout(location = 3) out vec4 outPBR;
+#endif
 
 const float PBR_WORKFLOW_SEPARATE_TEXTURES = 0.0f;
 const float PBR_WORKFLOW_METALLIC_ROUGHNESS = 1.0f;
@@ -100,6 +107,22 @@ vec3 GetNormalFromMap()
 	return normalize(TBN * tangentNormal);
 }
 
+#ifdef GBUFFER_COMPACT
+// Octahedral encoding, the normal is projected onto an octahedron whose lower half is folded over the upper half
+vec2 EncodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signs;
+}
+
+// Metallic and AO share a half float channel. 5 and 6 bits stay below 2048 so the sum is stored exactly
+float PackMetallicAO(float metallic, float ao)
+{
+	return floor(clamp(metallic, 0.0, 1.0) * 31.0 + 0.5) * 64.0 + floor(clamp(ao, 0.0, 1.0) * 63.0 + 0.5);
+}
+#endif
+
 void main()
 {
 	vec4 texColour = GetAlbedo();
@@ -130,6 +153,11 @@ void main()
 	vec3 emissive   = GetEmissive();
 	float ao		= GetAO();
 
+#ifdef GBUFFER_COMPACT
+	outColor  = vec4(texColour.rgb, roughness);
+	outNormal = EncodeNormal(GetNormalFromMap());
+	outPBR    = vec4(emissive, PackMetallicAO(metallic, ao));
+#else
     outColor    = texColour;
 	outPosition = fragPosition;
 	outNormal   = vec4(GetNormalFromMap(),1.0);
@@ -138,4 +166,5 @@ void main()
 	outPosition.w = emissive.x;
 	outNormal.w   = emissive.y;
 	outPBR.w      = emissive.z;
+#endif
 }
\ No newline at end of file
@@ -7,16 +7,12 @@ layout(set = 0,binding = 0) uniform UniformBufferObject
 	mat4 projView;
 } ubo;
 
-layout(push_constant) uniform PushConsts
-{
-	mat4 transform;
-} pushConsts;
-
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec3 inNormal;
 layout(location = 4) in vec3 inTangent;
+layout(location = 5) in mat4 inModel;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
@@ -31,11 +27,11 @@ out gl_PerVertex
 
 void main() 
 {
-	fragPosition = vec4(inPosition, 1.0) * pushConsts.transform;
+	fragPosition = vec4(inPosition, 1.0) * inModel;
     gl_Position = fragPosition * ubo.projView;
     
     fragColor = inColor;
 	fragTexCoord = inTexCoord;
-    fragNormal = normalize(inNormal) * transpose(inverse(mat3(pushConsts.transform)));
+    fragNormal = normalize(inNormal) * transpose(inverse(mat3(inModel)));
     fragTangent = inTangent;
 }
\ No newline at end of file
@@ -0,0 +1,7 @@
+#shader vertex
+CompiledSPV/DeferredColour.vert.spv
+#shader end
+
+#shader fragment
+CompiledSPV/DeferredColourCompact.frag.spv
+#shader end
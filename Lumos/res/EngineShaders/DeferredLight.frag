@@ -5,8 +5,13 @@
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
 
+// GBUFFER_COMPACT builds the variant for GBufferLayout::Compact, where the position comes from the depth buffer.
+// LIGHT_STORAGE_BUFFERS builds the variant for devices with storage buffers, where the light and light index arrays
+// are as long as the buffers the renderer binds rather than a fixed uniform block size
 layout(set = 1, binding = 0) uniform sampler2D uColourSampler;
+#ifndef GBUFFER_COMPACT
 layout(set = 1, binding = 1) uniform sampler2D uPositionSampler;
+#endif
 layout(set = 1, binding = 2) uniform sampler2D uNormalSampler;
 layout(set = 1, binding = 3) uniform sampler2D uPBRSampler;
 layout(set = 1, binding = 4) uniform sampler2D uPreintegratedFG;
@@ -15,9 +20,17 @@ layout(set = 1, binding = 6) uniform samplerCube uIrradianceMap;
 layout(set = 1, binding = 7) uniform sampler2DArray uShadowMap;
 layout(set = 1, binding = 8) uniform sampler2D uDepthSampler;
 
-#define MAX_LIGHTS 32
+// Must match MAX_UNIFORM_LIGHTS in DeferredRenderer
+#define MAX_LIGHTS 1024
 #define MAX_SHADOWMAPS 16
 
+// Must match LightClusters
+#define CLUSTER_X 16
+#define CLUSTER_Y 8
+#define CLUSTER_Z 24
+#define CLUSTER_WORDS 768
+#define LIGHT_INDEX_WORDS 3200
+
 struct Light
 {
 	vec4 colour;
@@ -31,18 +44,53 @@ struct Light
 
 layout(std140, binding = 0) uniform UniformBufferLight
 {
-	Light lights[MAX_LIGHTS];
  	vec4 cameraPosition;
 	mat4 viewMatrix;
 	mat4 uShadowTransform[MAX_SHADOWMAPS];
     vec4 uSplitDepths[MAX_SHADOWMAPS];
 	mat4 biasMat;
-	int lightCount;
+	int directionalLightCount;
 	int shadowCount;
 	int mode;
 	int cubemapMipLevels;
+	// Maps (uv, depth) to world space
+	mat4 screenToWorld;
 } ubo;
 
+// Both variants have the same layout, std430 lays these members out the way std140 does.
+// Directional lights first, then point and spot lights
+#ifdef LIGHT_STORAGE_BUFFERS
+layout(std430, binding = 1) readonly buffer UniformBufferLightData
+{
+	Light lights[];
+} lightData;
+#else
+layout(std140, binding = 1) uniform UniformBufferLightData
+{
+	Light lights[MAX_LIGHTS];
+} lightData;
+#endif
+
+// Froxel grid over the view. Each cluster packs the offset of its first light index in the low 16 bits
+// and its light count in the high 16 bits. Light indices are 16 bit, two per word
+#ifdef LIGHT_STORAGE_BUFFERS
+layout(std430, binding = 2) readonly buffer UniformBufferLightClusters
+{
+	mat4 viewProjection;
+	vec4 params;
+	uvec4 clusters[CLUSTER_WORDS];
+	uvec4 lightIndices[];
+} clusterData;
+#else
+layout(std140, binding = 2) uniform UniformBufferLightClusters
+{
+	mat4 viewProjection;
+	vec4 params;
+	uvec4 clusters[CLUSTER_WORDS];
+	uvec4 lightIndices[LIGHT_INDEX_WORDS];
+} clusterData;
+#endif
+
 #define PI 3.1415926535897932384626433832795
 #define GAMMA 2.2
 
@@ -275,13 +323,47 @@ float CalculateShadow(vec3 wsPos, int cascadeIndex, float bias)
 		//return TextureProj(shadowCoord * ( 1.0 / shadowCoord.w), vec2(0.0,0.0), cascadeIndex, bias);
 }
 
+int GetCluster(vec3 wsPos)
+{
+	vec4 clip = vec4(wsPos, 1.0) * clusterData.viewProjection;
+	ivec2 tile = ivec2((clip.xy / clip.w * 0.5 + 0.5) * clusterData.params.xy);
+	tile = clamp(tile, ivec2(0), ivec2(CLUSTER_X - 1, CLUSTER_Y - 1));
+
+	float depth = -(vec4(wsPos, 1.0) * ubo.viewMatrix).z;
+	int slice = int(log(max(depth, 0.0001)) * clusterData.params.z + clusterData.params.w);
+	slice = clamp(slice, 0, CLUSTER_Z - 1);
+
+	return tile.x + tile.y * CLUSTER_X + slice * CLUSTER_X * CLUSTER_Y;
+}
+
+int GetClusterLight(int index)
+{
+	uint word = clusterData.lightIndices[index >> 3][(index >> 1) & 3];
+	return int((word >> ((index & 1) * 16)) & 0xFFFFu);
+}
+
+// Fades to zero at the light radius, past which the light is not assigned to a cluster
+float RadiusFalloff(float dist, float radius)
+{
+	float d = dist / radius;
+	float falloff = clamp(1.0 - d * d * d * d, 0.0, 1.0);
+	return falloff * falloff;
+}
+
 vec3 Lighting(vec3 F0, vec3 wsPos, Material material)
 {
+	int cluster = GetCluster(wsPos);
+	uint clusterLights = clusterData.clusters[cluster >> 2][cluster & 3];
+	int firstClusterLight = int(clusterLights & 0xFFFFu);
+	int clusterLightCount = int(clusterLights >> 16);
+
 	vec3 result = vec3(0.0);
 
-	for(int i = 0; i < ubo.lightCount; i++)
+	// Every directional light, then the point and spot lights of this pixel's cluster
+	for(int i = 0; i < ubo.directionalLightCount + clusterLightCount; i++)
 	{
-		Light light = ubo.lights[i];
+		int lightIndex = i < ubo.directionalLightCount ? i : GetClusterLight(max(firstClusterLight + i - ubo.directionalLightCount, 0));
+		Light light = lightData.lights[lightIndex];
 
 		float value = 0.0;
 
@@ -296,7 +378,7 @@ vec3 Lighting(vec3 F0, vec3 wsPos, Material material)
 			L = normalize(L);
 
 			// Attenuation
-			float atten = light.radius / (pow(dist, 2.0) + 1.0);
+			float atten = light.radius / (pow(dist, 2.0) + 1.0) * RadiusFalloff(dist, light.radius);
 
 			value = atten;
 
@@ -311,7 +393,7 @@ vec3 Lighting(vec3 F0, vec3 wsPos, Material material)
 			float theta         = dot(L.xyz, light.direction.xyz);
 			float epsilon       = cutoffAngle - cutoffAngle * 0.9f;
 			float attenuation 	= ((theta - cutoffAngle) / epsilon); // atteunate when approaching the outer cone
-			attenuation         *= light.radius / (pow(dist, 2.0) + 1.0);//saturate(1.0f - dist / light.range);
+			attenuation         *= light.radius / (pow(dist, 2.0) + 1.0) * RadiusFalloff(dist, light.radius);//saturate(1.0f - dist / light.range);
 			//float intensity 	= attenuation * attenuation;
 			
 			
@@ -374,6 +456,24 @@ vec3 IBL(vec3 F0, vec3 Lr, Material material)
 	return kd * diffuseIBL + specularIBL;
 }
 
+#ifdef GBUFFER_COMPACT
+vec3 DecodeNormal(vec2 f)
+{
+	vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+	float t = clamp(-n.z, 0.0, 1.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+vec2 UnpackMetallicAO(float packed)
+{
+	packed = floor(packed + 0.5);
+	float metallic = floor(packed / 64.0);
+	return vec2(metallic / 31.0, (packed - metallic * 64.0) / 63.0);
+}
+#endif
+
 vec3 FinalGamma(vec3 color)
 {
 	return pow(color, vec3(1.0 / GAMMA));
@@ -395,6 +495,28 @@ layout(location = 0) out vec4 outColor;
 
 void main()
 {
+#ifdef GBUFFER_COMPACT
+	float depth = texture(uDepthSampler, fragTexCoord).r;
+
+	// Nothing was drawn here
+	if(depth >= 1.0)
+		discard;
+
+	vec4 colourTex   = texture(uColourSampler   , fragTexCoord);
+    vec4 pbrTex		 = texture(uPBRSampler      , fragTexCoord);
+    vec4 normalTex   = texture(uNormalSampler   , fragTexCoord);
+
+	vec2 metallicAO = UnpackMetallicAO(pbrTex.w);
+    vec3  spec      = vec3(metallicAO.x);
+
+	float roughness = colourTex.w;
+	float ao		= metallicAO.y;
+	vec3 emissive	= pbrTex.xyz;
+	vec4 worldPos	= vec4(fragTexCoord, depth, 1.0) * ubo.screenToWorld;
+    vec3 wsPos      = worldPos.xyz / worldPos.w;
+	vec3 normal		= DecodeNormal(normalTex.xy);
+	colourTex.w		= 1.0;
+#else
 	vec4 colourTex   = texture(uColourSampler   , fragTexCoord);
 	
 	if(colourTex.w < 0.1)
@@ -407,9 +529,11 @@ void main()
     vec3  spec      = vec3(pbrTex.x);
 
 	float roughness = pbrTex.y;
+	float ao		= pbrTex.z;
 	vec3 emissive	= vec3(positionTex.w, normalTex.w, pbrTex.w);
     vec3 wsPos      = positionTex.xyz;
 	vec3 normal		= normalize(normalTex.xyz);
+#endif
     vec3 finalColour;
 
 	Material material;
@@ -417,7 +541,7 @@ void main()
     material.Metallic  = spec;
     material.Roughness = max(roughness, 0.05);
     material.Normal    = normal;
-	material.AO		= pbrTex.z;
+	material.AO		= ao;
 	material.Emissive  = emissive;
 	material.View 	 = normalize(ubo.cameraPosition.xyz - wsPos);
 	material.NDotV     = max(dot(material.Normal, material.View), 0.0);
@@ -0,0 +1,7 @@
+#shader vertex
+CompiledSPV/DeferredLight.vert.spv
+#shader end
+
+#shader fragment
+CompiledSPV/DeferredLightCompact.frag.spv
+#shader end
\ No newline at end of file
@@ -4,7 +4,6 @@
 
 layout(push_constant) uniform PushConsts
 {
-	mat4 transform;
 	uint cascadeIndex;
 } pushConsts;
 
@@ -19,6 +18,7 @@ out gl_PerVertex
 };
 
 layout (location = 0) in vec3 position;
+layout (location = 5) in mat4 inModel;
 
 void main()
 {
@@ -38,5 +38,5 @@ void main()
             proj = ubo.projView[3];
             break;
     }
-    gl_Position = vec4(position, 1.0) * pushConsts.transform * proj; 
+    gl_Position = vec4(position, 1.0) * inModel * proj; 
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 #include "Graphics/API/Renderer.h"
 #include "Graphics/API/GraphicsContext.h"
+#include "Graphics/API/UniformRingBuffer.h"
 #include "Graphics/Renderers/RenderGraph.h"
 #include "Graphics/Camera/Camera.h"
 #include "Graphics/Material.h"
@@ -57,8 +58,10 @@ namespace Lumos
         
 #ifdef LUMOS_PLATFORM_IOS
         FilePath = Lumos::OS::Instance()->GetAssetPath() + projectName + ".lmproj";
+        m_CachePath = Lumos::OS::Instance()->GetCachePath();
 #else
         FilePath = projectRoot + projectName + std::string(".lmproj");
+        m_CachePath = ROOT_DIR "/bin/";
 #endif
         
 #ifndef LUMOS_PLATFORM_IOS
@@ -131,6 +134,9 @@ namespace Lumos
         
 		Graphics::Renderer::Init(screenWidth, screenHeight);
 
+		// Shaders used last run load on worker threads while the rest of the engine starts up
+		m_ShaderLibrary->LoadAsync(Graphics::Pipeline::GetCacheManifestShaders(m_CachePath + "PipelineManifest.json"));
+
 		// Graphics Loading on main thread
 		m_RenderGraph = CreateUniqueRef<Graphics::RenderGraph>(screenWidth, screenHeight);
 
@@ -153,6 +159,9 @@ namespace Lumos
         
         m_SceneManager->LoadCurrentList();
 
+		// Create the pipelines used last run before the renderers ask for them
+		Graphics::Pipeline::PrewarmCache(m_CachePath + "PipelineManifest.json");
+
 		m_CurrentState = AppState::Running;
 
 #ifdef LUMOS_EDITOR
@@ -195,6 +204,7 @@ namespace Lumos
 		delete m_Editor;
 #endif
         
+		Graphics::Pipeline::SaveCacheManifest(m_CachePath + "PipelineManifest.json");
 		Graphics::Renderer::Release();
         Graphics::Pipeline::ClearCache();
         Graphics::RenderPass::ClearCache();
@@ -308,6 +318,7 @@ namespace Lumos
 		if(m_RenderGraph->GetCount() > 0)
 		{
 			Graphics::Renderer::GetRenderer()->Begin();
+			Graphics::Renderer::GetUniformRingBuffer()->BeginFrame();
 			DebugRenderer::Reset();
 
 			m_SystemManager->OnDebugDraw();
@@ -346,7 +357,7 @@ namespace Lumos
         m_ImGuiManager->OnUpdate(dt, m_SceneManager->GetCurrentScene());
         
         {
-            //Do every few frames instead?
+            // Ages the cached resources nothing else holds and evicts the stale ones
             Graphics::Pipeline::DeleteUnusedCache();
             Graphics::RenderPass::DeleteUnusedCache();
             Graphics::Framebuffer::DeleteUnusedCache();
@@ -387,6 +398,7 @@ namespace Lumos
 	void Application::OnNewScene(Scene* scene)
 	{
 		LUMOS_PROFILE_FUNCTION();
+		m_RenderGraph->OnNewScene(scene);
 #ifdef LUMOS_EDITOR
 		m_SceneViewSizeUpdated = true;
 		m_Editor->OnNewScene(scene);
@@ -135,6 +135,9 @@ namespace Lumos
         
         Ref<ShaderLibrary>& GetShaderLibrary() { return m_ShaderLibrary; }
 
+        // Folder for data kept between runs, e.g. compiled pipelines
+        const std::string& GetCachePath() const { return m_CachePath; }
+
 		static Application& Get()
 		{
 			return *s_Instance;
@@ -276,6 +279,8 @@ namespace Lumos
 		std::string FilePath;
 		//
 
+		std::string m_CachePath;
+
 		u32 m_Frames;
 		u32 m_Updates;
 		float m_SecondTimer = 0.0f;
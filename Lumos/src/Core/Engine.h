@@ -19,13 +19,43 @@ namespace Lumos
         
         static TimeStep& GetTimeStep() { return Engine::Get().m_TimeStep; }
 		
+		// Matches SHADOWMAP_MAX in ShadowRenderer.h
+		static constexpr u32 MaxShadowCascades = 16;
+
+		struct CacheStats
+		{
+			u32 Size = 0;
+			u32 Hits = 0;
+			u32 Misses = 0;
+			u32 Evicted = 0;
+			u32 PendingRelease = 0;
+		};
+
 		struct Stats
 		{
 			u32 UpdatesPerSecond;
 			u32 FramesPerSecond;
 			u32 NumRenderedObjects = 0;
 			u32 NumShadowObjects = 0;
+			u32 NumShadowCascades = 0;
+			u32 NumShadowCascadesCached = 0;
+			u32 NumShadowCascadeObjects[MaxShadowCascades] = {};
+			u32 NumShadowCascadeDrawCalls[MaxShadowCascades] = {};
 			u32 NumDrawCalls = 0;
+			u32 NumDrawCallsSavedByInstancing = 0;
+			u32 NumDescriptorBindsSaved = 0;
+			u32 NumBufferBindsSaved = 0;
+			u32 NumPhysics2DBodiesSynced = 0;
+			CacheStats PipelineCache;
+			CacheStats RenderPassCache;
+			CacheStats FramebufferCache;
+			u32 NumDescriptorPools = 0;
+			u32 NumTransientDescriptorPools = 0;
+			u32 NumDescriptorSets = 0;
+			u32 NumDescriptorSetsShared = 0;
+			u32 NumTransientDescriptorSets = 0;
+			u32 NumUploadBatchesInFlight = 0;
+			u32 UploadedBytes = 0;
 			float FrameTime = 0.0f;
 			float UsedGPUMemory = 0.0f;
 			float UsedRam = 0.0f;
@@ -36,10 +66,30 @@ namespace Lumos
 		{
 			m_Stats.NumRenderedObjects = 0;
 			m_Stats.NumShadowObjects = 0;
+			m_Stats.NumShadowCascades = 0;
+			m_Stats.NumShadowCascadesCached = 0;
+			for(u32 i = 0; i < MaxShadowCascades; i++)
+			{
+				m_Stats.NumShadowCascadeObjects[i] = 0;
+				m_Stats.NumShadowCascadeDrawCalls[i] = 0;
+			}
 			m_Stats.FrameTime = 0.0f;
 			m_Stats.UsedGPUMemory = 0.0f;
 			m_Stats.UsedRam = 0.0f;
 			m_Stats.NumDrawCalls = 0;
+			m_Stats.NumDrawCallsSavedByInstancing = 0;
+			m_Stats.NumDescriptorBindsSaved = 0;
+			m_Stats.NumBufferBindsSaved = 0;
+			m_Stats.PipelineCache = CacheStats();
+			m_Stats.RenderPassCache = CacheStats();
+			m_Stats.FramebufferCache = CacheStats();
+			m_Stats.NumDescriptorPools = 0;
+			m_Stats.NumTransientDescriptorPools = 0;
+			m_Stats.NumDescriptorSets = 0;
+			m_Stats.NumDescriptorSetsShared = 0;
+			m_Stats.NumTransientDescriptorSets = 0;
+			m_Stats.NumUploadBatchesInFlight = 0;
+			m_Stats.UploadedBytes = 0;
 			m_Stats.TotalGPUMemory = 0.0f;
 		}
 		
@@ -148,7 +148,18 @@ namespace Lumos
                 wakeCondition.notify_one(); // wake one thread
             }
 
-            void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job)
+            void Execute(Context& ctx, const std::function<void()>& job)
+            {
+                ctx.counter.fetch_add(1);
+
+                Execute([&ctx, job]() {
+                    job();
+                    ctx.counter.fetch_sub(1);
+                });
+            }
+
+            // ctx is optional, jobs dispatched without one are only tracked by the global labels
+            static void DispatchGroups(Context* ctx, uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job)
             {
                 if (jobCount == 0 || groupSize == 0)
                 {
@@ -161,10 +172,13 @@ namespace Lumos
                 // The main thread label state is updated:
                 currentLabel += groupCount;
 
+                if (ctx)
+                    ctx->counter.fetch_add(groupCount);
+
                 for (uint32_t groupIndex = 0; groupIndex < groupCount; ++groupIndex)
                 {
                     // For each group, generate one real job:
-                    const auto& jobGroup = [jobCount, groupSize, job, groupIndex]() {
+                    const auto& jobGroup = [ctx, jobCount, groupSize, job, groupIndex]() {
 
                         // Calculate the current group's offset into the jobs:
                         const uint32_t groupJobOffset = groupIndex * groupSize;
@@ -179,6 +193,9 @@ namespace Lumos
                             args.jobIndex = i;
                             job(args);
                         }
+
+                        if (ctx)
+                            ctx->counter.fetch_sub(1);
                     };
 
                     // Try to push a new job until it is pushed successfully:
@@ -190,16 +207,36 @@ namespace Lumos
 
             }
 
+            void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job)
+            {
+                DispatchGroups(nullptr, jobCount, groupSize, job);
+            }
+
+            void Dispatch(Context& ctx, uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job)
+            {
+                DispatchGroups(&ctx, jobCount, groupSize, job);
+            }
+
             bool IsBusy()
             {
                 // Whenever the main thread label is not reached by the workers, it indicates that some worker is still alive
                 return finishedLabel.load() < currentLabel;
             }
 
+            bool IsBusy(const Context& ctx)
+            {
+                return ctx.counter.load() > 0;
+            }
+
             void Wait()
             {
                 while (IsBusy()) { poll(); }
             }
+
+            void Wait(const Context& ctx)
+            {
+                while (IsBusy(ctx)) { poll(); }
+            }
         }
     }
 }
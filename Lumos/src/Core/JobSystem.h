@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 
 struct JobDispatchArgs
 {
@@ -12,24 +13,38 @@ namespace Lumos
     {
         namespace JobSystem
         {
+            // Tracks the jobs added through it, so a caller can wait on its own work without waiting on every job in flight
+            struct Context
+            {
+                std::atomic<uint32_t> counter { 0 };
+            };
+
             void OnInit();
 
             uint32_t GetThreadCount();
 
             // Add a job to execute asynchronously. Any idle thread will execute this job.
             void Execute(const std::function<void()>& job);
+            void Execute(Context& ctx, const std::function<void()>& job);
 
             // Divide a job onto multiple jobs and execute in parallel.
             //	jobCount	: how many jobs to generate for this task.
             //	groupSize	: how many jobs to execute per thread. Jobs inside a group execute serially. It might be worth to increase for small jobs
             //	func		: receives a JobDispatchArgs as parameter
             void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job);
+            void Dispatch(Context& ctx, uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job);
 
             // Check if any threads are working currently or not
             bool IsBusy();
 
+            // Check if any job added through the context is still pending
+            bool IsBusy(const Context& ctx);
+
             // Wait until all threads become idle
             void Wait();
+
+            // Wait until the jobs added through the context have finished. Jobs from other contexts may still be running
+            void Wait(const Context& ctx);
         }
     }
 }
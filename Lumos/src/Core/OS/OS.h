@@ -44,6 +44,11 @@ namespace Lumos
 		{
 			return "";
 		};
+		// Writable directory for data that can be rebuilt, such as shader and pipeline caches
+		virtual std::string GetCachePath()
+		{
+			return "";
+		};
 		virtual void Vibrate() const {};
         virtual void SetTitleBarColour(const Maths::Vector4& colour, bool dark = true) {};
         
@@ -10,10 +10,12 @@
 #define LUMOS_PROFILE_FRAMEMARKER() FrameMark
 #define LUMOS_PROFILE_LOCK(type, var, name) TracyLockableN(type, var, name)
 #define LUMOS_PROFILE_LOCKMARKER(var) LockMark(var)
+#define LUMOS_PROFILE_PLOT(name, value) TracyPlot(name, value)
 #else
 #define LUMOS_PROFILE_SCOPE(name)
 #define LUMOS_PROFILE_FUNCTION()
 #define LUMOS_PROFILE_FRAMEMARKER()
 #define LUMOS_PROFILE_LOCK(type, var, name) type var
 #define LUMOS_PROFILE_LOCKMARKER(var)
+#define LUMOS_PROFILE_PLOT(name, value)
 #endif
@@ -71,7 +71,7 @@ namespace Lumos
 
 						ImGui::TreePop();
 					}
-					if(ImGui::TreeNode("Position Texture"))
+					if(Application::Get().GetRenderGraph()->GetGBuffer()->GetLayout() == Graphics::GBufferLayout::Standard && ImGui::TreeNode("Position Texture"))
 					{
 						ImGuiHelpers::Image(Application::Get().GetRenderGraph()->GetGBuffer()->GetTexture(Graphics::SCREENTEX_POSITION), Maths::Vector2(128.0f, 128.0f));
 						ImGuiHelpers::Tooltip(Application::Get().GetRenderGraph()->GetGBuffer()->GetTexture(Graphics::SCREENTEX_POSITION), Maths::Vector2(256.0f, 256.0f));
@@ -40,6 +40,8 @@
 #include "Graphics/API/GraphicsContext.h"
 #include "Graphics/Renderers/GridRenderer.h"
 #include "Graphics/Renderers/DebugRenderer.h"
+#include "Graphics/Renderers/RenderGraph.h"
+#include "Graphics/Renderers/VisibilityStage.h"
 #include "Graphics/Model.h"
 #include "Graphics/Environment.h"
 #include "Scene/EntityFactory.h"
@@ -1337,36 +1339,19 @@ namespace Lumos
 		float closestEntityDist = Maths::M_INFINITY;
 		entt::entity currentClosestEntity = entt::null;
         
-		auto group = registry.group<Graphics::Model>(entt::get<Maths::Transform>);
+		// World space bounds were gathered by the visibility stage while rendering the last frame
+		auto visibility = Application::Get().GetRenderGraph()->GetVisibility();
         
 		static Timer timer;
 		static float timeSinceLastSelect = 0.0f;
         
-		for(auto entity : group)
+		float dist;
+		u32 item = visibility->RayCast(ray, Graphics::VisibilityType::Mesh, dist);
+        
+		if(item != Graphics::VisibilityStage::InvalidItem && registry.valid(visibility->GetEntity(item)))
 		{
-			const auto& [model, trans] = group.get<Graphics::Model, Maths::Transform>(entity);
-            
-			auto& meshes = model.GetMeshes();
-            
-			for(auto mesh : meshes)
-			{
-				if(mesh->GetActive())
-				{
-					auto& worldTransform = trans.GetWorldMatrix();
-                    
-					auto bbCopy = mesh->GetBoundingBox()->Transformed(worldTransform);
-					float dist = ray.HitDistance(bbCopy);
-                    
-					if(dist < Maths::M_INFINITY)
-					{
-						if(dist < closestEntityDist)
-						{
-							closestEntityDist = dist;
-							currentClosestEntity = entity;
-						}
-					}
-				}
-			}
+			closestEntityDist = dist;
+			currentClosestEntity = visibility->GetEntity(item);
 		}
         
 		if(m_SelectedEntity != entt::null)
@@ -1392,46 +1377,12 @@ namespace Lumos
 			return;
 		}
         
-		auto spriteGroup = registry.group<Graphics::Sprite>(entt::get<Maths::Transform>);
-        
-		for(auto entity : spriteGroup)
-		{
-			const auto& [sprite, trans] = spriteGroup.get<Graphics::Sprite, Maths::Transform>(entity);
-            
-			auto& worldTransform = trans.GetWorldMatrix();
-			auto bb = Maths::BoundingBox(Maths::Rect(sprite.GetPosition(), sprite.GetPosition() + sprite.GetScale()));
-			bb.Transform(trans.GetWorldMatrix());
-			float dist = ray.HitDistance(bb);
-            
-			if(dist < Maths::M_INFINITY)
-			{
-				if(dist < closestEntityDist)
-				{
-					closestEntityDist = dist;
-					currentClosestEntity = entity;
-				}
-			}
-		}
-		
-		auto animSpriteGroup = registry.group<Graphics::AnimatedSprite>(entt::get<Maths::Transform>);
+		item = visibility->RayCast(ray, Graphics::VisibilityType::Sprite, dist);
         
-		for(auto entity : animSpriteGroup)
+		if(item != Graphics::VisibilityStage::InvalidItem && dist < closestEntityDist && registry.valid(visibility->GetEntity(item)))
 		{
-			const auto& [sprite, trans] = animSpriteGroup.get<Graphics::AnimatedSprite, Maths::Transform>(entity);
-            
-			auto& worldTransform = trans.GetWorldMatrix();
-			auto bb = Maths::BoundingBox(Maths::Rect(sprite.GetPosition(), sprite.GetPosition() + sprite.GetScale()));
-			bb.Transform(trans.GetWorldMatrix());
-			float dist = ray.HitDistance(bb);
-            
-			if(dist < Maths::M_INFINITY)
-			{
-				if(dist < closestEntityDist)
-				{
-					closestEntityDist = dist;
-					currentClosestEntity = entity;
-				}
-			}
+			closestEntityDist = dist;
+			currentClosestEntity = visibility->GetEntity(item);
 		}
         
 		if(m_SelectedEntity != entt::null)
@@ -1528,7 +1479,7 @@ namespace Lumos
             .ToMatrix4();
 		m_PreviewRenderer->Begin();
 		m_PreviewRenderer->BeginScene(proj, view);
-		m_PreviewRenderer->SubmitMesh(m_PreviewSphere.get(), nullptr, Maths::Matrix4(), Maths::Matrix4());
+		m_PreviewRenderer->SubmitMesh(m_PreviewSphere.get(), nullptr, Maths::Matrix4());
         m_PreviewRenderer->SetSystemUniforms(m_PreviewRenderer->GetShader().get());
 		m_PreviewRenderer->Present();
 		m_PreviewRenderer->End();
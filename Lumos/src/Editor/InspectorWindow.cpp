@@ -1631,63 +1631,6 @@ namespace MM
 		ImGui::PopStyleVar();
 	}
 
-	template<>
-	void ComponentEditorWidget<Lumos::TextureMatrixComponent>(entt::registry& reg, entt::registry::entity_type e)
-	{
-		LUMOS_PROFILE_FUNCTION();
-		auto& textureMatrix = reg.get<Lumos::TextureMatrixComponent>(e);
-		Lumos::Maths::Matrix4& mat = textureMatrix.GetMatrix();
-		auto rotation = textureMatrix.GetMatrix().Rotation();
-		auto position = textureMatrix.GetMatrix().Translation();
-		auto scale = textureMatrix.GetMatrix().Scale();
-
-		ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(2, 2));
-		ImGui::Columns(2);
-		ImGui::Separator();
-
-		ImGui::AlignTextToFramePadding();
-		ImGui::TextUnformatted("Position");
-		ImGui::NextColumn();
-		ImGui::PushItemWidth(-1);
-		if(ImGui::DragFloat3("##Position", Lumos::Maths::ValuePointer(position)))
-		{
-			mat.SetTranslation(position);
-		}
-
-		ImGui::PopItemWidth();
-		ImGui::NextColumn();
-
-		ImGui::AlignTextToFramePadding();
-		ImGui::TextUnformatted("Rotation");
-		ImGui::NextColumn();
-		ImGui::PushItemWidth(-1);
-		if(ImGui::DragFloat3("##Rotation", Lumos::Maths::ValuePointer(rotation)))
-		{
-			float pitch = Lumos::Maths::Min(rotation.x, 89.9f);
-			pitch = Lumos::Maths::Max(pitch, -89.9f);
-			mat.SetRotation(Lumos::Maths::Quaternion::EulerAnglesToQuaternion(pitch, rotation.y, rotation.z).RotationMatrix());
-		}
-
-		ImGui::PopItemWidth();
-		ImGui::NextColumn();
-
-		ImGui::AlignTextToFramePadding();
-		ImGui::TextUnformatted("Scale");
-		ImGui::NextColumn();
-		ImGui::PushItemWidth(-1);
-		if(ImGui::DragFloat3("##Scale", Lumos::Maths::ValuePointer(scale), 0.1f))
-		{
-			mat.SetScale(scale);
-		}
-
-		ImGui::PopItemWidth();
-		ImGui::NextColumn();
-
-		ImGui::Columns(1);
-		ImGui::Separator();
-		ImGui::PopStyleVar();
-	}
-
 	template<>
 	void ComponentEditorWidget<Lumos::DefaultCameraController>(entt::registry& reg, entt::registry::entity_type e)
 	{
@@ -1768,7 +1711,6 @@ namespace Lumos
 		TRIVIAL_COMPONENT(Graphics::Light, "Light");
 		TRIVIAL_COMPONENT(LuaScriptComponent, "LuaScript");
 		TRIVIAL_COMPONENT(Graphics::Environment, "Environment");
-		TRIVIAL_COMPONENT(TextureMatrixComponent, "Texture Matrix");
 		TRIVIAL_COMPONENT(DefaultCameraController, "Default Camera Controller");
 	}
 
@@ -277,7 +277,25 @@ namespace Lumos
 				
 				ImGui::Text("Num Rendered Objects %u", stats.NumRenderedObjects);
 				ImGui::Text("Num Shadow Objects %u", stats.NumShadowObjects);
+				if(stats.NumShadowCascades > 0)
+				{
+					ImGui::Text("Shadow Cascades Cached %u / %u", stats.NumShadowCascadesCached, stats.NumShadowCascades);
+					for(u32 i = 0; i < stats.NumShadowCascades; i++)
+						ImGui::Text("  Cascade %u : Objects %u | Draw Calls %u", i, stats.NumShadowCascadeObjects[i], stats.NumShadowCascadeDrawCalls[i]);
+				}
 				ImGui::Text("Num Draw Calls  %u", stats.NumDrawCalls);
+				ImGui::Text("Draw Calls Saved By Instancing %u", stats.NumDrawCallsSavedByInstancing);
+				ImGui::Text("Binds Saved : Descriptor %u | Buffer %u", stats.NumDescriptorBindsSaved, stats.NumBufferBindsSaved);
+				ImGui::Text("Num 2D Bodies Synced %u", stats.NumPhysics2DBodiesSynced);
+				auto cacheText = [](const char* name, const Engine::CacheStats& cache) {
+					ImGui::Text("%s Cache : Size %u | Hits %u | Misses %u | Evicted %u | Pending %u", name, cache.Size, cache.Hits, cache.Misses, cache.Evicted, cache.PendingRelease);
+				};
+				cacheText("Pipeline", stats.PipelineCache);
+				cacheText("RenderPass", stats.RenderPassCache);
+				cacheText("Framebuffer", stats.FramebufferCache);
+				ImGui::Text("Descriptor Pools %u | Transient Pools %u", stats.NumDescriptorPools, stats.NumTransientDescriptorPools);
+				ImGui::Text("Descriptor Sets %u | Shared %u | Transient %u", stats.NumDescriptorSets, stats.NumDescriptorSetsShared, stats.NumTransientDescriptorSets);
+				ImGui::Text("Uploaded : %.1f kb | Upload Batches In Flight %u", stats.UploadedBytes * 0.001f, stats.NumUploadBatchesInFlight);
 				ImGui::Text("Used GPU Memory : %.1f mb | Total : %.1f mb", stats.UsedGPUMemory * 0.000001f, stats.TotalGPUMemory * 0.000001f);
 				
 				if(ImGui::BeginPopupContextWindow())
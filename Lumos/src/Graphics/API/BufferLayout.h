@@ -39,7 +39,6 @@ namespace Lumos
 				return m_Size;
 			}
 
-		private:
 			void Push(const std::string& name, Format format, u32 size, bool normalized);
 		};
 
@@ -27,6 +27,8 @@ namespace Lumos
 			static CommandBuffer* Create();
 
 			virtual bool Init(bool primary) = 0;
+			// Allocates from a separate command pool per index so buffers can be recorded on different threads at once
+			virtual bool Init(bool primary, u32 commandPoolIndex) = 0;
 			virtual void Unload() = 0;
 			virtual void BeginRecording() = 0;
 			virtual void BeginRecordingSecondary(RenderPass* renderPass, Framebuffer* framebuffer) = 0;
@@ -15,7 +15,8 @@ namespace Lumos
 		{
 			UNIFORM_BUFFER,
 			UNIFORM_BUFFER_DYNAMIC,
-			IMAGE_SAMPLER
+			IMAGE_SAMPLER,
+			STORAGE_BUFFER
 		};
 
 		enum class Format
@@ -63,6 +64,8 @@ namespace Lumos
 			u32 layoutIndex;
 			Shader* shader;
 			u32 count = 1;
+			// Contents change every frame, so the set is not worth caching and comes from memory reset each frame
+			bool transient = false;
 		};
 
 		struct BufferInfo
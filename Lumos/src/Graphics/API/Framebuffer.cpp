@@ -3,6 +3,7 @@
 #include "Texture.h"
 #include "Graphics/API/GraphicsContext.h"
 
+#include "ResourceCache.h"
 #include "Utilities/CombineHash.h"
 
 namespace Lumos
@@ -18,7 +19,9 @@ namespace Lumos
             return CreateFunc(framebufferInfo);
 		}
     
-        static std::unordered_map<std::size_t, Ref<Framebuffer>> m_FramebufferCache;
+        // Keys hold raw texture pointers that may be reused by new textures once the old ones are freed,
+        // so framebuffers nothing references are evicted on the next update rather than kept around
+        static ResourceCache<Framebuffer> m_FramebufferCache(0);
     
         Ref<Framebuffer> Framebuffer::Get(const FramebufferInfo& framebufferInfo)
         {
@@ -30,30 +33,27 @@ namespace Lumos
                 HashCombine(hash, framebufferInfo.attachmentTypes[i], framebufferInfo.attachments[i]);
             }
             
-            auto found = m_FramebufferCache.find(hash);
-            if (found != m_FramebufferCache.end() && found->second)
+            auto found = m_FramebufferCache.Find(hash);
+            if (found)
             {
                 //Disable until fix resize issue. 
-                return found->second;
+                return found;
             }
             
             auto framebuffer = Ref<Framebuffer>(Create(framebufferInfo));
-            m_FramebufferCache[hash] = framebuffer;
+            m_FramebufferCache.Insert(hash, framebuffer);
             return framebuffer;
         }
     
         void Framebuffer::ClearCache()
         {
-            m_FramebufferCache.clear();
+            m_FramebufferCache.Clear();
         }
     
         void Framebuffer::DeleteUnusedCache()
         {
-            for (const auto & [ key, value ] : m_FramebufferCache)
-            {
-                if(value && value.GetCounter()->GetReferenceCount() == 1)
-                    m_FramebufferCache[key] = nullptr;
-            }
+            LUMOS_PROFILE_FUNCTION();
+            m_FramebufferCache.Update(GetResourceReleaseDelay(), Engine::Get().Statistics().FramebufferCache);
         }
 
 		Framebuffer::~Framebuffer()
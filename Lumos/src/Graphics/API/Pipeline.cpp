@@ -1,58 +1,309 @@
 #include "Precompiled.h"
 #include "Pipeline.h"
+#include "RenderPass.h"
+#include "Shader.h"
+#include "GraphicsContext.h"
+#include "ResourceCache.h"
 
+#include "Core/Application.h"
+#include "Core/JobSystem.h"
+#include "Core/OS/FileSystem.h"
+#include "Utilities/AssetManager.h"
 #include "Utilities/CombineHash.h"
 
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
 namespace Lumos
 {
 	namespace Graphics
 	{
-        static std::unordered_map<std::size_t, Ref<Pipeline>> m_PipelineCache;
+        static constexpr u32 PIPELINE_MANIFEST_VERSION = 1;
+        static constexpr u32 PIPELINE_CACHE_MAX_AGE = 300;
+
+        // PipelineInfo with the shader and renderpass replaced by what is needed to recreate them
+        struct PipelineDescription
+        {
+            struct Element
+            {
+                std::string name;
+                u32 format = 0;
+                u32 offset = 0;
+                bool normalized = false;
+
+                template<typename Archive>
+                void serialize(Archive& archive)
+                {
+                    archive(cereal::make_nvp("Name", name), cereal::make_nvp("Format", format), cereal::make_nvp("Offset", offset), cereal::make_nvp("Normalized", normalized));
+                }
+            };
+
+            std::string shader;
+            std::vector<int> attachmentTypes;
+            std::vector<int> attachmentFormats;
+            bool clear = true;
+
+            int cullMode = 0;
+            int polygonMode = 0;
+            int drawType = 0;
+            bool transparencyEnabled = false;
+            bool depthBiasEnabled = false;
+
+            u32 vertexStride = 0;
+            std::vector<Element> vertexLayout;
+            u32 instanceStride = 0;
+            std::vector<Element> instanceLayout;
+
+            template<typename Archive>
+            void serialize(Archive& archive)
+            {
+                archive(cereal::make_nvp("Shader", shader), cereal::make_nvp("AttachmentTypes", attachmentTypes), cereal::make_nvp("AttachmentFormats", attachmentFormats), cereal::make_nvp("Clear", clear),
+                    cereal::make_nvp("CullMode", cullMode), cereal::make_nvp("PolygonMode", polygonMode), cereal::make_nvp("DrawType", drawType),
+                    cereal::make_nvp("Transparency", transparencyEnabled), cereal::make_nvp("DepthBias", depthBiasEnabled),
+                    cereal::make_nvp("VertexStride", vertexStride), cereal::make_nvp("VertexLayout", vertexLayout),
+                    cereal::make_nvp("InstanceStride", instanceStride), cereal::make_nvp("InstanceLayout", instanceLayout));
+            }
+        };
+
+        static ResourceCache<Pipeline> m_PipelineCache(PIPELINE_CACHE_MAX_AGE);
+        // Created by PrewarmCache and not requested yet
+        static std::unordered_map<std::size_t, Ref<Pipeline>> m_PrewarmedPipelines;
+        // Every pipeline requested this session, written out by SaveCacheManifest
+        static std::unordered_map<std::size_t, PipelineDescription> m_PipelineDescriptions;
 
         Pipeline*(*Pipeline::CreateFunc)(const PipelineInfo&) = nullptr;
 
-		Pipeline* Pipeline::Create(const PipelineInfo& pipelineInfo)
-		{
-            LUMOS_ASSERT(CreateFunc, "No Pipeline Create Function");
-            return CreateFunc(pipelineInfo);
-		}
-    
-        Ref<Pipeline> Pipeline::Get(const PipelineInfo& pipelineInfo)
+        static size_t HashPipelineInfo(const PipelineInfo& pipelineInfo)
         {
             size_t hash = 0;
             HashCombine(hash, pipelineInfo.shader.get(), pipelineInfo.cullMode, pipelineInfo.depthBiasEnabled, pipelineInfo.drawType, pipelineInfo.polygonMode,  pipelineInfo.transparencyEnabled, pipelineInfo.renderpass.get());
-            
+
             const auto& vertexLayout = pipelineInfo.vertexBufferLayout.GetLayout();
             HashCombine(hash, pipelineInfo.vertexBufferLayout.GetStride(), vertexLayout.size() );
-            
+
             for(auto& layout : vertexLayout)
             {
                 HashCombine(hash, layout.name, layout.format, layout.normalized, layout.offset);
             }
-            
-            auto found = m_PipelineCache.find(hash);
-            if (found != m_PipelineCache.end() && found->second)
+
+            const auto& instanceLayout = pipelineInfo.instanceBufferLayout.GetLayout();
+            HashCombine(hash, pipelineInfo.instanceBufferLayout.GetStride(), instanceLayout.size());
+
+            for(auto& layout : instanceLayout)
+            {
+                HashCombine(hash, layout.name, layout.format, layout.normalized, layout.offset);
+            }
+
+            return hash;
+        }
+
+        static void DescribeLayout(const BufferLayout& layout, u32& stride, std::vector<PipelineDescription::Element>& elements)
+        {
+            stride = layout.GetStride();
+            for(auto& element : layout.GetLayout())
+                elements.push_back({ element.name, static_cast<u32>(element.format), element.offset, element.normalized });
+        }
+
+        static BufferLayout RebuildLayout(u32 stride, const std::vector<PipelineDescription::Element>& elements)
+        {
+            BufferLayout layout;
+            for(size_t i = 0; i < elements.size(); i++)
+            {
+                // Element sizes are not stored, they are the gap to the next element
+                const u32 end = i + 1 < elements.size() ? elements[i + 1].offset : stride;
+                layout.Push(elements[i].name, static_cast<Format>(elements[i].format), end - elements[i].offset, elements[i].normalized);
+            }
+            return layout;
+        }
+
+        static void RecordDescription(size_t hash, const PipelineInfo& pipelineInfo)
+        {
+            if(m_PipelineDescriptions.find(hash) != m_PipelineDescriptions.end())
+                return;
+
+            PipelineDescription description;
+            if(!pipelineInfo.shader || !pipelineInfo.renderpass || !Application::Get().GetShaderLibrary()->GetName(pipelineInfo.shader, description.shader))
+                return;
+
+            for(auto& attachment : pipelineInfo.renderpass->GetAttachmentInfos())
             {
-                return found->second;
+                description.attachmentTypes.push_back(static_cast<int>(attachment.textureType));
+                description.attachmentFormats.push_back(static_cast<int>(attachment.format));
             }
-            
+
+            description.clear = pipelineInfo.renderpass->GetClear();
+            description.cullMode = static_cast<int>(pipelineInfo.cullMode);
+            description.polygonMode = static_cast<int>(pipelineInfo.polygonMode);
+            description.drawType = static_cast<int>(pipelineInfo.drawType);
+            description.transparencyEnabled = pipelineInfo.transparencyEnabled;
+            description.depthBiasEnabled = pipelineInfo.depthBiasEnabled;
+            DescribeLayout(pipelineInfo.vertexBufferLayout, description.vertexStride, description.vertexLayout);
+            DescribeLayout(pipelineInfo.instanceBufferLayout, description.instanceStride, description.instanceLayout);
+
+            m_PipelineDescriptions[hash] = description;
+        }
+
+        static bool ReadCacheManifest(const std::string& filePath, std::vector<PipelineDescription>& descriptions)
+        {
+            if(!FileSystem::FileExists(filePath))
+                return false;
+
+            u32 version = 0;
+            std::istringstream istr;
+            istr.str(FileSystem::ReadTextFile(filePath));
+            cereal::JSONInputArchive input(istr);
+            input(cereal::make_nvp("Version", version));
+            if(version != PIPELINE_MANIFEST_VERSION)
+                return false;
+            input(cereal::make_nvp("Pipelines", descriptions));
+            return true;
+        }
+
+		Pipeline* Pipeline::Create(const PipelineInfo& pipelineInfo)
+		{
+            LUMOS_ASSERT(CreateFunc, "No Pipeline Create Function");
+            return CreateFunc(pipelineInfo);
+		}
+
+        Ref<Pipeline> Pipeline::Get(const PipelineInfo& pipelineInfo)
+        {
+            const size_t hash = HashPipelineInfo(pipelineInfo);
+            RecordDescription(hash, pipelineInfo);
+
+            auto found = m_PipelineCache.Find(hash);
+            if (found)
+            {
+                m_PrewarmedPipelines.erase(hash);
+                return found;
+            }
+
             auto pipeline = Ref<Pipeline>(Create(pipelineInfo));
-            m_PipelineCache[hash] = pipeline;
+            m_PipelineCache.Insert(hash, pipeline);
             return pipeline;
         }
-    
+
         void Pipeline::ClearCache()
         {
-            m_PipelineCache.clear();
+            m_PrewarmedPipelines.clear();
+            m_PipelineCache.Clear();
+            m_PipelineDescriptions.clear();
         }
-    
+
         void Pipeline::DeleteUnusedCache()
         {
-            for (const auto & [ key, value ] : m_PipelineCache)
+            LUMOS_PROFILE_FUNCTION();
+            m_PipelineCache.Update(GetResourceReleaseDelay(), Engine::Get().Statistics().PipelineCache);
+        }
+
+        void Pipeline::SaveCacheManifest(const std::string& filePath)
+        {
+            LUMOS_PROFILE_FUNCTION();
+            std::vector<PipelineDescription> descriptions;
+            descriptions.reserve(m_PipelineDescriptions.size());
+            for(auto& [hash, description] : m_PipelineDescriptions)
+                descriptions.push_back(description);
+
+            std::stringstream storage;
+            {
+                // output finishes flushing its contents when it goes out of scope
+                cereal::JSONOutputArchive output{storage};
+                output(cereal::make_nvp("Version", PIPELINE_MANIFEST_VERSION), cereal::make_nvp("Pipelines", descriptions));
+            }
+
+            FileSystem::WriteTextFile(filePath, storage.str());
+        }
+
+        std::vector<std::string> Pipeline::GetCacheManifestShaders(const std::string& filePath)
+        {
+            LUMOS_PROFILE_FUNCTION();
+            std::vector<std::string> shaders;
+            std::vector<PipelineDescription> descriptions;
+            if(!ReadCacheManifest(filePath, descriptions))
+                return shaders;
+
+            for(auto& description : descriptions)
             {
-                if(value && value.GetCounter()->GetReferenceCount() == 1)
-                    m_PipelineCache[key] = nullptr;
+                if(std::find(shaders.begin(), shaders.end(), description.shader) == shaders.end())
+                    shaders.push_back(description.shader);
             }
+            return shaders;
+        }
+
+        void Pipeline::PrewarmCache(const std::string& filePath)
+        {
+            LUMOS_PROFILE_FUNCTION();
+            std::vector<PipelineDescription> descriptions;
+            if(!ReadCacheManifest(filePath, descriptions))
+                return;
+
+            // Shaders and renderpasses come from caches that are not thread safe, so they are resolved here first
+            std::vector<PipelineInfo> pipelineInfos;
+            std::vector<size_t> hashes;
+            pipelineInfos.reserve(descriptions.size());
+
+            for(auto& description : descriptions)
+            {
+                if(description.attachmentTypes.size() != description.attachmentFormats.size())
+                    continue;
+
+                PipelineInfo pipelineInfo;
+                pipelineInfo.shader = Application::Get().GetShaderLibrary()->GetResource(description.shader);
+                if(!pipelineInfo.shader)
+                    continue;
+
+                std::vector<AttachmentInfo> attachments;
+                for(size_t i = 0; i < description.attachmentTypes.size(); i++)
+                    attachments.push_back({ static_cast<TextureType>(description.attachmentTypes[i]), static_cast<TextureFormat>(description.attachmentFormats[i]) });
+
+                RenderPassInfo renderPassInfo;
+                renderPassInfo.textureType = attachments.data();
+                renderPassInfo.attachmentCount = static_cast<int>(attachments.size());
+                renderPassInfo.clear = description.clear;
+
+                pipelineInfo.renderpass = RenderPass::Get(renderPassInfo);
+                pipelineInfo.cullMode = static_cast<CullMode>(description.cullMode);
+                pipelineInfo.polygonMode = static_cast<PolygonMode>(description.polygonMode);
+                pipelineInfo.drawType = static_cast<DrawType>(description.drawType);
+                pipelineInfo.transparencyEnabled = description.transparencyEnabled;
+                pipelineInfo.depthBiasEnabled = description.depthBiasEnabled;
+                pipelineInfo.vertexBufferLayout = RebuildLayout(description.vertexStride, description.vertexLayout);
+                pipelineInfo.instanceBufferLayout = RebuildLayout(description.instanceStride, description.instanceLayout);
+
+                const size_t hash = HashPipelineInfo(pipelineInfo);
+                if(m_PipelineCache.Find(hash))
+                    continue;
+
+                pipelineInfos.push_back(pipelineInfo);
+                hashes.push_back(hash);
+            }
+
+            const u32 count = static_cast<u32>(pipelineInfos.size());
+            std::vector<Pipeline*> pipelines(count, nullptr);
+
+            // Vulkan objects can be created from any thread, OpenGL ones only where the context is current
+            if(GraphicsContext::GetRenderAPI() == RenderAPI::VULKAN)
+            {
+                System::JobSystem::Context ctx;
+                System::JobSystem::Dispatch(ctx, count, 1, [&](JobDispatchArgs args) {
+                    pipelines[args.jobIndex] = Create(pipelineInfos[args.jobIndex]);
+                });
+                System::JobSystem::Wait(ctx);
+            }
+            else
+            {
+                for(u32 i = 0; i < count; i++)
+                    pipelines[i] = Create(pipelineInfos[i]);
+            }
+
+            for(u32 i = 0; i < count; i++)
+            {
+                auto pipeline = Ref<Pipeline>(pipelines[i]);
+                m_PipelineCache.Insert(hashes[i], pipeline);
+                m_PrewarmedPipelines[hashes[i]] = pipeline;
+            }
+
+            LUMOS_LOG_INFO("Prewarmed {0} pipelines", count);
         }
 	}
 }
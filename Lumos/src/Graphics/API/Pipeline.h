@@ -34,6 +34,9 @@ namespace Lumos
             Ref<RenderPass> renderpass;
 			Ref<Shader> shader;
             BufferLayout vertexBufferLayout;
+            // Per instance attributes, read from the buffer bound with VertexBuffer::BindInstances.
+            // Locations follow on from the vertex layout
+            BufferLayout instanceBufferLayout;
             
 			CullMode cullMode = CullMode::BACK;
 			PolygonMode polygonMode = PolygonMode::FILL;
@@ -51,6 +54,17 @@ namespace Lumos
             static void ClearCache();
             static void DeleteUnusedCache();
 
+            // Writes a description of every pipeline requested this session, so the next session can create them before first use.
+            // Only pipelines whose shader came from the ShaderLibrary can be described
+            static void SaveCacheManifest(const std::string& filePath);
+
+            // Shaders used by the pipelines in a manifest, so they can start loading before PrewarmCache needs them
+            static std::vector<std::string> GetCacheManifestShaders(const std::string& filePath);
+
+            // Creates the pipelines listed in a manifest written by SaveCacheManifest, on worker threads when the render API allows it.
+            // They are kept alive until first requested through Get
+            static void PrewarmCache(const std::string& filePath);
+
 			virtual ~Pipeline() = default;
 
             virtual void Bind(CommandBuffer* cmdBuffer) = 0;
@@ -15,13 +15,13 @@ namespace Lumos
 {
 	namespace Graphics
     {
-        Query*(*Query::CreateFunc)(QueryType) = nullptr;
+        Query*(*Query::CreateFunc)(QueryType, u32) = nullptr;
 
-		Query* Query::Create(QueryType type)
+		Query* Query::Create(QueryType type, u32 count)
 		{
             LUMOS_ASSERT(CreateFunc, "No Query Create Function");
             
-            return CreateFunc(type);
+            return CreateFunc(type, count);
 		}
 	}
 }
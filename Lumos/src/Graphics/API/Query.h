@@ -4,29 +4,39 @@ namespace Lumos
 {
 	namespace Graphics
 	{
+		class CommandBuffer;
+
 		enum class LUMOS_EXPORT QueryType
 		{
 			SAMPLES_PASSED,
-			ANY_SAMPLES_PASSED
+			ANY_SAMPLES_PASSED,
+			TIMESTAMP
 		};
 
 		class Query
 		{
 		public:
 			virtual ~Query() = default;
-			static Query* Create(QueryType type);
+			// Timestamp queries hold count timestamps, the other types a single result
+			static Query* Create(QueryType type, u32 count = 1);
 
 			virtual void Begin() = 0;
 			virtual u32 GetResult() = 0;
 			virtual bool GetResultReady() = 0;
 			virtual void End() = 0;
 
+			// Records the GPU time at which every command submitted before this one has finished. Must be recorded
+			// outside a render pass. OpenGL writes it into the command stream and ignores commandBuffer
+			virtual void WriteTimestamp(CommandBuffer* commandBuffer, u32 index) = 0;
+			// Reads count timestamps in nanoseconds without waiting, returns false when the GPU has not written them all yet
+			virtual bool GetTimestamps(u32 first, u32 count, u64* nanoseconds) = 0;
+
 			_FORCE_INLINE_ bool GetInUse() const { return m_InUse; }
 
 			bool m_InUse;
             
         protected:
-            static Query* (*CreateFunc)(QueryType);
+            static Query* (*CreateFunc)(QueryType, u32);
 		};
 	}
 }
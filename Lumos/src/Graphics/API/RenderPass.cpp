@@ -1,13 +1,15 @@
 #include "Precompiled.h"
 #include "RenderPass.h"
 
+#include "ResourceCache.h"
 #include "Utilities/CombineHash.h"
 
 namespace Lumos
 {
 	namespace Graphics
 	{
-        static std::unordered_map<std::size_t, Ref<RenderPass>> m_RenderPassCache;
+        static constexpr u32 RENDERPASS_CACHE_MAX_AGE = 300;
+        static ResourceCache<RenderPass> m_RenderPassCache(RENDERPASS_CACHE_MAX_AGE);
 
 		RenderPass::~RenderPass() = default;
         RenderPass*(*RenderPass::CreateFunc)(const RenderPassInfo&) = nullptr;
@@ -16,7 +18,10 @@ namespace Lumos
 		{
             LUMOS_ASSERT(CreateFunc, "No RenderPass Create Function");
             
-            return CreateFunc(renderPassCI);
+            RenderPass* renderPass = CreateFunc(renderPassCI);
+            renderPass->m_AttachmentInfos.assign(renderPassCI.textureType, renderPassCI.textureType + renderPassCI.attachmentCount);
+            renderPass->m_Clear = renderPassCI.clear;
+            return renderPass;
 		}
     
         Ref<RenderPass> RenderPass::Get(const RenderPassInfo& renderPassInfo)
@@ -29,29 +34,26 @@ namespace Lumos
                 HashCombine(hash, renderPassInfo.textureType[i].format, renderPassInfo.textureType[i].textureType);
             }
             
-            auto found = m_RenderPassCache.find(hash);
-            if (found != m_RenderPassCache.end() && found->second)
+            auto found = m_RenderPassCache.Find(hash);
+            if (found)
             {
-                return found->second;
+                return found;
             }
             
             auto renderpass = Ref<RenderPass>(Create(renderPassInfo));
-            m_RenderPassCache[hash] = renderpass;
+            m_RenderPassCache.Insert(hash, renderpass);
             return renderpass;
         }
     
         void RenderPass::ClearCache()
         {
-            m_RenderPassCache.clear();
+            m_RenderPassCache.Clear();
         }
     
         void RenderPass::DeleteUnusedCache()
         {
-            for (const auto & [ key, value ] : m_RenderPassCache)
-            {
-                if(value && value.GetCounter()->GetReferenceCount() == 1)
-                    m_RenderPassCache[key] = nullptr;
-            }
+            LUMOS_PROFILE_FUNCTION();
+            m_RenderPassCache.Update(GetResourceReleaseDelay(), Engine::Get().Statistics().RenderPassCache);
         }
 	}
 }
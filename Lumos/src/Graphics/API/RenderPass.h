@@ -46,9 +46,16 @@ namespace Lumos
 			virtual void BeginRenderpass(CommandBuffer* commandBuffer, const Maths::Vector4& clearColour, Framebuffer* frame, SubPassContents contents, uint32_t width, uint32_t height, bool beginCommandBuffer = true) const = 0;
 			virtual void EndRenderpass(CommandBuffer* commandBuffer, bool endCommandBuffer = true) = 0;
             virtual int GetAttachmentCount() const = 0;
+
+            // Copy of the RenderPassInfo this was created from
+            const std::vector<AttachmentInfo>& GetAttachmentInfos() const { return m_AttachmentInfos; }
+            bool GetClear() const { return m_Clear; }
             
         protected:
             static RenderPass* (*CreateFunc)(const RenderPassInfo&);
+
+            std::vector<AttachmentInfo> m_AttachmentInfos;
+            bool m_Clear = true;
 		};
 	}
 }
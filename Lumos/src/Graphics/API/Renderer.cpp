@@ -1,5 +1,7 @@
 #include "Precompiled.h"
 #include "Renderer.h"
+#include "ResourceCache.h"
+#include "UniformRingBuffer.h"
 
 namespace Lumos
 {
@@ -8,6 +10,9 @@ namespace Lumos
         Renderer*(*Renderer::CreateFunc)(u32, u32) = nullptr;
 
 		Renderer* Renderer::s_Instance = nullptr;
+		UniformRingBuffer* Renderer::s_UniformRingBuffer = nullptr;
+
+		static constexpr u32 UNIFORM_RING_FRAME_SIZE = 256 * 1024;
 
 		void Renderer::Init(u32 width, u32 height)
 		{
@@ -15,10 +20,15 @@ namespace Lumos
             
             s_Instance = CreateFunc(width, height);
 			s_Instance->InitInternal();
+
+			s_UniformRingBuffer = new UniformRingBuffer(UNIFORM_RING_FRAME_SIZE, GetResourceReleaseDelay());
 		}
 
 		void Renderer::Release()
 		{
+			delete s_UniformRingBuffer;
+			s_UniformRingBuffer = nullptr;
+
 			delete s_Instance;
 
 			s_Instance = nullptr;
@@ -10,6 +10,8 @@ namespace Lumos
 		class Swapchain;
 		class IndexBuffer;
 		class Mesh;
+		class UniformRingBuffer;
+		struct PushConstant;
 
 		enum RendererBufferType
 		{
@@ -82,6 +84,16 @@ namespace Lumos
 			float MaxAnisotropy = 0.0f;
 			int MaxTextureUnits = 0;
 			int UniformBufferOffsetAlignment = 0;
+			// Largest range of a buffer one uniform block binding can cover
+			int MaxUniformBufferRange = 0;
+			// Largest range of a buffer one storage block binding can cover
+			int MaxStorageBufferRange = 0;
+			// Sampler arrays can be indexed with values that differ across a draw, so one draw can sample any bound texture
+			bool SupportsBindlessTextures = false;
+			// Fragment shaders can read storage blocks, whose arrays are sized by the buffer bound rather than the shader
+			bool SupportsStorageBuffers = false;
+			// Query::WriteTimestamp works on the queue the renderers submit to
+			bool SupportsTimestampQueries = false;
 		};
 
 		class LUMOS_EXPORT Renderer
@@ -103,9 +115,11 @@ namespace Lumos
 			virtual void PresentInternal() = 0;
 			virtual void PresentInternal(Graphics::CommandBuffer* cmdBuffer) = 0;
 			virtual void BindDescriptorSetsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, u32 dynamicOffset, std::vector<Graphics::DescriptorSet*>& descriptorSets) = 0;
+			virtual void PushConstantsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, std::vector<Graphics::PushConstant>& pushConstants) = 0;
 
 			virtual const std::string& GetTitleInternal() const = 0;
 			virtual void DrawIndexedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 start) const = 0;
+			virtual void DrawIndexedInstancedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 instanceCount) const = 0;
 			virtual void DrawInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, DataType datayType, void* indices) const = 0;
 			virtual Graphics::Swapchain* GetSwapchainInternal() const = 0;
 
@@ -121,6 +135,11 @@ namespace Lumos
 			{
 				s_Instance->BindDescriptorSetsInternal(pipeline, cmdBuffer, dynamicOffset, descriptorSets);
 			}
+			// Updates push constants without rebinding descriptor sets, for draws that reuse the sets already bound
+			_FORCE_INLINE_ static void PushConstants(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, std::vector<Graphics::PushConstant>& pushConstants)
+			{
+				s_Instance->PushConstantsInternal(pipeline, cmdBuffer, pushConstants);
+			}
 			_FORCE_INLINE_ static void Draw(CommandBuffer* commandBuffer, DrawType type, u32 count, DataType datayType = DataType::UNSIGNED_INT, void* indices = nullptr)
 			{
 				s_Instance->DrawInternal(commandBuffer, type, count, datayType, indices);
@@ -129,6 +148,11 @@ namespace Lumos
 			{
 				s_Instance->DrawIndexedInternal(commandBuffer, type, count, start);
 			}
+			// Not counted in Engine stats, record instanced draws through RenderBindState which tallies them per thread
+			_FORCE_INLINE_ static void DrawIndexedInstanced(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 instanceCount)
+			{
+				s_Instance->DrawIndexedInstancedInternal(commandBuffer, type, count, instanceCount);
+			}
 			_FORCE_INLINE_ static const std::string& GetTitle()
 			{
 				return s_Instance->GetTitleInternal();
@@ -139,6 +163,12 @@ namespace Lumos
 				return s_Instance->GetSwapchainInternal();
 			}
 
+			// Per frame uniforms of every renderer are pushed here and bound with dynamic offsets
+			_FORCE_INLINE_ static UniformRingBuffer* GetUniformRingBuffer()
+			{
+				return s_UniformRingBuffer;
+			}
+
 			static RenderAPICapabilities& GetCapabilities()
 			{
 				static RenderAPICapabilities capabilities;
@@ -149,6 +179,7 @@ namespace Lumos
 			static Renderer* (*CreateFunc)(u32, u32);
 
 			static Renderer* s_Instance;
+			static UniformRingBuffer* s_UniformRingBuffer;
 		};
 	}
 }
@@ -0,0 +1,121 @@
+#pragma once
+#include "Core/Engine.h"
+#include "Renderer.h"
+#include "Swapchain.h"
+
+#include <deque>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// Frames a resource may still be referenced by submitted command buffers
+		inline u32 GetResourceReleaseDelay()
+		{
+			Swapchain* swapchain = Renderer::GetSwapchain();
+			return swapchain ? static_cast<u32>(swapchain->GetSwapchainBufferCount()) + 1 : 1;
+		}
+
+		// Hash keyed cache behind Pipeline::Get, RenderPass::Get and Framebuffer::Get.
+		// Entries only the cache still references age by one every Update and are erased once older than maxAge frames,
+		// so anything requested again soon after being dropped is reused. Erased resources are held for a few more
+		// frames before they are released, as command buffers still in flight may reference them
+		template<typename T>
+		class ResourceCache
+		{
+		public:
+			explicit ResourceCache(u32 maxAge)
+				: m_MaxAge(maxAge)
+			{
+			}
+
+			Ref<T> Find(size_t hash)
+			{
+				auto found = m_Entries.find(hash);
+				if(found == m_Entries.end())
+				{
+					m_Misses++;
+					return nullptr;
+				}
+
+				m_Hits++;
+				found->second.lastUsedFrame = m_Frame;
+				return found->second.resource;
+			}
+
+			void Insert(size_t hash, const Ref<T>& resource)
+			{
+				auto& entry = m_Entries[hash];
+				if(entry.resource && entry.resource != resource)
+					m_PendingRelease.push_back({ m_Frame, entry.resource });
+
+				entry.resource = resource;
+				entry.lastUsedFrame = m_Frame;
+			}
+
+			// Call once per frame. releaseDelay is the number of frames the GPU may still be using a resource
+			void Update(u32 releaseDelay, Engine::CacheStats& stats)
+			{
+				m_Frame++;
+
+				u32 evicted = 0;
+				for(auto itr = m_Entries.begin(); itr != m_Entries.end();)
+				{
+					Entry& entry = itr->second;
+					if(entry.resource.GetCounter()->GetReferenceCount() > 1)
+					{
+						// Still held outside the cache
+						entry.lastUsedFrame = m_Frame;
+						++itr;
+					}
+					else if(m_Frame - entry.lastUsedFrame > m_MaxAge)
+					{
+						m_PendingRelease.push_back({ m_Frame, entry.resource });
+						itr = m_Entries.erase(itr);
+						evicted++;
+					}
+					else
+						++itr;
+				}
+
+				while(!m_PendingRelease.empty() && m_Frame - m_PendingRelease.front().frame >= releaseDelay)
+					m_PendingRelease.pop_front();
+
+				stats.Size = static_cast<u32>(m_Entries.size());
+				stats.PendingRelease = static_cast<u32>(m_PendingRelease.size());
+				stats.Hits += m_Hits;
+				stats.Misses += m_Misses;
+				stats.Evicted += evicted;
+				m_Hits = 0;
+				m_Misses = 0;
+			}
+
+			// Releases everything immediately, the GPU must be idle
+			void Clear()
+			{
+				m_Entries.clear();
+				m_PendingRelease.clear();
+			}
+
+		private:
+			struct Entry
+			{
+				Ref<T> resource;
+				u64 lastUsedFrame = 0;
+			};
+
+			struct PendingRelease
+			{
+				u64 frame;
+				Ref<T> resource;
+			};
+
+			std::unordered_map<size_t, Entry> m_Entries;
+			std::deque<PendingRelease> m_PendingRelease;
+			u64 m_Frame = 0;
+			u32 m_MaxAge;
+			u32 m_Hits = 0;
+			u32 m_Misses = 0;
+		};
+	}
+}
@@ -8,14 +8,14 @@ namespace Lumos
 {
 	namespace Graphics
 	{
-		Shader* (*Shader::CreateFunc)(const std::string&) = nullptr;
+		Shader* (*Shader::CreateFunc)(const std::string&, bool) = nullptr;
 
 		const Shader* Shader::s_CurrentlyBound = nullptr;
 
-		Shader* Shader::CreateFromFile(const std::string& filepath)
+		Shader* Shader::CreateFromFile(const std::string& filepath, bool deferred)
 		{
 			LUMOS_ASSERT(CreateFunc, "No Shader Create Function");
-			return CreateFunc(filepath);
+			return CreateFunc(filepath, deferred);
 		}
 	}
 }
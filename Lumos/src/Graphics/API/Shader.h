@@ -12,6 +12,11 @@
 #define SHADER_MID_INDEX 4
 #define SHADER_COLOR_INDEX 5
 
+// The vertex stage uniform block at this set and binding holds the per frame system uniforms. It is always
+// reflected as UNIFORM_BUFFER_DYNAMIC and bound to the UniformRingBuffer, whatever the block is called
+#define SHADER_SYSTEM_UNIFORM_SET 0
+#define SHADER_SYSTEM_UNIFORM_BINDING 0
+
 namespace Lumos
 {
 	namespace Graphics
@@ -59,11 +64,15 @@ namespace Lumos
 
 			virtual void* GetHandle() const = 0;
 
+			// Finishes a shader created deferred, on the main thread. Does nothing for shaders that are already complete
+			virtual void CompleteLoading() {}
+
 		public:
-			static Shader* CreateFromFile(const std::string& filepath);
+			// A deferred shader only does the work that is safe on a worker thread, CompleteLoading does the rest
+			static Shader* CreateFromFile(const std::string& filepath, bool deferred = false);
 
 		protected:
-			static Shader* (*CreateFunc)(const std::string&);
+			static Shader* (*CreateFunc)(const std::string&, bool);
 		};
 	}
 }
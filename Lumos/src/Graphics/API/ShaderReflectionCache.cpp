@@ -0,0 +1,126 @@
+#include "Precompiled.h"
+#include "ShaderReflectionCache.h"
+#include "Core/OS/FileSystem.h"
+#include "Core/Application.h"
+#include "Core/StringUtilities.h"
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <filesystem>
+#include <string_view>
+#include <mutex>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// Bump when the reflection or the GLSL options used by GLShader change, so stale entries are rebuilt
+		static constexpr u32 SHADER_REFLECTION_VERSION = 2;
+
+		// Shaders load on worker threads and some share a stage, so two of them can write the same entry
+		static std::mutex s_CacheMutex;
+
+		template<typename Archive>
+		void serialize(Archive& archive, DescriptorLayoutInfo& info)
+		{
+			u32 type = static_cast<u32>(info.type);
+			u32 stage = static_cast<u32>(info.stage);
+			archive(cereal::make_nvp("Type", type), cereal::make_nvp("Stage", stage), cereal::make_nvp("Binding", info.binding), cereal::make_nvp("Set", info.setID), cereal::make_nvp("Count", info.count));
+			info.type = static_cast<DescriptorType>(type);
+			info.stage = static_cast<ShaderType>(stage);
+		}
+
+		template<typename Archive>
+		void serialize(Archive& archive, PushConstant& pushConstant)
+		{
+			u32 stage = static_cast<u32>(pushConstant.shaderStage);
+			archive(cereal::make_nvp("Size", pushConstant.size), cereal::make_nvp("Stage", stage));
+			pushConstant.shaderStage = static_cast<ShaderType>(stage);
+			pushConstant.data = nullptr;
+		}
+
+		u64 ShaderReflectionCache::HashSource(const u32* source, size_t size)
+		{
+			return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(source), size));
+		}
+
+		std::string ShaderReflectionCache::GetFilePath(const std::string& stagePath, const std::string& extension)
+		{
+			std::stringstream path;
+			path << Application::Get().GetCachePath() << "ShaderCache/" << StringUtilities::GetFileName(stagePath) << "_" << std::hex << std::hash<std::string>()(stagePath) << extension;
+			return path.str();
+		}
+
+		bool ShaderReflectionCache::Load(const std::string& filePath, u64 hash, ShaderReflection& reflection)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			std::lock_guard<std::mutex> lock(s_CacheMutex);
+			if(!FileSystem::FileExists(filePath))
+				return false;
+
+			u32 version = 0;
+			u64 sourceHash = 0;
+
+			std::istringstream istr;
+			istr.str(FileSystem::ReadTextFile(filePath));
+
+			// A truncated or corrupt file is treated as a miss, the entry is rebuilt and saved over it
+			try
+			{
+				cereal::JSONInputArchive input(istr);
+				input(cereal::make_nvp("Version", version), cereal::make_nvp("Hash", sourceHash));
+				if(version != SHADER_REFLECTION_VERSION || sourceHash != hash)
+					return false;
+
+				ShaderReflection loaded;
+				input(cereal::make_nvp("DescriptorLayout", loaded.descriptorLayout), cereal::make_nvp("PushConstants", loaded.pushConstants),
+					cereal::make_nvp("GLSL", loaded.glsl), cereal::make_nvp("UniformBlocks", loaded.uniformBlocks));
+				reflection = std::move(loaded);
+			}
+			catch(const cereal::Exception& e)
+			{
+				LUMOS_LOG_WARN("Ignoring unreadable shader reflection cache {0} : {1}", filePath, e.what());
+				return false;
+			}
+
+			return true;
+		}
+
+		void ShaderReflectionCache::Save(const std::string& filePath, u64 hash, const ShaderReflection& reflection)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			ShaderReflection copy = reflection;
+
+			std::stringstream storage;
+			{
+				// output finishes flushing its contents when it goes out of scope
+				cereal::JSONOutputArchive output{storage};
+				output(cereal::make_nvp("Version", SHADER_REFLECTION_VERSION), cereal::make_nvp("Hash", hash),
+					cereal::make_nvp("DescriptorLayout", copy.descriptorLayout), cereal::make_nvp("PushConstants", copy.pushConstants),
+					cereal::make_nvp("GLSL", copy.glsl), cereal::make_nvp("UniformBlocks", copy.uniformBlocks));
+			}
+
+			std::lock_guard<std::mutex> lock(s_CacheMutex);
+
+			std::error_code error;
+			std::filesystem::create_directories(std::filesystem::path(filePath).parent_path(), error);
+
+			// Written next to the cache and moved over it, so a crash mid write never leaves a partial file behind
+			const std::string tempPath = filePath + ".tmp";
+			if(!FileSystem::WriteTextFile(tempPath, storage.str()))
+			{
+				LUMOS_LOG_WARN("Failed to write shader reflection cache {0}", tempPath);
+				return;
+			}
+
+			std::filesystem::rename(tempPath, filePath, error);
+			if(error)
+			{
+				LUMOS_LOG_WARN("Failed to replace shader reflection cache {0} : {1}", filePath, error.message());
+				std::filesystem::remove(tempPath, error);
+			}
+		}
+	}
+}
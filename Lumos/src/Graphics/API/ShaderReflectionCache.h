@@ -0,0 +1,35 @@
+#pragma once
+#include "DescriptorSet.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// What the shaders take from SPIRV-Cross when a stage is loaded
+		struct ShaderReflection
+		{
+			std::vector<DescriptorLayoutInfo> descriptorLayout;
+			std::vector<PushConstant> pushConstants;
+
+			// OpenGL only, the stage cross compiled to GLSL and the names of its uniform blocks
+			std::string glsl;
+			std::vector<std::string> uniformBlocks;
+		};
+
+		// Keeps the reflection of each compiled stage in a file under the application's cache path, so loading a shader does not
+		// have to parse and cross compile the SPIR-V again. Entries are keyed by a hash of the SPIR-V and are rebuilt when it changes
+		class LUMOS_EXPORT ShaderReflectionCache
+		{
+		public:
+			static u64 HashSource(const u32* source, size_t size);
+
+			// Cache file for the stage at stagePath, named after the stage and a hash of its full path so stages with the
+			// same name in different directories do not share an entry
+			static std::string GetFilePath(const std::string& stagePath, const std::string& extension);
+
+			// Returns false when there is no entry for this hash, the reflection should then be built and saved
+			static bool Load(const std::string& filePath, u64 hash, ShaderReflection& reflection);
+			static void Save(const std::string& filePath, u64 hash, const ShaderReflection& reflection);
+		};
+	}
+}
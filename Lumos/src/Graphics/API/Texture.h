@@ -30,6 +30,7 @@ namespace Lumos
 			RG8,
 			RGB8,
 			RGBA8,
+			RG16,
 			RGB16,
 			RGBA16,
 			RGB32,
@@ -151,6 +152,12 @@ namespace Lumos
 				return 0;
 			}
 			virtual void* GetHandle() const = 0;
+			// Changes whenever the objects behind GetHandle are recreated. Drivers reuse handle values once an
+			// object is destroyed, so caches of descriptors key on this rather than on the handles alone
+			virtual u64 GetHandleID() const
+			{
+				return 0;
+			}
 
 			static bool IsDepthStencilFormat(TextureFormat format)
 			{
@@ -4,6 +4,7 @@ namespace Lumos
 {
 	namespace Graphics
 	{
+		// Also backs storage blocks, bound with DescriptorType::STORAGE_BUFFER
 		class UniformBuffer
 		{
 		public:
@@ -16,6 +17,10 @@ namespace Lumos
 			virtual void SetDynamicData(uint32_t size, uint32_t typeSize, const void* data) = 0;
 
 			virtual u8* GetBuffer() const = 0;
+
+			// Maps the whole buffer for the rest of its lifetime. Writes reach the GPU once the written range is flushed
+			virtual u8* MapPersistent() = 0;
+			virtual void Flush(uint32_t offset, uint32_t size) = 0;
             
         protected:
             static UniformBuffer* (*CreateFunc)();
@@ -0,0 +1,67 @@
+#include "Precompiled.h"
+#include "UniformRingBuffer.h"
+#include "UniformBuffer.h"
+#include "Renderer.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		static constexpr u32 FALLBACK_BLOCK_SIZE = 16 * 1024;
+
+		UniformRingBuffer::UniformRingBuffer(u32 frameSize, u32 frameCount)
+			: m_FrameCount(frameCount)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			// Every offset handed out has to be usable as a dynamic offset
+			const int alignment = Renderer::GetCapabilities().UniformBufferOffsetAlignment;
+			m_Alignment = alignment > 0 ? u32(alignment) : 256;
+			m_FrameSize = (frameSize + m_Alignment - 1) / m_Alignment * m_Alignment;
+
+			m_Buffer = UniformBuffer::Create();
+			m_Buffer->Init((m_FrameSize + FALLBACK_BLOCK_SIZE) * m_FrameCount, nullptr);
+			m_Mapped = m_Buffer->MapPersistent();
+		}
+
+		UniformRingBuffer::~UniformRingBuffer()
+		{
+			delete m_Buffer;
+		}
+
+		void UniformRingBuffer::BeginFrame()
+		{
+			m_FrameIndex = (m_FrameIndex + 1) % m_FrameCount;
+			m_Head = 0;
+			m_FallbackHead = 0;
+			m_Overflowed = false;
+		}
+
+		u32 UniformRingBuffer::Push(const void* data, u32 size)
+		{
+			const u32 alignedSize = (size + m_Alignment - 1) / m_Alignment * m_Alignment;
+			u32 offset = m_Head.fetch_add(alignedSize);
+
+			if(offset + size <= m_FrameSize)
+				offset += m_FrameIndex * m_FrameSize;
+			else
+			{
+				if(!m_Overflowed.exchange(true))
+					LUMOS_LOG_ERROR("Uniform ring buffer frame region of {0} bytes is full, increase its frame size", m_FrameSize);
+
+				// This frame's fallback block, the other frames in flight may still be reading theirs
+				const u32 fallbackOffset = m_FallbackHead.fetch_add(alignedSize);
+				LUMOS_ASSERT(fallbackOffset + size <= FALLBACK_BLOCK_SIZE, "Uniform ring buffer fallback block is full");
+				// Nothing is written in release, the draw reads stale uniforms rather than overwriting bound ones
+				if(fallbackOffset + size > FALLBACK_BLOCK_SIZE)
+					return m_FrameSize * m_FrameCount + m_FrameIndex * FALLBACK_BLOCK_SIZE;
+
+				offset = m_FrameSize * m_FrameCount + m_FrameIndex * FALLBACK_BLOCK_SIZE + fallbackOffset;
+			}
+
+			memcpy(m_Mapped + offset, data, size);
+			m_Buffer->Flush(offset, size);
+
+			return offset;
+		}
+	}
+}
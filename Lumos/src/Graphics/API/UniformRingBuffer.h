@@ -0,0 +1,48 @@
+#pragma once
+#include "Core/Core.h"
+
+#include <atomic>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class UniformBuffer;
+
+		// One persistently mapped uniform buffer split into a region per frame in flight.
+		// Renderers copy their per frame uniforms in with Push and bind the returned offset as the dynamic offset of a
+		// UNIFORM_BUFFER_DYNAMIC binding, so they need no uniform buffers of their own and nothing is mapped per frame.
+		// A region is reused once the GPU is done with the frame that wrote it.
+		// Pushes that do not fit in the frame's region are bump allocated from that frame's fallback block, which follows
+		// the last region, so they never overwrite uniforms already pushed or still read by the GPU
+		class LUMOS_EXPORT UniformRingBuffer
+		{
+		public:
+			UniformRingBuffer(u32 frameSize, u32 frameCount);
+			~UniformRingBuffer();
+
+			// Call once per frame before any Push
+			void BeginFrame();
+
+			// Copies size bytes into this frame's region and returns their offset from the start of the buffer.
+			// Space is reserved without locking, so Vulkan renderers may push from worker threads
+			u32 Push(const void* data, u32 size);
+
+			UniformBuffer* GetBuffer() const { return m_Buffer; }
+			// Includes pushes that overflowed, more than GetFrameSize means the ring needs to be larger
+			u32 GetUsedSize() const { return std::min(m_Head.load(), m_FrameSize) + m_FallbackHead; }
+			u32 GetFrameSize() const { return m_FrameSize; }
+
+		private:
+			UniformBuffer* m_Buffer = nullptr;
+			u8* m_Mapped = nullptr;
+			u32 m_FrameSize;
+			u32 m_FrameCount;
+			u32 m_Alignment;
+			u32 m_FrameIndex = 0;
+			std::atomic<u32> m_Head = 0;
+			std::atomic<u32> m_FallbackHead = 0;
+			std::atomic<bool> m_Overflowed = false;
+		};
+	}
+}
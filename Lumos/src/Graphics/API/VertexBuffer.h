@@ -22,6 +22,8 @@ namespace Lumos
 			virtual void SetDataSub(u32 size, const void* data, u32 offset) = 0;
 			virtual void ReleasePointer() = 0;
 			virtual void Bind(CommandBuffer* commandBuffer, Pipeline* pipeline) = 0;
+			// Binds the buffer as the per instance stream of pipeline, starting offset bytes in
+			virtual void BindInstances(CommandBuffer* commandBuffer, Pipeline* pipeline, u32 offset) = 0;
 			virtual void Unbind() = 0;
 
 			template<typename T>
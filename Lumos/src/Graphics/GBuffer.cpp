@@ -7,6 +7,54 @@ namespace Lumos
 {
 	namespace Graphics
 	{
+		static u32 BytesPerPixel(TextureFormat format)
+		{
+			switch(format)
+			{
+			case TextureFormat::R8:		return 1;
+			case TextureFormat::RG8:	return 2;
+			case TextureFormat::RGB8:	return 4;
+			case TextureFormat::RGBA8:	return 4;
+			case TextureFormat::RG16:	return 4;
+			case TextureFormat::RGB16:	return 6;
+			case TextureFormat::RGBA16:	return 8;
+			case TextureFormat::RGB32:	return 12;
+			case TextureFormat::RGBA32:	return 16;
+			case TextureFormat::DEPTH:	return 4;
+			default:					return 0;
+			}
+		}
+
+		static void GetLayoutFormats(GBufferLayout layout, TextureFormat* formats)
+		{
+			formats[SCREENTEX_DEPTH] = TextureFormat::DEPTH;
+			formats[SCREENTEX_OFFSCREEN0] = TextureFormat::RGBA8;
+			formats[SCREENTEX_OFFSCREEN1] = TextureFormat::NONE;
+
+			if(layout == GBufferLayout::Compact)
+			{
+				formats[SCREENTEX_COLOUR] = TextureFormat::RGBA8;
+				formats[SCREENTEX_POSITION] = TextureFormat::NONE;
+				formats[SCREENTEX_NORMALS] = TextureFormat::RG16;
+				formats[SCREENTEX_PBR] = TextureFormat::RGBA16;
+				return;
+			}
+
+#ifdef LUMOS_PLATFORM_IOS
+			//Unless all render targets were rgba32 there were visual glitches on ios
+			formats[SCREENTEX_COLOUR] = TextureFormat::RGBA32;
+			formats[SCREENTEX_POSITION] = TextureFormat::RGBA32;
+			formats[SCREENTEX_NORMALS] = TextureFormat::RGBA32;
+			formats[SCREENTEX_PBR] = TextureFormat::RGBA32;
+			formats[SCREENTEX_OFFSCREEN0] = TextureFormat::RGBA32;
+#else
+			formats[SCREENTEX_COLOUR] = TextureFormat::RGBA8;
+			formats[SCREENTEX_POSITION] = TextureFormat::RGBA32;
+			formats[SCREENTEX_NORMALS] = TextureFormat::RGBA16;
+			formats[SCREENTEX_PBR] = TextureFormat::RGBA16;
+#endif
+		}
+
 		GBuffer::GBuffer(u32 width, u32 height)
 			: m_Width(width), m_Height(height)
 		{
@@ -55,31 +103,48 @@ namespace Lumos
 				m_DepthTexture = TextureDepth::Create(m_Width, m_Height);
 			}
 
-#ifdef LUMOS_PLATFORM_IOS
-            //Unless all render targets were rgba32 there were visual glitches on ios
-			m_Formats[0] = TextureFormat::RGBA32;
-			m_Formats[1] = TextureFormat::RGBA32;
-			m_Formats[2] = TextureFormat::RGBA32;
-			m_Formats[3] = TextureFormat::RGBA32;
-            m_Formats[4] = TextureFormat::RGBA32;
-#else
-            m_Formats[0] = TextureFormat::RGBA8;
-            m_Formats[1] = TextureFormat::RGBA32;
-            m_Formats[2] = TextureFormat::RGBA16;
-            m_Formats[3] = TextureFormat::RGBA16;
-            m_Formats[4] = TextureFormat::RGBA8;
-#endif
-		
+			GetLayoutFormats(m_Layout, m_Formats);
 
-			m_ScreenTex[SCREENTEX_COLOUR]->BuildTexture(m_Formats[0], m_Width, m_Height, false, false, false);
-			m_ScreenTex[SCREENTEX_POSITION]->BuildTexture(m_Formats[1], m_Width, m_Height, false, false, false);
-			m_ScreenTex[SCREENTEX_NORMALS]->BuildTexture(m_Formats[2], m_Width, m_Height, false, false, false);
-			m_ScreenTex[SCREENTEX_PBR]->BuildTexture(m_Formats[3], m_Width, m_Height, false, false, false);
-			m_ScreenTex[SCREENTEX_OFFSCREEN0]->BuildTexture(m_Formats[4], m_Width, m_Height, false, false, false);
+			m_ScreenTex[SCREENTEX_COLOUR]->BuildTexture(m_Formats[SCREENTEX_COLOUR], m_Width, m_Height, false, false, false);
+			m_ScreenTex[SCREENTEX_NORMALS]->BuildTexture(m_Formats[SCREENTEX_NORMALS], m_Width, m_Height, false, false, false);
+			m_ScreenTex[SCREENTEX_PBR]->BuildTexture(m_Formats[SCREENTEX_PBR], m_Width, m_Height, false, false, false);
+			m_ScreenTex[SCREENTEX_OFFSCREEN0]->BuildTexture(m_Formats[SCREENTEX_OFFSCREEN0], m_Width, m_Height, false, false, false);
+
+			if(m_Layout == GBufferLayout::Standard)
+				m_ScreenTex[SCREENTEX_POSITION]->BuildTexture(m_Formats[SCREENTEX_POSITION], m_Width, m_Height, false, false, false);
+			else
+			{
+				// Releases the position target left over from the standard layout
+				delete m_ScreenTex[SCREENTEX_POSITION];
+				m_ScreenTex[SCREENTEX_POSITION] = Texture2D::Create();
+			}
 
 			m_DepthTexture->Resize(m_Width, m_Height);
 		}
 
+		void GBuffer::SetLayout(GBufferLayout layout)
+		{
+			if(layout == m_Layout)
+				return;
+
+			m_Layout = layout;
+			BuildTextures();
+
+			LUMOS_LOG_INFO("GBuffer layout changed, {0:.2f}MB at {1}x{2}", float(GetMemorySize()) / (1024.0f * 1024.0f), m_Width, m_Height);
+		}
+
+		u64 GBuffer::CalculateMemorySize(GBufferLayout layout, u32 width, u32 height)
+		{
+			TextureFormat formats[SCREENTEX_MAX];
+			GetLayoutFormats(layout, formats);
+
+			u32 bytesPerPixel = 0;
+			for(u32 i = SCREENTEX_DEPTH; i <= SCREENTEX_PBR; i++)
+				bytesPerPixel += BytesPerPixel(formats[i]);
+
+			return u64(bytesPerPixel) * width * height;
+		}
+
 		void GBuffer::Bind(i32 mode)
 		{
 		}
@@ -24,6 +24,15 @@ namespace Lumos
 			SCREENTEX_MAX
 		};
 
+		enum class GBufferLayout
+		{
+			// RGBA8 albedo, RGBA32 world position, RGBA16 normals and RGBA16 metallic/roughness/ao with emissive spread over the alpha channels
+			Standard,
+			// RGBA8 albedo and roughness, RG16 octahedral normals and RGBA16 emissive with metallic and ao packed together.
+			// The position target is not used, positions are reconstructed from depth
+			Compact
+		};
+
 		class LUMOS_EXPORT GBuffer
 		{
 		public:
@@ -37,12 +46,20 @@ namespace Lumos
 			void UpdateTextureSize(u32 width, u32 height);
 			void SetReadBuffer(ScreenTextures type);
 
+			// Rebuilds the textures. Use RenderGraph::SetGBufferLayout to also rebuild the renderers writing and reading them
+			void SetLayout(GBufferLayout layout);
+
+			// Bytes the G-buffer targets and depth take at the given size, written once and read once every frame
+			static u64 CalculateMemorySize(GBufferLayout layout, u32 width, u32 height);
+			u64 GetMemorySize() const { return CalculateMemorySize(m_Layout, m_Width, m_Height); }
+
 			_FORCE_INLINE_ u32 GetWidth() const { return m_Width; }
 			_FORCE_INLINE_ u32 GetHeight() const { return m_Height; }
 
 			_FORCE_INLINE_ Texture2D* GetTexture(u32 index) const { return m_ScreenTex[index]; }
 			_FORCE_INLINE_ TextureDepth* GetDepthTexture() const { return m_DepthTexture; };
 			_FORCE_INLINE_ TextureFormat GetTextureFormat(u32 index) const { return m_Formats[index]; };
+			_FORCE_INLINE_ GBufferLayout GetLayout() const { return m_Layout; }
 
 		private:
 			void Init();
@@ -53,6 +70,7 @@ namespace Lumos
 			TextureDepth* m_DepthTexture{};
 			TextureFormat m_Formats[ScreenTextures::SCREENTEX_MAX];
 			u32 m_Width, m_Height;
+			GBufferLayout m_Layout = GBufferLayout::Standard;
 		};
 	}
 }
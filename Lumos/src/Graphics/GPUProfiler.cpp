@@ -0,0 +1,208 @@
+#include "Precompiled.h"
+#include "GPUProfiler.h"
+#include "Graphics/API/Query.h"
+#include "Graphics/API/Renderer.h"
+#include "Graphics/API/GraphicsContext.h"
+#include "Maths/Maths.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// Two timestamps per interval, a pass has one interval per primary command buffer under Vulkan
+		static constexpr u32 GPU_PROFILER_MAX_QUERIES = 256;
+
+		static GPUProfiler* s_Instance = nullptr;
+
+		GPUProfiler::GPUProfiler()
+		{
+			s_Instance = this;
+			m_Supported = Renderer::GetCapabilities().SupportsTimestampQueries;
+			if(!m_Supported)
+				return;
+
+			for(auto& frame : m_Frames)
+				frame.query = Query::Create(QueryType::TIMESTAMP, GPU_PROFILER_MAX_QUERIES);
+		}
+
+		GPUProfiler::~GPUProfiler()
+		{
+			for(auto& frame : m_Frames)
+				delete frame.query;
+
+			if(s_Instance == this)
+				s_Instance = nullptr;
+		}
+
+		void GPUProfiler::BeginFrame()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			m_Recording = nullptr;
+			m_CurrentPass = InvalidPass;
+			m_Open.clear();
+
+			if(!m_Supported)
+				return;
+
+			m_FrameIndex++;
+			Frame& frame = m_Frames[m_FrameIndex % FrameCount];
+			Resolve(frame);
+			frame.passes.clear();
+			frame.intervals.clear();
+
+			if(m_Enabled)
+				m_Recording = &frame;
+		}
+
+		void GPUProfiler::BeginPass(const std::string& name)
+		{
+			if(!m_Recording)
+				return;
+
+			Timing& timing = m_Timings[name];
+			if(timing.name.empty())
+			{
+				timing.name = name;
+				timing.plotName = "GPU " + name;
+			}
+
+			m_CurrentPass = static_cast<u32>(m_Recording->passes.size());
+			m_Recording->passes.push_back(&timing);
+
+			if(GraphicsContext::GetRenderAPI() != RenderAPI::VULKAN)
+				Open(nullptr);
+		}
+
+		void GPUProfiler::EndPass()
+		{
+			if(!m_Recording)
+				return;
+
+			if(GraphicsContext::GetRenderAPI() != RenderAPI::VULKAN)
+				Close(nullptr);
+			m_CurrentPass = InvalidPass;
+		}
+
+		void GPUProfiler::Open(CommandBuffer* commandBuffer)
+		{
+			if(m_CurrentPass == InvalidPass)
+				return;
+
+			const u32 query = static_cast<u32>(m_Recording->intervals.size()) * 2;
+			if(query + 2 > GPU_PROFILER_MAX_QUERIES)
+				return;
+
+			m_Open.push_back({ commandBuffer, static_cast<u32>(m_Recording->intervals.size()) });
+			m_Recording->intervals.push_back({ m_CurrentPass, query, false });
+			m_Recording->query->WriteTimestamp(commandBuffer, query);
+		}
+
+		void GPUProfiler::Close(CommandBuffer* commandBuffer)
+		{
+			for(auto it = m_Open.begin(); it != m_Open.end(); ++it)
+			{
+				if(it->first != commandBuffer)
+					continue;
+
+				Interval& interval = m_Recording->intervals[it->second];
+				m_Recording->query->WriteTimestamp(commandBuffer, interval.query + 1);
+				interval.closed = true;
+				m_Open.erase(it);
+				return;
+			}
+		}
+
+		void GPUProfiler::Resolve(Frame& frame)
+		{
+			if(frame.passes.empty())
+				return;
+
+			std::vector<u64> passTimes(frame.passes.size(), 0);
+			for(auto& interval : frame.intervals)
+			{
+				// A command buffer still recording when the frame ended never wrote its end
+				if(!interval.closed)
+					continue;
+
+				u64 timestamps[2];
+				if(!frame.query->GetTimestamps(interval.query, 2, timestamps))
+					return;
+
+				if(timestamps[1] > timestamps[0])
+					passTimes[interval.pass] += timestamps[1] - timestamps[0];
+			}
+
+			m_Resolved.clear();
+			for(size_t i = 0; i < frame.passes.size(); i++)
+			{
+				Timing* timing = frame.passes[i];
+				timing->milliseconds = static_cast<float>(static_cast<double>(passTimes[i]) / 1000000.0);
+				timing->average = timing->average > 0.0f ? Maths::Lerp(timing->average, timing->milliseconds, 0.1f) : timing->milliseconds;
+				m_Resolved.push_back(timing);
+
+				LUMOS_PROFILE_PLOT(timing->plotName.c_str(), timing->milliseconds);
+			}
+		}
+
+		void GPUProfiler::OnBeginRecording(CommandBuffer* commandBuffer)
+		{
+			if(s_Instance && s_Instance->m_Recording)
+				s_Instance->Open(commandBuffer);
+		}
+
+		void GPUProfiler::OnEndRecording(CommandBuffer* commandBuffer)
+		{
+			if(s_Instance && s_Instance->m_Recording)
+				s_Instance->Close(commandBuffer);
+		}
+
+		const char* GPUProfiler::GetCurrentPassName()
+		{
+			if(!s_Instance || !s_Instance->m_Recording || s_Instance->m_CurrentPass == InvalidPass)
+				return nullptr;
+			return s_Instance->m_Recording->passes[s_Instance->m_CurrentPass]->name.c_str();
+		}
+
+		void GPUProfiler::OnImGui()
+		{
+			if(!m_Supported)
+			{
+				ImGui::TextDisabled("Timestamp queries are not supported");
+				return;
+			}
+
+			ImGui::Checkbox("Enabled", &m_Enabled);
+
+			float total = 0.0f;
+			ImGui::Columns(3);
+			ImGui::TextUnformatted("Pass");
+			ImGui::NextColumn();
+			ImGui::TextUnformatted("ms");
+			ImGui::NextColumn();
+			ImGui::TextUnformatted("Average ms");
+			ImGui::NextColumn();
+			ImGui::Separator();
+
+			for(auto timing : m_Resolved)
+			{
+				ImGui::TextUnformatted(timing->name.c_str());
+				ImGui::NextColumn();
+				ImGui::Text("%.3f", timing->milliseconds);
+				ImGui::NextColumn();
+				ImGui::Text("%.3f", timing->average);
+				ImGui::NextColumn();
+				total += timing->milliseconds;
+			}
+
+			ImGui::Separator();
+			ImGui::TextUnformatted("Total");
+			ImGui::NextColumn();
+			ImGui::Text("%.3f", total);
+			ImGui::NextColumn();
+			ImGui::NextColumn();
+			ImGui::Columns(1);
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class Query;
+		class CommandBuffer;
+
+		// Measures how long each render graph pass takes on the GPU with timestamp queries. A frame's timestamps are read
+		// back a few frames later, and dropped if they are still not ready, so the CPU never waits on the GPU.
+		// Vulkan renderers record and submit their own primary command buffers, so there the timestamps bracket every
+		// primary command buffer recorded during a pass. OpenGL writes them into the command stream around the pass
+		class LUMOS_EXPORT GPUProfiler
+		{
+		public:
+			GPUProfiler();
+			~GPUProfiler();
+
+			// Reads back the oldest frame in the ring. Call once per frame before the first pass
+			void BeginFrame();
+			void BeginPass(const std::string& name);
+			void EndPass();
+
+			void SetEnabled(bool enabled) { m_Enabled = enabled; }
+			bool GetEnabled() const { return m_Enabled; }
+
+			void OnImGui();
+
+			// Called by the render API when a primary command buffer starts and finishes recording
+			static void OnBeginRecording(CommandBuffer* commandBuffer);
+			static void OnEndRecording(CommandBuffer* commandBuffer);
+			// Pass being recorded, nullptr outside a pass or while disabled
+			static const char* GetCurrentPassName();
+
+		private:
+			struct Timing
+			{
+				std::string name;
+				// Tracy keeps the pointer, so it lives as long as the profiler
+				std::string plotName;
+				float milliseconds = 0.0f;
+				float average = 0.0f;
+			};
+
+			struct Interval
+			{
+				u32 pass;
+				u32 query;
+				bool closed;
+			};
+
+			struct Frame
+			{
+				Query* query = nullptr;
+				std::vector<Timing*> passes;
+				std::vector<Interval> intervals;
+			};
+
+			void Resolve(Frame& frame);
+			void Open(CommandBuffer* commandBuffer);
+			void Close(CommandBuffer* commandBuffer);
+
+			static constexpr u32 FrameCount = 4;
+			static constexpr u32 InvalidPass = ~0u;
+
+			Frame m_Frames[FrameCount];
+			Frame* m_Recording = nullptr;
+			u64 m_FrameIndex = 0;
+			u32 m_CurrentPass = InvalidPass;
+			// Intervals whose end has not been written yet, by the command buffer that opened them
+			std::vector<std::pair<CommandBuffer*, u32>> m_Open;
+
+			std::unordered_map<std::string, Timing> m_Timings;
+			// Passes of the last frame read back, in the order they ran
+			std::vector<Timing*> m_Resolved;
+
+			bool m_Supported = false;
+			bool m_Enabled = true;
+		};
+	}
+}
@@ -29,6 +29,7 @@
 #include "Maths/BoundingBox.h"
 #include "Maths/Sphere.h"
 #include "Audio/SoundNode.h"
+#include "Core/Engine.h"
  
 
 namespace Lumos
@@ -36,19 +37,21 @@ namespace Lumos
 	using namespace Graphics;
 
 	DebugRenderer* DebugRenderer::s_Instance = nullptr;
+	u32 DebugRenderer::s_Generation = 0;
 
-	static const uint32_t MaxLines = 10000;
-	static const uint32_t MaxLineVertices = MaxLines * 2;
-	static const uint32_t MaxLineIndices = MaxLines * 6;
-#define MAX_BATCH_DRAW_CALLS 100
-#define RENDERER_LINE_SIZE RENDERER2DLINE_VERTEX_SIZE * 4
-#define RENDERER_BUFFER_SIZE RENDERER_LINE_SIZE* MaxLineVertices
+	struct DebugThreadBuffer
+	{
+		std::vector<LineInfo> lines;
+		std::vector<PointInfo> points;
+		std::vector<TriangleInfo> triangles;
+	};
 
 	void DebugRenderer::Init(u32 width, u32 height)
 	{
 		if(s_Instance)
 			return;
 
+		s_Generation++;
 		s_Instance = new DebugRenderer();
 
 		s_Instance->m_Renderer2D = new Graphics::Renderer2D(width, height, false, true, false);
@@ -74,6 +77,27 @@ namespace Lumos
 		delete m_LineRenderer;
 		delete m_Renderer2D;
 		delete m_PointRenderer;
+
+		for(auto buffer : m_ThreadBuffers)
+			delete buffer;
+	}
+
+	DebugThreadBuffer* DebugRenderer::GetThreadBuffer()
+	{
+		static thread_local DebugThreadBuffer* buffer = nullptr;
+		static thread_local u32 generation = 0;
+
+		if(!buffer || generation != s_Generation)
+		{
+			// Owned by the instance, which frees it on Release
+			buffer = new DebugThreadBuffer();
+			generation = s_Generation;
+
+			std::lock_guard<std::mutex> lock(s_Instance->m_Mutex);
+			s_Instance->m_ThreadBuffers.push_back(buffer);
+		}
+
+		return buffer;
 	}
 
 	void DebugRenderer::SetRenderTarget(Graphics::Texture* texture, bool rebuildFramebuffer)
@@ -90,7 +114,7 @@ namespace Lumos
 	void DebugRenderer::GenDrawPoint(bool ndt, const Maths::Vector3& pos, float point_radius, const Maths::Vector4& colour)
 	{
 		if(s_Instance && s_Instance->m_PointRenderer)
-			s_Instance->m_PointRenderer->Submit(pos, point_radius, colour);
+			GetThreadBuffer()->points.emplace_back(pos, point_radius, colour);
 	}
 
 	void DebugRenderer::DrawPoint(const Maths::Vector3& pos, float point_radius, const Maths::Vector3& colour)
@@ -114,7 +138,7 @@ namespace Lumos
 	void DebugRenderer::GenDrawThickLine(bool ndt, const Maths::Vector3& start, const Maths::Vector3& end, float line_width, const Maths::Vector4& colour)
 	{
 		if(s_Instance && s_Instance->m_LineRenderer)
-			s_Instance->m_LineRenderer->Submit(start, end, colour);
+			GetThreadBuffer()->lines.emplace_back(start, end, colour);
 	}
 	void DebugRenderer::DrawThickLine(const Maths::Vector3& start, const Maths::Vector3& end, float line_width, const Maths::Vector3& colour)
 	{
@@ -137,7 +161,7 @@ namespace Lumos
 	void DebugRenderer::GenDrawHairLine(bool ndt, const Maths::Vector3& start, const Maths::Vector3& end, const Maths::Vector4& colour)
 	{
 		if(s_Instance && s_Instance->m_LineRenderer)
-			s_Instance->m_LineRenderer->Submit(start, end, colour);
+			GetThreadBuffer()->lines.emplace_back(start, end, colour);
 	}
 	void DebugRenderer::DrawHairLine(const Maths::Vector3& start, const Maths::Vector3& end, const Maths::Vector3& colour)
 	{
@@ -188,7 +212,7 @@ namespace Lumos
 	void DebugRenderer::GenDrawTriangle(bool ndt, const Maths::Vector3& v0, const Maths::Vector3& v1, const Maths::Vector3& v2, const Maths::Vector4& colour)
 	{
 		if(s_Instance && s_Instance->m_Renderer2D)
-			s_Instance->m_Renderer2D->SubmitTriangle(v0, v1, v2, colour);
+			GetThreadBuffer()->triangles.emplace_back(v0, v1, v2, colour);
 	}
 
 	void DebugRenderer::DrawTriangle(const Maths::Vector3& v0, const Maths::Vector3& v1, const Maths::Vector3& v2, const Maths::Vector4& colour)
@@ -322,9 +346,103 @@ namespace Lumos
 			m_PointRenderer->Begin();
 	}
 
+	u32 DebugRenderer::AddRetainedLine(const Maths::Vector3& start, const Maths::Vector3& end, const Maths::Vector4& colour, float seconds)
+	{
+		if(!s_Instance)
+			return 0;
+
+		return s_Instance->AddRetained({ 0, seconds, seconds > 0.0f, false, start, end, 0.0f, colour });
+	}
+
+	u32 DebugRenderer::AddRetainedPoint(const Maths::Vector3& pos, float point_radius, const Maths::Vector4& colour, float seconds)
+	{
+		if(!s_Instance)
+			return 0;
+
+		return s_Instance->AddRetained({ 0, seconds, seconds > 0.0f, true, pos, pos, point_radius, colour });
+	}
+
+	u32 DebugRenderer::AddRetained(const RetainedPrimitive& primitive)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Retained.push_back(primitive);
+		m_Retained.back().handle = m_NextRetainedHandle++;
+		return m_Retained.back().handle;
+	}
+
+	void DebugRenderer::RemoveRetained(u32 handle)
+	{
+		if(!s_Instance)
+			return;
+
+		std::lock_guard<std::mutex> lock(s_Instance->m_Mutex);
+		auto& retained = s_Instance->m_Retained;
+		auto found = std::find_if(retained.begin(), retained.end(), [handle](const RetainedPrimitive& primitive) { return primitive.handle == handle; });
+		if(found != retained.end())
+			retained.erase(found);
+	}
+
+	void DebugRenderer::ClearRetained()
+	{
+		if(!s_Instance)
+			return;
+
+		std::lock_guard<std::mutex> lock(s_Instance->m_Mutex);
+		s_Instance->m_Retained.clear();
+	}
+
+	void DebugRenderer::SubmitThreadBuffers()
+	{
+		LUMOS_PROFILE_FUNCTION();
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for(auto buffer : m_ThreadBuffers)
+		{
+			for(auto& line : buffer->lines)
+				m_LineRenderer->Submit(line.p1, line.p2, line.col);
+			for(auto& point : buffer->points)
+				m_PointRenderer->Submit(point.p1, point.size, point.col);
+			for(auto& triangle : buffer->triangles)
+				m_Renderer2D->SubmitTriangle(triangle.p1, triangle.p2, triangle.p3, triangle.col);
+
+			buffer->lines.clear();
+			buffer->points.clear();
+			buffer->triangles.clear();
+		}
+	}
+
+	void DebugRenderer::SubmitRetained(float dt)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		u32 kept = 0;
+		for(u32 i = 0; i < m_Retained.size(); i++)
+		{
+			RetainedPrimitive& primitive = m_Retained[i];
+			if(primitive.timed)
+			{
+				primitive.remaining -= dt;
+				if(primitive.remaining < 0.0f)
+					continue;
+			}
+
+			if(primitive.point)
+				m_PointRenderer->Submit(primitive.start, primitive.radius, primitive.colour);
+			else
+				m_LineRenderer->Submit(primitive.start, primitive.end, primitive.colour);
+
+			m_Retained[kept++] = primitive;
+		}
+
+		m_Retained.resize(kept);
+	}
+
 	void DebugRenderer::RenderInternal(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform)
 	{
 		LUMOS_PROFILE_FUNCTION();
+		SubmitThreadBuffers();
+		SubmitRetained(Engine::GetTimeStep().GetSeconds());
+
 		if(m_Renderer2D)
 		{
 			m_Renderer2D->BeginRenderPass();
@@ -3,6 +3,8 @@
 
 #include "Maths/Maths.h"
 
+#include <mutex>
+
 namespace Lumos
 {
 
@@ -37,6 +39,10 @@ namespace Lumos
         class Transform;
 	}
 
+	struct DebugThreadBuffer;
+
+	// Draw calls can be made from any thread, JobSystem workers included, as long as they are done before Render.
+	// Each thread appends to its own buffer, and the buffers are handed to the line, point and triangle renderers by Render
 	class LUMOS_EXPORT DebugRenderer
 	{
 		friend class Scene;
@@ -98,6 +104,13 @@ namespace Lumos
         static void DebugDrawSphere(float radius, const Maths::Vector3& position, const Maths::Vector4& colour);
         static void DebugDrawCircle(int numVerts, float radius, const Maths::Vector3& position, const Maths::Quaternion& rotation, const Maths::Vector4& colour);
         static void DebugDrawCone(int numCircleVerts, int numLinesToCircle, float angle, float length, const Maths::Vector3& position , const Maths::Quaternion& rotation, const Maths::Vector4& colour);
+
+		//Retained lines and points are drawn every frame until seconds have passed, or when seconds <= 0 until RemoveRetained is called with the returned handle
+		static u32 AddRetainedLine(const Maths::Vector3& start, const Maths::Vector3& end, const Maths::Vector4& colour, float seconds = 0.0f);
+		static u32 AddRetainedPoint(const Maths::Vector3& pos, float point_radius, const Maths::Vector4& colour, float seconds = 0.0f);
+		static void RemoveRetained(u32 handle);
+		static void ClearRetained();
+
 		static void OnResize(u32 width, u32 height)
 		{
 			if(s_Instance)
@@ -131,11 +144,35 @@ namespace Lumos
 		}
 
 	private:
+		struct RetainedPrimitive
+		{
+			u32 handle;
+			// Seconds left, <= 0 for primitives kept until removed
+			float remaining;
+			bool timed;
+			bool point;
+			Maths::Vector3 start;
+			Maths::Vector3 end;
+			float radius;
+			Maths::Vector4 colour;
+		};
+
 		void Begin();
 		void RenderInternal(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform);
 		void OnResizeInternal(u32 width, u32 height);
+		void SubmitThreadBuffers();
+		void SubmitRetained(float dt);
+		u32 AddRetained(const RetainedPrimitive& primitive);
+		static DebugThreadBuffer* GetThreadBuffer();
 
 		static DebugRenderer* s_Instance;
+		// Bumped by Init, so threads drop buffers they registered with an earlier instance
+		static u32 s_Generation;
+
+		std::mutex m_Mutex;
+		std::vector<DebugThreadBuffer*> m_ThreadBuffers;
+		std::vector<RetainedPrimitive> m_Retained;
+		u32 m_NextRetainedHandle = 1;
 
 		Graphics::Renderer2D* m_Renderer2D;
 		Graphics::LineRenderer* m_LineRenderer;
@@ -3,11 +3,11 @@
 #include "Scene/Scene.h"
 #include "Core/Application.h"
 #include "Core/Engine.h"
-#include "Scene/Component/TextureMatrixComponent.h"
 #include "Maths/Maths.h"
 #include "Maths/Transform.h"
 
 #include "RenderGraph.h"
+#include "VisibilityStage.h"
 #include "Graphics/Camera/Camera.h"
 #include "Graphics/Mesh.h"
 #include "Graphics/Model.h"
@@ -17,7 +17,6 @@
 #include "Graphics/API/Shader.h"
 #include "Graphics/API/Framebuffer.h"
 #include "Graphics/API/Texture.h"
-#include "Graphics/API/UniformBuffer.h"
 #include "Graphics/API/Renderer.h"
 #include "Graphics/API/CommandBuffer.h"
 #include "Graphics/API/Swapchain.h"
@@ -25,10 +24,14 @@
 #include "Graphics/API/Pipeline.h"
 #include "Graphics/API/GraphicsContext.h"
 
+#include "Core/JobSystem.h"
+
 #include <imgui/imgui.h>
 
 #define MAX_LIGHTS 32
 #define MAX_SHADOWMAPS 16
+// Fewer batches than this per chunk and recording in parallel costs more than it saves
+#define MIN_BATCHES_PER_RECORDING_CHUNK 64
 
 namespace Lumos
 {
@@ -56,8 +59,10 @@ namespace Lumos
 
 		DeferredOffScreenRenderer::~DeferredOffScreenRenderer()
 		{
-			delete m_UniformBuffer;
 			delete m_DeferredCommandBuffers;
+
+			for(auto commandBuffer : m_SecondaryCommandBuffers)
+				delete commandBuffer;
 			delete m_DefaultMaterial;
 
 			delete[] m_VSSystemUniformBuffer;
@@ -73,7 +78,6 @@ namespace Lumos
 		void DeferredOffScreenRenderer::Init()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			m_Shader = Application::Get().GetShaderLibrary()->GetResource("/CoreShaders/DeferredColour.shader");
 			m_DefaultMaterial = new Material();
 
 			Graphics::MaterialProperties properties;
@@ -88,8 +92,6 @@ namespace Lumos
 
 			const size_t minUboAlignment = size_t(Graphics::Renderer::GetCapabilities().UniformBufferOffsetAlignment);
 
-			m_UniformBuffer = nullptr;
-
 			m_CommandQueue.reserve(1000);
 
 			//
@@ -103,27 +105,7 @@ namespace Lumos
 			// Per Scene System Uniforms
 			m_VSSystemUniformBufferOffsets[VSSystemUniformIndex_ProjectionViewMatrix] = 0;
 
-			AttachmentInfo textureTypesOffScreen[5] =
-				{
-					{TextureType::COLOUR, Application::Get().GetRenderGraph()->GetGBuffer()->GetTextureFormat(SCREENTEX_COLOUR)},
-					{TextureType::COLOUR, Application::Get().GetRenderGraph()->GetGBuffer()->GetTextureFormat(SCREENTEX_POSITION)},
-					{TextureType::COLOUR, Application::Get().GetRenderGraph()->GetGBuffer()->GetTextureFormat(SCREENTEX_NORMALS)},
-					{TextureType::COLOUR, Application::Get().GetRenderGraph()->GetGBuffer()->GetTextureFormat(SCREENTEX_PBR)},
-					{TextureType::DEPTH, TextureFormat::DEPTH}};
-
-			Graphics::RenderPassInfo renderpassCIOffScreen{};
-			renderpassCIOffScreen.attachmentCount = 5;
-			renderpassCIOffScreen.textureType = textureTypesOffScreen;
-
-            m_RenderPass = Graphics::RenderPass::Get(renderpassCIOffScreen);
-
-            
-            auto pushConstant = Graphics::PushConstant();
-            pushConstant.size = sizeof(Lumos::Maths::Matrix4);
-            pushConstant.data = new u8[sizeof(Lumos::Maths::Matrix4)];
-            pushConstant.shaderStage = ShaderType::VERTEX;
-            
-            m_PushConstants.push_back(pushConstant);
+			CreateRenderPass();
 
 			m_CommandBuffers.resize(Renderer::GetSwapchain()->GetSwapchainBufferCount());
 
@@ -136,6 +118,25 @@ namespace Lumos
 			m_DeferredCommandBuffers = Graphics::CommandBuffer::Create();
 			m_DeferredCommandBuffers->Init(true);
 
+			// Only Vulkan can record command buffers off the main thread
+			const u32 threadCount = System::JobSystem::GetThreadCount();
+			if(Graphics::GraphicsContext::GetRenderAPI() == Graphics::RenderAPI::VULKAN && threadCount > 1)
+			{
+				m_SecondaryCommandBuffers.resize(threadCount);
+
+				for(u32 i = 0; i < threadCount; i++)
+				{
+					m_SecondaryCommandBuffers[i] = Graphics::CommandBuffer::Create();
+					m_SecondaryCommandBuffers[i]->Init(false, i);
+				}
+			}
+
+			const size_t chunkCount = Maths::Max(m_SecondaryCommandBuffers.size(), size_t(1));
+			m_BindStates.resize(chunkCount);
+			m_ChunkDescriptorSets.resize(chunkCount);
+			for(auto& descriptorSets : m_ChunkDescriptorSets)
+				descriptorSets.resize(2);
+
 			CreatePipeline();
 			CreateBuffer();
 			CreateFramebuffer();
@@ -150,6 +151,8 @@ namespace Lumos
 		{
 			LUMOS_PROFILE_FUNCTION();
 
+			BuildCommandQueue();
+
 			Begin();
 			SetSystemUniforms(m_Shader.get());
 			Present();
@@ -165,7 +168,21 @@ namespace Lumos
 		void DeferredOffScreenRenderer::Begin()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			m_RenderPass->BeginRenderpass(m_DeferredCommandBuffers, Maths::Vector4(0.0f), m_Framebuffers.front().get(), Graphics::INLINE, m_ScreenBufferWidth, m_ScreenBufferHeight);
+			const u32 batchCount = static_cast<u32>(m_InstanceBatches.size());
+
+			m_RecordingChunkCount = 1;
+			m_RecordingChunkSize = batchCount;
+
+			if(batchCount >= MIN_BATCHES_PER_RECORDING_CHUNK * 2 && !m_SecondaryCommandBuffers.empty())
+			{
+				const u32 chunkCount = Maths::Min(static_cast<u32>(m_SecondaryCommandBuffers.size()), batchCount / MIN_BATCHES_PER_RECORDING_CHUNK);
+				m_RecordingChunkSize = (batchCount + chunkCount - 1) / chunkCount;
+				m_RecordingChunkCount = (batchCount + m_RecordingChunkSize - 1) / m_RecordingChunkSize;
+			}
+
+			// The render pass contents have to be all inline or all from secondary command buffers
+			const SubPassContents contents = m_RecordingChunkCount > 1 ? Graphics::SECONDARY : Graphics::INLINE;
+			m_RenderPass->BeginRenderpass(m_DeferredCommandBuffers, Maths::Vector4(0.0f), m_Framebuffers.front().get(), contents, m_ScreenBufferWidth, m_ScreenBufferHeight);
 		}
 
 		void DeferredOffScreenRenderer::BeginScene(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform)
@@ -173,6 +190,7 @@ namespace Lumos
 			LUMOS_PROFILE_FUNCTION();
             m_CommandQueue.clear();
             m_SystemUniforms.clear();
+            m_VisibilityView = VisibilityStage::InvalidView;
             {
                 LUMOS_PROFILE_SCOPE("Get Camera");
 
@@ -188,55 +206,47 @@ namespace Lumos
 
                 LUMOS_ASSERT(m_Camera, "No Camera Set for Renderer");
                 auto projView = m_Camera->GetProjectionMatrix() * view;
+                m_CameraPosition = m_CameraTransform->GetWorldPosition();
+                m_InvCameraFar = 1.0f / m_Camera->GetFar();
                 memcpy(m_VSSystemUniformBuffer + m_VSSystemUniformBufferOffsets[VSSystemUniformIndex_ProjectionViewMatrix], &projView, sizeof(Maths::Matrix4));
 
                 m_Frustum = m_Camera->GetFrustum(view);
             }
-			
+
+            m_VisibilityView = Application::Get().GetRenderGraph()->GetVisibility()->AddView(m_Frustum, VisibilityType::Mesh);
+		}
+
+		void DeferredOffScreenRenderer::BuildCommandQueue()
+		{
+			LUMOS_PROFILE_FUNCTION();
+            auto visibility = Application::Get().GetRenderGraph()->GetVisibility();
+
+            for(u32 index : visibility->GetVisible(m_VisibilityView))
             {
-                auto& registry = scene->GetRegistry();
-                auto group = registry.group<Model>(entt::get<Maths::Transform>);
-                
-                for(auto entity : group)
+                Mesh* mesh = visibility->GetMesh(index);
+                auto material = mesh->GetMaterial();
+                if(material)
                 {
-                    const auto& [model, trans] = group.get<Model, Maths::Transform>(entity);
-                    const auto& meshes = model.GetMeshes();
-                    
-                    for(auto& mesh : meshes)
+                    if(material->GetDescriptorSet() == nullptr || material->GetPipeline() != m_Pipeline.get() || material->GetTexturesUpdated())
                     {
+                        LUMOS_PROFILE_SCOPE("Create DescriptorSet");
 
-                        if(mesh->GetActive())
-                        {
-
-                            auto& worldTransform = trans.GetWorldMatrix();
-                            Maths::Intersection inside;
-                            {
-                                LUMOS_PROFILE_SCOPE("Frustum Check");
-
-                                inside = m_Frustum.IsInsideFast(mesh->GetBoundingBox()->Transformed(worldTransform));
-                            }
-                            
-                            if(inside == Maths::Intersection::OUTSIDE)
-                                continue;
-                            
-                            auto material = mesh->GetMaterial();
-                            if(material)
-                            {
-                                if(material->GetDescriptorSet() == nullptr || material->GetPipeline() != m_Pipeline.get() || material->GetTexturesUpdated())
-                                {
-                                    LUMOS_PROFILE_SCOPE("Create DescriptorSet");
-
-                                    material->CreateDescriptorSet(m_Pipeline.get(), 1);
-                                    material->SetTexturesUpdated(false);
-                                }
-                            }
-                            
-                            auto textureMatrixTransform = registry.try_get<TextureMatrixComponent>(entity);
-                            SubmitMesh(mesh.get(), material.get(), worldTransform, textureMatrixTransform ? textureMatrixTransform->GetMatrix() : Maths::Matrix4());
-                        }
+                        material->CreateDescriptorSet(m_Pipeline.get(), 1);
+                        material->SetTexturesUpdated(false);
                     }
                 }
+
+                SubmitMesh(mesh, material.get(), visibility->GetTransform(index));
             }
+
+            // Views are only valid for the frame they were added in
+            m_VisibilityView = VisibilityStage::InvalidView;
+
+            SortCommandQueue(m_CommandQueue);
+
+            m_InstanceBatches.clear();
+            m_InstanceTransforms.clear();
+            BuildInstanceBatches(m_CommandQueue, m_InstanceBatches, m_InstanceTransforms);
 		}
 
 		void DeferredOffScreenRenderer::Submit(const RenderCommand& command)
@@ -245,14 +255,16 @@ namespace Lumos
 			m_CommandQueue.push_back(command);
 		}
 
-		void DeferredOffScreenRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix)
+		void DeferredOffScreenRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform)
 		{
 			LUMOS_PROFILE_FUNCTION();
 			RenderCommand command;
 			command.mesh = mesh;
 			command.material = material;
 			command.transform = transform;
-			command.textureMatrix = textureMatrix;
+
+			const float depth = (transform.Translation() - m_CameraPosition).Length() * m_InvCameraFar;
+			command.sortKey = RenderSortKey::Make(0, m_Pipeline.get(), material, mesh, depth);
 			Submit(command);
 		}
 
@@ -270,36 +282,76 @@ namespace Lumos
 		void DeferredOffScreenRenderer::SetSystemUniforms(Shader* shader)
 		{
 			LUMOS_PROFILE_FUNCTION();
-			m_UniformBuffer->SetData(m_VSSystemUniformBufferSize, *&m_VSSystemUniformBuffer);
+			PushVSSystemUniforms();
+			// Set before the batches are recorded in parallel, every chunk binds the same offset
+			m_Pipeline->GetDescriptorSet()->SetDynamicOffset(m_VSSystemUniformOffset);
 		}
 
 		void DeferredOffScreenRenderer::Present()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			m_Pipeline->Bind(m_DeferredCommandBuffers);
+			m_InstanceBuffer.Upload(m_InstanceTransforms);
 
-			for(u32 i = 0; i < static_cast<u32>(m_CommandQueue.size()); i++)
+			for(auto& batch : m_InstanceBatches)
+				Engine::Get().Statistics().NumRenderedObjects += batch.instanceCount;
+
+			const u32 batchCount = static_cast<u32>(m_InstanceBatches.size());
+
+			if(m_RecordingChunkCount <= 1)
 			{
-				Engine::Get().Statistics().NumRenderedObjects++;
-				
-				auto command = m_CommandQueue[i];
-				Mesh* mesh = command.mesh;
-                
-                m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
-                m_CurrentDescriptorSets[1] = command.material ? command.material->GetDescriptorSet() : m_DefaultMaterial->GetDescriptorSet();
-                
-                auto trans = command.transform;
-                memcpy(m_PushConstants[0].data, &trans, sizeof(Maths::Matrix4));
-                m_CurrentDescriptorSets[0]->SetPushConstants(m_PushConstants);
+				RecordBatches(m_DeferredCommandBuffers, 0, 0, batchCount);
+				m_BindStates[0].End();
+				return;
+			}
 
-				mesh->GetVertexBuffer()->Bind(m_DeferredCommandBuffers, m_Pipeline.get());
-				mesh->GetIndexBuffer()->Bind(m_DeferredCommandBuffers);
+			System::JobSystem::Context ctx;
+			System::JobSystem::Dispatch(ctx, m_RecordingChunkCount, 1, [&](JobDispatchArgs args)
+			{
+				const u32 first = args.jobIndex * m_RecordingChunkSize;
+				const u32 last = Maths::Min(first + m_RecordingChunkSize, batchCount);
+
+				CommandBuffer* commandBuffer = m_SecondaryCommandBuffers[args.jobIndex];
+				commandBuffer->BeginRecordingSecondary(m_RenderPass.get(), m_Framebuffers.front().get());
+				commandBuffer->UpdateViewport(m_ScreenBufferWidth, m_ScreenBufferHeight);
+
+				RecordBatches(commandBuffer, args.jobIndex, first, last);
 
-				Renderer::BindDescriptorSets(m_Pipeline.get(), m_DeferredCommandBuffers, 0, m_CurrentDescriptorSets);
-				Renderer::DrawIndexed(m_DeferredCommandBuffers, DrawType::TRIANGLE, mesh->GetIndexBuffer()->GetCount());
+				commandBuffer->EndRecording();
+			});
 
-				mesh->GetVertexBuffer()->Unbind();
-				mesh->GetIndexBuffer()->Unbind();
+			System::JobSystem::Wait(ctx);
+
+			// Execute in chunk order so the sorted draw order is kept
+			for(u32 i = 0; i < m_RecordingChunkCount; i++)
+			{
+				m_SecondaryCommandBuffers[i]->ExecuteSecondary(m_DeferredCommandBuffers);
+				m_BindStates[i].End();
+			}
+		}
+
+		void DeferredOffScreenRenderer::RecordBatches(CommandBuffer* commandBuffer, u32 chunk, u32 first, u32 last)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			RenderBindState& bindState = m_BindStates[chunk];
+			std::vector<DescriptorSet*>& descriptorSets = m_ChunkDescriptorSets[chunk];
+
+			bindState.Reset(commandBuffer);
+			bindState.BindPipeline(m_Pipeline.get());
+
+			descriptorSets[0] = m_Pipeline->GetDescriptorSet();
+
+			for(u32 i = first; i < last; i++)
+			{
+				const InstanceBatch& batch = m_InstanceBatches[i];
+				Mesh* mesh = batch.mesh;
+
+				descriptorSets[1] = batch.material ? batch.material->GetDescriptorSet() : m_DefaultMaterial->GetDescriptorSet();
+
+				bindState.BindMesh(mesh);
+				bindState.BindDescriptorSets(descriptorSets[1], descriptorSets, m_PushConstants);
+				m_InstanceBuffer.Bind(commandBuffer, m_Pipeline.get(), batch.firstInstance);
+
+				bindState.DrawIndexedInstanced(mesh->GetIndexBuffer()->GetCount(), batch.instanceCount);
 			}
 		}
 
@@ -317,6 +369,7 @@ namespace Lumos
 			pipelineCreateInfo.shader = m_Shader;
 			pipelineCreateInfo.renderpass = m_RenderPass;
             pipelineCreateInfo.vertexBufferLayout = vertexBufferLayout;
+            pipelineCreateInfo.instanceBufferLayout = InstanceBuffer::GetLayout();
             pipelineCreateInfo.polygonMode = Graphics::PolygonMode::FILL;
 			pipelineCreateInfo.cullMode = Graphics::CullMode::BACK;
 			pipelineCreateInfo.transparencyEnabled = false;
@@ -328,26 +381,8 @@ namespace Lumos
 		void DeferredOffScreenRenderer::CreateBuffer()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			if(m_UniformBuffer == nullptr)
-			{
-				m_UniformBuffer = Graphics::UniformBuffer::Create();
-
-				uint32_t bufferSize = m_VSSystemUniformBufferSize;
-				m_UniformBuffer->Init(bufferSize, nullptr);
-			}
-
 			std::vector<Graphics::BufferInfo> bufferInfos;
-
-			Graphics::BufferInfo bufferInfo = {};
-			bufferInfo.buffer = m_UniformBuffer;
-			bufferInfo.offset = 0;
-			bufferInfo.size = m_VSSystemUniformBufferSize;
-			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
-			bufferInfo.binding = 0;
-			bufferInfo.shaderType = ShaderType::VERTEX;
-			bufferInfo.systemUniforms = true;
-			bufferInfo.name = "UniformBufferObject";
-			bufferInfos.push_back(bufferInfo);
+			bufferInfos.push_back(GetVSSystemUniformBufferInfo());
 
 			m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
 		}
@@ -355,13 +390,25 @@ namespace Lumos
 		void DeferredOffScreenRenderer::CreateFramebuffer()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			const u32 attachmentCount = 5;
-			TextureType attachmentTypes[attachmentCount];
-			attachmentTypes[0] = TextureType::COLOUR;
-			attachmentTypes[1] = TextureType::COLOUR;
-			attachmentTypes[2] = TextureType::COLOUR;
-			attachmentTypes[3] = TextureType::COLOUR;
-			attachmentTypes[4] = TextureType::DEPTH;
+			GBuffer* gbuffer = Application::Get().GetRenderGraph()->GetGBuffer();
+
+			u32 attachmentCount = 0;
+			TextureType attachmentTypes[5];
+			Texture* attachments[5];
+
+			attachmentTypes[attachmentCount] = TextureType::COLOUR;
+			attachments[attachmentCount++] = gbuffer->GetTexture(SCREENTEX_COLOUR);
+			if(m_GBufferLayout == GBufferLayout::Standard)
+			{
+				attachmentTypes[attachmentCount] = TextureType::COLOUR;
+				attachments[attachmentCount++] = gbuffer->GetTexture(SCREENTEX_POSITION);
+			}
+			attachmentTypes[attachmentCount] = TextureType::COLOUR;
+			attachments[attachmentCount++] = gbuffer->GetTexture(SCREENTEX_NORMALS);
+			attachmentTypes[attachmentCount] = TextureType::COLOUR;
+			attachments[attachmentCount++] = gbuffer->GetTexture(SCREENTEX_PBR);
+			attachmentTypes[attachmentCount] = TextureType::DEPTH;
+			attachments[attachmentCount++] = gbuffer->GetDepthTexture();
 
 			FramebufferInfo bufferInfo{};
 			bufferInfo.width = m_ScreenBufferWidth;
@@ -369,18 +416,36 @@ namespace Lumos
 			bufferInfo.attachmentCount = attachmentCount;
 			bufferInfo.renderPass = m_RenderPass.get();
 			bufferInfo.attachmentTypes = attachmentTypes;
-
-			Texture* attachments[attachmentCount];
-			attachments[0] = Application::Get().GetRenderGraph()->GetGBuffer()->GetTexture(SCREENTEX_COLOUR);
-			attachments[1] = Application::Get().GetRenderGraph()->GetGBuffer()->GetTexture(SCREENTEX_POSITION);
-			attachments[2] = Application::Get().GetRenderGraph()->GetGBuffer()->GetTexture(SCREENTEX_NORMALS);
-			attachments[3] = Application::Get().GetRenderGraph()->GetGBuffer()->GetTexture(SCREENTEX_PBR);
-			attachments[4] = Application::Get().GetRenderGraph()->GetGBuffer()->GetDepthTexture();
 			bufferInfo.attachments = attachments;
 
 			m_Framebuffers.push_back(Ref<Framebuffer>(Framebuffer::Get(bufferInfo)));
 		}
 
+		void DeferredOffScreenRenderer::CreateRenderPass()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			GBuffer* gbuffer = Application::Get().GetRenderGraph()->GetGBuffer();
+			m_GBufferLayout = gbuffer->GetLayout();
+
+			// The compact variant has no position output, the attachments follow the shader's output locations
+			u32 attachmentCount = 0;
+			AttachmentInfo textureTypesOffScreen[5];
+			textureTypesOffScreen[attachmentCount++] = {TextureType::COLOUR, gbuffer->GetTextureFormat(SCREENTEX_COLOUR)};
+			if(m_GBufferLayout == GBufferLayout::Standard)
+				textureTypesOffScreen[attachmentCount++] = {TextureType::COLOUR, gbuffer->GetTextureFormat(SCREENTEX_POSITION)};
+			textureTypesOffScreen[attachmentCount++] = {TextureType::COLOUR, gbuffer->GetTextureFormat(SCREENTEX_NORMALS)};
+			textureTypesOffScreen[attachmentCount++] = {TextureType::COLOUR, gbuffer->GetTextureFormat(SCREENTEX_PBR)};
+			textureTypesOffScreen[attachmentCount++] = {TextureType::DEPTH, TextureFormat::DEPTH};
+
+			m_Shader = Application::Get().GetShaderLibrary()->GetResource(m_GBufferLayout == GBufferLayout::Compact ? "/CoreShaders/DeferredColourCompact.shader" : "/CoreShaders/DeferredColour.shader");
+
+			Graphics::RenderPassInfo renderpassCIOffScreen{};
+			renderpassCIOffScreen.attachmentCount = attachmentCount;
+			renderpassCIOffScreen.textureType = textureTypesOffScreen;
+
+            m_RenderPass = Graphics::RenderPass::Get(renderpassCIOffScreen);
+		}
+
 		void DeferredOffScreenRenderer::OnResize(u32 width, u32 height)
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -388,12 +453,21 @@ namespace Lumos
 
 			DeferredOffScreenRenderer::SetScreenBufferSize(width, height);
 
+			if(m_GBufferLayout != Application::Get().GetRenderGraph()->GetGBuffer()->GetLayout())
+			{
+				CreateRenderPass();
+				CreatePipeline();
+				CreateBuffer();
+				m_DefaultMaterial->CreateDescriptorSet(m_Pipeline.get(), 1);
+			}
+
 			CreateFramebuffer();
 		}
 
 		void DeferredOffScreenRenderer::OnImGui()
 		{
 			ImGui::TextUnformatted("Deferred Offscreen Renderer");
+			ImGui::Text("Recording Chunks %u", m_RecordingChunkCount);
 		}
 	}
 }
@@ -19,6 +19,7 @@ namespace Lumos
 		class ShadowRenderer;
 		class Framebuffer;
 		class Material;
+		enum class GBufferLayout;
 
 		class LUMOS_EXPORT DeferredOffScreenRenderer : public IRenderer
 		{
@@ -32,7 +33,7 @@ namespace Lumos
 			void Begin() override;
 			void BeginScene(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransforms) override;
 			void Submit(const RenderCommand& command) override;
-			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override;
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform) override;
 			void EndScene() override;
 			void End() override;
 			void Present() override;
@@ -42,6 +43,8 @@ namespace Lumos
 			void CreatePipeline();
 			void CreateBuffer();
 			void CreateFramebuffer();
+			// Picks the shader and render pass matching the G-buffer layout
+			void CreateRenderPass();
 
 			int GetCommandBufferCount() const
 			{
@@ -57,11 +60,11 @@ namespace Lumos
 
 		private:
 			void SetSystemUniforms(Shader* shader);
+			void BuildCommandQueue();
+			void RecordBatches(CommandBuffer* commandBuffer, u32 chunk, u32 first, u32 last);
 
 			Material* m_DefaultMaterial;
 
-			UniformBuffer* m_UniformBuffer;
-
 			CommandBuffer* m_DeferredCommandBuffers;
 
 			struct UniformBufferModel
@@ -72,6 +75,22 @@ namespace Lumos
 			UniformBufferModel m_UBODataDynamic;
 			int m_CommandBufferIndex = 0;
             std::vector<Graphics::PushConstant> m_PushConstants;
+
+			// Per recording chunk. Chunk i is recorded into m_SecondaryCommandBuffers[i] on a job thread,
+			// or into m_DeferredCommandBuffers when recording serially
+			std::vector<RenderBindState> m_BindStates;
+			std::vector<std::vector<DescriptorSet*>> m_ChunkDescriptorSets;
+			std::vector<CommandBuffer*> m_SecondaryCommandBuffers;
+			u32 m_RecordingChunkCount = 1;
+			u32 m_RecordingChunkSize = 0;
+
+			InstanceBuffer m_InstanceBuffer;
+			std::vector<InstanceBatch> m_InstanceBatches;
+			std::vector<Maths::Matrix4> m_InstanceTransforms;
+			Maths::Vector3 m_CameraPosition;
+			float m_InvCameraFar = 0.0f;
+			u32 m_VisibilityView = ~0u;
+			GBufferLayout m_GBufferLayout;
 		};
 	}
 }
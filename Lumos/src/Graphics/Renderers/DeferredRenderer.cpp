@@ -2,6 +2,7 @@
 #include "DeferredRenderer.h"
 #include "DeferredOffScreenRenderer.h"
 #include "ShadowRenderer.h"
+#include "LightClusters.h"
 
 #include "Scene/Scene.h"
 #include "Core/Application.h"
@@ -32,25 +33,36 @@
 
 #include <imgui/imgui.h>
 
-#define MAX_LIGHTS 32
+#define MAX_LIGHTS 4096
+// Length of the light array in DeferredLight.frag's uniform block variant
+#define MAX_UNIFORM_LIGHTS 1024
 #define MAX_SHADOWMAPS 16
 
 namespace Lumos
 {
 	namespace Graphics
 	{
+		static_assert(MAX_LIGHTS <= 65536, "Clustered light indices are 16 bit");
+
+		static const char* GetLightShaderPath(GBufferLayout layout, bool storageLightBuffers)
+		{
+			if(storageLightBuffers)
+				return layout == GBufferLayout::Compact ? "/CoreShaders/DeferredLightCompactStorage.shader" : "/CoreShaders/DeferredLightStorage.shader";
+			return layout == GBufferLayout::Compact ? "/CoreShaders/DeferredLightCompact.shader" : "/CoreShaders/DeferredLight.shader";
+		}
+
 		enum PSSystemUniformIndices : i32
 		{
-			PSSystemUniformIndex_Lights = 0,
-			PSSystemUniformIndex_CameraPosition,
+			PSSystemUniformIndex_CameraPosition = 0,
 			PSSystemUniformIndex_ViewMatrix,
 			PSSystemUniformIndex_ShadowTransforms,
 			PSSystemUniformIndex_ShadowSplitDepths,
 			PSSystemUniformIndex_BiasMatrix,
-			PSSystemUniformIndex_LightCount,
+			PSSystemUniformIndex_DirectionalLightCount,
 			PSSystemUniformIndex_ShadowCount,
 			PSSystemUniformIndex_RenderMode,
 			PSSystemUniformIndex_cubemapMipLevels,
+			PSSystemUniformIndex_ScreenToWorld,
 			PSSystemUniformIndex_Size
 		};
 
@@ -64,6 +76,9 @@ namespace Lumos
 		{
 			delete m_UniformBuffer;
 			delete m_LightUniformBuffer;
+			delete m_LightDataUniformBuffer;
+			delete m_ClusterUniformBuffer;
+			delete m_LightClusters;
 			delete m_ScreenQuad;
 			delete m_OffScreenRenderer;
 
@@ -76,25 +91,30 @@ namespace Lumos
 			LUMOS_PROFILE_FUNCTION();
 			m_OffScreenRenderer = new DeferredOffScreenRenderer(m_ScreenBufferWidth, m_ScreenBufferHeight);
 
-            m_Shader = Application::Get().GetShaderLibrary()->GetResource("/CoreShaders/DeferredLight.shader");
+			m_GBufferLayout = Application::Get().GetRenderGraph()->GetGBuffer()->GetLayout();
+			m_StorageLightBuffers = Renderer::GetCapabilities().SupportsStorageBuffers;
+            m_Shader = Application::Get().GetShaderLibrary()->GetResource(GetLightShaderPath(m_GBufferLayout, m_StorageLightBuffers));
 
 			switch(Graphics::GraphicsContext::GetRenderAPI())
 			{
 #ifdef LUMOS_RENDER_API_OPENGL
 			case Graphics::RenderAPI::OPENGL:
 				m_BiasMatrix = Maths::Matrix4(0.5f, 0.0f, 0.0f, 0.5f, 0.0f, 0.5f, 0.0f, 0.5f, 0.0f, 0.0f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 1.0f);
+				m_ScreenToNDC = Maths::Matrix4(2.0f, 0.0f, 0.0f, -1.0f, 0.0f, 2.0f, 0.0f, -1.0f, 0.0f, 0.0f, 2.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
 				break;
 #endif
 
 #ifdef LUMOS_RENDER_API_VULKAN
 			case Graphics::RenderAPI::VULKAN:
 				m_BiasMatrix = Maths::Matrix4(0.5f, 0.0f, 0.0f, 0.5f, 0.0f, 0.5f, 0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+				m_ScreenToNDC = Maths::Matrix4(2.0f, 0.0f, 0.0f, -1.0f, 0.0f, 2.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
 				break;
 #endif
 
 #ifdef LUMOS_RENDER_API_DIRECT3D
 			case Graphics::RenderAPI::DIRECT3D:
 				m_BiasMatrix = Maths::Matrix4(0.5f, 0.0f, 0.0f, 0.5f, 0.0f, 0.5f, 0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+				m_ScreenToNDC = Maths::Matrix4(2.0f, 0.0f, 0.0f, -1.0f, 0.0f, 2.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
 				break;
 #endif
 			default:
@@ -110,27 +130,41 @@ namespace Lumos
 			m_PreintegratedFG = UniqueRef<Texture2D>(Texture2D::CreateFromSource(BRDFTextureWidth, BRDFTextureHeight, (void*)BRDFTexture, param));
 
 			m_LightUniformBuffer = nullptr;
+			m_LightDataUniformBuffer = nullptr;
+			m_ClusterUniformBuffer = nullptr;
 			m_UniformBuffer = nullptr;
 
+			// Storage blocks take as many lights as the buffers hold. Uniform blocks are declared at their largest in the shader,
+			// only as much as the device can bind is used
+			const u32 maxLights = m_StorageLightBuffers ? MAX_LIGHTS : MAX_UNIFORM_LIGHTS;
+			const int deviceRange = m_StorageLightBuffers ? Renderer::GetCapabilities().MaxStorageBufferRange : Renderer::GetCapabilities().MaxUniformBufferRange;
+			const u32 maxRange = deviceRange > 0 ? u32(deviceRange) : sizeof(Light) * maxLights;
+			m_MaxLights = Maths::Min(maxLights, maxRange / u32(sizeof(Light)));
+			if(m_MaxLights < maxLights)
+				LUMOS_LOG_WARN("Light buffers are limited to {0} bytes, drawing at most {1} lights", maxRange, m_MaxLights);
+
+			m_LightClusters = new LightClusters(maxRange, m_StorageLightBuffers ? LightClusters::MaxLightIndices : LightClusters::MaxUniformLightIndices);
+			m_Lights.reserve(m_MaxLights);
+
 			m_ScreenQuad = Graphics::CreateQuad();
 
 			// Pixel/fragment shader System uniforms
-			m_PSSystemUniformBufferSize = sizeof(Light) * MAX_LIGHTS + sizeof(Maths::Vector4) + sizeof(Maths::Matrix4) * 2 + (sizeof(Maths::Matrix4) + sizeof(Maths::Vector4)) * MAX_SHADOWMAPS + sizeof(int) * 4;
+			m_PSSystemUniformBufferSize = sizeof(Maths::Vector4) + sizeof(Maths::Matrix4) * 3 + (sizeof(Maths::Matrix4) + sizeof(Maths::Vector4)) * MAX_SHADOWMAPS + sizeof(int) * 4;
 			m_PSSystemUniformBuffer = new u8[m_PSSystemUniformBufferSize];
 			memset(m_PSSystemUniformBuffer, 0, m_PSSystemUniformBufferSize);
 			m_PSSystemUniformBufferOffsets.resize(PSSystemUniformIndex_Size);
 
 			// Per Scene System Uniforms
-			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_Lights] = 0;
-			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_CameraPosition] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_Lights] + sizeof(Light) * MAX_LIGHTS;
+			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_CameraPosition] = 0;
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ViewMatrix] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_CameraPosition] + sizeof(Maths::Vector4);
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowTransforms] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ViewMatrix] + sizeof(Maths::Matrix4);
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowSplitDepths] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowTransforms] + sizeof(Maths::Matrix4) * MAX_SHADOWMAPS;
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_BiasMatrix] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowSplitDepths] + sizeof(Maths::Vector4) * MAX_SHADOWMAPS;
-			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_LightCount] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_BiasMatrix] + sizeof(Maths::Matrix4);
-			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowCount] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_LightCount] + sizeof(int);
+			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_DirectionalLightCount] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_BiasMatrix] + sizeof(Maths::Matrix4);
+			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowCount] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_DirectionalLightCount] + sizeof(int);
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_RenderMode] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowCount] + sizeof(int);
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_cubemapMipLevels] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_RenderMode] + sizeof(int);
+			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ScreenToWorld] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_cubemapMipLevels] + sizeof(int);
 
 			AttachmentInfo textureTypes[2] =
             {
@@ -272,13 +306,12 @@ namespace Lumos
 			m_CommandQueue.push_back(command);
 		}
 
-		void DeferredRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix)
+		void DeferredRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform)
 		{
 			LUMOS_PROFILE_FUNCTION();
 			RenderCommand command;
 			command.mesh = mesh;
 			command.transform = transform;
-			command.textureMatrix = textureMatrix;
 			command.material = material;
 			Submit(command);
 		}
@@ -291,12 +324,12 @@ namespace Lumos
 
 			auto group = registry.group<Graphics::Light>(entt::get<Maths::Transform>);
 
-			u32 numLights = 0;
-
 			auto viewMatrix = m_CameraTransform->GetWorldMatrix().Inverse();
 
 			auto& frustum = m_Camera->GetFrustum(viewMatrix);
 
+			m_Lights.clear();
+
 			for(auto entity : group)
 			{
 				const auto& [light, trans] = group.get<Graphics::Light, Maths::Transform>(entity);
@@ -315,13 +348,29 @@ namespace Lumos
 
 				light.Direction = forward.Normalized();
 
-				memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_Lights] + sizeof(Graphics::Light) * numLights, &light, sizeof(Graphics::Light));
-				numLights++;
+				m_Lights.push_back(light);
+			}
+
+			// Directional lights light every pixel and are looped over first, the rest are only read through their clusters
+			auto firstClustered = std::stable_partition(m_Lights.begin(), m_Lights.end(), [](const Graphics::Light& light) { return light.Type == float(LightType::DirectionalLight); });
+			int numDirectionalLights = int(firstClustered - m_Lights.begin());
+
+			if(m_Lights.size() > m_MaxLights)
+			{
+				LUMOS_LOG_WARN("{0} visible lights, only the first {1} are drawn", m_Lights.size(), m_MaxLights);
+				m_Lights.resize(m_MaxLights);
+				numDirectionalLights = Maths::Min(numDirectionalLights, int(m_MaxLights));
 			}
 
+			m_LightClusters->Build(viewMatrix, m_Camera->GetProjectionMatrix(), m_Camera->GetNear(), m_Camera->GetFar(), m_Camera->IsOrthographic(), m_Lights.data(), u32(numDirectionalLights), u32(m_Lights.size()) - u32(numDirectionalLights));
+
 			Maths::Vector4 cameraPos = Maths::Vector4(m_CameraTransform->GetWorldPosition());
 			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_CameraPosition], &cameraPos, sizeof(Maths::Vector4));
 
+			// The compact G-buffer has no position target, world positions are reconstructed from depth
+			Maths::Matrix4 screenToWorld = (m_Camera->GetProjectionMatrix() * viewMatrix).Inverse() * m_ScreenToNDC;
+			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ScreenToWorld], &screenToWorld, sizeof(Maths::Matrix4));
+
 			auto shadowRenderer = Application::Get().GetRenderGraph()->GetShadowRenderer();
 			if(shadowRenderer)
 			{
@@ -337,7 +386,7 @@ namespace Lumos
 			int numShadows = shadowRenderer ? int(shadowRenderer->GetShadowMapNum()) : 0;
 
 			auto cubemapMipLevels = m_EnvironmentMap ? m_EnvironmentMap->GetMipMapLevels() : 0;
-			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_LightCount], &numLights, sizeof(int));
+			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_DirectionalLightCount], &numDirectionalLights, sizeof(int));
 			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowCount], &numShadows, sizeof(int));
 			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_RenderMode], &m_RenderMode, sizeof(int));
 			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_cubemapMipLevels], &cubemapMipLevels, sizeof(int));
@@ -360,6 +409,10 @@ namespace Lumos
 		{
 			LUMOS_PROFILE_FUNCTION();
 			m_LightUniformBuffer->SetData(m_PSSystemUniformBufferSize, *&m_PSSystemUniformBuffer);
+
+			// Only the lights and cluster light indices used this frame are uploaded
+			m_LightDataUniformBuffer->SetData(u32(sizeof(Light) * m_Lights.size()), m_Lights.data());
+			m_ClusterUniformBuffer->SetData(m_LightClusters->GetUsedSize(), &m_LightClusters->GetUniforms());
 		}
 
 		void DeferredRenderer::Present()
@@ -441,6 +494,20 @@ namespace Lumos
 			}
 		}
 
+		void DeferredRenderer::DeclareResources(RenderGraphBuilder& builder, u32 pass)
+		{
+			// Includes the G-buffer pass recorded by m_OffScreenRenderer
+			builder.SetPassName(pass, "Deferred");
+			builder.Write(pass, builder.AddResource(RenderGraphResources::GBufferColour));
+			if(m_GBufferLayout == GBufferLayout::Standard)
+				builder.Write(pass, builder.AddResource(RenderGraphResources::GBufferPosition));
+			builder.Write(pass, builder.AddResource(RenderGraphResources::GBufferNormals));
+			builder.Write(pass, builder.AddResource(RenderGraphResources::GBufferPBR));
+			builder.Write(pass, builder.AddResource(RenderGraphResources::Depth));
+			builder.Read(pass, builder.AddResource(RenderGraphResources::ShadowMap));
+			builder.Write(pass, builder.AddResource(RenderGraphResources::Screen));
+		}
+
 		void DeferredRenderer::OnImGui()
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -460,6 +527,22 @@ namespace Lumos
 			ImGui::PopItemWidth();
 			ImGui::NextColumn();
 
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Number Of Lights");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::Text("%5.2lu", m_Lights.size());
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Cluster Light Indices");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::Text("%u / %u", m_LightClusters->GetLightIndexCount(), m_LightClusters->GetMaxLightIndexCount());
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
 			ImGui::AlignTextToFramePadding();
 			ImGui::TextUnformatted("Render Mode");
 			ImGui::NextColumn();
@@ -528,6 +611,18 @@ namespace Lumos
 				m_LightUniformBuffer->Init(bufferSize, nullptr);
 			}
 
+			if(m_LightDataUniformBuffer == nullptr)
+			{
+				m_LightDataUniformBuffer = Graphics::UniformBuffer::Create();
+				m_LightDataUniformBuffer->Init(sizeof(Light) * m_MaxLights, nullptr);
+			}
+
+			if(m_ClusterUniformBuffer == nullptr)
+			{
+				m_ClusterUniformBuffer = Graphics::UniformBuffer::Create();
+				m_ClusterUniformBuffer->Init(m_LightClusters->GetMaxSize(), nullptr);
+			}
+
 			std::vector<Graphics::BufferInfo> bufferInfos;
 
 			Graphics::BufferInfo bufferInfo = {};
@@ -542,6 +637,19 @@ namespace Lumos
 
 			bufferInfos.push_back(bufferInfo);
 
+			bufferInfo.name = "UniformBufferLightData";
+			bufferInfo.buffer = m_LightDataUniformBuffer;
+			bufferInfo.size = sizeof(Light) * m_MaxLights;
+			bufferInfo.type = m_StorageLightBuffers ? Graphics::DescriptorType::STORAGE_BUFFER : Graphics::DescriptorType::UNIFORM_BUFFER;
+			bufferInfo.binding = 1;
+			bufferInfos.push_back(bufferInfo);
+
+			bufferInfo.name = "UniformBufferLightClusters";
+			bufferInfo.buffer = m_ClusterUniformBuffer;
+			bufferInfo.size = m_LightClusters->GetMaxSize();
+			bufferInfo.binding = 2;
+			bufferInfos.push_back(bufferInfo);
+
 			m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
 		}
 
@@ -559,6 +667,21 @@ namespace Lumos
             m_EnvironmentMap = nullptr;
             m_IrradianceMap = nullptr;
 
+			if(m_GBufferLayout != Application::Get().GetRenderGraph()->GetGBuffer()->GetLayout())
+			{
+				m_GBufferLayout = Application::Get().GetRenderGraph()->GetGBuffer()->GetLayout();
+				m_Shader = Application::Get().GetShaderLibrary()->GetResource(GetLightShaderPath(m_GBufferLayout, m_StorageLightBuffers));
+
+				CreateDeferredPipeline();
+				CreateLightBuffer();
+
+				Graphics::DescriptorInfo info{};
+				info.pipeline = m_Pipeline.get();
+				info.layoutIndex = 1;
+				info.shader = m_Shader.get();
+				m_DescriptorSet = Ref<Graphics::DescriptorSet>(Graphics::DescriptorSet::Create(info));
+			}
+
 			//Update DescriptorSet with updated gbuffer textures
 			UpdateScreenDescriptorSet();
 		}
@@ -621,7 +744,11 @@ namespace Lumos
 			imageInfo9.name = "uDepthSampler";
 
 			bufferInfos.push_back(imageInfo);
-			bufferInfos.push_back(imageInfo2);
+			// The compact layout reads depth in place of the position target
+			if(m_GBufferLayout == GBufferLayout::Standard)
+				bufferInfos.push_back(imageInfo2);
+			else
+				bufferInfos.push_back(imageInfo9);
 			bufferInfos.push_back(imageInfo3);
 			bufferInfos.push_back(imageInfo4);
 			bufferInfos.push_back(imageInfo5);
@@ -18,6 +18,9 @@ namespace Lumos
 		class ShadowRenderer;
 		class Framebuffer;
 		class DeferredOffScreenRenderer;
+		class LightClusters;
+		struct Light;
+		enum class GBufferLayout;
 
 		class LUMOS_EXPORT DeferredRenderer : public IRenderer
 		{
@@ -32,7 +35,7 @@ namespace Lumos
 			void Begin(int commandBufferID);
 			void BeginScene(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform) override;
 			void Submit(const RenderCommand& command) override;
-			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override;
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform) override;
 			void SubmitLightSetup(Scene* scene);
 			void EndScene() override;
 			void End() override;
@@ -58,6 +61,7 @@ namespace Lumos
 			void SetRenderTarget(Texture* texture, bool rebuildFramebuffer) override;
 
 			void OnImGui() override;
+			void DeclareResources(RenderGraphBuilder& builder, u32 pass) override;
 
 		private:
 			DeferredOffScreenRenderer* m_OffScreenRenderer;
@@ -68,9 +72,21 @@ namespace Lumos
 			u32 m_PSSystemUniformBufferSize;
 
 			Maths::Matrix4 m_BiasMatrix;
+			// Maps texture coordinates and depth to normalised device coordinates
+			Maths::Matrix4 m_ScreenToNDC;
+			GBufferLayout m_GBufferLayout;
 
 			UniformBuffer* m_UniformBuffer;
 			UniformBuffer* m_LightUniformBuffer;
+			UniformBuffer* m_LightDataUniformBuffer;
+			UniformBuffer* m_ClusterUniformBuffer;
+
+			// Lights visible this frame, directional lights first
+			std::vector<Light> m_Lights;
+			u32 m_MaxLights = 0;
+			LightClusters* m_LightClusters = nullptr;
+			// Light data and clusters are bound as storage blocks rather than fixed size uniform blocks
+			bool m_StorageLightBuffers = false;
 
 			CommandBuffer* m_DeferredCommandBuffers;
 
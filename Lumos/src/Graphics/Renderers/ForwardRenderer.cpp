@@ -16,7 +16,6 @@
 #include "Graphics/API/GraphicsContext.h"
 #include "Graphics/GBuffer.h"
 #include "Scene/Scene.h"
-#include "Scene/Component/TextureMatrixComponent.h"
 #include "Maths/Maths.h"
 #include "Maths/Transform.h"
 
@@ -178,7 +177,8 @@ namespace Lumos
 			bufferInfo.buffer = m_UniformBuffer;
 			bufferInfo.offset = 0;
 			bufferInfo.size = sizeof(UniformBufferObject);
-			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
+			// Reflection declares the system uniform binding dynamic, the offset is left at 0
+			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER_DYNAMIC;
 			bufferInfo.binding = 0;
 
 			Graphics::BufferInfo bufferInfo2 = {};
@@ -287,14 +287,7 @@ namespace Lumos
                             }
                         }
 
-                        auto textureMatrixTransform = registry.try_get<TextureMatrixComponent>(entity);
-                        Maths::Matrix4 textureMatrix;
-                        if(textureMatrixTransform)
-                            textureMatrix = textureMatrixTransform->GetMatrix();
-                        else
-                            textureMatrix = Maths::Matrix4();
-
-                        SubmitMesh(meshPtr.get(), material.get(), worldTransform, textureMatrix);
+                        SubmitMesh(meshPtr.get(), material.get(), worldTransform);
                     }
                 }
             }
@@ -311,12 +304,11 @@ namespace Lumos
 			m_CommandQueue.push_back(command);
 		}
 
-		void ForwardRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix)
+		void ForwardRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform)
 		{
 			RenderCommand command;
 			command.mesh = mesh;
 			command.transform = transform;
-			command.textureMatrix = textureMatrix;
 			command.material = material;
 			Submit(command);
 		}
@@ -354,30 +346,29 @@ namespace Lumos
 		{
 			int index = 0;
 
+			Graphics::CommandBuffer* currentCMDBuffer = m_CommandBuffers[m_CurrentBufferID];
+
+			m_BindState.Reset(currentCMDBuffer);
+			m_BindState.BindPipeline(m_Pipeline.get());
+
+			m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
+			m_CurrentDescriptorSets[1] = m_DescriptorSet.get();
+
 			for(auto& command : m_CommandQueue)
 			{
 				Mesh* mesh = command.mesh;
 
-				Graphics::CommandBuffer* currentCMDBuffer = m_CommandBuffers[m_CurrentBufferID];
-
-				m_Pipeline->Bind(currentCMDBuffer);
-
 				uint32_t dynamicOffset = index * static_cast<uint32_t>(m_DynamicAlignment);
 
-                m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
-                m_CurrentDescriptorSets[1] = m_DescriptorSet.get();
-				
-				mesh->GetVertexBuffer()->Bind(currentCMDBuffer, m_Pipeline.get());
-				mesh->GetIndexBuffer()->Bind(currentCMDBuffer);
+				m_BindState.BindMesh(mesh);
+				m_BindState.BindDescriptorSets(m_CurrentDescriptorSets[1], m_CurrentDescriptorSets, m_PushConstants, dynamicOffset);
 
-				Renderer::BindDescriptorSets(m_Pipeline.get(), currentCMDBuffer, dynamicOffset, m_CurrentDescriptorSets);
 				Renderer::DrawIndexed(currentCMDBuffer, DrawType::TRIANGLE, mesh->GetIndexBuffer()->GetCount());
 
-				mesh->GetVertexBuffer()->Unbind();
-				mesh->GetIndexBuffer()->Unbind();
-
 				index++;
 			}
+
+			m_BindState.End();
 		}
 
 		void ForwardRenderer::OnResize(u32 width, u32 height)
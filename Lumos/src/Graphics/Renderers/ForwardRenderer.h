@@ -25,7 +25,7 @@ namespace Lumos
 
 			void BeginScene(const Maths::Matrix4& proj, const Maths::Matrix4& view);
 			void Submit(const RenderCommand& command) override;
-			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override;
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform) override;
 			void EndScene() override;
 			void End() override;
 			void Present() override;
@@ -62,6 +62,9 @@ namespace Lumos
 
 			u32 m_CurrentBufferID = 0;
 			bool m_DepthTest = false;
+
+			RenderBindState m_BindState;
+			std::vector<Graphics::PushConstant> m_PushConstants;
 		};
 	}
 }
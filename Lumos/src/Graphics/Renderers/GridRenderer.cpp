@@ -24,8 +24,7 @@ namespace Lumos
 	namespace Graphics
 	{
 		GridRenderer::GridRenderer(u32 width, u32 height)
-			: m_UniformBuffer(nullptr)
-			, m_UniformBufferFrag(nullptr)
+			: m_UniformBufferFrag(nullptr)
 		{
 			m_Pipeline = nullptr;
             
@@ -39,7 +38,6 @@ namespace Lumos
 		GridRenderer::~GridRenderer()
 		{
 			delete m_Quad;
-			delete m_UniformBuffer;
 			delete m_UniformBufferFrag;
 			delete[] m_VSSystemUniformBuffer;
             delete[] m_PSSystemUniformBuffer;
@@ -59,6 +57,7 @@ namespace Lumos
             m_Pipeline->Bind(m_CommandBuffers[m_CurrentBufferID].get());
             
             m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
+			m_CurrentDescriptorSets[0]->SetDynamicOffset(m_VSSystemUniformOffset);
             
 			m_Quad->GetVertexBuffer()->Bind(m_CommandBuffers[m_CurrentBufferID].get(), m_Pipeline.get());
 			m_Quad->GetIndexBuffer()->Bind(m_CommandBuffers[m_CurrentBufferID].get());
@@ -174,10 +173,10 @@ namespace Lumos
 				m_CommandBuffers[m_CurrentBufferID]->Execute(true);
 		}
         
-		void GridRenderer::SetSystemUniforms(Shader* shader) const
+		void GridRenderer::SetSystemUniforms(Shader* shader)
 		{
 			LUMOS_PROFILE_FUNCTION();
-			m_UniformBuffer->SetData(sizeof(UniformBufferObject), *&m_VSSystemUniformBuffer);
+			PushVSSystemUniforms();
 			m_UniformBufferFrag->SetData(sizeof(UniformBufferObjectFrag), *&m_PSSystemUniformBuffer);
 		}
         
@@ -233,25 +232,8 @@ namespace Lumos
 		void GridRenderer::UpdateUniformBuffer()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			if(m_UniformBuffer == nullptr)
-			{
-				m_UniformBuffer = Graphics::UniformBuffer::Create();
-				uint32_t bufferSize = static_cast<uint32_t>(sizeof(UniformBufferObject));
-				m_UniformBuffer->Init(bufferSize, nullptr);
-			}
-            
 			std::vector<Graphics::BufferInfo> bufferInfos;
             
-			Graphics::BufferInfo bufferInfo;
-			bufferInfo.name = "UniformBufferObject";
-			bufferInfo.buffer = m_UniformBuffer;
-			bufferInfo.offset = 0;
-			bufferInfo.size = sizeof(UniformBufferObject);
-			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
-			bufferInfo.binding = 0;
-			bufferInfo.shaderType = ShaderType::VERTEX;
-			bufferInfo.systemUniforms = true;
-            
 			if(m_UniformBufferFrag == nullptr)
 			{
 				m_UniformBufferFrag = Graphics::UniformBuffer::Create();
@@ -269,7 +251,7 @@ namespace Lumos
 			bufferInfo2.shaderType = ShaderType::FRAGMENT;
 			bufferInfo2.systemUniforms = false;
             
-			bufferInfos.push_back(bufferInfo);
+			bufferInfos.push_back(GetVSSystemUniformBufferInfo());
 			bufferInfos.push_back(bufferInfo2);
 			if(m_Pipeline != nullptr)
 				m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
@@ -22,7 +22,7 @@ namespace Lumos
 
 			void Begin() override;
 			void Submit(const RenderCommand& command) override{};
-			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override{};
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform) override{};
 			void EndScene() override{};
 			void End() override;
 			void Present() override{};
@@ -49,9 +49,8 @@ namespace Lumos
 			void OnImGui() override;
 
 		private:
-			void SetSystemUniforms(Shader* shader) const;
+			void SetSystemUniforms(Shader* shader);
 
-			Lumos::Graphics::UniformBuffer* m_UniformBuffer;
 			Lumos::Graphics::UniformBuffer* m_UniformBufferFrag;
 
 			u32 m_CurrentBufferID = 0;
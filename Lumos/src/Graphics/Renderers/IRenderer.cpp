@@ -9,9 +9,41 @@
 //#include "Graphics/API/Pipeline.h"
 //#include "Graphics/API/Texture.h"
 
+#include "Graphics/API/Renderer.h"
+#include "Graphics/API/UniformRingBuffer.h"
+#include "RenderGraph.h"
+
 namespace Lumos
 {
     Graphics::IRenderer::~IRenderer()
     {
     }
+
+	void Graphics::IRenderer::DeclareResources(RenderGraphBuilder& builder, u32 pass)
+	{
+		if(m_ScreenRenderer)
+			builder.Write(pass, builder.AddResource(RenderGraphResources::Screen));
+		else
+			builder.MarkSideEffect(pass);
+	}
+
+	void Graphics::IRenderer::PushVSSystemUniforms()
+	{
+		LUMOS_PROFILE_FUNCTION();
+		m_VSSystemUniformOffset = Renderer::GetUniformRingBuffer()->Push(m_VSSystemUniformBuffer, m_VSSystemUniformBufferSize);
+	}
+
+	Graphics::BufferInfo Graphics::IRenderer::GetVSSystemUniformBufferInfo(int binding) const
+	{
+		BufferInfo bufferInfo;
+		bufferInfo.buffer = Renderer::GetUniformRingBuffer()->GetBuffer();
+		bufferInfo.offset = 0;
+		bufferInfo.size = m_VSSystemUniformBufferSize;
+		bufferInfo.type = DescriptorType::UNIFORM_BUFFER_DYNAMIC;
+		bufferInfo.shaderType = ShaderType::VERTEX;
+		bufferInfo.systemUniforms = false;
+		bufferInfo.name = "UniformBufferObject";
+		bufferInfo.binding = binding;
+		return bufferInfo;
+	}
 }
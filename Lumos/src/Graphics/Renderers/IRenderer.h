@@ -7,6 +7,7 @@
 #include "Graphics/API/Framebuffer.h"
 #include "Graphics/API/RenderPass.h"
 #include "Graphics/API/Pipeline.h"
+#include "Graphics/API/DescriptorSet.h"
 
 namespace Lumos
 {
@@ -21,6 +22,7 @@ namespace Lumos
 		class Texture;
 		class Shader;
     	class Material;
+		class RenderGraphBuilder;
 
 		typedef std::vector<RenderCommand> CommandQueue;
 		typedef std::vector<RendererUniform> SystemUniformList;
@@ -34,7 +36,7 @@ namespace Lumos
 			virtual void Begin() = 0;
 			virtual void BeginScene(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform) = 0;
 			virtual void Submit(const RenderCommand& command) {};
-			virtual void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) {};
+			virtual void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform) {};
 			virtual void EndScene() = 0;
 			virtual void End() = 0;
 			virtual void Present() = 0;
@@ -42,6 +44,10 @@ namespace Lumos
 			virtual void OnResize(u32 width, u32 height) = 0;
 			virtual void OnImGui() {};
 
+			// Declares what the renderer reads and writes so the render graph can order, cull and transition it.
+			// By default screen renderers write the screen and anything else is never culled
+			virtual void DeclareResources(RenderGraphBuilder& builder, u32 pass);
+
 			virtual void SetScreenBufferSize(u32 width, u32 height)
 			{
 				if(width == 0)
@@ -89,6 +95,10 @@ namespace Lumos
             }
 
 		protected:
+			void PushVSSystemUniforms();
+			// Describes the VS system uniforms in the UniformRingBuffer, see SHADER_SYSTEM_UNIFORM_BINDING
+			BufferInfo GetVSSystemUniformBufferInfo(int binding = SHADER_SYSTEM_UNIFORM_BINDING) const;
+
 			Camera* m_Camera = nullptr;
 			Maths::Transform* m_CameraTransform = nullptr;
 
@@ -112,6 +122,8 @@ namespace Lumos
 
 			u8* m_VSSystemUniformBuffer = nullptr;
 			u32 m_VSSystemUniformBufferSize = 0;
+			// Where PushVSSystemUniforms copied m_VSSystemUniformBuffer this frame, bound as the dynamic offset of its descriptor set
+			u32 m_VSSystemUniformOffset = 0;
 			u8* m_PSSystemUniformBuffer = nullptr;
 			u32 m_PSSystemUniformBufferSize = 0;
 
@@ -0,0 +1,253 @@
+#include "Precompiled.h"
+#include "LightClusters.h"
+#include "Graphics/Light.h"
+#include "Maths/BoundingBox.h"
+#include "Maths/Sphere.h"
+#include "Core/JobSystem.h"
+
+namespace Lumos::Graphics
+{
+	static_assert(offsetof(LightClusters::Uniforms, lightIndices) + LightClusters::MaxUniformLightIndices / 2 * sizeof(u32) <= 65536, "Light cluster uniforms must fit in 64KB");
+	static_assert(LightClusters::MaxUniformLightIndices <= LightClusters::MaxLightIndices, "The uniform light index list is a prefix of the full one");
+	static_assert(LightClusters::ClusterCount % 4 == 0, "Clusters are read as uvec4");
+	static_assert(LightClusters::MaxLightIndices % 8 == 0 && LightClusters::MaxUniformLightIndices % 8 == 0, "Light indices are read as uvec4");
+	static_assert(offsetof(LightClusters::Uniforms, clusters) == 80, "Light cluster uniforms must match the std140 layout");
+
+	LightClusters::LightClusters(u32 maxSize, u32 maxLightIndices)
+	{
+		m_Uniforms = CreateUniqueRef<Uniforms>();
+		*m_Uniforms = Uniforms{};
+
+		const u32 indexOffset = static_cast<u32>(offsetof(Uniforms, lightIndices));
+		if(maxSize < indexOffset)
+		{
+			LUMOS_LOG_ERROR("Light cluster uniforms need {0} bytes, the device can bind {1}", indexOffset, maxSize);
+			m_MaxLightIndices = 0;
+		}
+		else
+		{
+			// Two indices per word, rounded down to whole uvec4s
+			const u32 fitting = (maxSize - indexOffset) / sizeof(u32) * 2 / 8 * 8;
+			m_MaxLightIndices = Maths::Min(Maths::Min(maxLightIndices, MaxLightIndices), fitting);
+		}
+
+		m_ClusterBounds.resize(ClusterCount);
+		m_ColumnBounds.resize(ClusterCountZ * ClusterCountX);
+		m_RowBounds.resize(ClusterCountZ * ClusterCountY);
+		m_SliceDepths.resize(ClusterCountZ + 1);
+		m_ClusterLights.resize(ClusterCount);
+	}
+
+	void LightClusters::Build(const Maths::Matrix4& view, const Maths::Matrix4& projection, float nearPlane, float farPlane, bool orthographic, const Light* lights, u32 first, u32 count)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		if(projection != m_Projection || nearPlane != m_Near || farPlane != m_Far || orthographic != m_Orthographic)
+			BuildClusterBounds(projection, nearPlane, farPlane, orthographic);
+
+		m_Uniforms->viewProjection = projection * view;
+
+		m_ViewLights.resize(count);
+		for(u32 i = 0; i < count; i++)
+		{
+			const Light& light = lights[first + i];
+			m_ViewLights[i].centre = view * light.Position.ToVector3();
+			m_ViewLights[i].radius = light.Radius;
+			m_ViewLights[i].index = static_cast<u16>(first + i);
+		}
+
+		System::JobSystem::Context ctx;
+		System::JobSystem::Dispatch(ctx, m_SliceCount, 1, [&](JobDispatchArgs args) {
+			AssignSlice(args.jobIndex);
+		});
+
+		System::JobSystem::Wait(ctx);
+
+		// Pack the per cluster lists into one index list
+		u32* clusters = m_Uniforms->clusters;
+		u32* indices = m_Uniforms->lightIndices;
+		const u32 usedClusters = m_SliceCount * ClusterCountX * ClusterCountY;
+
+		u32 offset = 0;
+		m_DroppedIndexCount = 0;
+
+		for(u32 cluster = 0; cluster < usedClusters; cluster++)
+		{
+			const auto& clusterLights = m_ClusterLights[cluster];
+			const u32 clusterCount = Maths::Min(static_cast<u32>(clusterLights.size()), m_MaxLightIndices - offset);
+
+			for(u32 i = 0; i < clusterCount; i++)
+			{
+				const u32 index = offset + i;
+				if(index & 1)
+					indices[index >> 1] |= u32(clusterLights[i]) << 16;
+				else
+					indices[index >> 1] = clusterLights[i];
+			}
+
+			clusters[cluster] = offset | (clusterCount << 16);
+			offset += clusterCount;
+			m_DroppedIndexCount += static_cast<u32>(clusterLights.size()) - clusterCount;
+		}
+
+		memset(clusters + usedClusters, 0, sizeof(u32) * (ClusterCount - usedClusters));
+		m_LightIndexCount = offset;
+
+		if(m_DroppedIndexCount > 0)
+			LUMOS_LOG_WARN("Light cluster index list full, {0} light assignments dropped", m_DroppedIndexCount);
+	}
+
+	u32 LightClusters::GetUsedSize() const
+	{
+		return static_cast<u32>(offsetof(Uniforms, lightIndices)) + ((m_LightIndexCount + 1) / 2) * sizeof(u32);
+	}
+
+	u32 LightClusters::GetMaxSize() const
+	{
+		return static_cast<u32>(offsetof(Uniforms, lightIndices)) + (m_MaxLightIndices / 2) * sizeof(u32);
+	}
+
+	void LightClusters::BuildClusterBounds(const Maths::Matrix4& projection, float nearPlane, float farPlane, bool orthographic)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		m_Projection = projection;
+		m_Near = nearPlane;
+		m_Far = farPlane;
+		m_Orthographic = orthographic;
+
+		// Slices are spaced exponentially so clusters stay roughly cubic. That needs a positive near plane,
+		// orthographic cameras (which may have a negative one) use a single slice through the whole depth range
+		m_SliceCount = orthographic ? 1 : ClusterCountZ;
+
+		if(orthographic)
+		{
+			m_SliceDepths[0] = nearPlane;
+			m_SliceDepths[1] = farPlane;
+			m_Uniforms->params = Maths::Vector4(float(ClusterCountX), float(ClusterCountY), 0.0f, 0.0f);
+		}
+		else
+		{
+			const float sliceNear = Maths::Max(nearPlane, 0.01f);
+			const float logRange = logf(farPlane / sliceNear);
+
+			for(u32 z = 0; z <= ClusterCountZ; z++)
+				m_SliceDepths[z] = sliceNear * expf(logRange * float(z) / float(ClusterCountZ));
+
+			// slice = log(depth) * scale + bias
+			const float scale = float(ClusterCountZ) / logRange;
+			m_Uniforms->params = Maths::Vector4(float(ClusterCountX), float(ClusterCountY), scale, -logf(sliceNear) * scale);
+		}
+
+		// Lines through the corners of the screen tiles, as two view space points at different depths
+		const Maths::Matrix4 inverse = projection.Inverse();
+		const u32 cornerCountX = ClusterCountX + 1;
+		const u32 cornerCountY = ClusterCountY + 1;
+		std::vector<Maths::Vector3> cornerNear(cornerCountX * cornerCountY);
+		std::vector<Maths::Vector3> cornerFar(cornerCountX * cornerCountY);
+
+		auto unproject = [&inverse](float x, float y, float z) {
+			const Maths::Vector4 p = inverse * Maths::Vector4(x, y, z, 1.0f);
+			return Maths::Vector3(p.x, p.y, p.z) / p.w;
+		};
+
+		for(u32 y = 0; y < cornerCountY; y++)
+		{
+			for(u32 x = 0; x < cornerCountX; x++)
+			{
+				const float ndcX = float(x) / float(ClusterCountX) * 2.0f - 1.0f;
+				const float ndcY = float(y) / float(ClusterCountY) * 2.0f - 1.0f;
+
+				// Both depths are inside the clip volume for zero to one and minus one to one depth ranges
+				cornerNear[y * cornerCountX + x] = unproject(ndcX, ndcY, 0.0f);
+				cornerFar[y * cornerCountX + x] = unproject(ndcX, ndcY, 0.5f);
+			}
+		}
+
+		auto pointAtDepth = [&](u32 corner, float depth) {
+			const Maths::Vector3& a = cornerNear[corner];
+			const Maths::Vector3& b = cornerFar[corner];
+			const float t = (depth + a.z) / (a.z - b.z);
+			return a + (b - a) * t;
+		};
+
+		for(u32 z = 0; z < m_SliceCount; z++)
+		{
+			for(u32 x = 0; x < ClusterCountX; x++)
+				m_ColumnBounds[z * ClusterCountX + x].Clear();
+			for(u32 y = 0; y < ClusterCountY; y++)
+				m_RowBounds[z * ClusterCountY + y].Clear();
+
+			for(u32 y = 0; y < ClusterCountY; y++)
+			{
+				for(u32 x = 0; x < ClusterCountX; x++)
+				{
+					Maths::BoundingBox& bounds = m_ClusterBounds[(z * ClusterCountY + y) * ClusterCountX + x];
+					bounds.Clear();
+
+					for(u32 corner = 0; corner < 4; corner++)
+					{
+						const u32 index = (y + (corner >> 1)) * cornerCountX + x + (corner & 1);
+						bounds.Merge(pointAtDepth(index, m_SliceDepths[z]));
+						bounds.Merge(pointAtDepth(index, m_SliceDepths[z + 1]));
+					}
+
+					m_ColumnBounds[z * ClusterCountX + x].Merge(bounds);
+					m_RowBounds[z * ClusterCountY + y].Merge(bounds);
+				}
+			}
+		}
+	}
+
+	void LightClusters::AssignSlice(u32 slice)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		const u32 firstCluster = slice * ClusterCountX * ClusterCountY;
+		for(u32 i = 0; i < ClusterCountX * ClusterCountY; i++)
+			m_ClusterLights[firstCluster + i].clear();
+
+		const float sliceNear = m_SliceDepths[slice];
+		const float sliceFar = m_SliceDepths[slice + 1];
+
+		for(const ViewLight& light : m_ViewLights)
+		{
+			const float depth = -light.centre.z;
+			if(depth + light.radius < sliceNear || depth - light.radius > sliceFar)
+				continue;
+
+			const Maths::Sphere sphere(light.centre, light.radius);
+
+			// Columns and rows are contiguous, so the light touches a rectangle of tiles
+			u32 minX = ClusterCountX, maxX = 0;
+			for(u32 x = 0; x < ClusterCountX; x++)
+			{
+				if(m_ColumnBounds[slice * ClusterCountX + x].IsInsideFast(sphere) != Maths::OUTSIDE)
+				{
+					minX = Maths::Min(minX, x);
+					maxX = x;
+				}
+			}
+
+			if(minX > maxX)
+				continue;
+
+			u32 minY = ClusterCountY, maxY = 0;
+			for(u32 y = 0; y < ClusterCountY; y++)
+			{
+				if(m_RowBounds[slice * ClusterCountY + y].IsInsideFast(sphere) != Maths::OUTSIDE)
+				{
+					minY = Maths::Min(minY, y);
+					maxY = y;
+				}
+			}
+
+			for(u32 y = minY; y <= maxY && minY <= maxY; y++)
+			{
+				for(u32 x = minX; x <= maxX; x++)
+				{
+					const u32 cluster = firstCluster + y * ClusterCountX + x;
+					if(m_ClusterBounds[cluster].IsInsideFast(sphere) != Maths::OUTSIDE)
+						m_ClusterLights[cluster].push_back(light.index);
+				}
+			}
+		}
+	}
+}
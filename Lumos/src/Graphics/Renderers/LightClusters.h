@@ -0,0 +1,90 @@
+#pragma once
+#include "Maths/Maths.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		struct Light;
+
+		// Froxel grid over the camera frustum, exponentially sliced in depth, with the point and spot lights touching each cell.
+		// Cells are assigned on the JobSystem, one depth slice per job, so shading cost follows the lights near a pixel rather than the light count.
+		// Directional lights light every pixel so they are not clustered
+		class LUMOS_EXPORT LightClusters
+		{
+		public:
+			static constexpr u32 ClusterCountX = 16;
+			static constexpr u32 ClusterCountY = 8;
+			static constexpr u32 ClusterCountZ = 24;
+			static constexpr u32 ClusterCount = ClusterCountX * ClusterCountY * ClusterCountZ;
+
+			// Indices are 16 bit, two per word. The cluster words keep offsets in 16 bits, so even the offset one past
+			// the end of a full list has to stay below 65536
+			static constexpr u32 MaxLightIndices = 65528;
+			// Length of the list in DeferredLight.frag's uniform block variant, sized so it fits in a 64KB uniform buffer
+			static constexpr u32 MaxUniformLightIndices = 25600;
+
+			// Matches UniformBufferLightClusters in DeferredLight.frag. Only the uniform block variant has a fixed length list
+			struct Uniforms
+			{
+				Maths::Matrix4 viewProjection;
+				// xy : cluster count, zw : scale and bias from log view depth to depth slice
+				Maths::Vector4 params;
+				// First light index in the low 16 bits, light count in the high 16 bits
+				u32 clusters[ClusterCount];
+				u32 lightIndices[MaxLightIndices / 2];
+			};
+
+			// maxSize is the largest block the device can bind, the light index list is shortened to fit it and maxLightIndices
+			explicit LightClusters(u32 maxSize = sizeof(Uniforms), u32 maxLightIndices = MaxLightIndices);
+			~LightClusters() = default;
+
+			// Assigns lights[first, first + count) to clusters. Indices stored are into lights
+			void Build(const Maths::Matrix4& view, const Maths::Matrix4& projection, float nearPlane, float farPlane, bool orthographic, const Light* lights, u32 first, u32 count);
+
+			const Uniforms& GetUniforms() const { return *m_Uniforms; }
+
+			// Bytes of the uniforms written by the last Build, the unused end of the index list is left out
+			u32 GetUsedSize() const;
+			// Bytes of the uniforms that can be in use, the range to bind
+			u32 GetMaxSize() const;
+
+			u32 GetMaxLightIndexCount() const { return m_MaxLightIndices; }
+			u32 GetLightIndexCount() const { return m_LightIndexCount; }
+			// Light and cluster pairs left out because the index list was full
+			u32 GetDroppedIndexCount() const { return m_DroppedIndexCount; }
+
+		private:
+			struct ViewLight
+			{
+				Maths::Vector3 centre;
+				float radius;
+				u16 index;
+			};
+
+			void BuildClusterBounds(const Maths::Matrix4& projection, float nearPlane, float farPlane, bool orthographic);
+			void AssignSlice(u32 slice);
+
+			UniqueRef<Uniforms> m_Uniforms;
+
+			Maths::Matrix4 m_Projection;
+			float m_Near = 0.0f;
+			float m_Far = 0.0f;
+			bool m_Orthographic = false;
+			u32 m_SliceCount = ClusterCountZ;
+
+			// View space bounds of every cluster, and of each column and row of a depth slice
+			std::vector<Maths::BoundingBox> m_ClusterBounds;
+			std::vector<Maths::BoundingBox> m_ColumnBounds;
+			std::vector<Maths::BoundingBox> m_RowBounds;
+			std::vector<float> m_SliceDepths;
+
+			std::vector<ViewLight> m_ViewLights;
+			std::vector<std::vector<u16>> m_ClusterLights;
+
+			u32 m_MaxLightIndices = MaxLightIndices;
+			u32 m_LightIndexCount = 0;
+			u32 m_DroppedIndexCount = 0;
+		};
+	}
+}
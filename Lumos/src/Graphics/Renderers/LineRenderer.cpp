@@ -3,7 +3,6 @@
 #include "Core/OS/Window.h"
 #include "Graphics/API/Shader.h"
 #include "Graphics/API/Framebuffer.h"
-#include "Graphics/API/UniformBuffer.h"
 #include "Graphics/API/Renderer.h"
 #include "Graphics/API/CommandBuffer.h"
 #include "Graphics/API/Swapchain.h"
@@ -26,19 +25,14 @@ namespace Lumos
 {
 	using namespace Graphics;
 
-	static const uint32_t MaxLines = 10000;
-	static const uint32_t MaxLineVertices = MaxLines * 2;
-	static const uint32_t MaxLineIndices = MaxLines * 6;
-    static const uint32_t MAX_BATCH_DRAW_CALLS = 100;
-    static const uint32_t RENDERER_LINE_SIZE = sizeof(LineVertexData) * 4;
-    static const uint32_t RENDERER_BUFFER_SIZE = RENDERER_LINE_SIZE* MaxLineVertices;
+	// Lines the stream starts out with room for, it grows when a frame needs more
+	static const uint32_t InitialLineCapacity = 10000;
 
 	LineRenderer::LineRenderer(u32 width, u32 height, bool clear)
 		: m_Buffer(nullptr)
 		, m_Clear(clear)
 	{
 		m_RenderTexture = nullptr;
-		m_BatchDrawCallIndex = 0;
 		LineIndexCount = 0;
 
 		LineRenderer::SetScreenBufferSize(width, height);
@@ -48,18 +42,13 @@ namespace Lumos
 	LineRenderer::~LineRenderer()
 	{
 		delete m_IndexBuffer;
-		delete m_UniformBuffer;
+		delete m_VertexBuffer;
+		delete m_SecondaryCommandBuffer;
 
 		delete[] m_VSSystemUniformBuffer;
 
 		m_Framebuffers.clear();
 		m_CommandBuffers.clear();
-
-		for(int i = 0; i < MAX_BATCH_DRAW_CALLS; i++)
-			delete m_VertexBuffers[i];
-
-		for(int i = 0; i < MAX_BATCH_DRAW_CALLS; i++)
-			delete m_SecondaryCommandBuffers[i];
 	}
 
 	void LineRenderer::Init()
@@ -71,8 +60,6 @@ namespace Lumos
 		m_VSSystemUniformBufferSize = sizeof(Maths::Matrix4);
 		m_VSSystemUniformBuffer = new u8[m_VSSystemUniformBufferSize];
 
-		m_UniformBuffer = Graphics::UniformBuffer::Create();
-
 		AttachmentInfo textureTypes[2] =
 			{
 				{TextureType::COLOUR, TextureFormat::RGBA8}};
@@ -94,53 +81,17 @@ namespace Lumos
 			commandBuffer->Init(true);
 		}
 
-		m_SecondaryCommandBuffers.resize(MAX_BATCH_DRAW_CALLS);
-
-		for(auto& cmdBuffer : m_SecondaryCommandBuffers)
-		{
-			cmdBuffer = Graphics::CommandBuffer::Create();
-			cmdBuffer->Init(false);
-		}
+		m_SecondaryCommandBuffer = Graphics::CommandBuffer::Create();
+		m_SecondaryCommandBuffer->Init(false);
 
 		CreateGraphicsPipeline();
 
-		uint32_t bufferSize = static_cast<uint32_t>(sizeof(UniformBufferObject));
-		m_UniformBuffer->Init(bufferSize, nullptr);
-
 		std::vector<Graphics::BufferInfo> bufferInfos;
-
-		Graphics::BufferInfo bufferInfo;
-		bufferInfo.buffer = m_UniformBuffer;
-		bufferInfo.offset = 0;
-		bufferInfo.size = sizeof(UniformBufferObject);
-		bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
-		bufferInfo.shaderType = Graphics::ShaderType::VERTEX;
-		bufferInfo.systemUniforms = false;
-		bufferInfo.name = "UniformBufferObject";
-		bufferInfo.binding = 0;
-
-		bufferInfos.push_back(bufferInfo);
+		bufferInfos.push_back(GetVSSystemUniformBufferInfo());
 
 		m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
 
-		m_VertexBuffers.resize(MAX_BATCH_DRAW_CALLS);
-
-		for(auto& vertexBuffer : m_VertexBuffers)
-		{
-			vertexBuffer = Graphics::VertexBuffer::Create(BufferUsage::DYNAMIC);
-			vertexBuffer->Resize(RENDERER_BUFFER_SIZE);
-		}
-
-		u32* indices = new u32[MaxLineIndices];
-
-		for(i32 i = 0; i < MaxLineIndices; i++)
-		{
-			indices[i] = i;
-		}
-
-		m_IndexBuffer = IndexBuffer::Create(indices, MaxLineIndices);
-
-		delete[] indices;
+		ReserveLines(InitialLineCapacity);
 
 		m_ClearColour = Maths::Vector4(0.2f, 0.7f, 0.2f, 1.0f);
         m_CurrentDescriptorSets.resize(1);
@@ -153,9 +104,6 @@ namespace Lumos
 
 	void LineRenderer::SubmitInternal(const LineInfo& info)
 	{
-		if(LineIndexCount >= MaxLineIndices)
-			FlushAndResetLines();
-
 		m_Buffer->vertex = info.p1;
 		m_Buffer->color = info.col;
 		m_Buffer++;
@@ -196,9 +144,9 @@ namespace Lumos
 		m_RenderPass->BeginRenderpass(m_CommandBuffers[m_CurrentBufferID].get(), m_ClearColour, m_Framebuffers[m_CurrentBufferID].get(), Graphics::SECONDARY, m_ScreenBufferWidth, m_ScreenBufferHeight);
 	}
 
-	void LineRenderer::SetSystemUniforms(Shader* shader) const
+	void LineRenderer::SetSystemUniforms(Shader* shader)
 	{
-		m_UniformBuffer->SetData(sizeof(UniformBufferObject), *&m_VSSystemUniformBuffer);
+		PushVSSystemUniforms();
 	}
 
 	void LineRenderer::BeginScene(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform)
@@ -230,34 +178,33 @@ namespace Lumos
 
 	void LineRenderer::Present()
 	{
-		Graphics::CommandBuffer* currentCMDBuffer = m_SecondaryCommandBuffers[m_BatchDrawCallIndex];
+		Graphics::CommandBuffer* currentCMDBuffer = m_SecondaryCommandBuffer;
 
 		currentCMDBuffer->BeginRecordingSecondary(m_RenderPass.get(), m_Framebuffers[m_CurrentBufferID].get());
 		currentCMDBuffer->UpdateViewport(m_ScreenBufferWidth, m_ScreenBufferHeight);
 		m_Pipeline->Bind(currentCMDBuffer);
 
-		m_VertexBuffers[m_BatchDrawCallIndex]->ReleasePointer();
-		m_VertexBuffers[m_BatchDrawCallIndex]->Unbind();
+		m_VertexBuffer->ReleasePointer();
+		m_VertexBuffer->Unbind();
 
 		m_IndexBuffer->SetCount(LineIndexCount);
 
         m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
+		m_CurrentDescriptorSets[0]->SetDynamicOffset(m_VSSystemUniformOffset);
 
-        m_VertexBuffers[m_BatchDrawCallIndex]->Bind(currentCMDBuffer, m_Pipeline.get());
+        m_VertexBuffer->Bind(currentCMDBuffer, m_Pipeline.get());
 		m_IndexBuffer->Bind(currentCMDBuffer);
         
 		Renderer::BindDescriptorSets(m_Pipeline.get(), currentCMDBuffer, 0, m_CurrentDescriptorSets);
 		Renderer::DrawIndexed(currentCMDBuffer, DrawType::LINES, LineIndexCount);
 
-		m_VertexBuffers[m_BatchDrawCallIndex]->Unbind();
+		m_VertexBuffer->Unbind();
 		m_IndexBuffer->Unbind();
 
 		LineIndexCount = 0;
 
 		currentCMDBuffer->EndRecording();
 		currentCMDBuffer->ExecuteSecondary(m_CommandBuffers[m_CurrentBufferID].get());
-
-		m_BatchDrawCallIndex++;
 	}
 
 	void LineRenderer::End()
@@ -269,8 +216,6 @@ namespace Lumos
 
 		if(!m_RenderTexture)
 			PresentToScreen();
-
-		m_BatchDrawCallIndex = 0;
 	}
 
 	void LineRenderer::RenderInternal(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform)
@@ -287,17 +232,22 @@ namespace Lumos
 
 		m_RenderPass->BeginRenderpass(m_CommandBuffers[m_CurrentBufferID].get(), m_ClearColour, m_Framebuffers[m_CurrentBufferID].get(), Graphics::SECONDARY, m_ScreenBufferWidth, m_ScreenBufferHeight);
 
-        m_VertexBuffers[m_BatchDrawCallIndex]->Bind(m_CommandBuffers[m_CurrentBufferID].get(), m_Pipeline.get());
-		m_Buffer = m_VertexBuffers[m_BatchDrawCallIndex]->GetPointer<LineVertexData>();
-
 		SetSystemUniforms(m_Shader.get());
 
-		for(auto& line : m_Lines)
+		if(!m_Lines.empty())
 		{
-			SubmitInternal(line);
-		}
+			ReserveLines(static_cast<u32>(m_Lines.size()));
+
+			m_VertexBuffer->Bind(m_CommandBuffers[m_CurrentBufferID].get(), m_Pipeline.get());
+			m_Buffer = m_VertexBuffer->GetPointer<LineVertexData>();
 
-		Present();
+			for(auto& line : m_Lines)
+			{
+				SubmitInternal(line);
+			}
+
+			Present();
+		}
 
 		End();
 	}
@@ -396,13 +346,29 @@ namespace Lumos
 		CreateFramebuffers();
 	}
 
-	void LineRenderer::FlushAndResetLines()
+	void LineRenderer::ReserveLines(u32 count)
 	{
-		Present();
+		if(count <= m_LineCapacity)
+			return;
 
-		m_Lines.clear();
+		// Half again so a slowly rising line count does not recreate the buffers every frame
+		m_LineCapacity = Maths::Max(count + count / 2, InitialLineCapacity);
+
+		delete m_VertexBuffer;
+		m_VertexBuffer = Graphics::VertexBuffer::Create(BufferUsage::DYNAMIC);
+		m_VertexBuffer->Resize(m_LineCapacity * 2 * sizeof(LineVertexData));
+
+		const u32 indexCount = m_LineCapacity * 2;
+		u32* indices = new u32[indexCount];
+
+		for(u32 i = 0; i < indexCount; i++)
+		{
+			indices[i] = i;
+		}
 
-		m_VertexBuffers[m_BatchDrawCallIndex]->Bind(nullptr, nullptr);
-		m_Buffer = m_VertexBuffers[m_BatchDrawCallIndex]->GetPointer<LineVertexData>();
+		delete m_IndexBuffer;
+		m_IndexBuffer = IndexBuffer::Create(indices, indexCount);
+
+		delete[] indices;
 	}
 }
@@ -28,7 +28,6 @@ namespace Lumos
 		class Pipeline;
 		class DescriptorSet;
 		class CommandBuffer;
-		class UniformBuffer;
 		class Renderable2D;
 		class Framebuffer;
 		class Texture;
@@ -71,7 +70,7 @@ namespace Lumos
 			void SetScreenBufferSize(u32 width, u32 height) override;
 			void SetRenderTarget(Graphics::Texture* texture, bool rebuildFramebuffer) override;
 
-			void SetSystemUniforms(Graphics::Shader* shader) const;
+			void SetSystemUniforms(Graphics::Shader* shader);
 			float SubmitTexture(Graphics::Texture* texture);
             void PresentToScreen() override;
 			void RenderScene(Scene* scene) override {};
@@ -85,21 +84,22 @@ namespace Lumos
 
 			void CreateGraphicsPipeline();
 			void CreateFramebuffers();
-			void FlushAndResetLines();
 
 		protected:
 			void SubmitInternal(const LineInfo& info);
+			// Grows the vertex and index buffers to hold at least count lines
+			void ReserveLines(u32 count);
 
-			Graphics::UniformBuffer* m_UniformBuffer = nullptr;
-			std::vector<Graphics::CommandBuffer*> m_SecondaryCommandBuffers;
-			std::vector<Graphics::VertexBuffer*> m_VertexBuffers;
+			// Every line of the frame goes into one vertex stream, written once and drawn with a single call
+			Graphics::CommandBuffer* m_SecondaryCommandBuffer = nullptr;
+			Graphics::VertexBuffer* m_VertexBuffer = nullptr;
 			Graphics::IndexBuffer* m_IndexBuffer{};
+			u32 m_LineCapacity = 0;
 
 			LineVertexData* m_Buffer = nullptr;
             std::vector<LineInfo> m_Lines;
 
 			u32 m_CurrentBufferID = 0;
-            u32 m_BatchDrawCallIndex = 0;
             u32 LineIndexCount = 0;
             bool m_Clear = false;
 		};
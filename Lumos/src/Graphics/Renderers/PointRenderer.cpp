@@ -3,7 +3,6 @@
 #include "Core/OS/Window.h"
 #include "Graphics/API/Shader.h"
 #include "Graphics/API/Framebuffer.h"
-#include "Graphics/API/UniformBuffer.h"
 #include "Graphics/API/Renderer.h"
 #include "Graphics/API/CommandBuffer.h"
 #include "Graphics/API/Swapchain.h"
@@ -24,12 +23,8 @@ namespace Lumos
 {
 	using namespace Graphics;
 
-	static const uint32_t MaxPoints = 10000;
-	static const uint32_t MaxPointVertices = MaxPoints * 4;
-	static const uint32_t MaxPointIndices = MaxPoints * 6;
-    static const uint32_t MAX_BATCH_DRAW_CALLS = 100;
-    static const uint32_t RENDERER_POINT_SIZE = sizeof(PointVertexData) * 4;
-    static const uint32_t RENDERER_BUFFER_SIZE = RENDERER_POINT_SIZE * MaxPointVertices;
+	// Points the stream starts out with room for, it grows when a frame needs more
+	static const uint32_t InitialPointCapacity = 10000;
 
 	PointRenderer::PointRenderer(u32 width, u32 height, bool clear)
 		: m_IndexCount(0)
@@ -37,7 +32,6 @@ namespace Lumos
 		, m_Clear(clear)
 	{
 		m_RenderTexture = nullptr;
-		m_BatchDrawCallIndex = 0;
 
 		PointRenderer::SetScreenBufferSize(width, height);
 
@@ -47,14 +41,9 @@ namespace Lumos
 	PointRenderer::~PointRenderer()
 	{
 		delete m_IndexBuffer;
-		delete m_UniformBuffer;
+		delete m_VertexBuffer;
+		delete m_SecondaryCommandBuffer;
 		delete[] m_VSSystemUniformBuffer;
-		
-		for(int i = 0; i < MAX_BATCH_DRAW_CALLS; i++)
-			delete m_VertexBuffers[i];
-
-		for(int i = 0; i < MAX_BATCH_DRAW_CALLS; i++)
-			delete m_SecondaryCommandBuffers[i];
 	}
 
 	void PointRenderer::Init()
@@ -66,8 +55,6 @@ namespace Lumos
 		m_VSSystemUniformBufferSize = sizeof(Maths::Matrix4);
 		m_VSSystemUniformBuffer = new u8[m_VSSystemUniformBufferSize];
 
-		m_UniformBuffer = Graphics::UniformBuffer::Create();
-
 		AttachmentInfo textureTypes[2] =
 			{
 				{TextureType::COLOUR, TextureFormat::RGBA8}};
@@ -89,62 +76,17 @@ namespace Lumos
 			commandBuffer->Init(true);
 		}
 
-		m_SecondaryCommandBuffers.resize(MAX_BATCH_DRAW_CALLS);
-
-		for(auto& cmdBuffer : m_SecondaryCommandBuffers)
-		{
-			cmdBuffer = Graphics::CommandBuffer::Create();
-			cmdBuffer->Init(false);
-		}
+		m_SecondaryCommandBuffer = Graphics::CommandBuffer::Create();
+		m_SecondaryCommandBuffer->Init(false);
 
 		CreateGraphicsPipeline();
 
-		uint32_t bufferSize = static_cast<uint32_t>(sizeof(UniformBufferObject));
-		m_UniformBuffer->Init(bufferSize, nullptr);
-
 		std::vector<Graphics::BufferInfo> bufferInfos;
-
-		Graphics::BufferInfo bufferInfo;
-		bufferInfo.buffer = m_UniformBuffer;
-		bufferInfo.offset = 0;
-		bufferInfo.size = sizeof(UniformBufferObject);
-		bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
-		bufferInfo.shaderType = Graphics::ShaderType::VERTEX;
-		bufferInfo.systemUniforms = false;
-		bufferInfo.name = "UniformBufferObject";
-		bufferInfo.binding = 0;
-
-		bufferInfos.push_back(bufferInfo);
+		bufferInfos.push_back(GetVSSystemUniformBufferInfo());
 
 		m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
 
-		m_VertexBuffers.resize(MAX_BATCH_DRAW_CALLS);
-
-		for(auto& vertexBuffer : m_VertexBuffers)
-		{
-			vertexBuffer = Graphics::VertexBuffer::Create(BufferUsage::DYNAMIC);
-			vertexBuffer->Resize(RENDERER_BUFFER_SIZE);
-		}
-
-		u32* indices = new u32[MaxPointIndices];
-
-		i32 offset = 0;
-		for(i32 i = 0; i < MaxPointIndices; i += 6)
-		{
-			indices[i] = offset + 0;
-			indices[i + 1] = offset + 1;
-			indices[i + 2] = offset + 2;
-
-			indices[i + 3] = offset + 2;
-			indices[i + 4] = offset + 3;
-			indices[i + 5] = offset + 0;
-
-			offset += 4;
-		}
-
-		m_IndexBuffer = IndexBuffer::Create(indices, MaxPointIndices);
-
-		delete[] indices;
+		ReservePoints(InitialPointCapacity);
 
 		m_ClearColour = Maths::Vector4(0.2f, 0.7f, 0.2f, 1.0f);
         m_CurrentDescriptorSets.resize(1);
@@ -157,9 +99,6 @@ namespace Lumos
 
 	void PointRenderer::SubmitInternal(PointInfo& pointInfo)
 	{
-		if(PointIndexCount >= MaxPointIndices)
-			FlushAndResetPoints();
-
 		Maths::Vector3 right = pointInfo.size * m_CameraTransform->GetRightDirection();
 		Maths::Vector3 up = pointInfo.size * m_CameraTransform->GetUpDirection();
 
@@ -197,9 +136,9 @@ namespace Lumos
 		m_Points.clear();
 	}
 
-	void PointRenderer::SetSystemUniforms(Shader* shader) const
+	void PointRenderer::SetSystemUniforms(Shader* shader)
 	{
-		m_UniformBuffer->SetData(sizeof(UniformBufferObject), *&m_VSSystemUniformBuffer);
+		PushVSSystemUniforms();
 	}
 
 	void PointRenderer::BeginScene(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform)
@@ -233,34 +172,33 @@ namespace Lumos
 	{
 		UpdateDesciptorSet();
 
-		Graphics::CommandBuffer* currentCMDBuffer = m_SecondaryCommandBuffers[m_BatchDrawCallIndex];
+		Graphics::CommandBuffer* currentCMDBuffer = m_SecondaryCommandBuffer;
 
 		currentCMDBuffer->BeginRecordingSecondary(m_RenderPass.get(), m_Framebuffers[m_CurrentBufferID].get());
 		currentCMDBuffer->UpdateViewport(m_ScreenBufferWidth, m_ScreenBufferHeight);
 		m_Pipeline->Bind(currentCMDBuffer);
 
-		m_VertexBuffers[m_BatchDrawCallIndex]->ReleasePointer();
-		m_VertexBuffers[m_BatchDrawCallIndex]->Unbind();
+		m_VertexBuffer->ReleasePointer();
+		m_VertexBuffer->Unbind();
 
 		m_IndexBuffer->SetCount(PointIndexCount);
 
         m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
+		m_CurrentDescriptorSets[0]->SetDynamicOffset(m_VSSystemUniformOffset);
 
-        m_VertexBuffers[m_BatchDrawCallIndex]->Bind(currentCMDBuffer, m_Pipeline.get());
+        m_VertexBuffer->Bind(currentCMDBuffer, m_Pipeline.get());
 		m_IndexBuffer->Bind(currentCMDBuffer);
         
 		Renderer::BindDescriptorSets(m_Pipeline.get(), currentCMDBuffer, 0, m_CurrentDescriptorSets);
 		Renderer::DrawIndexed(currentCMDBuffer, DrawType::TRIANGLE, PointIndexCount);
 
-		m_VertexBuffers[m_BatchDrawCallIndex]->Unbind();
+		m_VertexBuffer->Unbind();
 		m_IndexBuffer->Unbind();
 
 		PointIndexCount = 0;
 
 		currentCMDBuffer->EndRecording();
 		currentCMDBuffer->ExecuteSecondary(m_CommandBuffers[m_CurrentBufferID].get());
-
-		m_BatchDrawCallIndex++;
 	}
 
 	void PointRenderer::End()
@@ -272,8 +210,6 @@ namespace Lumos
 
 		if(!m_RenderTexture)
 			PresentToScreen();
-
-		m_BatchDrawCallIndex = 0;
 	}
 
 	void PointRenderer::RenderInternal(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform)
@@ -289,15 +225,20 @@ namespace Lumos
 
         m_Pipeline->Bind(m_CommandBuffers[m_CurrentBufferID].get());
 
-        m_VertexBuffers[m_BatchDrawCallIndex]->Bind(m_CommandBuffers[m_CurrentBufferID].get(), m_Pipeline.get());
-		m_Buffer = m_VertexBuffers[m_BatchDrawCallIndex]->GetPointer<PointVertexData>();
-
 		SetSystemUniforms(m_Shader.get());
 
-		for(auto& point : m_Points)
-			SubmitInternal(point);
+		if(!m_Points.empty())
+		{
+			ReservePoints(static_cast<u32>(m_Points.size()));
+
+			m_VertexBuffer->Bind(m_CommandBuffers[m_CurrentBufferID].get(), m_Pipeline.get());
+			m_Buffer = m_VertexBuffer->GetPointer<PointVertexData>();
+
+			for(auto& point : m_Points)
+				SubmitInternal(point);
 
-		Present();
+			Present();
+		}
 
 		End();
 	}
@@ -400,13 +341,38 @@ namespace Lumos
 		}
 	}
 
-	void PointRenderer::FlushAndResetPoints()
+	void PointRenderer::ReservePoints(u32 count)
 	{
-		Present();
+		if(count <= m_PointCapacity)
+			return;
 
-		m_Points.clear();
+		// Half again so a slowly rising point count does not recreate the buffers every frame
+		m_PointCapacity = Maths::Max(count + count / 2, InitialPointCapacity);
+
+		delete m_VertexBuffer;
+		m_VertexBuffer = Graphics::VertexBuffer::Create(BufferUsage::DYNAMIC);
+		m_VertexBuffer->Resize(m_PointCapacity * 4 * sizeof(PointVertexData));
 
-		m_VertexBuffers[m_BatchDrawCallIndex]->Bind(nullptr, nullptr);
-		m_Buffer = m_VertexBuffers[m_BatchDrawCallIndex]->GetPointer<PointVertexData>();
+		const u32 indexCount = m_PointCapacity * 6;
+		u32* indices = new u32[indexCount];
+
+		u32 offset = 0;
+		for(u32 i = 0; i < indexCount; i += 6)
+		{
+			indices[i] = offset + 0;
+			indices[i + 1] = offset + 1;
+			indices[i + 2] = offset + 2;
+
+			indices[i + 3] = offset + 2;
+			indices[i + 4] = offset + 3;
+			indices[i + 5] = offset + 0;
+
+			offset += 4;
+		}
+
+		delete m_IndexBuffer;
+		m_IndexBuffer = IndexBuffer::Create(indices, indexCount);
+
+		delete[] indices;
 	}
 }
@@ -45,7 +45,6 @@ namespace Lumos
 		class Pipeline;
 		class DescriptorSet;
 		class CommandBuffer;
-		class UniformBuffer;
 		class Renderable2D;
 		class Framebuffer;
 		class Texture;
@@ -72,7 +71,7 @@ namespace Lumos
 			void RenderInternal(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform) ;
 			void PresentToScreen() override;
 			void Submit(const Maths::Vector3& p1, float size, const Maths::Vector4& colour);
-			void SetSystemUniforms(Graphics::Shader* shader) const;
+			void SetSystemUniforms(Graphics::Shader* shader);
 			float SubmitTexture(Graphics::Texture* texture);
 
 			struct UniformBufferObject
@@ -85,17 +84,18 @@ namespace Lumos
 			void UpdateDesciptorSet() const;
 	
 		protected:
-			void FlushAndResetPoints();
 			void SubmitInternal(PointInfo& pointInfo);
+			// Grows the vertex and index buffers to hold at least count points
+			void ReservePoints(u32 count);
 
 			PointVertexData* m_Buffer = nullptr;
+			// Every point of the frame goes into one vertex stream, written once and drawn with a single call
 			Graphics::IndexBuffer* m_IndexBuffer = nullptr;
-			Graphics::UniformBuffer* m_UniformBuffer = nullptr;
-			std::vector<Graphics::CommandBuffer*> m_SecondaryCommandBuffers;
-			std::vector<Graphics::VertexBuffer*> m_VertexBuffers;
+			Graphics::CommandBuffer* m_SecondaryCommandBuffer = nullptr;
+			Graphics::VertexBuffer* m_VertexBuffer = nullptr;
+			u32 m_PointCapacity = 0;
 			std::vector<PointInfo> m_Points;
 
-			u32 m_BatchDrawCallIndex = 0;
 			u32 PointIndexCount = 0;
 			u32 m_IndexCount = 0;
 			u32 m_CurrentBufferID = 0;
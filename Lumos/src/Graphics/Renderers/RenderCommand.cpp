@@ -0,0 +1,250 @@
+#include "Precompiled.h"
+#include "RenderCommand.h"
+#include "Core/Engine.h"
+
+#include "Graphics/API/Renderer.h"
+#include "Graphics/API/Pipeline.h"
+#include "Graphics/API/VertexBuffer.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		static u64 FoldPointer(const void* ptr, u32 bits)
+		{
+			// Allocations are at least 16 byte aligned, drop the low bits before folding
+			u64 value = reinterpret_cast<uintptr_t>(ptr) >> 4;
+			value ^= value >> 29;
+			value *= 0x9E3779B97F4A7C15ull;
+			return value >> (64 - bits);
+		}
+
+		u64 RenderSortKey::Make(u32 pass, const Pipeline* pipeline, const Material* material, const Mesh* mesh, float depth01)
+		{
+			const u64 maxDepth = (1ull << DepthBits) - 1;
+			const u64 depth = static_cast<u64>(Maths::Clamp(depth01, 0.0f, 1.0f) * static_cast<float>(maxDepth));
+
+			u64 key = static_cast<u64>(pass & ((1u << PassBits) - 1));
+			key = (key << PipelineBits) | (pipeline ? FoldPointer(pipeline, PipelineBits) : 0);
+			key = (key << MaterialBits) | (material ? FoldPointer(material, MaterialBits) : 0);
+			key = (key << MeshBits) | (mesh ? FoldPointer(mesh, MeshBits) : 0);
+			key = (key << DepthBits) | depth;
+
+			return key;
+		}
+
+		struct SortEntry
+		{
+			u64 key;
+			u32 index;
+		};
+
+		void SortCommandQueue(std::vector<RenderCommand>& commands)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			const size_t count = commands.size();
+			if(count < 2)
+				return;
+
+			static thread_local std::vector<SortEntry> s_Entries;
+			static thread_local std::vector<SortEntry> s_Scratch;
+			static thread_local std::vector<RenderCommand> s_Sorted;
+
+			s_Entries.resize(count);
+			s_Scratch.resize(count);
+
+			for(u32 i = 0; i < static_cast<u32>(count); i++)
+				s_Entries[i] = {commands[i].sortKey, i};
+
+			// Sort the (key, index) pairs 8 bits at a time, then permute the commands once
+			SortEntry* src = s_Entries.data();
+			SortEntry* dst = s_Scratch.data();
+
+			for(u32 shift = 0; shift < 64; shift += 8)
+			{
+				u32 histogram[256] = {};
+				for(size_t i = 0; i < count; i++)
+					histogram[(src[i].key >> shift) & 0xFF]++;
+
+				// Every key has the same byte here, nothing to do for this pass
+				if(histogram[(src[0].key >> shift) & 0xFF] == count)
+					continue;
+
+				u32 offset = 0;
+				for(u32 b = 0; b < 256; b++)
+				{
+					u32 c = histogram[b];
+					histogram[b] = offset;
+					offset += c;
+				}
+
+				for(size_t i = 0; i < count; i++)
+					dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+				std::swap(src, dst);
+			}
+
+			s_Sorted.resize(count);
+			for(size_t i = 0; i < count; i++)
+				s_Sorted[i] = commands[src[i].index];
+
+			commands.swap(s_Sorted);
+		}
+
+		void BuildInstanceBatches(const std::vector<RenderCommand>& commands, std::vector<InstanceBatch>& batches, std::vector<Maths::Matrix4>& transforms)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			transforms.reserve(transforms.size() + commands.size());
+
+			for(auto& command : commands)
+			{
+				if(batches.empty() || batches.back().mesh != command.mesh || batches.back().material != command.material)
+				{
+					InstanceBatch batch;
+					batch.mesh = command.mesh;
+					batch.material = command.material;
+					batch.firstInstance = static_cast<u32>(transforms.size());
+					batches.push_back(batch);
+				}
+
+				batches.back().instanceCount++;
+				transforms.push_back(command.transform);
+			}
+		}
+
+		InstanceBuffer::~InstanceBuffer()
+		{
+			delete m_Buffer;
+		}
+
+		void InstanceBuffer::Upload(const std::vector<Maths::Matrix4>& transforms)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			if(transforms.empty())
+				return;
+
+			const u32 count = static_cast<u32>(transforms.size());
+			if(!m_Buffer || count > m_Capacity)
+			{
+				// Recreate rather than resize so the old allocation is released
+				delete m_Buffer;
+				m_Capacity = Maths::Max(count + count / 2, 256u);
+				m_Buffer = VertexBuffer::Create(BufferUsage::DYNAMIC);
+				m_Buffer->Resize(m_Capacity * sizeof(Maths::Matrix4));
+			}
+
+			m_Buffer->SetDataSub(count * sizeof(Maths::Matrix4), transforms.data(), 0);
+		}
+
+		void InstanceBuffer::Bind(CommandBuffer* commandBuffer, Pipeline* pipeline, u32 firstInstance)
+		{
+			m_Buffer->BindInstances(commandBuffer, pipeline, firstInstance * sizeof(Maths::Matrix4));
+		}
+
+		BufferLayout InstanceBuffer::GetLayout()
+		{
+			BufferLayout layout;
+			layout.Push<Maths::Vector4>("model0");
+			layout.Push<Maths::Vector4>("model1");
+			layout.Push<Maths::Vector4>("model2");
+			layout.Push<Maths::Vector4>("model3");
+			return layout;
+		}
+
+		void RenderBindState::Reset(CommandBuffer* commandBuffer)
+		{
+			m_CommandBuffer = commandBuffer;
+			m_Pipeline = nullptr;
+			m_DescriptorSet = nullptr;
+			m_DynamicOffset = 0;
+			m_Mesh = nullptr;
+
+			m_DescriptorBindsSaved = 0;
+			m_BufferBindsSaved = 0;
+			m_DrawCalls = 0;
+			m_DrawCallsSavedByInstancing = 0;
+		}
+
+		void RenderBindState::BindPipeline(Pipeline* pipeline)
+		{
+			if(pipeline == m_Pipeline)
+				return;
+
+			// Vertex input and descriptor sets are bound against the pipeline, rebind them after a change
+			if(m_Mesh)
+			{
+				m_Mesh->GetVertexBuffer()->Unbind();
+				m_Mesh->GetIndexBuffer()->Unbind();
+				m_Mesh = nullptr;
+			}
+			m_DescriptorSet = nullptr;
+
+			pipeline->Bind(m_CommandBuffer);
+			m_Pipeline = pipeline;
+		}
+
+		void RenderBindState::BindMesh(Mesh* mesh)
+		{
+			if(mesh == m_Mesh)
+			{
+				m_BufferBindsSaved += 2;
+				return;
+			}
+
+			if(m_Mesh)
+			{
+				m_Mesh->GetVertexBuffer()->Unbind();
+				m_Mesh->GetIndexBuffer()->Unbind();
+			}
+
+			mesh->GetVertexBuffer()->Bind(m_CommandBuffer, m_Pipeline);
+			mesh->GetIndexBuffer()->Bind(m_CommandBuffer);
+			m_Mesh = mesh;
+		}
+
+		void RenderBindState::BindDescriptorSets(DescriptorSet* drawSet, std::vector<DescriptorSet*>& descriptorSets, std::vector<PushConstant>& pushConstants, u32 dynamicOffset)
+		{
+			if(drawSet && drawSet == m_DescriptorSet && dynamicOffset == m_DynamicOffset)
+			{
+				m_DescriptorBindsSaved++;
+
+				if(!pushConstants.empty())
+					Renderer::PushConstants(m_Pipeline, m_CommandBuffer, pushConstants);
+				return;
+			}
+
+			Renderer::BindDescriptorSets(m_Pipeline, m_CommandBuffer, dynamicOffset, descriptorSets);
+			m_DescriptorSet = drawSet;
+			m_DynamicOffset = dynamicOffset;
+		}
+
+		void RenderBindState::DrawIndexedInstanced(u32 count, u32 instanceCount)
+		{
+			Renderer::DrawIndexedInstanced(m_CommandBuffer, DrawType::TRIANGLE, count, instanceCount);
+			m_DrawCalls++;
+			m_DrawCallsSavedByInstancing += instanceCount - 1;
+		}
+
+		void RenderBindState::End()
+		{
+			if(m_Mesh)
+			{
+				m_Mesh->GetVertexBuffer()->Unbind();
+				m_Mesh->GetIndexBuffer()->Unbind();
+			}
+
+			m_Mesh = nullptr;
+
+			auto& stats = Engine::Get().Statistics();
+			stats.NumDescriptorBindsSaved += m_DescriptorBindsSaved;
+			stats.NumBufferBindsSaved += m_BufferBindsSaved;
+			stats.NumDrawCalls += m_DrawCalls;
+			stats.NumDrawCallsSavedByInstancing += m_DrawCallsSavedByInstancing;
+
+			m_DescriptorBindsSaved = 0;
+			m_BufferBindsSaved = 0;
+			m_DrawCalls = 0;
+			m_DrawCallsSavedByInstancing = 0;
+		}
+	}
+}
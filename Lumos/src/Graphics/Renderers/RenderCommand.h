@@ -2,6 +2,7 @@
 
 #include "Graphics/Mesh.h"
 #include "Graphics/API/Shader.h"
+#include "Graphics/API/BufferLayout.h"
 
 namespace Lumos
 {
@@ -9,7 +10,12 @@ namespace Lumos
 	namespace Graphics
 	{
 		class Material;
-		
+		class Pipeline;
+		class DescriptorSet;
+		class CommandBuffer;
+		class VertexBuffer;
+		struct PushConstant;
+
 		struct LUMOS_EXPORT RendererUniform
 		{
 			std::string uniform;
@@ -21,7 +27,92 @@ namespace Lumos
 			Mesh* mesh = nullptr;
 			Material* material = nullptr;
 			Maths::Matrix4 transform;
-			Maths::Matrix4 textureMatrix;
+			u64 sortKey = 0;
+		};
+
+		// Sort key layout, most significant bits first :
+		// | pass (4) | pipeline (10) | material (16) | mesh (14) | depth (20) |
+		// Commands sorted by key are grouped by state first and drawn front to back within a group
+		namespace RenderSortKey
+		{
+			constexpr u32 PassBits = 4;
+			constexpr u32 PipelineBits = 10;
+			constexpr u32 MaterialBits = 16;
+			constexpr u32 MeshBits = 14;
+			constexpr u32 DepthBits = 20;
+
+			LUMOS_EXPORT u64 Make(u32 pass, const Pipeline* pipeline, const Material* material, const Mesh* mesh, float depth01);
+		}
+
+		// Stable LSD radix sort of the queue by RenderCommand::sortKey
+		LUMOS_EXPORT void SortCommandQueue(std::vector<RenderCommand>& commands);
+
+		// Run of commands sharing a mesh and material, drawn with one instanced draw
+		struct LUMOS_EXPORT InstanceBatch
+		{
+			Mesh* mesh = nullptr;
+			Material* material = nullptr;
+			u32 firstInstance = 0;
+			u32 instanceCount = 0;
+		};
+
+		// Merges neighbouring commands of a sorted queue that share a mesh and material.
+		// Batches and transforms are appended, so several queues can share one instance buffer
+		LUMOS_EXPORT void BuildInstanceBatches(const std::vector<RenderCommand>& commands, std::vector<InstanceBatch>& batches, std::vector<Maths::Matrix4>& transforms);
+
+		// Per instance model matrices, read by shaders as a mat4 vertex input
+		class LUMOS_EXPORT InstanceBuffer
+		{
+		public:
+			InstanceBuffer() = default;
+			~InstanceBuffer();
+
+			// Grows the buffer when needed. Only call once the previous contents are no longer in use
+			void Upload(const std::vector<Maths::Matrix4>& transforms);
+			void Bind(CommandBuffer* commandBuffer, Pipeline* pipeline, u32 firstInstance);
+
+			// Instance layout to set on PipelineInfo::instanceBufferLayout
+			static BufferLayout GetLayout();
+
+		private:
+			VertexBuffer* m_Buffer = nullptr;
+			u32 m_Capacity = 0;
+		};
+
+		// Tracks the state bound while recording a sorted queue so repeated binds can be skipped.
+		// Saved binds and draws are counted locally, so one state per thread can record in parallel,
+		// and added to Engine::Stats by End()
+		class LUMOS_EXPORT RenderBindState
+		{
+		public:
+			void Reset(CommandBuffer* commandBuffer);
+
+			void BindPipeline(Pipeline* pipeline);
+
+			// Vertex and index buffers are only rebound when the mesh changes
+			void BindMesh(Mesh* mesh);
+
+			// descriptorSets are rebound when the set identifying the draw (usually the material set) changes,
+			// otherwise only the push constants are updated
+			void BindDescriptorSets(DescriptorSet* drawSet, std::vector<DescriptorSet*>& descriptorSets, std::vector<PushConstant>& pushConstants, u32 dynamicOffset = 0);
+
+			void DrawIndexedInstanced(u32 count, u32 instanceCount);
+
+			// Unbinds the current mesh and adds the counters to Engine::Stats.
+			// Call once the queue has been recorded, from the main thread
+			void End();
+
+		private:
+			CommandBuffer* m_CommandBuffer = nullptr;
+			Pipeline* m_Pipeline = nullptr;
+			DescriptorSet* m_DescriptorSet = nullptr;
+			u32 m_DynamicOffset = 0;
+			Mesh* m_Mesh = nullptr;
+
+			u32 m_DescriptorBindsSaved = 0;
+			u32 m_BufferBindsSaved = 0;
+			u32 m_DrawCalls = 0;
+			u32 m_DrawCallsSavedByInstancing = 0;
 		};
 	}
 }
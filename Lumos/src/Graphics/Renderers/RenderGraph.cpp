@@ -1,7 +1,17 @@
 #include "Precompiled.h"
 #include "RenderGraph.h"
 #include "Graphics/GBuffer.h"
+#include "Graphics/TextureAtlas.h"
+#include "Graphics/GPUProfiler.h"
+#include "Graphics/Sprite.h"
+#include "Graphics/AnimatedSprite.h"
+#include "Scene/Scene.h"
 #include "Graphics/Renderers/IRenderer.h"
+#include "Graphics/Renderers/VisibilityStage.h"
+#include "Graphics/API/Texture.h"
+#include "Graphics/API/GraphicsContext.h"
+
+#include <imgui/imgui.h>
 
 namespace Lumos::Graphics
 {
@@ -10,12 +20,18 @@ namespace Lumos::Graphics
 		SetScreenBufferSize(width, height);
 		
 		m_GBuffer = new GBuffer(width, height);
+		m_Visibility = new VisibilityStage();
+		m_TextureAtlas = new TextureAtlas();
+		m_GPUProfiler = new GPUProfiler();
 		Reset();
 	}
 	
 	RenderGraph::~RenderGraph()
     {
         delete m_GBuffer;
+        delete m_Visibility;
+        delete m_TextureAtlas;
+        delete m_GPUProfiler;
         for(auto renderer: m_Renderers)
         {
             delete renderer;
@@ -26,14 +42,21 @@ namespace Lumos::Graphics
 	{
 		SetScreenBufferSize(width, height);
 		m_GBuffer->UpdateTextureSize(width, height);
+		m_GraphDirty = true;
 	}
 
-    void RenderGraph::BeginScene(Scene* scene)
+    void RenderGraph::SetGBufferLayout(GBufferLayout layout)
     {
-        for(auto renderer: m_Renderers)
-        {
-            renderer->BeginScene(scene, m_OverrideCamera , m_OverrideCameraTransform);
-        }
+        if(m_GBuffer->GetLayout() == layout)
+            return;
+
+        // The textures are about to be destroyed
+        Graphics::GraphicsContext::GetContext()->WaitIdle();
+
+        m_GBuffer->SetLayout(layout);
+        for(auto renderer : m_Renderers)
+            renderer->OnResize(m_ScreenBufferWidth, m_ScreenBufferHeight);
+        m_GraphDirty = true;
     }
 
     void RenderGraph::SetRenderTarget(Graphics::Texture* texture, bool onlyIfTargetsScreen, bool rebuildFramebuffer)
@@ -47,13 +70,56 @@ namespace Lumos::Graphics
 
     void RenderGraph::OnRender(Scene * scene)
     {
-        for(auto renderer : m_Renderers)
+        if(m_GraphDirty)
+            Compile();
+
+        m_GPUProfiler->BeginFrame();
+
+        // Pages are uploaded before any renderer records draws sampling them
+        m_TextureAtlas->Update();
+
+        // Every renderer registers its views in BeginScene, so all of them are culled together before recording
+        m_Visibility->BeginFrame(scene);
+
+        for(u32 pass : m_Builder.GetOrder())
+        {
+            m_Renderers[pass]->BeginScene(scene, m_OverrideCamera, m_OverrideCameraTransform);
+        }
+
+        m_Visibility->Cull();
+
+        for(u32 pass : m_Builder.GetOrder())
         {
-            renderer->BeginScene(scene, m_OverrideCamera, m_OverrideCameraTransform );
-            renderer->RenderScene(scene);
+            m_GPUProfiler->BeginPass(m_Builder.GetPassName(pass));
+            m_Renderers[pass]->RenderScene(scene);
+            m_GPUProfiler->EndPass();
         }
     }
 
+    void RenderGraph::Compile()
+    {
+        LUMOS_PROFILE_FUNCTION();
+        m_Builder.Clear();
+
+        m_Builder.MarkOutput(m_Builder.AddResource(RenderGraphResources::Screen));
+        m_Builder.AddResource(RenderGraphResources::Depth);
+        m_Builder.AddResource(RenderGraphResources::ShadowMap);
+        m_Builder.AddResource(RenderGraphResources::GBufferColour);
+        m_Builder.AddResource(RenderGraphResources::GBufferPosition);
+        m_Builder.AddResource(RenderGraphResources::GBufferNormals);
+        m_Builder.AddResource(RenderGraphResources::GBufferPBR);
+
+        // Pass indices match m_Renderers
+        for(u32 i = 0; i < m_Renderers.size(); i++)
+        {
+            const u32 pass = m_Builder.AddPass("Pass " + std::to_string(i), m_Renderers[i]->GetRenderPriority());
+            m_Renderers[i]->DeclareResources(m_Builder, pass);
+        }
+
+        m_Builder.Compile();
+        m_GraphDirty = false;
+    }
+
     void RenderGraph::OnUpdate(const TimeStep& timeStep, Scene* scene)
     {
     }
@@ -75,6 +141,49 @@ namespace Lumos::Graphics
 
     void RenderGraph::OnImGui()
     {
+        if(ImGui::TreeNode("Passes"))
+        {
+            for(u32 pass : m_Builder.GetOrder())
+                ImGui::Text("%s", m_Builder.GetPassName(pass).c_str());
+
+            for(u32 pass = 0; pass < m_Builder.GetPassCount(); pass++)
+            {
+                if(m_Builder.IsCulled(pass))
+                    ImGui::TextDisabled("%s (Culled)", m_Builder.GetPassName(pass).c_str());
+            }
+
+            ImGui::TreePop();
+        }
+
+        if(ImGui::TreeNode("GBuffer"))
+        {
+            static const char* layoutNames[] = { "Standard", "Compact" };
+            int layout = static_cast<int>(m_GBuffer->GetLayout());
+            if(ImGui::Combo("Layout", &layout, layoutNames, IM_ARRAYSIZE(layoutNames)))
+                SetGBufferLayout(static_cast<GBufferLayout>(layout));
+
+            // Every target is written by the geometry pass and read once by the lighting pass
+            const float pixels = static_cast<float>(m_ScreenBufferWidth) * static_cast<float>(m_ScreenBufferHeight);
+            for(int i = 0; i < IM_ARRAYSIZE(layoutNames); i++)
+            {
+                const u64 size = GBuffer::CalculateMemorySize(static_cast<GBufferLayout>(i), m_ScreenBufferWidth, m_ScreenBufferHeight);
+                ImGui::Text("%s : %.1f MB, %.0f bytes per pixel, %.1f MB traffic per frame", layoutNames[i], size / (1024.0f * 1024.0f), size / pixels, size * 2 / (1024.0f * 1024.0f));
+            }
+            ImGui::TreePop();
+        }
+
+        if(ImGui::TreeNode("Texture Atlas"))
+        {
+            m_TextureAtlas->OnImGui();
+            ImGui::TreePop();
+        }
+
+        if(ImGui::TreeNode("GPU Timings"))
+        {
+            m_GPUProfiler->OnImGui();
+            ImGui::TreePop();
+        }
+
         for(auto renderer : m_Renderers)
         {
             renderer->OnImGui();
@@ -83,6 +192,16 @@ namespace Lumos::Graphics
 
     void RenderGraph::OnNewScene(Scene* scene)
     {
+        LUMOS_PROFILE_FUNCTION();
+        // Pack the scene's sprites up front rather than as they first come into view
+        auto& registry = scene->GetRegistry();
+        auto spriteView = registry.view<Sprite>();
+        for(auto entity : spriteView)
+            m_TextureAtlas->Add(spriteView.get<Sprite>(entity).GetTexture());
+
+        auto animatedSpriteView = registry.view<AnimatedSprite>();
+        for(auto entity : animatedSpriteView)
+            m_TextureAtlas->Add(animatedSpriteView.get<AnimatedSprite>(entity).GetTexture());
     }
 
 	void RenderGraph::Reset()
@@ -95,18 +214,13 @@ namespace Lumos::Graphics
     void RenderGraph::AddRenderer(Graphics::IRenderer* renderer)
     {
         m_Renderers.push_back(renderer);
-        //SortRenderers();
+        m_GraphDirty = true;
     }
 
     void RenderGraph::AddRenderer(Graphics::IRenderer* renderer, int renderPriority)
     {
         renderer->SetRenderPriority(renderPriority);
         m_Renderers.push_back(renderer);
-        //SortRenderers();
-    }
-
-    void RenderGraph::SortRenderers()
-    {
-		std::sort(m_Renderers.begin(), m_Renderers.end(), [](Graphics::IRenderer* a, Graphics::IRenderer* b) { return a->GetRenderPriority() > b->GetRenderPriority(); });
+        m_GraphDirty = true;
     }
 }
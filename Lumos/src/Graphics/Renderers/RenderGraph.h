@@ -1,5 +1,6 @@
 #pragma once
 #include "Scene/Scene.h"
+#include "RenderGraphBuilder.h"
 
 namespace Lumos
 {
@@ -25,9 +26,25 @@ namespace Lumos
 		class IRenderer;
 		class Texture;
 		class GBuffer;
+		class TextureAtlas;
+		class GPUProfiler;
+		enum class GBufferLayout;
 		class TextureDepthArray;
 		class ShadowRenderer;
 		class SkyboxRenderer;
+		class VisibilityStage;
+
+		// Resources the renderers read and write, owned outside the graph
+		namespace RenderGraphResources
+		{
+			static constexpr const char* Screen = "Screen";
+			static constexpr const char* Depth = "Depth";
+			static constexpr const char* ShadowMap = "ShadowMap";
+			static constexpr const char* GBufferColour = "GBufferColour";
+			static constexpr const char* GBufferPosition = "GBufferPosition";
+			static constexpr const char* GBufferNormals = "GBufferNormals";
+			static constexpr const char* GBufferPBR = "GBufferPBR";
+		}
 
 		class RenderGraph
 		{
@@ -38,11 +55,8 @@ namespace Lumos
 			void AddRenderer(Graphics::IRenderer* renderer);
             void AddRenderer(Graphics::IRenderer* renderer, int renderPriority);
 
-			void SortRenderers();
-			
 			void Reset();
 			void OnResize(u32 width, u32 height);
-            void BeginScene(Scene* scene);
             void OnNewScene(Scene* scene);
             
             void OnRender(Scene* scene);
@@ -55,6 +69,11 @@ namespace Lumos
 			u32 GetNumShadowMaps() const { return m_NumShadowMaps; };
 			TextureDepthArray* GetShadowTexture() const { return m_ShadowTexture; };
 			GBuffer* GetGBuffer() const { return m_GBuffer; }
+			// Rebuilds the G-buffer and every renderer using it
+			void SetGBufferLayout(GBufferLayout layout);
+			VisibilityStage* GetVisibility() const { return m_Visibility; }
+			TextureAtlas* GetTextureAtlas() const { return m_TextureAtlas; }
+			GPUProfiler* GetGPUProfiler() const { return m_GPUProfiler; }
 			
 			void SetReflectSkyBox(bool reflect) { m_ReflectSkyBox = reflect; }
 			void SetUseShadowMap(bool shadow) { m_UseShadowMap = shadow; }
@@ -85,8 +104,15 @@ namespace Lumos
             bool OnwindowResizeEvent(WindowResizeEvent& e);
             u32 GetCount() const { return (u32)m_Renderers.size(); }
 
+			const RenderGraphBuilder& GetBuilder() const { return m_Builder; }
+
         private:
+			// Rebuilds the pass order from the resources the renderers declare, when renderers or the screen size change
+			void Compile();
+
 			std::vector<Graphics::IRenderer*> m_Renderers;
+			RenderGraphBuilder m_Builder;
+			bool m_GraphDirty = true;
 			
 			bool m_ReflectSkyBox = false;
 			bool m_UseShadowMap = false;
@@ -95,6 +121,9 @@ namespace Lumos
 			Texture* m_ScreenTexture = nullptr;
 			
 			GBuffer* m_GBuffer = nullptr;
+			VisibilityStage* m_Visibility = nullptr;
+			TextureAtlas* m_TextureAtlas = nullptr;
+			GPUProfiler* m_GPUProfiler = nullptr;
 			
 			ShadowRenderer* m_ShadowRenderer = nullptr;
             
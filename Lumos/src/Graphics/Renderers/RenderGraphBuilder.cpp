@@ -0,0 +1,222 @@
+#include "Precompiled.h"
+#include "RenderGraphBuilder.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		u32 RenderGraphBuilder::AddResource(const std::string& name)
+		{
+			auto found = m_ResourceLookup.find(name);
+			if(found != m_ResourceLookup.end())
+				return found->second;
+
+			const u32 index = static_cast<u32>(m_Resources.size());
+			Resource resource;
+			resource.name = name;
+			m_Resources.push_back(resource);
+			m_ResourceLookup[name] = index;
+			return index;
+		}
+
+		u32 RenderGraphBuilder::AddPass(const std::string& name, int priority)
+		{
+			Pass pass;
+			pass.name = name;
+			pass.priority = priority;
+			m_Passes.push_back(pass);
+			return static_cast<u32>(m_Passes.size() - 1);
+		}
+
+		void RenderGraphBuilder::SetPassName(u32 pass, const std::string& name)
+		{
+			m_Passes[pass].name = name;
+		}
+
+		void RenderGraphBuilder::Read(u32 pass, u32 resource)
+		{
+			m_Passes[pass].reads.push_back(resource);
+		}
+
+		void RenderGraphBuilder::Write(u32 pass, u32 resource)
+		{
+			m_Passes[pass].writes.push_back(resource);
+		}
+
+		void RenderGraphBuilder::MarkOutput(u32 resource)
+		{
+			m_Resources[resource].output = true;
+		}
+
+		void RenderGraphBuilder::MarkSideEffect(u32 pass)
+		{
+			m_Passes[pass].sideEffect = true;
+		}
+
+		void RenderGraphBuilder::Clear()
+		{
+			m_Passes.clear();
+			m_Resources.clear();
+			m_ResourceLookup.clear();
+			m_Order.clear();
+		}
+
+		bool RenderGraphBuilder::Compile()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			m_Order.clear();
+			for(auto& pass : m_Passes)
+				pass.culled = false;
+
+			// Writers of each resource in the order their passes run relative to each other
+			std::vector<u32> declared(m_Passes.size());
+			for(u32 i = 0; i < declared.size(); i++)
+				declared[i] = i;
+			std::stable_sort(declared.begin(), declared.end(), [this](u32 a, u32 b) { return m_Passes[a].priority < m_Passes[b].priority; });
+
+			std::vector<std::vector<u32>> writers(m_Resources.size());
+			for(u32 pass : declared)
+			{
+				for(u32 resource : m_Passes[pass].writes)
+					writers[resource].push_back(pass);
+			}
+
+			CullPasses(writers);
+
+			const bool sorted = SortPasses(writers);
+			if(!sorted)
+			{
+				LUMOS_LOG_ERROR("Render graph has a dependency cycle, running every pass in the order it was added");
+				for(auto& pass : m_Passes)
+					pass.culled = false;
+				m_Order = declared;
+			}
+
+			return sorted;
+		}
+
+		void RenderGraphBuilder::CullPasses(const std::vector<std::vector<u32>>& writers)
+		{
+			std::vector<bool> live(m_Passes.size(), false);
+			std::vector<u32> stack;
+
+			for(u32 pass = 0; pass < m_Passes.size(); pass++)
+			{
+				bool root = m_Passes[pass].sideEffect;
+				for(u32 resource : m_Passes[pass].writes)
+					root |= m_Resources[resource].output;
+
+				if(root)
+				{
+					live[pass] = true;
+					stack.push_back(pass);
+				}
+			}
+
+			// Everything writing a resource a live pass reads is live too
+			while(!stack.empty())
+			{
+				const u32 pass = stack.back();
+				stack.pop_back();
+
+				for(u32 resource : m_Passes[pass].reads)
+				{
+					for(u32 writer : writers[resource])
+					{
+						if(!live[writer])
+						{
+							live[writer] = true;
+							stack.push_back(writer);
+						}
+					}
+				}
+			}
+
+			for(u32 pass = 0; pass < m_Passes.size(); pass++)
+				m_Passes[pass].culled = !live[pass];
+		}
+
+		bool RenderGraphBuilder::SortPasses(const std::vector<std::vector<u32>>& writers)
+		{
+			std::vector<std::vector<u32>> edges(m_Passes.size());
+			std::vector<u32> incoming(m_Passes.size(), 0);
+
+			auto addEdge = [&](u32 from, u32 to) {
+				edges[from].push_back(to);
+				incoming[to]++;
+			};
+
+			for(u32 resource = 0; resource < m_Resources.size(); resource++)
+			{
+				// Writers of a resource keep their relative order
+				u32 previous = InvalidIndex;
+				for(u32 writer : writers[resource])
+				{
+					if(m_Passes[writer].culled)
+						continue;
+					if(previous != InvalidIndex)
+						addEdge(previous, writer);
+					previous = writer;
+				}
+			}
+
+			// Readers wait for every writer. A pass that also writes the resource is ordered as a writer instead
+			for(u32 pass = 0; pass < m_Passes.size(); pass++)
+			{
+				if(m_Passes[pass].culled)
+					continue;
+
+				const auto& writes = m_Passes[pass].writes;
+				for(u32 resource : m_Passes[pass].reads)
+				{
+					if(std::find(writes.begin(), writes.end(), resource) != writes.end())
+						continue;
+
+					for(u32 writer : writers[resource])
+					{
+						if(!m_Passes[writer].culled)
+							addEdge(writer, pass);
+					}
+				}
+			}
+
+			std::vector<u32> ready;
+			u32 liveCount = 0;
+			for(u32 pass = 0; pass < m_Passes.size(); pass++)
+			{
+				if(m_Passes[pass].culled)
+					continue;
+				liveCount++;
+				if(incoming[pass] == 0)
+					ready.push_back(pass);
+			}
+
+			// Of the passes that are ready, the one added first runs first so unrelated passes keep their order
+			auto runsFirst = [this](u32 a, u32 b) {
+				return m_Passes[a].priority != m_Passes[b].priority ? m_Passes[a].priority < m_Passes[b].priority : a < b;
+			};
+
+			while(!ready.empty())
+			{
+				auto next = std::min_element(ready.begin(), ready.end(), runsFirst);
+				const u32 pass = *next;
+				ready.erase(next);
+				m_Order.push_back(pass);
+
+				for(u32 dependent : edges[pass])
+				{
+					if(--incoming[dependent] == 0)
+						ready.push_back(dependent);
+				}
+			}
+
+			if(m_Order.size() != liveCount)
+			{
+				m_Order.clear();
+				return false;
+			}
+
+			return true;
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// Describes the passes of a frame and the resources they read and write, and compiles that into an execution order.
+		// A pass runs after every pass writing a resource it reads, and passes writing the same resource keep the order
+		// they were added in (lowest priority first). Passes that nothing live depends on are culled.
+		// Nothing here touches the GPU, layout transitions stay with each pass's renderpass and resources are not aliased
+		class LUMOS_EXPORT RenderGraphBuilder
+		{
+		public:
+			static constexpr u32 InvalidIndex = ~0u;
+
+			// Returns the existing resource when name was already added
+			u32 AddResource(const std::string& name);
+			u32 AddPass(const std::string& name, int priority = 0);
+			void SetPassName(u32 pass, const std::string& name);
+
+			void Read(u32 pass, u32 resource);
+			void Write(u32 pass, u32 resource);
+			// Output resources are consumed outside the graph, so their writers are never culled
+			void MarkOutput(u32 resource);
+			// The pass does work the graph cannot see and is never culled
+			void MarkSideEffect(u32 pass);
+
+			// Returns false when the dependencies form a cycle, every pass then runs in the order it was added
+			bool Compile();
+			void Clear();
+
+			// Passes to run this frame, culled passes are left out
+			const std::vector<u32>& GetOrder() const { return m_Order; }
+			bool IsCulled(u32 pass) const { return m_Passes[pass].culled; }
+
+			u32 GetPassCount() const { return static_cast<u32>(m_Passes.size()); }
+			u32 GetResourceCount() const { return static_cast<u32>(m_Resources.size()); }
+			const std::string& GetPassName(u32 pass) const { return m_Passes[pass].name; }
+			const std::string& GetResourceName(u32 resource) const { return m_Resources[resource].name; }
+
+		private:
+			struct Pass
+			{
+				std::string name;
+				int priority = 0;
+				std::vector<u32> reads;
+				std::vector<u32> writes;
+				bool sideEffect = false;
+				bool culled = false;
+			};
+
+			struct Resource
+			{
+				std::string name;
+				bool output = false;
+			};
+
+			void CullPasses(const std::vector<std::vector<u32>>& writers);
+			bool SortPasses(const std::vector<std::vector<u32>>& writers);
+
+			std::vector<Pass> m_Passes;
+			std::vector<Resource> m_Resources;
+			std::unordered_map<std::string, u32> m_ResourceLookup;
+
+			std::vector<u32> m_Order;
+		};
+	}
+}
@@ -2,7 +2,6 @@
 #include "Renderer2D.h"
 #include "Graphics/API/Shader.h"
 #include "Graphics/API/Framebuffer.h"
-#include "Graphics/API/UniformBuffer.h"
 #include "Graphics/API/Renderer.h"
 #include "Graphics/API/CommandBuffer.h"
 #include "Graphics/API/Swapchain.h"
@@ -13,14 +12,21 @@
 #include "Graphics/GBuffer.h"
 #include "Graphics/Sprite.h"
 #include "Graphics/AnimatedSprite.h"
+#include "Graphics/TextureAtlas.h"
 #include "Scene/Scene.h"
 #include "Core/Application.h"
 #include "RenderGraph.h"
+#include "VisibilityStage.h"
 #include "Platform/OpenGL/GLDescriptorSet.h"
 #include "Graphics/Renderable2D.h"
 #include "Graphics/Camera/Camera.h"
 #include "Maths/Transform.h"
 #include "Core/Engine.h"
+#include "Core/JobSystem.h"
+
+#include <imgui/imgui.h>
+
+#define RENDERER2D_INSTANCE_GROUP_SIZE 256
 
 namespace Lumos
 {
@@ -34,7 +40,6 @@ namespace Lumos
 			, m_TriangleIndicies(triangleIndicies)
 		{
 			m_Limits.SetMaxQuads(10000);
-			m_Limits.MaxQuads = 16; //Renderer::GetCapabilities().MaxTextureUnits;
 
 			Renderer2D::SetScreenBufferSize(width, height);
 			Renderer2D::Init();
@@ -43,7 +48,9 @@ namespace Lumos
 		Renderer2D::~Renderer2D()
 		{
 			delete m_IndexBuffer;
-			delete m_UniformBuffer;
+			delete m_CornerBuffer;
+			delete m_CornerIndexBuffer;
+			delete m_InstanceBuffer;
 
 			delete[] m_VSSystemUniformBuffer;
 			for(u32 i = 0; i < m_Limits.MaxBatchDrawCalls; i++)
@@ -56,7 +63,9 @@ namespace Lumos
 		void Renderer2D::Init()
 		{
 			LUMOS_PROFILE_FUNCTION();
-            m_Shader = Application::Get().GetShaderLibrary()->GetResource("/CoreShaders/Batch2D.shader");
+			m_BindlessTextures = Renderer::GetCapabilities().SupportsBindlessTextures;
+			m_Limits.MaxTextures = m_BindlessTextures ? MAX_BINDLESS_TEXTURES : MAX_BOUND_TEXTURES;
+            m_Shader = Application::Get().GetShaderLibrary()->GetResource(m_BindlessTextures ? "/CoreShaders/Batch2DBindless.shader" : "/CoreShaders/Batch2D.shader");
 
 			m_TransformationStack.emplace_back(Maths::Matrix4());
 			m_TransformationBack = &m_TransformationStack.back();
@@ -64,8 +73,6 @@ namespace Lumos
 			m_VSSystemUniformBufferSize = sizeof(Maths::Matrix4);
 			m_VSSystemUniformBuffer = new u8[m_VSSystemUniformBufferSize];
 
-			m_UniformBuffer = Graphics::UniformBuffer::Create();
-
 			AttachmentInfo textureTypes[2] =
 				{
 					{TextureType::COLOUR, TextureFormat::RGBA8}};
@@ -102,22 +109,8 @@ namespace Lumos
 
 			CreateGraphicsPipeline();
 
-			uint32_t bufferSize = static_cast<uint32_t>(sizeof(Maths::Matrix4));
-			m_UniformBuffer->Init(bufferSize, nullptr);
-
 			std::vector<Graphics::BufferInfo> bufferInfos;
-
-			Graphics::BufferInfo bufferInfo;
-			bufferInfo.buffer = m_UniformBuffer;
-			bufferInfo.offset = 0;
-			bufferInfo.size = bufferSize;
-			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
-			bufferInfo.shaderType = ShaderType::VERTEX;
-			bufferInfo.systemUniforms = false;
-			bufferInfo.name = "UniformBufferObject";
-			bufferInfo.binding = 0;
-
-			bufferInfos.push_back(bufferInfo);
+			bufferInfos.push_back(GetVSSystemUniformBufferInfo());
 
 			m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
 
@@ -125,8 +118,27 @@ namespace Lumos
             info.pipeline = m_Pipeline.get();
 			info.layoutIndex = 1; //?
             info.shader = m_Shader.get();
+			// Rewritten for every batch
+			info.transient = true;
 			m_DescriptorSet = Graphics::DescriptorSet::Create(info);
 
+			m_InstancedShader = Application::Get().GetShaderLibrary()->GetResource(m_BindlessTextures ? "/CoreShaders/Batch2DInstancedBindless.shader" : "/CoreShaders/Batch2DInstanced.shader");
+			CreateInstancedPipeline();
+			m_InstancedPipeline->GetDescriptorSet()->Update(bufferInfos);
+
+			// OpenGL sets belong to a shader, so the instanced pipeline gets its own texture set
+			info.pipeline = m_InstancedPipeline.get();
+			info.shader = m_InstancedShader.get();
+			m_InstancedDescriptorSet = Graphics::DescriptorSet::Create(info);
+
+			// Every instanced sprite draws the same unit quad
+			const Maths::Vector2 corners[4] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+			m_CornerBuffer = Graphics::VertexBuffer::Create(BufferUsage::STATIC);
+			m_CornerBuffer->SetData(sizeof(corners), corners);
+
+			u32 cornerIndices[6] = { 0, 1, 2, 2, 3, 0 };
+			m_CornerIndexBuffer = IndexBuffer::Create(cornerIndices, 6);
+
 			m_VertexBuffers.resize(m_Limits.MaxBatchDrawCalls);
 
 			for(auto& vertexBuffer : m_VertexBuffers)
@@ -181,12 +193,22 @@ namespace Lumos
 			const Maths::Vector2 max = renderable->GetPosition() + renderable->GetScale();
 
 			const Maths::Vector4 colour = renderable->GetColour();
-			const auto& uv = renderable->GetUVs();
-			const Texture* texture = renderable->GetTexture();
+			std::array<Maths::Vector2, 4> uv = renderable->GetUVs();
+			Texture* texture = renderable->GetTexture();
+
+			// Sprites packed in the atlas sample their part of a page instead
+			TextureAtlas::Region region;
+			auto atlas = Application::Get().GetRenderGraph()->GetTextureAtlas();
+			if(texture && atlas->Find(renderable->GetTexture(), region))
+			{
+				for(auto& coord : uv)
+					coord = region.uvMin + coord * (region.uvMax - region.uvMin);
+				texture = atlas->GetPage(region.page);
+			}
 
 			float textureSlot = 0.0f;
 			if(texture)
-				textureSlot = SubmitTexture(renderable->GetTexture());
+				textureSlot = SubmitTexture(texture);
 
 			Maths::Vector3 vertex = transform * Maths::Vector3(min.x, min.y, 0.0f);
 			m_Buffer->vertex = vertex;
@@ -291,16 +313,17 @@ namespace Lumos
 			m_Buffer = m_VertexBuffers[m_BatchDrawCallIndex]->GetPointer<VertexData>();
 		}
 
-		void Renderer2D::SetSystemUniforms(Shader* shader) const
+		void Renderer2D::SetSystemUniforms(Shader* shader)
 		{
 			LUMOS_PROFILE_FUNCTION();
-            m_UniformBuffer->SetData(sizeof(Maths::Matrix4), *&m_VSSystemUniformBuffer);
+			PushVSSystemUniforms();
 		}
 
 		void Renderer2D::BeginScene(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform)
 		{
 			LUMOS_PROFILE_FUNCTION();
 			auto& registry = scene->GetRegistry();
+			m_VisibilityView = VisibilityStage::InvalidView;
 
 			if(overrideCamera)
 			{
@@ -326,6 +349,19 @@ namespace Lumos
 			memcpy(m_VSSystemUniformBuffer, &projView, sizeof(Maths::Matrix4));
 
 			m_Frustum = m_Camera->GetFrustum(view);
+
+			auto visibility = Application::Get().GetRenderGraph()->GetVisibility();
+			if(m_Camera->IsOrthographic())
+			{
+				// Sprites are flat, so what an orthographic camera sees of them is the xy extent of its frustum
+				Maths::Rect bounds;
+				for(auto& vertex : m_Frustum.vertices_)
+					bounds.Merge(Maths::Vector2(vertex.x, vertex.y));
+
+				m_VisibilityView = visibility->AddView(bounds);
+			}
+			else
+				m_VisibilityView = visibility->AddView(m_Frustum, VisibilityType::Sprite);
 		}
 
 		void Renderer2D::Present()
@@ -334,7 +370,8 @@ namespace Lumos
             if(m_IndexCount == 0)
             {
                 m_VertexBuffers[m_BatchDrawCallIndex]->ReleasePointer();
-                m_Empty = true;
+                // Earlier batches of the frame still have to be presented
+                m_Empty = m_BatchDrawCallIndex == 0;
                 return;
             }
 
@@ -354,6 +391,8 @@ namespace Lumos
 
             m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
             m_CurrentDescriptorSets[1] = m_DescriptorSet.get();
+			// Pipelines are shared, so the offset is set again before every bind
+			m_CurrentDescriptorSets[0]->SetDynamicOffset(m_VSSystemUniformOffset);
 
 			m_VertexBuffers[m_BatchDrawCallIndex]->Bind(currentCMDBuffer, m_Pipeline.get());
 			m_IndexBuffer->Bind(currentCMDBuffer);
@@ -393,45 +432,208 @@ namespace Lumos
 
 			SetSystemUniforms(m_Shader.get());
 
-			auto& registry = scene->GetRegistry();
-			auto group = registry.group<Graphics::Sprite>(entt::get<Maths::Transform>);
-			for(auto entity : group)
+			auto visibility = Application::Get().GetRenderGraph()->GetVisibility();
+			auto atlas = Application::Get().GetRenderGraph()->GetTextureAtlas();
+			const auto& visible = visibility->GetVisible(m_VisibilityView);
+
+			// Back to front so blending holds, then by texture so a batch only flushes once it has seen MaxTextures distinct textures
+			m_SortedSprites.clear();
+			m_SortedSprites.reserve(visible.size());
+			for(u32 index : visible)
 			{
-				const auto& [sprite, trans] = group.get<Graphics::Sprite, Maths::Transform>(entity);
+				Renderable2D* sprite = visibility->GetSprite(index);
+
+				SpriteSortKey key;
+				key.depth = visibility->GetTransform(index).Translation().z;
+				key.texture = sprite->GetTexture();
+				key.index = index;
+				key.uvOffset = Maths::Vector2(0.0f, 0.0f);
+				key.uvScale = Maths::Vector2(1.0f, 1.0f);
+				key.textureSlot = 0.0f;
+
+				// Sorted by the texture that is actually bound, atlased sprites share their page
+				TextureAtlas::Region region;
+				if(key.texture && atlas->Find(sprite->GetTexture(), region))
+				{
+					key.texture = atlas->GetPage(region.page);
+					key.uvOffset = region.uvMin;
+					key.uvScale = region.uvMax - region.uvMin;
+				}
 
-				auto bb = Maths::BoundingBox(Maths::Rect(sprite.GetPosition(), sprite.GetPosition() + sprite.GetScale()));
-				bb.Transform(trans.GetWorldMatrix());
-				auto inside = m_Frustum.IsInside(bb);
+				m_SortedSprites.push_back(key);
+			}
 
-				if(inside == Maths::Intersection::OUTSIDE)
-					continue;
+			// Sprites at the same depth can overlap, so they keep registry order. A batch binds up to
+			// m_Limits.MaxTextures textures, which keeps interleaved textures in the same draw
+			std::stable_sort(m_SortedSprites.begin(), m_SortedSprites.end(), [](const SpriteSortKey& a, const SpriteSortKey& b) {
+				return a.depth < b.depth;
+			});
 
-				Submit(&sprite, trans.GetWorldMatrix());
-			};
-			
-			auto group2 = registry.group<Graphics::AnimatedSprite>(entt::get<Maths::Transform>);
-			for(auto entity : group2)
+			if(m_Instanced)
 			{
-				const auto& [sprite, trans] = group2.get<Graphics::AnimatedSprite, Maths::Transform>(entity);
-				
-				auto bb = Maths::BoundingBox(Maths::Rect(sprite.GetPosition(), sprite.GetPosition() + sprite.GetScale()));
-				bb.Transform(trans.GetWorldMatrix());
-				auto inside = m_Frustum.IsInside(bb);
-				
-				if(inside == Maths::Intersection::OUTSIDE)
-					continue;
-				
-				Submit(&sprite, trans.GetWorldMatrix());
-			};
+				// Nothing is written to the mapped vertex buffer, and OpenGL has to unmap it before another buffer is bound
+				m_VertexBuffers[m_BatchDrawCallIndex]->ReleasePointer();
+				PresentInstanced(visibility);
+			}
+			else
+			{
+				for(auto& sprite : m_SortedSprites)
+				{
+					Submit(visibility->GetSprite(sprite.index), visibility->GetTransform(sprite.index));
+				}
+			}
+
+			// Views are only valid for the frame they were added in
+			m_VisibilityView = VisibilityStage::InvalidView;
 
 			Present();
 
 			End();
 		}
 
+		void Renderer2D::PresentInstanced(VisibilityStage* visibility)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			const u32 count = static_cast<u32>(m_SortedSprites.size());
+			if(count == 0)
+				return;
+
+			// Texture slots and batch boundaries depend on the sprites before, a batch ends once it has seen MaxTextures distinct textures
+			m_SpriteBatches.clear();
+			m_BatchTextures.clear();
+			m_SpriteBatches.push_back({ 0, 0, 0, 0 });
+
+			for(u32 i = 0; i < count; i++)
+			{
+				SpriteSortKey& sprite = m_SortedSprites[i];
+				SpriteBatch* batch = &m_SpriteBatches.back();
+
+				if(sprite.texture)
+				{
+					const Texture* const* textures = m_BatchTextures.data() + batch->firstTexture;
+					u32 slot = batch->textureCount;
+
+					// Sorted by texture, so a repeat is nearly always the last texture added
+					if(slot > 0 && textures[slot - 1] == sprite.texture)
+						slot--;
+					else
+					{
+						for(u32 t = 0; t < batch->textureCount; t++)
+						{
+							if(textures[t] == sprite.texture)
+							{
+								slot = t;
+								break;
+							}
+						}
+					}
+
+					if(slot == batch->textureCount)
+					{
+						if(batch->textureCount >= m_Limits.MaxTextures)
+						{
+							m_SpriteBatches.push_back({ i, 0, static_cast<u32>(m_BatchTextures.size()), 0 });
+							batch = &m_SpriteBatches.back();
+							slot = 0;
+						}
+
+						m_BatchTextures.push_back(sprite.texture);
+						batch->textureCount++;
+					}
+
+					sprite.textureSlot = static_cast<float>(slot + 1);
+				}
+
+				batch->instanceCount++;
+			}
+
+			// Each sprite only reads its own key, so the records are filled in parallel
+			m_Instances.resize(count);
+			{
+				LUMOS_PROFILE_SCOPE("Fill Sprite Instances");
+				System::JobSystem::Context ctx;
+				System::JobSystem::Dispatch(ctx, count, RENDERER2D_INSTANCE_GROUP_SIZE, [&](JobDispatchArgs args) {
+					const SpriteSortKey& sprite = m_SortedSprites[args.jobIndex];
+					const Renderable2D* renderable = visibility->GetSprite(sprite.index);
+					const Maths::Matrix4& transform = visibility->GetTransform(sprite.index);
+					const Maths::Vector2 position = renderable->GetPosition();
+					const Maths::Vector2 scale = renderable->GetScale();
+
+					// Position and scale are folded into the transform, so the shader maps the unit quad straight to world space.
+					// Depth is taken at the sprite origin
+					SpriteInstance& instance = m_Instances[args.jobIndex];
+					instance.row0 = Maths::Vector4(transform.m00_ * scale.x, transform.m01_ * scale.y,
+						transform.m00_ * position.x + transform.m01_ * position.y + transform.m03_,
+						transform.m20_ * position.x + transform.m21_ * position.y + transform.m23_);
+					instance.row1 = Maths::Vector4(transform.m10_ * scale.x, transform.m11_ * scale.y,
+						transform.m10_ * position.x + transform.m11_ * position.y + transform.m13_,
+						sprite.textureSlot);
+
+					const auto& uv = renderable->GetUVs();
+					const Maths::Vector2 uvMin = sprite.uvOffset + uv[0] * sprite.uvScale;
+					const Maths::Vector2 uvMax = sprite.uvOffset + uv[2] * sprite.uvScale;
+					instance.uvRect = Maths::Vector4(uvMin.x, uvMin.y, uvMax.x, uvMax.y);
+					instance.colour = renderable->GetColour();
+				});
+
+				System::JobSystem::Wait(ctx);
+			}
+
+			if(!m_InstanceBuffer || count > m_InstanceCapacity)
+			{
+				// Recreate rather than resize so the old allocation is released
+				delete m_InstanceBuffer;
+				m_InstanceCapacity = Maths::Max(count + count / 2, 1024u);
+				m_InstanceBuffer = VertexBuffer::Create(BufferUsage::DYNAMIC);
+				m_InstanceBuffer->Resize(m_InstanceCapacity * sizeof(SpriteInstance));
+			}
+
+			m_InstanceBuffer->SetDataSub(count * sizeof(SpriteInstance), m_Instances.data(), 0);
+
+			Graphics::CommandBuffer* currentCMDBuffer = m_SecondaryCommandBuffers[m_BatchDrawCallIndex];
+
+			currentCMDBuffer->BeginRecordingSecondary(m_RenderPass.get(), m_Framebuffers[m_CurrentBufferID].get());
+			currentCMDBuffer->UpdateViewport(m_ScreenBufferWidth, m_ScreenBufferHeight);
+			m_InstancedPipeline->Bind(currentCMDBuffer);
+
+			m_CornerBuffer->Bind(currentCMDBuffer, m_InstancedPipeline.get());
+			m_CornerIndexBuffer->Bind(currentCMDBuffer);
+
+			m_CurrentDescriptorSets[0] = m_InstancedPipeline->GetDescriptorSet();
+			m_CurrentDescriptorSets[1] = m_InstancedDescriptorSet.get();
+			m_CurrentDescriptorSets[0]->SetDynamicOffset(m_VSSystemUniformOffset);
+
+			for(auto& batch : m_SpriteBatches)
+			{
+				// A batch without textures keeps the previous set, its sprites never sample it
+				m_TextureCount = batch.textureCount;
+				for(u32 i = 0; i < batch.textureCount; i++)
+					m_Textures[i] = m_BatchTextures[batch.firstTexture + i];
+				UpdateDesciptorSet(m_InstancedDescriptorSet.get());
+
+				m_InstanceBuffer->BindInstances(currentCMDBuffer, m_InstancedPipeline.get(), batch.firstInstance * sizeof(SpriteInstance));
+				Renderer::BindDescriptorSets(m_InstancedPipeline.get(), currentCMDBuffer, 0, m_CurrentDescriptorSets);
+				Renderer::DrawIndexedInstanced(currentCMDBuffer, DrawType::TRIANGLE, 6, batch.instanceCount);
+			}
+
+			m_CornerBuffer->Unbind();
+			m_CornerIndexBuffer->Unbind();
+			m_TextureCount = 0;
+
+			currentCMDBuffer->EndRecording();
+			currentCMDBuffer->ExecuteSecondary(m_CommandBuffers[m_CurrentBufferID].get());
+
+			m_BatchDrawCallIndex++;
+			Engine::Get().Statistics().NumRenderedObjects += count;
+		}
+
 		float Renderer2D::SubmitTexture(Texture* texture)
 		{
 			LUMOS_PROFILE_FUNCTION();
+			// Sprites arrive sorted by texture, so a repeat is nearly always the last texture added
+			if(m_TextureCount > 0 && m_Textures[m_TextureCount - 1] == texture)
+				return static_cast<float>(m_TextureCount);
+
 			float result = 0.0f;
 			bool found = false;
 			for(u32 i = 0; i < m_TextureCount; i++)
@@ -457,6 +659,22 @@ namespace Lumos
 			return result;
 		}
 
+		void Renderer2D::DeclareResources(RenderGraphBuilder& builder, u32 pass)
+		{
+			builder.SetPassName(pass, "2D");
+			if(m_RenderToDepthTexture)
+				builder.Write(pass, builder.AddResource(RenderGraphResources::Depth));
+			builder.Write(pass, builder.AddResource(RenderGraphResources::Screen));
+		}
+
+		void Renderer2D::OnImGui()
+		{
+			ImGui::TextUnformatted("Renderer 2D");
+			ImGui::Checkbox("Instanced Sprites", &m_Instanced);
+			if(m_Instanced)
+				ImGui::Text("Sprite Batches %u, Instance Capacity %u", static_cast<u32>(m_SpriteBatches.size()), m_InstanceCapacity);
+		}
+
 		void Renderer2D::OnResize(u32 width, u32 height)
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -511,6 +729,31 @@ namespace Lumos
 			m_Pipeline = Graphics::Pipeline::Get(pipelineCreateInfo);
 		}
 
+		void Renderer2D::CreateInstancedPipeline()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			Graphics::BufferLayout vertexBufferLayout;
+			vertexBufferLayout.Push<Maths::Vector2>("corner");
+
+			Graphics::BufferLayout instanceBufferLayout;
+			instanceBufferLayout.Push<Maths::Vector4>("instanceRow0");
+			instanceBufferLayout.Push<Maths::Vector4>("instanceRow1");
+			instanceBufferLayout.Push<Maths::Vector4>("instanceUV");
+			instanceBufferLayout.Push<Maths::Vector4>("instanceColour");
+
+			Graphics::PipelineInfo pipelineCreateInfo;
+			pipelineCreateInfo.shader = m_InstancedShader;
+			pipelineCreateInfo.renderpass = m_RenderPass;
+			pipelineCreateInfo.vertexBufferLayout = vertexBufferLayout;
+			pipelineCreateInfo.instanceBufferLayout = instanceBufferLayout;
+			pipelineCreateInfo.polygonMode = Graphics::PolygonMode::FILL;
+			pipelineCreateInfo.cullMode = Graphics::CullMode::BACK;
+			pipelineCreateInfo.transparencyEnabled = true;
+			pipelineCreateInfo.depthBiasEnabled = false;
+
+			m_InstancedPipeline = Graphics::Pipeline::Get(pipelineCreateInfo);
+		}
+
 		void Renderer2D::CreateFramebuffers()
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -552,6 +795,11 @@ namespace Lumos
 		}
 
 		void Renderer2D::UpdateDesciptorSet()
+		{
+			UpdateDesciptorSet(m_DescriptorSet.get());
+		}
+
+		void Renderer2D::UpdateDesciptorSet(DescriptorSet* descriptorSet)
 		{
 			LUMOS_PROFILE_FUNCTION();
 			if(m_TextureCount == 0)
@@ -562,15 +810,26 @@ namespace Lumos
 
 			imageInfo.binding = 0;
 			imageInfo.name = "textures";
-            if(m_TextureCount > 1)
+            if(m_BindlessTextures)
+            {
+                // Every element of the array is written, the unused ones repeat the first texture
+                for(u32 i = m_TextureCount; i < MAX_BINDLESS_TEXTURES; i++)
+                    m_Textures[i] = m_Textures[0];
                 imageInfo.textures = m_Textures;
+                imageInfo.count = MAX_BINDLESS_TEXTURES;
+            }
             else
-                imageInfo.texture = m_Textures[0];
-			imageInfo.count = m_TextureCount;
+            {
+                if(m_TextureCount > 1)
+                    imageInfo.textures = m_Textures;
+                else
+                    imageInfo.texture = m_Textures[0];
+                imageInfo.count = m_TextureCount;
+            }
 
 			imageInfos.push_back(imageInfo);
 
-			m_DescriptorSet->Update(imageInfos);
+			descriptorSet->Update(imageInfos);
 		}
 
 		void Renderer2D::SetRenderTarget(Texture* texture, bool rebuildFramebuffer)
@@ -6,6 +6,8 @@
 #include "Maths/Transform.h"
 
 #define MAX_BOUND_TEXTURES 16
+// Textures one batch can reference when the device can index sampler arrays freely
+#define MAX_BINDLESS_TEXTURES 256
 
 namespace Lumos
 {
@@ -18,13 +20,13 @@ namespace Lumos
 		class Pipeline;
 		class DescriptorSet;
 		class CommandBuffer;
-		class UniformBuffer;
 		class Renderable2D;
 		class Framebuffer;
 		class Texture;
 		class Shader;
 		class IndexBuffer;
 		class VertexBuffer;
+		class VisibilityStage;
 
 		struct TriangleInfo
 		{
@@ -59,6 +61,17 @@ namespace Lumos
 			}
 		};
 
+		// Per sprite record of the instanced path, expanded to a quad by Batch2DInstanced.vert
+		struct SpriteInstance
+		{
+			// 2x3 sprite to world transform, position and scale folded in. row0.w is the world z, row1.w the texture slot
+			Maths::Vector4 row0;
+			Maths::Vector4 row1;
+			// Texture coordinates at the quad corners (0, 0) and (1, 1)
+			Maths::Vector4 uvRect;
+			Maths::Vector4 colour;
+		};
+
 		class LUMOS_EXPORT Renderer2D : public IRenderer
 		{
 		public:
@@ -75,6 +88,8 @@ namespace Lumos
 			virtual void SetScreenBufferSize(u32 width, u32 height) override;
 			virtual void SetRenderTarget(Texture* texture, bool rebuildFrameBuffer = true) override;
 			virtual void RenderScene(Scene* scene) override;
+			virtual void DeclareResources(RenderGraphBuilder& builder, u32 pass) override;
+			virtual void OnImGui() override;
 
 			virtual void SubmitTriangle(const Maths::Vector3& p1, const Maths::Vector3& p2, const Maths::Vector3& p3, const Maths::Vector4& colour);
 			virtual void Submit(Renderable2D* renderable, const Maths::Matrix4& transform);
@@ -84,19 +99,43 @@ namespace Lumos
 
 			float SubmitTexture(Texture* texture);
 
-			void SetSystemUniforms(Shader* shader) const;
+			void SetSystemUniforms(Shader* shader);
 
 			void CreateGraphicsPipeline();
+			void CreateInstancedPipeline();
 			void CreateFramebuffers();
 			void UpdateDesciptorSet();
+			void UpdateDesciptorSet(DescriptorSet* descriptorSet);
 
 			void FlushAndReset();
 			void SubmitTriangles();
 
 		private:
 			void SubmitInternal(const TriangleInfo& triangle);
+			void PresentInstanced(VisibilityStage* visibility);
+
+			struct SpriteSortKey
+			{
+				float depth;
+				Texture* texture;
+				u32 index;
+				// Atlas remap applied to the sprite's uvs, identity when it is not in the atlas
+				Maths::Vector2 uvOffset;
+				Maths::Vector2 uvScale;
+				float textureSlot;
+			};
+
+			// Consecutive sorted sprites drawn with one instanced draw, their textures are in m_BatchTextures
+			struct SpriteBatch
+			{
+				u32 firstInstance;
+				u32 instanceCount;
+				u32 firstTexture;
+				u32 textureCount;
+			};
 
 			std::vector<Renderable2D*> m_Sprites;
+			std::vector<SpriteSortKey> m_SortedSprites;
 			std::vector<CommandBuffer*> m_SecondaryCommandBuffers;
 			std::vector<VertexBuffer*> m_VertexBuffers;
 
@@ -105,21 +144,35 @@ namespace Lumos
 
 			Render2DLimits m_Limits;
 
-			UniformBuffer* m_UniformBuffer = nullptr;
 			IndexBuffer* m_IndexBuffer = nullptr;
 			VertexData* m_Buffer = nullptr;
 
 			std::vector<Maths::Matrix4> m_TransformationStack;
 			const Maths::Matrix4* m_TransformationBack{};
 
-			Texture* m_Textures[MAX_BOUND_TEXTURES];
+			Texture* m_Textures[MAX_BINDLESS_TEXTURES];
             u32 m_TextureCount;
+			bool m_BindlessTextures = false;
 
 			u32 m_CurrentBufferID = 0;
+			u32 m_VisibilityView = ~0u;
 			Maths::Vector3 m_QuadPositions[4];
 
 			std::vector<TriangleInfo> m_Triangles;
 
+			// Instanced path, used by RenderScene. Submit and SubmitTriangle keep writing vertices
+			bool m_Instanced = true;
+			Ref<Shader> m_InstancedShader;
+			Ref<Pipeline> m_InstancedPipeline;
+			Ref<DescriptorSet> m_InstancedDescriptorSet;
+			VertexBuffer* m_CornerBuffer = nullptr;
+			IndexBuffer* m_CornerIndexBuffer = nullptr;
+			VertexBuffer* m_InstanceBuffer = nullptr;
+			u32 m_InstanceCapacity = 0;
+			std::vector<SpriteInstance> m_Instances;
+			std::vector<SpriteBatch> m_SpriteBatches;
+			std::vector<Texture*> m_BatchTextures;
+
 			bool m_Clear = false;
 			bool m_RenderToDepthTexture;
             bool m_Empty = false;
@@ -7,7 +7,6 @@
 #include "Graphics/API/CommandBuffer.h"
 #include "Graphics/API/RenderPass.h"
 #include "Graphics/API/Pipeline.h"
-#include "Graphics/API/UniformBuffer.h"
 #include "Graphics/API/GraphicsContext.h"
 #include "Graphics/API/Shader.h"
 
@@ -19,11 +18,13 @@
 #include "Scene/Scene.h"
 #include "Maths/Maths.h"
 #include "RenderCommand.h"
+#include "RenderGraph.h"
+#include "VisibilityStage.h"
 #include "Core/Application.h"
 
 #include <imgui/imgui.h>
 
-//#define THREAD_CASCADE_GEN
+#define THREAD_CASCADE_GEN
 #ifdef THREAD_CASCADE_GEN
 #	include "Core/JobSystem.h"
 #endif
@@ -38,12 +39,13 @@ namespace Lumos
 			VSSystemUniformIndex_Size
 		};
 
+		static_assert(SHADOWMAP_MAX <= Engine::MaxShadowCascades, "Engine::Stats has a shadow draw count per cascade");
+
 		ShadowRenderer::ShadowRenderer(TextureDepthArray* texture, u32 shadowMapSize, u32 numMaps)
 			: m_ShadowTex(nullptr)
 			, m_ShadowMapNum(numMaps)
 			, m_ShadowMapSize(shadowMapSize)
 			, m_ShadowMapsInvalidated(true)
-			, m_UniformBuffer(nullptr)
             , m_CascadeSplitLambda(0.95f)
             , m_SceneRadiusMultiplier(1.4f)
 		{
@@ -72,7 +74,6 @@ namespace Lumos
             
             m_PushConstants.clear();
 
-			delete m_UniformBuffer;
 			delete m_CommandBuffer;
 		}
 
@@ -85,8 +86,8 @@ namespace Lumos
 			m_VSSystemUniformBufferOffsets.resize(VSSystemUniformIndex_Size);
 
 			auto pushConstant = Graphics::PushConstant();
-            pushConstant.size = sizeof(i32) + sizeof(Lumos::Maths::Matrix4);
-            pushConstant.data = new u8[sizeof(i32) + sizeof(Lumos::Maths::Matrix4)];
+            pushConstant.size = sizeof(u32);
+            pushConstant.data = new u8[sizeof(u32)];
             pushConstant.shaderStage = ShaderType::VERTEX;
             
             m_PushConstants.push_back(pushConstant);
@@ -172,6 +173,18 @@ namespace Lumos
             }
             
 			UpdateCascades(scene, overrideCamera, overrideCameraTransform, light);
+
+            auto visibility = Application::Get().GetRenderGraph()->GetVisibility();
+            for(u32 i = 0; i < SHADOWMAP_MAX; ++i)
+            {
+                m_CascadeViews[i] = VisibilityStage::InvalidView;
+                if(i >= m_ShadowMapNum)
+                    continue;
+
+                Maths::Frustum f;
+                f.Define(m_ShadowProjView[i]);
+                m_CascadeViews[i] = visibility->AddView(f, VisibilityType::Mesh);
+            }
             
             m_ShouldRender = true;
 		}
@@ -190,39 +203,37 @@ namespace Lumos
 		void ShadowRenderer::Present()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			int index = 0;
 
 			m_RenderPass->BeginRenderpass(m_CommandBuffer, Maths::Vector4(0.0f), m_ShadowFramebuffer[m_Layer].get(), Graphics::INLINE, m_ShadowMapSize, m_ShadowMapSize, false);
 
-			m_Pipeline->Bind(m_CommandBuffer);
+			m_BindState.Reset(m_CommandBuffer);
+			m_BindState.BindPipeline(m_Pipeline.get());
 
-			for(auto& command : m_CommandQueue)
-			{
-				Engine::Get().Statistics().NumShadowObjects++;
-				
-				Mesh* mesh = command.mesh;
+			m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
+			m_CurrentDescriptorSets[0]->SetDynamicOffset(m_VSSystemUniformOffset);
 
-                m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
+			u32 layer = static_cast<u32>(m_Layer);
+			memcpy(m_PushConstants[0].data, &layer, sizeof(u32));
+			m_CurrentDescriptorSets[0]->SetPushConstants(m_PushConstants);
 
-				mesh->GetVertexBuffer()->Bind(m_CommandBuffer, m_Pipeline.get());
-				mesh->GetIndexBuffer()->Bind(m_CommandBuffer);
-                
-                u32 layer = static_cast<u32>(m_Layer);
-                auto trans = command.transform;
-                memcpy(m_PushConstants[0].data, &trans, sizeof(Maths::Matrix4));
-                memcpy(m_PushConstants[0].data + sizeof(Maths::Matrix4), &layer, sizeof(u32));
+			auto& stats = Engine::Get().Statistics();
+			for(auto& batch : m_CascadeBatches[m_Layer])
+			{
+				stats.NumShadowObjects += batch.instanceCount;
+				stats.NumShadowCascadeObjects[m_Layer] += batch.instanceCount;
+				stats.NumShadowCascadeDrawCalls[m_Layer]++;
 
-                m_CurrentDescriptorSets[0]->SetPushConstants(m_PushConstants);
-                
-				Renderer::BindDescriptorSets(m_Pipeline.get(), m_CommandBuffer, 0, m_CurrentDescriptorSets);
-				Renderer::DrawIndexed(m_CommandBuffer, DrawType::TRIANGLE, mesh->GetIndexBuffer()->GetCount());
+				Mesh* mesh = batch.mesh;
 
-				mesh->GetVertexBuffer()->Unbind();
-				mesh->GetIndexBuffer()->Unbind();
+				m_BindState.BindMesh(mesh);
+				m_BindState.BindDescriptorSets(m_CurrentDescriptorSets[0], m_CurrentDescriptorSets, m_PushConstants);
+				m_InstanceBuffer.Bind(m_CommandBuffer, m_Pipeline.get(), batch.firstInstance);
 
-				index++;
+				m_BindState.DrawIndexedInstanced(mesh->GetIndexBuffer()->GetCount(), batch.instanceCount);
 			}
 
+			m_BindState.End();
+
 			m_RenderPass->EndRenderpass(m_CommandBuffer, false);
             //m_CommandBuffer->Execute(true);
 		}
@@ -234,6 +245,7 @@ namespace Lumos
 			{
 				m_ShadowMapNum = num;
 				m_ShadowMapsInvalidated = true;
+				InvalidateCascadeCache();
 			}
 		}
 
@@ -243,9 +255,18 @@ namespace Lumos
 			if(!m_ShadowMapsInvalidated)
 				m_ShadowMapsInvalidated = (size != m_ShadowMapSize);
 
+			if(m_ShadowMapsInvalidated)
+				InvalidateCascadeCache();
+
 			m_ShadowMapSize = size;
 		}
 
+		void ShadowRenderer::InvalidateCascadeCache()
+		{
+			for(u32 i = 0; i < SHADOWMAP_MAX; ++i)
+				m_CascadeCacheValid[i] = false;
+		}
+
 		void ShadowRenderer::RenderScene(Scene* scene)
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -255,52 +276,100 @@ namespace Lumos
 
 			memcpy(m_VSSystemUniformBuffer + m_VSSystemUniformBufferOffsets[VSSystemUniformIndex_ProjectionViewMatrix], m_ShadowProjView, sizeof(Maths::Matrix4) * SHADOWMAP_MAX);
 
-			Begin();
-
-			auto& registry = scene->GetRegistry();
+			// Cascades only read their own view and queue, so they can be gathered and sorted in parallel
+#ifdef THREAD_CASCADE_GEN
+			System::JobSystem::Context ctx;
+			System::JobSystem::Dispatch(ctx, m_ShadowMapNum, 1, [&](JobDispatchArgs args) {
+				GatherCascade(args.jobIndex);
+			});
+			System::JobSystem::Wait(ctx);
+#else
+			for(u32 i = 0; i < m_ShadowMapNum; ++i)
+				GatherCascade(i);
+#endif
 
-			auto group = registry.group<Model>(entt::get<Maths::Transform>);
+			auto& stats = Engine::Get().Statistics();
+			stats.NumShadowCascades = m_ShadowMapNum;
 
+			// Batch every redrawn cascade first so all instance transforms are uploaded before recording
+			bool anyDirty = false;
+			m_InstanceTransforms.clear();
 			for(u32 i = 0; i < m_ShadowMapNum; ++i)
 			{
-				LUMOS_PROFILE_SCOPE("ShadowRenderer::RenderScene Per Shadow Map");
-				m_Layer = i;
-
-				Maths::Frustum f;
-				f.Define(m_ShadowProjView[i]);
-				
-				if(group.empty())
-					continue;
-				
-				for(auto entity : group)
+				m_CascadeBatches[i].clear();
+				if(!m_CascadeDirty[i])
 				{
-					const auto& [model, trans] = group.get<Model, Maths::Transform>(entity);
-                    const auto& meshes = model.GetMeshes();
-                                   
-                   for(auto mesh : meshes)
-                   {
-                        if(mesh->GetActive())
-                        {
-                            auto& worldTransform = trans.GetWorldMatrix();
-
-                            auto bb = mesh->GetBoundingBox();
-                            auto bbCopy = bb->Transformed(worldTransform);
-                            auto inside = f.IsInsideFast(bbCopy);
-
-                            if(inside == Maths::Intersection::OUTSIDE)
-                                continue;
-
-                            SubmitMesh(mesh.get(), nullptr, worldTransform, Maths::Matrix4());
-                        }
-                   }
+					stats.NumShadowCascadesCached++;
+					continue;
 				}
 
-				SetSystemUniforms(m_Shader.get());
+				anyDirty = true;
+				BuildInstanceBatches(m_CascadeQueues[i], m_CascadeBatches[i], m_InstanceTransforms);
+			}
+
+			if(!anyDirty)
+				return;
+
+			SetSystemUniforms(m_Shader.get());
+			m_InstanceBuffer.Upload(m_InstanceTransforms);
+
+			Begin();
+
+			for(u32 i = 0; i < m_ShadowMapNum; ++i)
+			{
+				if(!m_CascadeDirty[i])
+					continue;
 
+				m_Layer = i;
 				Present();
+
+				m_CachedProjView[i] = m_ShadowProjView[i];
+				m_CachedCasterHash[i] = m_CascadeCasterHash[i];
+				m_CascadeCacheValid[i] = true;
 			}
+
 			End();
 		}
+
+		void ShadowRenderer::GatherCascade(u32 cascade)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			auto visibility = Application::Get().GetRenderGraph()->GetVisibility();
+			const auto& visible = visibility->GetVisible(m_CascadeViews[cascade]);
+
+			// Hash the casters so one entering, leaving or changing mesh is noticed, even when nothing moved
+			u64 hash = 14695981039346656037ull;
+			bool moved = false;
+			for(u32 index : visible)
+			{
+				hash = (hash ^ static_cast<u64>(entt::to_integral(visibility->GetEntity(index)))) * 1099511628211ull;
+				hash = (hash ^ static_cast<u64>(reinterpret_cast<uintptr_t>(visibility->GetMesh(index)))) * 1099511628211ull;
+				moved |= visibility->HasMoved(index);
+			}
+
+			m_CascadeCasterHash[cascade] = hash;
+			m_CascadeDirty[cascade] = !m_CacheCascades || !m_CascadeCacheValid[cascade] || moved
+				|| hash != m_CachedCasterHash[cascade] || m_ShadowProjView[cascade] != m_CachedProjView[cascade];
+
+			CommandQueue& queue = m_CascadeQueues[cascade];
+			queue.clear();
+
+			if(!m_CascadeDirty[cascade])
+				return;
+
+			for(u32 index : visible)
+			{
+				RenderCommand command;
+				command.mesh = visibility->GetMesh(index);
+				command.transform = visibility->GetTransform(index);
+				command.material = nullptr;
+				// Depth only pass, group by mesh so vertex and index buffers are bound once per mesh
+				command.sortKey = RenderSortKey::Make(0, m_Pipeline.get(), nullptr, command.mesh, 0.0f);
+				queue.push_back(command);
+			}
+
+			SortCommandQueue(queue);
+		}
     
 		void ShadowRenderer::UpdateCascades(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform, Light* light)
 		{
@@ -315,6 +384,11 @@ namespace Lumos
 			float maxZ = nearClip + clipRange;
 			float range = maxZ - minZ;
 			float ratio = maxZ / minZ;
+
+			// Shared by every cascade, and the camera updates its projection lazily so it is read once here rather than from the jobs
+			const Maths::Matrix4 invCam = Maths::Matrix4::Inverse(m_Camera->GetProjectionMatrix() * m_CameraTransform->GetWorldMatrix().Inverse());
+			Maths::Vector3 lightDir = -light->Direction.ToVector3();
+			lightDir.Normalize();
 			// Calculate split depths based on view camera frustum
 			// Based on method presented in https://developer.nvidia.com/gpugems/GPUGems3/gpugems3_ch10.html
 			for(uint32_t i = 0; i < m_ShadowMapNum; i++)
@@ -327,7 +401,8 @@ namespace Lumos
 			}
 
 #ifdef THREAD_CASCADE_GEN
-			System::JobSystem::Dispatch(static_cast<u32>(m_ShadowMapNum), 1, [&](JobDispatchArgs args)
+			System::JobSystem::Context ctx;
+			System::JobSystem::Dispatch(ctx, static_cast<u32>(m_ShadowMapNum), 1, [&](JobDispatchArgs args)
 #else
 			for(uint32_t i = 0; i < m_ShadowMapNum; i++)
 #endif
@@ -349,8 +424,6 @@ namespace Lumos
 						Maths::Vector3(-1.0f, -1.0f, 1.0f),
 					};
 
-					const Maths::Matrix4 invCam = Maths::Matrix4::Inverse(m_Camera->GetProjectionMatrix() * m_CameraTransform->GetWorldMatrix().Inverse());
-
 					// Project frustum corners into world space
 					for(uint32_t j = 0; j < 8; j++)
 					{
@@ -387,8 +460,6 @@ namespace Lumos
 					Maths::Vector3 maxExtents = Maths::Vector3(radius);
 					Maths::Vector3 minExtents = -maxExtents;
 
-					Maths::Vector3 lightDir = -light->Direction.ToVector3();
-					lightDir.Normalize();
 					Maths::Matrix4 lightViewMatrix = Maths::Quaternion::LookAt(frustumCenter - lightDir * -minExtents.z, frustumCenter).RotationMatrix4();
 					lightViewMatrix.SetTranslation(frustumCenter);
 
@@ -419,7 +490,7 @@ namespace Lumos
 				}
 #ifdef THREAD_CASCADE_GEN
 			);
-			System::JobSystem::Wait();
+			System::JobSystem::Wait(ctx);
 #endif
 		}
 
@@ -468,6 +539,7 @@ namespace Lumos
 			pipelineCreateInfo.shader = m_Shader;
 			pipelineCreateInfo.renderpass = m_RenderPass;
             pipelineCreateInfo.vertexBufferLayout = vertexBufferLayout;
+            pipelineCreateInfo.instanceBufferLayout = InstanceBuffer::GetLayout();
 			pipelineCreateInfo.cullMode = Graphics::CullMode::NONE;
 			pipelineCreateInfo.transparencyEnabled = false;
 			pipelineCreateInfo.depthBiasEnabled = true;
@@ -478,27 +550,8 @@ namespace Lumos
 		void ShadowRenderer::CreateUniformBuffer()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			if(m_UniformBuffer == nullptr)
-			{
-				m_UniformBuffer = Graphics::UniformBuffer::Create();
-
-				const uint32_t bufferSize = static_cast<uint32_t>(sizeof(UniformBufferObject));
-				m_UniformBuffer->Init(bufferSize, nullptr);
-			}
-            
 			std::vector<Graphics::BufferInfo> bufferInfos;
-
-			Graphics::BufferInfo bufferInfo;
-			bufferInfo.buffer = m_UniformBuffer;
-			bufferInfo.offset = 0;
-			bufferInfo.name = "UniformBufferObject";
-			bufferInfo.size = sizeof(UniformBufferObject);
-			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
-			bufferInfo.binding = 0;
-			bufferInfo.shaderType = ShaderType::VERTEX;
-			bufferInfo.systemUniforms = false;
-
-			bufferInfos.push_back(bufferInfo);
+			bufferInfos.push_back(GetVSSystemUniformBufferInfo());
 
 			m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
 		}
@@ -506,11 +559,7 @@ namespace Lumos
 		void ShadowRenderer::SetSystemUniforms(Shader* shader)
 		{
 			LUMOS_PROFILE_FUNCTION();
-			
-			{
-				LUMOS_PROFILE_SCOPE("Vertex Uniform Buffer Update");
-                m_UniformBuffer->SetData(sizeof(Maths::Matrix4) * m_ShadowMapNum, *&m_VSSystemUniformBuffer);
-			}
+			PushVSSystemUniforms();
 		}
 
 		void ShadowRenderer::Submit(const RenderCommand& command)
@@ -518,16 +567,24 @@ namespace Lumos
 			m_CommandQueue.push_back(command);
 		}
 
-		void ShadowRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix)
+		void ShadowRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform)
 		{
 			LUMOS_PROFILE_FUNCTION();
 			RenderCommand command;
 			command.mesh = mesh;
 			command.transform = transform;
 			command.material = material;
+			// Depth only pass, group by mesh so vertex and index buffers are bound once per mesh
+			command.sortKey = RenderSortKey::Make(0, m_Pipeline.get(), nullptr, mesh, 0.0f);
 			Submit(command);
 		}
 
+		void ShadowRenderer::DeclareResources(RenderGraphBuilder& builder, u32 pass)
+		{
+			builder.SetPassName(pass, "Shadows");
+			builder.Write(pass, builder.AddResource(RenderGraphResources::ShadowMap));
+		}
+
 		void ShadowRenderer::OnImGui()
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -556,6 +613,7 @@ namespace Lumos
                         
             ImGui::DragFloat("Cascade Split Lambda", &m_CascadeSplitLambda, 0.005f, 0.0f, 3.0f);
             ImGui::DragFloat("Scene Radius Multiplier", &m_SceneRadiusMultiplier, 0.005f, 0.0f, 5.0f);
+            ImGui::Checkbox("Cache Static Cascades", &m_CacheCascades);
 
 		}
 	}
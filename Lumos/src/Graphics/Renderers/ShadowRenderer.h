@@ -46,7 +46,7 @@ namespace Lumos
 
 			void Begin() override;
 			void Submit(const RenderCommand& command) override;
-			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override;
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform) override;
 			void EndScene() override;
 			void End() override;
 			void Present() override;
@@ -73,18 +73,17 @@ namespace Lumos
 			_FORCE_INLINE_ void SetShadowInvalid()
 			{
 				m_ShadowMapsInvalidated = true;
+				InvalidateCascadeCache();
 			}
 
+			// Forces every cascade to be redrawn next frame, for changes to casters the renderer cannot see (e.g. mesh data)
+			void InvalidateCascadeCache();
+
 			_FORCE_INLINE_ TextureDepthArray* GetTexture() const
 			{
 				return m_ShadowTex;
 			}
 
-			u8* m_VSSystemUniformBuffer{};
-			u32 m_VSSystemUniformBufferSize{};
-
-			std::vector<u32> m_VSSystemUniformBufferOffsets;
-
 			struct UniformBufferObject
 			{
 				Lumos::Maths::Matrix4 projView[SHADOWMAP_MAX];
@@ -96,9 +95,11 @@ namespace Lumos
 			void UpdateCascades(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform, Light* light);
 
 			void OnImGui() override;
+			void DeclareResources(RenderGraphBuilder& builder, u32 pass) override;
 
 		protected:
 			void SetSystemUniforms(Shader* shader);
+			void GatherCascade(u32 cascade);
 
 			TextureDepthArray* m_ShadowTex;
 			u32 m_ShadowMapNum;
@@ -108,7 +109,6 @@ namespace Lumos
 			Maths::Matrix4 m_ShadowProjView[SHADOWMAP_MAX];
 			Maths::Vector4 m_SplitDepth[SHADOWMAP_MAX];
 
-			Lumos::Graphics::UniformBuffer* m_UniformBuffer;
 			Lumos::Graphics::CommandBuffer* m_CommandBuffer = nullptr;
 			
 			u32 m_Layer = 0;
@@ -117,6 +117,20 @@ namespace Lumos
             bool m_ShouldRender = false;
             
             std::vector<Graphics::PushConstant> m_PushConstants;
+			RenderBindState m_BindState;
+			InstanceBuffer m_InstanceBuffer;
+			std::vector<InstanceBatch> m_CascadeBatches[SHADOWMAP_MAX];
+			u32 m_CascadeViews[SHADOWMAP_MAX];
+			CommandQueue m_CascadeQueues[SHADOWMAP_MAX];
+
+			// A cascade is only redrawn when its matrix or its casters change, otherwise last frame's depth is kept
+			bool m_CacheCascades = true;
+			bool m_CascadeCacheValid[SHADOWMAP_MAX] = {};
+			bool m_CascadeDirty[SHADOWMAP_MAX] = {};
+			Maths::Matrix4 m_CachedProjView[SHADOWMAP_MAX];
+			u64 m_CascadeCasterHash[SHADOWMAP_MAX] = {};
+			u64 m_CachedCasterHash[SHADOWMAP_MAX] = {};
+			std::vector<Maths::Matrix4> m_InstanceTransforms;
 		};
 	}
 }
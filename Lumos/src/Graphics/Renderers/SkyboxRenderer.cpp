@@ -3,7 +3,6 @@
 #include "Graphics/API/Shader.h"
 #include "Graphics/API/Framebuffer.h"
 #include "Graphics/API/Texture.h"
-#include "Graphics/API/UniformBuffer.h"
 #include "Graphics/API/Renderer.h"
 #include "Graphics/API/CommandBuffer.h"
 #include "Graphics/API/Swapchain.h"
@@ -26,8 +25,7 @@ namespace Lumos
 	namespace Graphics
 	{
 		SkyboxRenderer::SkyboxRenderer(u32 width, u32 height)
-			: m_UniformBuffer(nullptr)
-			, m_CubeMap(nullptr)
+			: m_CubeMap(nullptr)
 		{
 			m_Pipeline = nullptr;
 
@@ -37,7 +35,6 @@ namespace Lumos
 
 		SkyboxRenderer::~SkyboxRenderer()
 		{
-			delete m_UniformBuffer;
 			delete m_Skybox;
 			delete[] m_VSSystemUniformBuffer;
 
@@ -60,6 +57,7 @@ namespace Lumos
 			m_Pipeline->Bind(m_CommandBuffers[m_CurrentBufferID].get());
 
             m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
+			m_CurrentDescriptorSets[0]->SetDynamicOffset(m_VSSystemUniformOffset);
 
 			m_Skybox->GetVertexBuffer()->Bind(m_CommandBuffers[m_CurrentBufferID].get(), m_Pipeline.get());
 			m_Skybox->GetIndexBuffer()->Bind(m_CommandBuffers[m_CurrentBufferID].get());
@@ -184,10 +182,10 @@ namespace Lumos
 				m_CommandBuffers[m_CurrentBufferID]->Execute(true);
 		}
 
-		void SkyboxRenderer::SetSystemUniforms(Shader* shader) const
+		void SkyboxRenderer::SetSystemUniforms(Shader* shader)
 		{
 			LUMOS_PROFILE_FUNCTION();
-			m_UniformBuffer->SetData(sizeof(UniformBufferObject), *&m_VSSystemUniformBuffer);
+			PushVSSystemUniforms();
 		}
 
 		void SkyboxRenderer::OnResize(u32 width, u32 height)
@@ -228,25 +226,8 @@ namespace Lumos
 		void SkyboxRenderer::UpdateUniformBuffer()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			if(m_UniformBuffer == nullptr)
-			{
-				m_UniformBuffer = Graphics::UniformBuffer::Create();
-				uint32_t bufferSize = static_cast<uint32_t>(sizeof(UniformBufferObject));
-				m_UniformBuffer->Init(bufferSize, nullptr);
-			}
-
 			std::vector<Graphics::BufferInfo> bufferInfos;
-
-			Graphics::BufferInfo bufferInfo = {};
-			bufferInfo.buffer = m_UniformBuffer;
-			bufferInfo.offset = 0;
-			bufferInfo.size = sizeof(UniformBufferObject);
-			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
-			bufferInfo.binding = 0;
-			bufferInfo.shaderType = ShaderType::VERTEX;
-			bufferInfo.systemUniforms = true;
-
-			bufferInfos.push_back(bufferInfo);
+			bufferInfos.push_back(GetVSSystemUniformBufferInfo());
 
 			std::vector<Graphics::ImageInfo> imageInfos;
 
@@ -322,6 +303,13 @@ namespace Lumos
 			}
 		}
 
+		void SkyboxRenderer::DeclareResources(RenderGraphBuilder& builder, u32 pass)
+		{
+			builder.SetPassName(pass, "Skybox");
+			builder.Write(pass, builder.AddResource(RenderGraphResources::Depth));
+			builder.Write(pass, builder.AddResource(RenderGraphResources::Screen));
+		}
+
 		void SkyboxRenderer::OnImGui()
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -25,7 +25,7 @@ namespace Lumos
 
 			void Begin() override;
 			void Submit(const RenderCommand& command) override{};
-			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override {};
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform) override {};
 			void EndScene() override{};
 			void End() override;
 			void Present() override{};
@@ -42,11 +42,11 @@ namespace Lumos
 			void SetRenderTarget(Texture* texture, bool rebuildFramebuffer) override;
 
 			void OnImGui() override;
+			void DeclareResources(RenderGraphBuilder& builder, u32 pass) override;
 
 		private:
-			void SetSystemUniforms(Shader* shader) const;
+			void SetSystemUniforms(Shader* shader);
 
-			Lumos::Graphics::UniformBuffer* m_UniformBuffer;
 
 			u32 m_CurrentBufferID = 0;
 
@@ -0,0 +1,432 @@
+#include "Precompiled.h"
+#include "VisibilityStage.h"
+#include "Graphics/Model.h"
+#include "Graphics/Sprite.h"
+#include "Graphics/AnimatedSprite.h"
+#include "Maths/Transform.h"
+#include "Maths/Ray.h"
+#include "Scene/Scene.h"
+#include "Core/JobSystem.h"
+
+#define VISIBILITY_BOUNDS_GROUP_SIZE 128
+#define VISIBILITY_2D_CHUNK_SIZE 4096
+#define VISIBILITY_SPRITE_PROXY 0
+#define VISIBILITY_ANIMATED_SPRITE_PROXY 1
+#define VISIBILITY_FIRST_MESH_PROXY 2
+
+namespace Lumos::Graphics
+{
+	void VisibilityStage::BoundsSoA::Resize(u32 count)
+	{
+		centreX.resize(count);
+		centreY.resize(count);
+		centreZ.resize(count);
+		extentX.resize(count);
+		extentY.resize(count);
+		extentZ.resize(count);
+	}
+
+	void VisibilityStage::BoundsSoA::Set(u32 index, const Maths::BoundingBox& bounds)
+	{
+		const Maths::Vector3 centre = bounds.Center();
+		const Maths::Vector3 extent = bounds.HalfSize();
+		centreX[index] = centre.x;
+		centreY[index] = centre.y;
+		centreZ[index] = centre.z;
+		extentX[index] = extent.x;
+		extentY[index] = extent.y;
+		extentZ[index] = extent.z;
+	}
+
+	void VisibilityStage::BeginFrame(Scene* scene)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		m_Frame++;
+		m_ViewCount = 0;
+		m_AcceptingViews = true;
+
+		if(scene != m_Scene)
+		{
+			// Entity ids are meaningless across scenes
+			m_Tree.Clear();
+			m_Slots.clear();
+			m_Scene = scene;
+		}
+
+		m_Entities.clear();
+		m_Meshes.clear();
+		m_Sprites.clear();
+		m_Transforms.clear();
+		m_ItemProxies.clear();
+		m_Moved.clear();
+		m_DirtyItems.clear();
+
+		auto& registry = scene->GetRegistry();
+
+		{
+			LUMOS_PROFILE_SCOPE("Gather Items");
+			auto group = registry.group<Model>(entt::get<Maths::Transform>);
+			for(auto entity : group)
+			{
+				const auto& [model, trans] = group.get<Model, Maths::Transform>(entity);
+				const auto& meshes = model.GetMeshes();
+				const u32 slot = GetSlot(entity);
+
+				// Static props keep their proxy untouched until their world matrix changes. Compared against the
+				// last matrix seen here, so the transform's own dirty flag is left for other systems
+				const Maths::Matrix4& world = trans.GetWorldMatrix();
+				Maths::Matrix4& lastWorld = m_Slots[slot].world;
+				const bool moved = memcmp(&world, &lastWorld, sizeof(Maths::Matrix4)) != 0;
+				lastWorld = world;
+
+				for(u32 i = 0; i < static_cast<u32>(meshes.size()); i++)
+				{
+					if(!meshes[i]->GetActive())
+						continue;
+
+					m_Meshes.push_back(meshes[i].get());
+					AddItem(entity, slot, VISIBILITY_FIRST_MESH_PROXY + i, &trans.GetWorldMatrix(), moved);
+				}
+			}
+
+			m_MeshCount = GetItemCount();
+
+			// Sprite bounds also depend on the sprite's own position and scale, so they are always refitted
+			auto spriteGroup = registry.group<Sprite>(entt::get<Maths::Transform>);
+			for(auto entity : spriteGroup)
+			{
+				const auto& [sprite, trans] = spriteGroup.get<Sprite, Maths::Transform>(entity);
+				m_Sprites.push_back(&sprite);
+				AddItem(entity, GetSlot(entity), VISIBILITY_SPRITE_PROXY, &trans.GetWorldMatrix(), true);
+			}
+
+			auto animatedSpriteGroup = registry.group<AnimatedSprite>(entt::get<Maths::Transform>);
+			for(auto entity : animatedSpriteGroup)
+			{
+				const auto& [sprite, trans] = animatedSpriteGroup.get<AnimatedSprite, Maths::Transform>(entity);
+				m_Sprites.push_back(&sprite);
+				AddItem(entity, GetSlot(entity), VISIBILITY_ANIMATED_SPRITE_PROXY, &trans.GetWorldMatrix(), true);
+			}
+		}
+
+		const u32 dirtyCount = static_cast<u32>(m_DirtyItems.size());
+		m_DirtyBounds.resize(dirtyCount);
+
+		{
+			LUMOS_PROFILE_SCOPE("Transform Bounds");
+			System::JobSystem::Context ctx;
+			System::JobSystem::Dispatch(ctx, dirtyCount, VISIBILITY_BOUNDS_GROUP_SIZE, [&](JobDispatchArgs args) {
+				const u32 item = m_DirtyItems[args.jobIndex].item;
+				Maths::BoundingBox& bb = m_DirtyBounds[args.jobIndex];
+
+				if(item < m_MeshCount)
+					bb = m_Meshes[item]->GetBoundingBox()->Transformed(*m_Transforms[item]);
+				else
+				{
+					const Renderable2D* sprite = m_Sprites[item - m_MeshCount];
+					bb = Maths::BoundingBox(Maths::Rect(sprite->GetPosition(), sprite->GetPosition() + sprite->GetScale()));
+					bb.Transform(*m_Transforms[item]);
+				}
+			});
+
+			System::JobSystem::Wait(ctx);
+		}
+
+		{
+			LUMOS_PROFILE_SCOPE("Update BVH");
+			for(u32 i = 0; i < dirtyCount; i++)
+			{
+				const DirtyItem& dirty = m_DirtyItems[i];
+				ProxyRef& ref = m_Slots[dirty.slot].proxies[dirty.proxyIndex];
+
+				if(ref.proxy == Maths::DynamicBVH::NULL_NODE)
+					ref.proxy = m_Tree.CreateProxy(m_DirtyBounds[i], dirty.item);
+				else
+				{
+					m_Tree.MoveProxy(ref.proxy, m_DirtyBounds[i]);
+					m_Tree.SetUserData(ref.proxy, dirty.item);
+				}
+
+				m_ItemProxies[dirty.item] = ref.proxy;
+			}
+
+			m_ProxyBounds.Resize(m_Tree.GetNodeCapacity());
+			for(u32 i = 0; i < dirtyCount; i++)
+				m_ProxyBounds.Set(m_ItemProxies[m_DirtyItems[i].item], m_DirtyBounds[i]);
+
+			// Remove the proxies of destroyed entities, removed components and inactive meshes
+			for(auto& slot : m_Slots)
+			{
+				for(auto& ref : slot.proxies)
+				{
+					if(ref.proxy != Maths::DynamicBVH::NULL_NODE && ref.frame != m_Frame)
+					{
+						m_Tree.DestroyProxy(ref.proxy);
+						ref.proxy = Maths::DynamicBVH::NULL_NODE;
+					}
+				}
+			}
+		}
+	}
+
+	u32 VisibilityStage::GetSlot(entt::entity entity)
+	{
+		const u32 index = static_cast<u32>(entt::to_integral(entt::registry::entity(entity)));
+		if(index >= m_Slots.size())
+			m_Slots.resize(index + 1, EntitySlot{entt::null, {}, Maths::Matrix4()});
+
+		EntitySlot& slot = m_Slots[index];
+		if(slot.entity != entity)
+		{
+			// The id was recycled, the old entity's proxies are stale
+			DestroyProxies(slot);
+			slot.entity = entity;
+		}
+
+		return index;
+	}
+
+	void VisibilityStage::AddItem(entt::entity entity, u32 slot, u32 proxyIndex, const Maths::Matrix4* transform, bool moved)
+	{
+		auto& proxies = m_Slots[slot].proxies;
+		if(proxyIndex >= proxies.size())
+			proxies.resize(proxyIndex + 1);
+
+		ProxyRef& ref = proxies[proxyIndex];
+		ref.frame = m_Frame;
+
+		const u32 item = GetItemCount();
+		m_Entities.push_back(entity);
+		m_Transforms.push_back(transform);
+		m_ItemProxies.push_back(ref.proxy);
+
+		const bool dirty = moved || ref.proxy == Maths::DynamicBVH::NULL_NODE;
+		m_Moved.push_back(dirty ? 1 : 0);
+
+		if(dirty)
+			m_DirtyItems.push_back({ item, slot, proxyIndex });
+		else
+			m_Tree.SetUserData(ref.proxy, item);
+	}
+
+	void VisibilityStage::DestroyProxies(EntitySlot& slot)
+	{
+		for(auto& ref : slot.proxies)
+		{
+			if(ref.proxy != Maths::DynamicBVH::NULL_NODE)
+				m_Tree.DestroyProxy(ref.proxy);
+		}
+
+		slot.proxies.clear();
+	}
+
+	u32 VisibilityStage::AddView(const Maths::Frustum& frustum, VisibilityType type)
+	{
+		if(!m_AcceptingViews)
+			return InvalidView;
+
+		if(m_ViewCount == m_Views.size())
+			m_Views.emplace_back();
+
+		View& view = m_Views[m_ViewCount];
+		view.frustum = frustum;
+		view.first = type == VisibilityType::Mesh ? 0 : m_MeshCount;
+		view.last = type == VisibilityType::Mesh ? m_MeshCount : GetItemCount();
+		view.visible.clear();
+		view.is2D = false;
+
+		return m_ViewCount++;
+	}
+
+	u32 VisibilityStage::AddView(const Maths::Rect& bounds)
+	{
+		const u32 index = AddView(Maths::Frustum(), VisibilityType::Sprite);
+		if(index == InvalidView)
+			return InvalidView;
+
+		View& view = m_Views[index];
+		view.is2D = true;
+		view.rect = bounds;
+		return index;
+	}
+
+	void VisibilityStage::Cull()
+	{
+		LUMOS_PROFILE_FUNCTION();
+		m_AcceptingViews = false;
+
+		m_CullTasks.clear();
+		for(u32 i = 0; i < m_ViewCount; i++)
+		{
+			View& view = m_Views[i];
+			if(!view.is2D)
+			{
+				m_CullTasks.push_back({ i, 0 });
+				continue;
+			}
+
+			const u32 chunkCount = (view.last - view.first + VISIBILITY_2D_CHUNK_SIZE - 1) / VISIBILITY_2D_CHUNK_SIZE;
+			view.chunkVisible.resize(chunkCount);
+			for(u32 chunk = 0; chunk < chunkCount; chunk++)
+				m_CullTasks.push_back({ i, chunk });
+		}
+
+		System::JobSystem::Context ctx;
+		System::JobSystem::Dispatch(ctx, static_cast<u32>(m_CullTasks.size()), 1, [&](JobDispatchArgs args) {
+			const CullTask& task = m_CullTasks[args.jobIndex];
+			View& view = m_Views[task.view];
+			if(view.is2D)
+				CullChunk2D(view, task.chunk);
+			else
+				CullView(view);
+		});
+
+		System::JobSystem::Wait(ctx);
+
+		// Chunks cover consecutive items, so joining them in order keeps registry order
+		for(u32 i = 0; i < m_ViewCount; i++)
+		{
+			View& view = m_Views[i];
+			if(!view.is2D)
+				continue;
+
+			size_t visibleCount = 0;
+			for(auto& chunk : view.chunkVisible)
+				visibleCount += chunk.size();
+
+			view.visible.clear();
+			view.visible.reserve(visibleCount);
+			for(auto& chunk : view.chunkVisible)
+				view.visible.insert(view.visible.end(), chunk.begin(), chunk.end());
+		}
+	}
+
+	void VisibilityStage::CullView(View& view) const
+	{
+		LUMOS_PROFILE_FUNCTION();
+		view.visible.clear();
+		view.candidates.clear();
+
+		m_Tree.Query(view.frustum, [&](u32 proxy, bool inside) {
+			const u32 item = m_Tree.GetUserData(proxy);
+			if(item < view.first || item >= view.last)
+				return;
+
+			if(inside)
+				view.visible.push_back(item);
+			else
+				view.candidates.push_back(proxy);
+		});
+
+		// Leaves whose enlarged bounds cross a plane are retested with their tight bounds, batched through the SIMD kernel
+		const u32 count = static_cast<u32>(view.candidates.size());
+		if(count > 0)
+		{
+			auto& bounds = view.candidateBounds;
+			bounds.Resize(count);
+			view.candidateMask.resize((count + 31) / 32);
+
+			for(u32 i = 0; i < count; i++)
+			{
+				const u32 proxy = view.candidates[i];
+				bounds.centreX[i] = m_ProxyBounds.centreX[proxy];
+				bounds.centreY[i] = m_ProxyBounds.centreY[proxy];
+				bounds.centreZ[i] = m_ProxyBounds.centreZ[proxy];
+				bounds.extentX[i] = m_ProxyBounds.extentX[proxy];
+				bounds.extentY[i] = m_ProxyBounds.extentY[proxy];
+				bounds.extentZ[i] = m_ProxyBounds.extentZ[proxy];
+			}
+
+			view.frustum.IsInsideFast(bounds.centreX.data(), bounds.centreY.data(), bounds.centreZ.data(),
+				bounds.extentX.data(), bounds.extentY.data(), bounds.extentZ.data(), count, view.candidateMask.data());
+
+			for(u32 i = 0; i < count; i++)
+			{
+				if(view.candidateMask[i >> 5] & (1u << (i & 31)))
+					view.visible.push_back(m_Tree.GetUserData(view.candidates[i]));
+			}
+		}
+
+		std::sort(view.visible.begin(), view.visible.end());
+	}
+
+	void VisibilityStage::CullChunk2D(View& view, u32 chunk) const
+	{
+		LUMOS_PROFILE_FUNCTION();
+		std::vector<u32>& visible = view.chunkVisible[chunk];
+		visible.clear();
+
+		const u32 first = view.first + chunk * VISIBILITY_2D_CHUNK_SIZE;
+		const u32 last = Maths::Min(first + VISIBILITY_2D_CHUNK_SIZE, view.last);
+
+		const Maths::Vector2 centre = view.rect.Center();
+		const Maths::Vector2 halfSize = view.rect.HalfSize();
+
+		for(u32 item = first; item < last; item++)
+		{
+			const u32 proxy = m_ItemProxies[item];
+			if(Maths::Abs(m_ProxyBounds.centreX[proxy] - centre.x) <= m_ProxyBounds.extentX[proxy] + halfSize.x
+				&& Maths::Abs(m_ProxyBounds.centreY[proxy] - centre.y) <= m_ProxyBounds.extentY[proxy] + halfSize.y)
+				visible.push_back(item);
+		}
+	}
+
+	const std::vector<u32>& VisibilityStage::GetVisible(u32 view) const
+	{
+		static const std::vector<u32> empty;
+		if(view >= m_ViewCount)
+			return empty;
+
+		return m_Views[view].visible;
+	}
+
+	u32 VisibilityStage::RayCast(const Maths::Ray& ray, VisibilityType type, float& distance) const
+	{
+		LUMOS_PROFILE_FUNCTION();
+		const u32 first = type == VisibilityType::Mesh ? 0 : m_MeshCount;
+		const u32 last = type == VisibilityType::Mesh ? m_MeshCount : GetItemCount();
+
+		u32 closestItem = InvalidItem;
+		distance = Maths::M_INFINITY;
+
+		m_Tree.RayCast(ray, [&](u32 proxy) {
+			const u32 item = m_Tree.GetUserData(proxy);
+			if(item < first || item >= last)
+				return Maths::M_INFINITY;
+
+			const float hitDistance = ray.HitDistance(GetProxyBounds(proxy));
+			if(hitDistance < distance)
+			{
+				distance = hitDistance;
+				closestItem = item;
+			}
+
+			return hitDistance;
+		});
+
+		return closestItem;
+	}
+
+	void VisibilityStage::Query(const Maths::BoundingBox& bounds, VisibilityType type, std::vector<u32>& items) const
+	{
+		LUMOS_PROFILE_FUNCTION();
+		const u32 first = type == VisibilityType::Mesh ? 0 : m_MeshCount;
+		const u32 last = type == VisibilityType::Mesh ? m_MeshCount : GetItemCount();
+
+		m_Tree.Query(bounds, [&](u32 proxy) {
+			const u32 item = m_Tree.GetUserData(proxy);
+			if(item < first || item >= last)
+				return;
+
+			if(bounds.IsInsideFast(GetProxyBounds(proxy)) != Maths::OUTSIDE)
+				items.push_back(item);
+		});
+	}
+
+	Maths::BoundingBox VisibilityStage::GetProxyBounds(u32 proxy) const
+	{
+		const Maths::Vector3 centre(m_ProxyBounds.centreX[proxy], m_ProxyBounds.centreY[proxy], m_ProxyBounds.centreZ[proxy]);
+		const Maths::Vector3 extent(m_ProxyBounds.extentX[proxy], m_ProxyBounds.extentY[proxy], m_ProxyBounds.extentZ[proxy]);
+		return Maths::BoundingBox(centre - extent, centre + extent);
+	}
+}
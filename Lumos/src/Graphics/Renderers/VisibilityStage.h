@@ -0,0 +1,162 @@
+#pragma once
+#include "Maths/Frustum.h"
+#include "Maths/DynamicBVH.h"
+#include <entt/entity/fwd.hpp>
+
+namespace Lumos
+{
+	class Scene;
+
+	namespace Maths
+	{
+		class Matrix4;
+		class Ray;
+	}
+
+	namespace Graphics
+	{
+		class Mesh;
+		class Renderable2D;
+
+		enum class VisibilityType
+		{
+			Mesh = 0,
+			Sprite = 1
+		};
+
+		// Shared per frame visibility for every view the renderers register (main camera, shadow cascades ...).
+		// World space bounds of each active mesh and sprite are kept in a dynamic BVH, refitted only for transforms
+		// that changed, and every view is culled at once on the JobSystem. Items are indexed per frame, meshes first, then sprites.
+		class LUMOS_EXPORT VisibilityStage
+		{
+		public:
+			static constexpr u32 InvalidView = ~0u;
+			static constexpr u32 InvalidItem = ~0u;
+
+			VisibilityStage() = default;
+			~VisibilityStage() = default;
+
+			// Gathers this frame's items, updates the BVH for the ones that moved and clears the registered views
+			void BeginFrame(Scene* scene);
+
+			// Views can only be added between BeginFrame and Cull, InvalidView is returned otherwise
+			u32 AddView(const Maths::Frustum& frustum, VisibilityType type);
+
+			// Sprite view for 2D cameras, only the xy bounds of sprites are tested against bounds. Sprites are scanned
+			// in chunks spread over the JobSystem rather than walking the BVH, which suits views seeing most of the scene
+			u32 AddView(const Maths::Rect& bounds);
+
+			// Culls every registered view in parallel
+			void Cull();
+
+			// Indices of the items left visible by a view, in registry order
+			const std::vector<u32>& GetVisible(u32 view) const;
+
+			// Closest item of a type hit by the ray, or InvalidItem. distance is set to the hit distance
+			u32 RayCast(const Maths::Ray& ray, VisibilityType type, float& distance) const;
+
+			// Appends the items of a type overlapping the box
+			void Query(const Maths::BoundingBox& bounds, VisibilityType type, std::vector<u32>& items) const;
+
+			u32 GetItemCount() const { return static_cast<u32>(m_Entities.size()); }
+			u32 GetMeshCount() const { return m_MeshCount; }
+
+			entt::entity GetEntity(u32 index) const { return m_Entities[index]; }
+			Mesh* GetMesh(u32 index) const { return m_Meshes[index]; }
+			Renderable2D* GetSprite(u32 index) const { return m_Sprites[index - m_MeshCount]; }
+			const Maths::Matrix4& GetTransform(u32 index) const { return *m_Transforms[index]; }
+			// True when the item's bounds were refitted this frame, because it moved or was just added
+			bool HasMoved(u32 index) const { return m_Moved[index] != 0; }
+			Maths::BoundingBox GetBounds(u32 index) const { return GetProxyBounds(m_ItemProxies[index]); }
+
+			const Maths::DynamicBVH& GetTree() const { return m_Tree; }
+
+		private:
+			struct BoundsSoA
+			{
+				void Resize(u32 count);
+				void Set(u32 index, const Maths::BoundingBox& bounds);
+
+				std::vector<float> centreX, centreY, centreZ;
+				std::vector<float> extentX, extentY, extentZ;
+			};
+
+			struct View
+			{
+				Maths::Frustum frustum;
+				u32 first = 0;
+				u32 last = 0;
+				std::vector<u32> visible;
+
+				// 2D views test rect instead of the frustum, each chunk of items fills its own list
+				bool is2D = false;
+				Maths::Rect rect;
+				std::vector<std::vector<u32>> chunkVisible;
+
+				// Leaves only partly inside the frustum, retested against their tight bounds
+				std::vector<u32> candidates;
+				BoundsSoA candidateBounds;
+				std::vector<unsigned> candidateMask;
+			};
+
+			// One job of Cull, a whole 3D view or one chunk of a 2D view
+			struct CullTask
+			{
+				u32 view;
+				u32 chunk;
+			};
+
+			struct ProxyRef
+			{
+				u32 proxy = Maths::DynamicBVH::NULL_NODE;
+				u32 frame = 0;
+			};
+
+			// Proxies of one entity, the sprite and animated sprite first followed by one per mesh.
+			// Proxies not seen in a frame are destroyed
+			struct EntitySlot
+			{
+				entt::entity entity;
+				std::vector<ProxyRef> proxies;
+				Maths::Matrix4 world; // World matrix the mesh proxies were last fitted with
+			};
+
+			struct DirtyItem
+			{
+				u32 item;
+				u32 slot;
+				u32 proxyIndex;
+			};
+
+			u32 GetSlot(entt::entity entity);
+			void AddItem(entt::entity entity, u32 slot, u32 proxyIndex, const Maths::Matrix4* transform, bool moved);
+			void DestroyProxies(EntitySlot& slot);
+			void CullView(View& view) const;
+			void CullChunk2D(View& view, u32 chunk) const;
+			Maths::BoundingBox GetProxyBounds(u32 proxy) const;
+
+			Scene* m_Scene = nullptr;
+			u32 m_Frame = 0;
+
+			std::vector<View> m_Views;
+			u32 m_ViewCount = 0;
+			bool m_AcceptingViews = false;
+			std::vector<CullTask> m_CullTasks;
+
+			u32 m_MeshCount = 0;
+			std::vector<entt::entity> m_Entities;
+			std::vector<Mesh*> m_Meshes;
+			std::vector<Renderable2D*> m_Sprites;
+			std::vector<const Maths::Matrix4*> m_Transforms;
+			std::vector<u32> m_ItemProxies;
+			std::vector<u8> m_Moved;
+
+			Maths::DynamicBVH m_Tree;
+			// Tight world space bounds, indexed by proxy
+			BoundsSoA m_ProxyBounds;
+			std::vector<EntitySlot> m_Slots;
+			std::vector<DirtyItem> m_DirtyItems;
+			std::vector<Maths::BoundingBox> m_DirtyBounds;
+		};
+	}
+}
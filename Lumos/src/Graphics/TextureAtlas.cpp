@@ -0,0 +1,280 @@
+#include "Precompiled.h"
+#include "TextureAtlas.h"
+#include "Graphics/API/Texture.h"
+#include "Utilities/LoadImage.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		static constexpr u32 ATLAS_BYTES_PER_PIXEL = 4;
+		// Images not drawn for this many frames are dropped from the atlas
+		static constexpr u64 ATLAS_EVICT_FRAMES = 1800;
+
+		TextureAtlas::TextureAtlas(u32 pageSize, u32 maxImageSize, u32 padding)
+			: m_PageSize(pageSize)
+			, m_MaxImageSize(Maths::Min(maxImageSize, pageSize - padding * 2))
+			, m_Padding(padding)
+		{
+		}
+
+		TextureAtlas::~TextureAtlas()
+		{
+			for(auto& page : m_Pages)
+				delete page.texture;
+		}
+
+		bool TextureAtlas::Add(const Texture2D* texture)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			if(!texture)
+				return false;
+
+			// Textures created from memory have no file to pack from
+			const std::string& path = texture->GetFilepath();
+			if(path.empty() || path == "NULL" || m_Rejected.find(path) != m_Rejected.end())
+				return false;
+
+			if(m_Images.find(path) != m_Images.end())
+				return true;
+
+			if(texture->GetWidth() > m_MaxImageSize || texture->GetHeight() > m_MaxImageSize)
+			{
+				m_Rejected.insert(path);
+				return false;
+			}
+
+			u32 width = 0, height = 0, bits = 0;
+			u8* pixels = Lumos::LoadImageFromFile(path, &width, &height, &bits);
+
+			u32 page;
+			i32 x, y;
+			const bool packed = pixels && bits == ATLAS_BYTES_PER_PIXEL * 8 && width <= m_MaxImageSize && height <= m_MaxImageSize && Place(width, height, page, x, y);
+			if(packed)
+			{
+				Blit(m_Pages[page], x, y, width, height, pixels, width * ATLAS_BYTES_PER_PIXEL);
+				m_Images[path] = { page, x, y, width, height, m_Frame };
+			}
+			else
+				m_Rejected.insert(path);
+
+			delete[] pixels;
+			return packed;
+		}
+
+		bool TextureAtlas::Find(const Texture2D* texture, Region& region)
+		{
+			Image* image = nullptr;
+
+			auto cached = m_FrameLookup.find(texture);
+			if(cached != m_FrameLookup.end())
+				image = cached->second;
+			else
+			{
+				if(Add(texture))
+				{
+					image = &m_Images[texture->GetFilepath()];
+					image->lastUsedFrame = m_Frame;
+				}
+				m_FrameLookup[texture] = image;
+			}
+
+			if(!image || !image->uploaded)
+				return false;
+
+			const float pageSize = static_cast<float>(m_PageSize);
+			region.page = image->page;
+			region.uvMin = Maths::Vector2(image->x / pageSize, image->y / pageSize);
+			region.uvMax = Maths::Vector2((image->x + image->width) / pageSize, (image->y + image->height) / pageSize);
+			return true;
+		}
+
+		void TextureAtlas::Update()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			m_Frame++;
+			m_FrameLookup.clear();
+
+			EvictUnused();
+			if(m_RepackRequested)
+				Repack();
+
+			// Page writes go through the upload queue, which is submitted ahead of this frame's command buffers
+			// and after the frames that sampled the old contents
+			for(u32 i = 0; i < m_Pages.size(); i++)
+			{
+				Page& page = m_Pages[i];
+				if(!page.dirty)
+					continue;
+
+				if(!page.texture)
+					page.texture = Texture2D::CreateFromSource(m_PageSize, m_PageSize, page.pixels.data());
+				else
+					page.texture->SetData(page.pixels.data());
+
+				page.dirty = false;
+				for(auto& [path, image] : m_Images)
+				{
+					if(image.page == i)
+						image.uploaded = true;
+				}
+			}
+		}
+
+		bool TextureAtlas::Place(u32 width, u32 height, u32& page, i32& x, i32& y)
+		{
+			const int paddedWidth = static_cast<int>(width + m_Padding * 2);
+			const int paddedHeight = static_cast<int>(height + m_Padding * 2);
+
+			page = ~0u;
+			for(u32 i = 0; i < m_Pages.size(); i++)
+			{
+				if(m_Pages[i].allocator.Allocate(paddedWidth, paddedHeight, x, y))
+				{
+					page = i;
+					break;
+				}
+			}
+
+			if(page == ~0u)
+			{
+				Page newPage;
+				newPage.allocator.Reset(m_PageSize, m_PageSize, m_PageSize, m_PageSize, false);
+				newPage.pixels.resize(size_t(m_PageSize) * m_PageSize * ATLAS_BYTES_PER_PIXEL, 0);
+				if(!newPage.allocator.Allocate(paddedWidth, paddedHeight, x, y))
+					return false;
+
+				page = static_cast<u32>(m_Pages.size());
+				m_Pages.push_back(std::move(newPage));
+			}
+
+			x += m_Padding;
+			y += m_Padding;
+			m_Pages[page].usedArea += paddedWidth * paddedHeight;
+			m_Pages[page].imageCount++;
+			return true;
+		}
+
+		void TextureAtlas::Blit(Page& page, i32 x, i32 y, u32 width, u32 height, const u8* pixels, u32 sourceRowPitch)
+		{
+			const u32 pageRowPitch = m_PageSize * ATLAS_BYTES_PER_PIXEL;
+			const u32 rowSize = width * ATLAS_BYTES_PER_PIXEL;
+			const i32 padding = static_cast<i32>(m_Padding);
+
+			for(u32 row = 0; row < height; row++)
+			{
+				u8* dst = &page.pixels[(y + row) * pageRowPitch + x * ATLAS_BYTES_PER_PIXEL];
+				memcpy(dst, pixels + row * sourceRowPitch, rowSize);
+
+				// Extend the first and last pixels of the row into the padding
+				for(i32 i = 1; i <= padding; i++)
+				{
+					memcpy(dst - i * ATLAS_BYTES_PER_PIXEL, dst, ATLAS_BYTES_PER_PIXEL);
+					memcpy(dst + rowSize + (i - 1) * ATLAS_BYTES_PER_PIXEL, dst + rowSize - ATLAS_BYTES_PER_PIXEL, ATLAS_BYTES_PER_PIXEL);
+				}
+			}
+
+			// Then the first and last rows, padding included, which also fills the corners
+			const u32 paddedRowSize = (width + m_Padding * 2) * ATLAS_BYTES_PER_PIXEL;
+			const u8* firstRow = &page.pixels[y * pageRowPitch + (x - padding) * ATLAS_BYTES_PER_PIXEL];
+			const u8* lastRow = &page.pixels[(y + height - 1) * pageRowPitch + (x - padding) * ATLAS_BYTES_PER_PIXEL];
+			for(i32 i = 1; i <= padding; i++)
+			{
+				memcpy(&page.pixels[(y - i) * pageRowPitch + (x - padding) * ATLAS_BYTES_PER_PIXEL], firstRow, paddedRowSize);
+				memcpy(&page.pixels[(y + height - 1 + i) * pageRowPitch + (x - padding) * ATLAS_BYTES_PER_PIXEL], lastRow, paddedRowSize);
+			}
+
+			page.dirty = true;
+		}
+
+		void TextureAtlas::EvictUnused()
+		{
+			bool evicted = false;
+			for(auto it = m_Images.begin(); it != m_Images.end();)
+			{
+				const Image& image = it->second;
+				if(m_Frame - image.lastUsedFrame > ATLAS_EVICT_FRAMES)
+				{
+					Page& page = m_Pages[image.page];
+					page.usedArea -= (image.width + m_Padding * 2) * (image.height + m_Padding * 2);
+					page.imageCount--;
+					it = m_Images.erase(it);
+					evicted = true;
+				}
+				else
+					++it;
+			}
+
+			if(!evicted)
+				return;
+
+			// The allocator cannot free single images, their space only comes back when the pages are repacked
+			u64 usedArea = 0;
+			for(auto& page : m_Pages)
+			{
+				usedArea += page.usedArea;
+				if(page.imageCount == 0)
+					m_RepackRequested = true;
+			}
+
+			const u64 pageArea = u64(m_PageSize) * m_PageSize;
+			if(usedArea * 2 < pageArea * m_Pages.size())
+				m_RepackRequested = true;
+		}
+
+		void TextureAtlas::Repack()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			m_RepackRequested = false;
+
+			std::vector<Page> oldPages;
+			oldPages.swap(m_Pages);
+
+			// Tallest first packs tighter
+			std::vector<Image*> images;
+			images.reserve(m_Images.size());
+			for(auto& [path, image] : m_Images)
+				images.push_back(&image);
+			std::sort(images.begin(), images.end(), [](const Image* a, const Image* b) {
+				return a->height != b->height ? a->height > b->height : a->width > b->width;
+			});
+
+			const u32 pageRowPitch = m_PageSize * ATLAS_BYTES_PER_PIXEL;
+			for(auto image : images)
+			{
+				const u8* source = &oldPages[image->page].pixels[image->y * pageRowPitch + image->x * ATLAS_BYTES_PER_PIXEL];
+
+				// Every image fitted in an empty page before, so it always finds a place
+				u32 page;
+				i32 x, y;
+				Place(image->width, image->height, page, x, y);
+				Blit(m_Pages[page], x, y, image->width, image->height, source, pageRowPitch);
+
+				image->page = page;
+				image->x = x;
+				image->y = y;
+				image->uploaded = false;
+			}
+
+			// Textures defer destroying their images until pending uploads to them have finished
+			for(auto& page : oldPages)
+				delete page.texture;
+
+			LUMOS_LOG_INFO("Texture atlas repacked {0} images from {1} pages into {2}", images.size(), oldPages.size(), m_Pages.size());
+		}
+
+		void TextureAtlas::OnImGui()
+		{
+			ImGui::Text("Images %u, Rejected %u", GetImageCount(), static_cast<u32>(m_Rejected.size()));
+
+			const float pageArea = static_cast<float>(m_PageSize) * static_cast<float>(m_PageSize);
+			for(u32 i = 0; i < m_Pages.size(); i++)
+				ImGui::BulletText("Page %u : %u images, %.0f%% used", i, m_Pages[i].imageCount, 100.0f * m_Pages[i].usedArea / pageArea);
+
+			if(ImGui::Button("Defragment"))
+				Defragment();
+		}
+	}
+}
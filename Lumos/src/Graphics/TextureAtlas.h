@@ -0,0 +1,94 @@
+#pragma once
+#include "Maths/AreaAllocator.h"
+#include "Maths/Maths.h"
+
+#include <unordered_set>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class Texture2D;
+
+		// Packs small sprite textures into a few large pages so 2D batches bind pages instead of one texture per sprite.
+		// Textures are found by the file they were loaded from, packed when first seen and uploaded on the next Update.
+		// Each image is surrounded by padding filled with its own edge pixels, so filtering and the first mips do not
+		// bleed in neighbouring images. Images that are not used for a while are dropped, and pages are repacked once
+		// that leaves one of them empty or most of their space unused
+		class LUMOS_EXPORT TextureAtlas
+		{
+		public:
+			struct Region
+			{
+				u32 page = 0;
+				Maths::Vector2 uvMin;
+				Maths::Vector2 uvMax;
+			};
+
+			TextureAtlas(u32 pageSize = 2048, u32 maxImageSize = 512, u32 padding = 2);
+			~TextureAtlas();
+
+			// Packs the image the texture was loaded from. Returns false when the texture cannot go in the atlas
+			bool Add(const Texture2D* texture);
+
+			// Finds where the texture was packed, packing it if it has not been seen yet. Returns false until the page
+			// holding it has been uploaded, the texture should be used on its own until then
+			bool Find(const Texture2D* texture, Region& region);
+
+			Texture2D* GetPage(u32 page) const { return m_Pages[page].texture; }
+			u32 GetPageCount() const { return static_cast<u32>(m_Pages.size()); }
+			u32 GetImageCount() const { return static_cast<u32>(m_Images.size()); }
+
+			// Uploads pages changed since the last call, evicts images that have not been used and repacks when needed.
+			// Call once per frame, before anything is recorded
+			void Update();
+
+			// Repacks every image into as few pages as possible on the next Update
+			void Defragment() { m_RepackRequested = true; }
+
+			void OnImGui();
+
+		private:
+			struct Page
+			{
+				Maths::AreaAllocator allocator;
+				std::vector<u8> pixels;
+				Texture2D* texture = nullptr;
+				u32 usedArea = 0;
+				u32 imageCount = 0;
+				bool dirty = false;
+			};
+
+			struct Image
+			{
+				u32 page;
+				// Position inside the page, padding excluded
+				i32 x;
+				i32 y;
+				u32 width;
+				u32 height;
+				u64 lastUsedFrame;
+				bool uploaded = false;
+			};
+
+			bool Place(u32 width, u32 height, u32& page, i32& x, i32& y);
+			void Blit(Page& page, i32 x, i32 y, u32 width, u32 height, const u8* pixels, u32 sourceRowPitch);
+			void EvictUnused();
+			void Repack();
+
+			u32 m_PageSize;
+			u32 m_MaxImageSize;
+			u32 m_Padding;
+
+			std::vector<Page> m_Pages;
+			std::unordered_map<std::string, Image> m_Images;
+			// Files that could not be packed, so they are not loaded again every frame
+			std::unordered_set<std::string> m_Rejected;
+
+			// Texture pointers are only stable within a frame, so this is cleared every Update
+			std::unordered_map<const Texture2D*, Image*> m_FrameLookup;
+			u64 m_Frame = 0;
+			bool m_RepackRequested = false;
+		};
+	}
+}
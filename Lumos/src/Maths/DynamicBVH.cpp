@@ -0,0 +1,318 @@
+#include "Precompiled.h"
+#include "Maths/DynamicBVH.h"
+
+namespace Lumos::Maths
+{
+    static BoundingBox Combine(const BoundingBox& a, const BoundingBox& b)
+    {
+        BoundingBox result(a);
+        result.Merge(b);
+        return result;
+    }
+
+    static float SurfaceArea(const BoundingBox& box)
+    {
+        const Vector3 size = box.Size();
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    DynamicBVH::DynamicBVH(float margin) :
+        margin_(margin)
+    {
+    }
+
+    unsigned DynamicBVH::CreateProxy(const BoundingBox& bounds, unsigned userData)
+    {
+        const unsigned proxy = AllocateNode();
+        Node& node = nodes_[proxy];
+        node.bounds_ = BoundingBox(bounds.min_ - Vector3(margin_), bounds.max_ + Vector3(margin_));
+        node.userData_ = userData;
+        node.height_ = 0;
+
+        InsertLeaf(proxy);
+        ++proxyCount_;
+        return proxy;
+    }
+
+    void DynamicBVH::DestroyProxy(unsigned proxy)
+    {
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        --proxyCount_;
+    }
+
+    bool DynamicBVH::MoveProxy(unsigned proxy, const BoundingBox& bounds)
+    {
+        if (nodes_[proxy].bounds_.IsInside(bounds) == INSIDE)
+            return false;
+
+        RemoveLeaf(proxy);
+        nodes_[proxy].bounds_ = BoundingBox(bounds.min_ - Vector3(margin_), bounds.max_ + Vector3(margin_));
+        InsertLeaf(proxy);
+        return true;
+    }
+
+    void DynamicBVH::Clear()
+    {
+        nodes_.clear();
+        root_ = NULL_NODE;
+        freeList_ = NULL_NODE;
+        proxyCount_ = 0;
+    }
+
+    unsigned DynamicBVH::AllocateNode()
+    {
+        if (freeList_ == NULL_NODE)
+        {
+            const unsigned oldSize = static_cast<unsigned>(nodes_.size());
+            const unsigned newSize = Max(16u, oldSize * 2);
+            nodes_.resize(newSize);
+
+            for (unsigned i = oldSize; i < newSize; ++i)
+            {
+                nodes_[i].parent_ = i + 1 < newSize ? i + 1 : NULL_NODE;
+                nodes_[i].height_ = -1;
+            }
+
+            freeList_ = oldSize;
+        }
+
+        const unsigned index = freeList_;
+        Node& node = nodes_[index];
+        freeList_ = node.parent_;
+        node.parent_ = NULL_NODE;
+        node.child1_ = NULL_NODE;
+        node.child2_ = NULL_NODE;
+        node.height_ = 0;
+        node.userData_ = 0;
+        return index;
+    }
+
+    void DynamicBVH::FreeNode(unsigned node)
+    {
+        nodes_[node].parent_ = freeList_;
+        nodes_[node].height_ = -1;
+        freeList_ = node;
+    }
+
+    void DynamicBVH::InsertLeaf(unsigned leaf)
+    {
+        if (root_ == NULL_NODE)
+        {
+            root_ = leaf;
+            nodes_[leaf].parent_ = NULL_NODE;
+            return;
+        }
+
+        // Walk down choosing the child with the lowest surface area cost
+        const BoundingBox leafBounds = nodes_[leaf].bounds_;
+        unsigned index = root_;
+        while (!nodes_[index].IsLeaf())
+        {
+            const Node& node = nodes_[index];
+            const float area = SurfaceArea(node.bounds_);
+            const float combinedArea = SurfaceArea(Combine(node.bounds_, leafBounds));
+
+            // Cost of making a new parent for this node and the leaf
+            const float cost = 2.0f * combinedArea;
+            // Minimum cost of pushing the leaf further down
+            const float inheritanceCost = 2.0f * (combinedArea - area);
+
+            float childCosts[2];
+            const unsigned children[2] = { node.child1_, node.child2_ };
+            for (unsigned i = 0; i < 2; ++i)
+            {
+                const Node& child = nodes_[children[i]];
+                const float childArea = SurfaceArea(Combine(child.bounds_, leafBounds));
+                childCosts[i] = (child.IsLeaf() ? childArea : childArea - SurfaceArea(child.bounds_)) + inheritanceCost;
+            }
+
+            if (cost < childCosts[0] && cost < childCosts[1])
+                break;
+
+            index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+        }
+
+        const unsigned sibling = index;
+        const unsigned oldParent = nodes_[sibling].parent_;
+        const unsigned newParent = AllocateNode();
+
+        Node& parent = nodes_[newParent];
+        parent.parent_ = oldParent;
+        parent.bounds_ = Combine(leafBounds, nodes_[sibling].bounds_);
+        parent.height_ = nodes_[sibling].height_ + 1;
+        parent.child1_ = sibling;
+        parent.child2_ = leaf;
+
+        if (oldParent != NULL_NODE)
+        {
+            if (nodes_[oldParent].child1_ == sibling)
+                nodes_[oldParent].child1_ = newParent;
+            else
+                nodes_[oldParent].child2_ = newParent;
+        }
+        else
+            root_ = newParent;
+
+        nodes_[sibling].parent_ = newParent;
+        nodes_[leaf].parent_ = newParent;
+
+        Refit(newParent);
+    }
+
+    void DynamicBVH::RemoveLeaf(unsigned leaf)
+    {
+        if (leaf == root_)
+        {
+            root_ = NULL_NODE;
+            return;
+        }
+
+        const unsigned parent = nodes_[leaf].parent_;
+        const unsigned grandParent = nodes_[parent].parent_;
+        const unsigned sibling = nodes_[parent].child1_ == leaf ? nodes_[parent].child2_ : nodes_[parent].child1_;
+
+        if (grandParent != NULL_NODE)
+        {
+            if (nodes_[grandParent].child1_ == parent)
+                nodes_[grandParent].child1_ = sibling;
+            else
+                nodes_[grandParent].child2_ = sibling;
+
+            nodes_[sibling].parent_ = grandParent;
+            FreeNode(parent);
+            Refit(grandParent);
+        }
+        else
+        {
+            root_ = sibling;
+            nodes_[sibling].parent_ = NULL_NODE;
+            FreeNode(parent);
+        }
+    }
+
+    void DynamicBVH::Refit(unsigned node)
+    {
+        unsigned index = node;
+        while (index != NULL_NODE)
+        {
+            index = Balance(index);
+
+            Node& current = nodes_[index];
+            const Node& child1 = nodes_[current.child1_];
+            const Node& child2 = nodes_[current.child2_];
+            current.height_ = 1 + Max(child1.height_, child2.height_);
+            current.bounds_ = Combine(child1.bounds_, child2.bounds_);
+
+            index = current.parent_;
+        }
+    }
+
+    unsigned DynamicBVH::Balance(unsigned iA)
+    {
+        Node* A = &nodes_[iA];
+        if (A->IsLeaf() || A->height_ < 2)
+            return iA;
+
+        const unsigned iB = A->child1_;
+        const unsigned iC = A->child2_;
+        Node* B = &nodes_[iB];
+        Node* C = &nodes_[iC];
+
+        const int balance = C->height_ - B->height_;
+
+        // Rotate C up
+        if (balance > 1)
+        {
+            const unsigned iF = C->child1_;
+            const unsigned iG = C->child2_;
+            Node* F = &nodes_[iF];
+            Node* G = &nodes_[iG];
+
+            C->child1_ = iA;
+            C->parent_ = A->parent_;
+            A->parent_ = iC;
+
+            if (C->parent_ != NULL_NODE)
+            {
+                if (nodes_[C->parent_].child1_ == iA)
+                    nodes_[C->parent_].child1_ = iC;
+                else
+                    nodes_[C->parent_].child2_ = iC;
+            }
+            else
+                root_ = iC;
+
+            if (F->height_ > G->height_)
+            {
+                C->child2_ = iF;
+                A->child2_ = iG;
+                G->parent_ = iA;
+                A->bounds_ = Combine(B->bounds_, G->bounds_);
+                C->bounds_ = Combine(A->bounds_, F->bounds_);
+                A->height_ = 1 + Max(B->height_, G->height_);
+                C->height_ = 1 + Max(A->height_, F->height_);
+            }
+            else
+            {
+                C->child2_ = iG;
+                A->child2_ = iF;
+                F->parent_ = iA;
+                A->bounds_ = Combine(B->bounds_, F->bounds_);
+                C->bounds_ = Combine(A->bounds_, G->bounds_);
+                A->height_ = 1 + Max(B->height_, F->height_);
+                C->height_ = 1 + Max(A->height_, G->height_);
+            }
+
+            return iC;
+        }
+
+        // Rotate B up
+        if (balance < -1)
+        {
+            const unsigned iD = B->child1_;
+            const unsigned iE = B->child2_;
+            Node* D = &nodes_[iD];
+            Node* E = &nodes_[iE];
+
+            B->child1_ = iA;
+            B->parent_ = A->parent_;
+            A->parent_ = iB;
+
+            if (B->parent_ != NULL_NODE)
+            {
+                if (nodes_[B->parent_].child1_ == iA)
+                    nodes_[B->parent_].child1_ = iB;
+                else
+                    nodes_[B->parent_].child2_ = iB;
+            }
+            else
+                root_ = iB;
+
+            if (D->height_ > E->height_)
+            {
+                B->child2_ = iD;
+                A->child1_ = iE;
+                E->parent_ = iA;
+                A->bounds_ = Combine(C->bounds_, E->bounds_);
+                B->bounds_ = Combine(A->bounds_, D->bounds_);
+                A->height_ = 1 + Max(C->height_, E->height_);
+                B->height_ = 1 + Max(A->height_, D->height_);
+            }
+            else
+            {
+                B->child2_ = iE;
+                A->child1_ = iD;
+                D->parent_ = iA;
+                A->bounds_ = Combine(C->bounds_, D->bounds_);
+                B->bounds_ = Combine(A->bounds_, E->bounds_);
+                A->height_ = 1 + Max(C->height_, D->height_);
+                B->height_ = 1 + Max(A->height_, E->height_);
+            }
+
+            return iB;
+        }
+
+        return iA;
+    }
+}
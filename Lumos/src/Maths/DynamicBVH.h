@@ -0,0 +1,185 @@
+#pragma once
+#include "Maths/BoundingBox.h"
+#include "Maths/Frustum.h"
+#include "Maths/Ray.h"
+
+namespace Lumos::Maths
+{
+    /// Dynamic bounding volume hierarchy of axis-aligned boxes.
+    /// Leaves store bounds enlarged by a margin, so small moves do not need a reinsert. The tree is kept balanced with rotations.
+    class  DynamicBVH
+    {
+    public:
+        static constexpr unsigned NULL_NODE = ~0u;
+
+        /// Construct with the margin added on every side of a leaf's bounds.
+        explicit DynamicBVH(float margin = 0.1f);
+
+        /// Insert a leaf. Return the proxy used to move or destroy it.
+        unsigned CreateProxy(const BoundingBox& bounds, unsigned userData);
+        /// Remove a leaf.
+        void DestroyProxy(unsigned proxy);
+        /// Update a leaf's bounds. Return true if it had to be reinserted because the bounds left its enlarged bounds.
+        bool MoveProxy(unsigned proxy, const BoundingBox& bounds);
+        /// Remove all leaves.
+        void Clear();
+
+        /// Return user data of a leaf.
+        unsigned GetUserData(unsigned proxy) const { return nodes_[proxy].userData_; }
+        /// Set user data of a leaf.
+        void SetUserData(unsigned proxy, unsigned userData) { nodes_[proxy].userData_ = userData; }
+        /// Return the enlarged bounds of a leaf.
+        const BoundingBox& GetFatBounds(unsigned proxy) const { return nodes_[proxy].bounds_; }
+
+        /// Return number of leaves.
+        unsigned GetProxyCount() const { return proxyCount_; }
+        /// Return number of allocated nodes. Proxies are always less than this.
+        unsigned GetNodeCapacity() const { return static_cast<unsigned>(nodes_.size()); }
+        /// Return height of the tree, zero when empty or a single leaf.
+        int GetHeight() const { return root_ == NULL_NODE ? 0 : nodes_[root_].height_; }
+
+        /// Call callback(proxy, inside) for each leaf whose enlarged bounds touch the frustum.
+        /// Subtrees fully inside the frustum are accepted without further plane tests and report inside as true.
+        template<typename Callback> void Query(const Frustum& frustum, Callback&& callback) const
+        {
+            if (root_ == NULL_NODE)
+                return;
+
+            // The top bit of a stack entry marks a subtree already known to be inside
+            const unsigned acceptBit = 1u << 31;
+            std::vector<unsigned> stack;
+            stack.reserve(64);
+            stack.push_back(root_);
+
+            while (!stack.empty())
+            {
+                const unsigned entry = stack.back();
+                stack.pop_back();
+
+                const unsigned nodeIndex = entry & ~acceptBit;
+                const Node& node = nodes_[nodeIndex];
+                bool inside = (entry & acceptBit) != 0;
+
+                if (!inside)
+                {
+                    const Intersection result = frustum.IsInside(node.bounds_);
+                    if (result == OUTSIDE)
+                        continue;
+
+                    inside = result == INSIDE;
+                }
+
+                if (node.IsLeaf())
+                {
+                    callback(nodeIndex, inside);
+                    continue;
+                }
+
+                const unsigned flag = inside ? acceptBit : 0u;
+                stack.push_back(node.child1_ | flag);
+                stack.push_back(node.child2_ | flag);
+            }
+        }
+
+        /// Call callback(proxy) for each leaf whose enlarged bounds overlap the box.
+        template<typename Callback> void Query(const BoundingBox& bounds, Callback&& callback) const
+        {
+            if (root_ == NULL_NODE)
+                return;
+
+            std::vector<unsigned> stack;
+            stack.reserve(64);
+            stack.push_back(root_);
+
+            while (!stack.empty())
+            {
+                const unsigned nodeIndex = stack.back();
+                stack.pop_back();
+
+                const Node& node = nodes_[nodeIndex];
+                if (bounds.IsInsideFast(node.bounds_) == OUTSIDE)
+                    continue;
+
+                if (node.IsLeaf())
+                    callback(nodeIndex);
+                else
+                {
+                    stack.push_back(node.child1_);
+                    stack.push_back(node.child2_);
+                }
+            }
+        }
+
+        /// Call callback(proxy) for each leaf the ray enters closer than the closest hit so far.
+        /// callback returns the hit distance for that proxy, or M_INFINITY for a miss. Return the closest hit distance.
+        template<typename Callback> float RayCast(const Ray& ray, Callback&& callback) const
+        {
+            float closest = M_INFINITY;
+            if (root_ == NULL_NODE)
+                return closest;
+
+            std::vector<unsigned> stack;
+            stack.reserve(64);
+            stack.push_back(root_);
+
+            while (!stack.empty())
+            {
+                const unsigned nodeIndex = stack.back();
+                stack.pop_back();
+
+                const Node& node = nodes_[nodeIndex];
+                if (ray.HitDistance(node.bounds_) >= closest)
+                    continue;
+
+                if (node.IsLeaf())
+                    closest = Min(closest, callback(nodeIndex));
+                else
+                {
+                    stack.push_back(node.child1_);
+                    stack.push_back(node.child2_);
+                }
+            }
+
+            return closest;
+        }
+
+    private:
+        struct Node
+        {
+            bool IsLeaf() const { return child1_ == NULL_NODE; }
+
+            BoundingBox bounds_;
+            /// Parent node, or next free node while on the free list.
+            unsigned parent_{NULL_NODE};
+            unsigned child1_{NULL_NODE};
+            unsigned child2_{NULL_NODE};
+            /// Leaf is 0, free node is -1.
+            int height_{-1};
+            unsigned userData_{0};
+        };
+
+        /// Take a node from the free list, growing the pool when empty.
+        unsigned AllocateNode();
+        /// Return a node to the free list.
+        void FreeNode(unsigned node);
+        /// Insert a leaf next to the sibling giving the lowest surface area cost.
+        void InsertLeaf(unsigned leaf);
+        /// Detach a leaf and remove its parent.
+        void RemoveLeaf(unsigned leaf);
+        /// Refit bounds and heights from a node up to the root, rotating unbalanced nodes.
+        void Refit(unsigned node);
+        /// Rotate a child up if the subtree is unbalanced. Return the index of the subtree root.
+        unsigned Balance(unsigned node);
+
+        /// Node pool.
+        std::vector<Node> nodes_;
+        /// Root node.
+        unsigned root_{NULL_NODE};
+        /// Head of the free node list.
+        unsigned freeList_{NULL_NODE};
+        /// Number of leaves.
+        unsigned proxyCount_{0};
+        /// Margin added to leaf bounds.
+        float margin_;
+    };
+}
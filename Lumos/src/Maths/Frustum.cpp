@@ -198,6 +198,105 @@ namespace Lumos::Maths
         return rect;
     }
 
+    void Frustum::IsInsideFast(const float* centreX, const float* centreY, const float* centreZ,
+        const float* extentX, const float* extentY, const float* extentZ, unsigned count, unsigned* visibility) const
+    {
+        memset(visibility, 0, sizeof(unsigned) * ((count + 31) / 32));
+        unsigned i = 0;
+
+        // A box is outside when dist + absDist < 0 for any plane, lanes are only rejected once all planes are tested
+    #ifdef LUMOS_SSE
+        const __m128 zero = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 cx = _mm_loadu_ps(centreX + i);
+            const __m128 cy = _mm_loadu_ps(centreY + i);
+            const __m128 cz = _mm_loadu_ps(centreZ + i);
+            const __m128 ex = _mm_loadu_ps(extentX + i);
+            const __m128 ey = _mm_loadu_ps(extentY + i);
+            const __m128 ez = _mm_loadu_ps(extentZ + i);
+            __m128 outside = zero;
+
+            for (const auto& plane : planes_)
+            {
+                __m128 dist = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal_.x), cx), _mm_set1_ps(plane.d_));
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.normal_.y), cy));
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.normal_.z), cz));
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.absNormal_.x), ex));
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.absNormal_.y), ey));
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.absNormal_.z), ez));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, zero));
+            }
+
+            visibility[i >> 5] |= (~unsigned(_mm_movemask_ps(outside)) & 0xFu) << (i & 31);
+        }
+    #endif
+
+        for (; i < count; ++i)
+        {
+            bool inside = true;
+            for (const auto& plane : planes_)
+            {
+                float dist = plane.normal_.x * centreX[i] + plane.normal_.y * centreY[i] + plane.normal_.z * centreZ[i] + plane.d_;
+                float absDist = plane.absNormal_.x * extentX[i] + plane.absNormal_.y * extentY[i] + plane.absNormal_.z * extentZ[i];
+
+                if (dist < -absDist)
+                {
+                    inside = false;
+                    break;
+                }
+            }
+
+            if (inside)
+                visibility[i >> 5] |= 1u << (i & 31);
+        }
+    }
+
+    void Frustum::IsInsideFast(const float* centreX, const float* centreY, const float* centreZ,
+        const float* radius, unsigned count, unsigned* visibility) const
+    {
+        memset(visibility, 0, sizeof(unsigned) * ((count + 31) / 32));
+        unsigned i = 0;
+
+    #ifdef LUMOS_SSE
+        const __m128 zero = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 cx = _mm_loadu_ps(centreX + i);
+            const __m128 cy = _mm_loadu_ps(centreY + i);
+            const __m128 cz = _mm_loadu_ps(centreZ + i);
+            const __m128 r = _mm_loadu_ps(radius + i);
+            __m128 outside = zero;
+
+            for (const auto& plane : planes_)
+            {
+                __m128 dist = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal_.x), cx), _mm_set1_ps(plane.d_));
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.normal_.y), cy));
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.normal_.z), cz));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, r), zero));
+            }
+
+            visibility[i >> 5] |= (~unsigned(_mm_movemask_ps(outside)) & 0xFu) << (i & 31);
+        }
+    #endif
+
+        for (; i < count; ++i)
+        {
+            bool inside = true;
+            for (const auto& plane : planes_)
+            {
+                if (plane.Distance(Vector3(centreX[i], centreY[i], centreZ[i])) < -radius[i])
+                {
+                    inside = false;
+                    break;
+                }
+            }
+
+            if (inside)
+                visibility[i >> 5] |= 1u << (i & 31);
+        }
+    }
+
     void Frustum::UpdatePlanes()
     {
         planes_[PLANE_NEAR].Define(vertices_[2], vertices_[1], vertices_[0]);
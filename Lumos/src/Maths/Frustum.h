@@ -143,6 +143,15 @@ namespace Lumos::Maths
             return distance;
         }
 
+        /// Test count boxes given as SoA centre and half extent arrays, 4 at a time with SSE.
+        /// Bit i of visibility is set when box i is (partially) inside. visibility needs (count + 31) / 32 words.
+        void IsInsideFast(const float* centreX, const float* centreY, const float* centreZ,
+            const float* extentX, const float* extentY, const float* extentZ, unsigned count, unsigned* visibility) const;
+
+        /// Test count spheres given as SoA centre and radius arrays. Writes the same bitmask as the box variant.
+        void IsInsideFast(const float* centreX, const float* centreY, const float* centreZ,
+            const float* radius, unsigned count, unsigned* visibility) const;
+
         /// Return transformed by a 3x3 matrix.
         Frustum Transformed(const Matrix3& transform) const;
         /// Return transformed by a 3x4 matrix.
@@ -3,6 +3,8 @@
 #include "RigidBody2D.h"
 
 #include "Utilities/TimeStep.h"
+#include "Core/JobSystem.h"
+#include "Core/Engine.h"
  
 #include "Scene/Component/Physics2DComponent.h"
 
@@ -74,22 +76,47 @@ namespace Lumos
 			else
 				m_B2DWorld->Step(m_UpdateTimestep, 6, 2);
 
-			auto& registry = scene->GetRegistry();
+			SyncTransforms(scene);
+		}
+	}
 
-			auto group = registry.group<Physics2DComponent>(entt::get<Maths::Transform>);
+	void B2PhysicsEngine::SyncTransforms(Scene* scene)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		auto& registry = scene->GetRegistry();
 
-			for(auto entity : group)
-			{
-				const auto& [phys, trans] = group.get<Physics2DComponent, Maths::Transform>(entity);
+		auto group = registry.group<Physics2DComponent>(entt::get<Maths::Transform>);
 
-				// if (!phys.GetRigidBody()->GetB2Body()->IsAwake())
-				//     break;
+		// Physics2DComponent is owned by the group, so the entities are packed and can be split by index
+		const entt::entity* entities = group.data();
+		std::atomic<u32> synced = 0;
 
-				trans.SetLocalPosition(Maths::Vector3(phys.GetRigidBody()->GetPosition(), 0.0f));
-				trans.SetLocalOrientation(Maths::Quaternion::EulerAnglesToQuaternion(0.0f, 0.0f, phys.GetRigidBody()->GetAngle() * Maths::M_RADTODEG));
-				trans.SetWorldMatrix(Maths::Matrix4()); // temp
-			};
-		}
+		System::JobSystem::Context ctx;
+		System::JobSystem::Dispatch(ctx, static_cast<u32>(group.size()), 256, [&](JobDispatchArgs args) {
+			const auto entity = entities[args.jobIndex];
+			auto& phys = group.get<Physics2DComponent>(entity);
+			RigidBody2D* rigidBody = phys.GetRigidBodyRaw();
+			b2Body* body = rigidBody->GetB2Body();
+
+			// Sleeping bodies have not moved since their last sync, leave the transform clean
+			if(!body || (!rigidBody->GetTransformDirty() && (!body->IsAwake() || body->GetType() == b2_staticBody)))
+				return;
+
+			auto& trans = group.get<Maths::Transform>(entity);
+			const b2Vec2& position = body->GetPosition();
+
+			trans.SetLocalPosition(Maths::Vector3(position.x, position.y, 0.0f));
+			trans.SetLocalOrientation(Maths::Quaternion::EulerAnglesToQuaternion(0.0f, 0.0f, body->GetAngle() * Maths::M_RADTODEG));
+			trans.SetWorldMatrix(Maths::Matrix4()); // temp
+
+			rigidBody->SetTransformDirty(false);
+			synced.fetch_add(1, std::memory_order_relaxed);
+		});
+
+		System::JobSystem::Wait(ctx);
+
+		m_BodiesSynced = synced.load();
+		Engine::Get().Statistics().NumPhysics2DBodiesSynced = m_BodiesSynced;
 	}
 
 	void B2PhysicsEngine::OnImGui()
@@ -116,6 +143,14 @@ namespace Lumos
 		ImGui::PopItemWidth();
 		ImGui::NextColumn();
 
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Bodies Synced");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		ImGui::Text("%5.2u", m_BodiesSynced);
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+
 		ImGui::AlignTextToFramePadding();
 		ImGui::TextUnformatted("Paused");
 		ImGui::NextColumn();
@@ -51,7 +51,15 @@ namespace Lumos
 
 		void SetContactListener(b2ContactListener* listener);
 
+		u32 GetNumberBodiesSynced() const
+		{
+			return m_BodiesSynced;
+		}
+
 	private:
+		// Writes the body positions back to their transforms, skipping sleeping and static bodies
+		void SyncTransforms(Scene* scene);
+
 		UniqueRef<b2World> m_B2DWorld;
 		UniqueRef<B2DebugDraw> m_DebugDraw;
 
@@ -60,5 +68,6 @@ namespace Lumos
 		bool m_MultipleUpdates = true;
 
 		b2ContactListener* m_Listener;
+		u32 m_BodiesSynced = 0;
 	};
 }
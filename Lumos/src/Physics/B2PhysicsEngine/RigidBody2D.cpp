@@ -46,11 +46,13 @@ namespace Lumos
 	void RigidBody2D::SetPosition(const Maths::Vector2& pos) const
 	{
 		m_B2Body->SetTransform(b2Vec2(pos.x, pos.y), m_B2Body->GetAngle());
+		m_TransformDirty = true;
 	}
 
 	void RigidBody2D::SetOrientation(float angle) const
 	{
 		m_B2Body->SetTransform(m_B2Body->GetPosition(), angle);
+		m_TransformDirty = true;
 	}
 
 	void RigidBody2D::Init(const RigidBodyParameters& params)
@@ -68,6 +70,7 @@ namespace Lumos
 
 		bodyDef.position.Set(params.position.x, params.position.y);
 		m_B2Body = Application::Get().GetSystem<B2PhysicsEngine>()->CreateB2Body(&bodyDef);
+		m_TransformDirty = true;
 
 		if(params.shape == Shape::Circle)
 		{
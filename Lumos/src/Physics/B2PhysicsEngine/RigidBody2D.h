@@ -45,6 +45,10 @@ namespace Lumos
 		float GetAngle() const;
         Shape GetShapeType() const { return m_ShapeType; }
 
+        // True when the body was moved directly and its transform must be synced even if it is asleep or static
+        bool GetTransformDirty() const { return m_TransformDirty; }
+        void SetTransformDirty(bool dirty) const { m_TransformDirty = dirty; }
+
         void SetShape(Shape shape, const std::vector<Maths::Vector2>& customPositions = {} );
 
 
@@ -75,5 +79,6 @@ namespace Lumos
 		float m_Angle;
 		Maths::Vector3 m_Scale;
         std::vector<Maths::Vector2> m_CustomShapePositions;
+        mutable bool m_TransformDirty = true;
 	};
 }
@@ -21,41 +21,45 @@ namespace Lumos
 		m_LocalOnB = Maths::Matrix3::Transpose(m_pObj2->GetOrientation().RotationMatrix()) * r2;
 	}
 
-	void DistanceConstraint::ApplyImpulse()
+	void DistanceConstraint::PreSolverStep(float dt)
 	{
-        LUMOS_PROFILE_FUNCTION();
+		m_ConstraintMass = 0.0f;
 
 		if(m_pObj1->GetInverseMass() + m_pObj2->GetInverseMass() == 0.0f)
 			return;
 
-		Maths::Vector3 r1 = m_pObj1->GetOrientation().RotationMatrix() * m_LocalOnA;
-		Maths::Vector3 r2 = m_pObj2->GetOrientation().RotationMatrix() * m_LocalOnB;
+		m_R1 = m_pObj1->GetOrientation().RotationMatrix() * m_LocalOnA;
+		m_R2 = m_pObj2->GetOrientation().RotationMatrix() * m_LocalOnB;
 
-		Maths::Vector3 globalOnA = r1 + m_pObj1->GetPosition();
-		Maths::Vector3 globalOnB = r2 + m_pObj2->GetPosition();
+		Maths::Vector3 globalOnA = m_R1 + m_pObj1->GetPosition();
+		Maths::Vector3 globalOnB = m_R2 + m_pObj2->GetPosition();
 
 		Maths::Vector3 ab = globalOnB - globalOnA;
-		Maths::Vector3 abn = ab;
-		abn.Normalize();
+		m_Normal = ab;
+		m_Normal.Normalize();
+
+		m_ConstraintMass = (m_pObj1->GetInverseMass() + m_pObj2->GetInverseMass()) + Maths::Vector3::Dot(m_Normal, Maths::Vector3::Cross(m_pObj1->GetInverseInertia() * Maths::Vector3::Cross(m_R1, m_Normal), m_R1) + Maths::Vector3::Cross(m_pObj2->GetInverseInertia() * Maths::Vector3::Cross(m_R2, m_Normal), m_R2));
+
+		float distanceOffset = ab.Length() - m_Distance;
+		float baumgarteScalar = 0.1f;
+		m_Bias = -(baumgarteScalar / dt) * distanceOffset;
+	}
 
-		Maths::Vector3 v0 = m_pObj1->GetLinearVelocity() + Maths::Vector3::Cross(m_pObj1->GetAngularVelocity(), r1);
-		Maths::Vector3 v1 = m_pObj2->GetLinearVelocity() + Maths::Vector3::Cross(m_pObj2->GetAngularVelocity(), r2);
-		float constraintMass = (m_pObj1->GetInverseMass() + m_pObj2->GetInverseMass()) + Maths::Vector3::Dot(abn, Maths::Vector3::Cross(m_pObj1->GetInverseInertia() * Maths::Vector3::Cross(r1, abn), r1) + Maths::Vector3::Cross(m_pObj2->GetInverseInertia() * Maths::Vector3::Cross(r2, abn), r2));
+	void DistanceConstraint::ApplyImpulse()
+	{
+		if(m_ConstraintMass == 0.0f)
+			return;
 
-		float b = 0.0f;
-		{
-			float distanceOffset = ab.Length() - m_Distance;
-			float baumgarteScalar = 0.1f;
-			b = -(baumgarteScalar / LumosPhysicsEngine::GetDeltaTime()) * distanceOffset;
-		}
+		Maths::Vector3 v0 = m_pObj1->GetLinearVelocity() + Maths::Vector3::Cross(m_pObj1->GetAngularVelocity(), m_R1);
+		Maths::Vector3 v1 = m_pObj2->GetLinearVelocity() + Maths::Vector3::Cross(m_pObj2->GetAngularVelocity(), m_R2);
 
-		float jn = -(Maths::Vector3::Dot(v0 - v1, abn) + b) / constraintMass;
+		float jn = -(Maths::Vector3::Dot(v0 - v1, m_Normal) + m_Bias) / m_ConstraintMass;
 
-		m_pObj1->SetLinearVelocity(m_pObj1->GetLinearVelocity() + abn * (jn * m_pObj1->GetInverseMass()));
-		m_pObj2->SetLinearVelocity(m_pObj2->GetLinearVelocity() - abn * (jn * m_pObj2->GetInverseMass()));
+		m_pObj1->SetLinearVelocity(m_pObj1->GetLinearVelocity() + m_Normal * (jn * m_pObj1->GetInverseMass()));
+		m_pObj2->SetLinearVelocity(m_pObj2->GetLinearVelocity() - m_Normal * (jn * m_pObj2->GetInverseMass()));
 
-		m_pObj1->SetAngularVelocity(m_pObj1->GetAngularVelocity() + m_pObj1->GetInverseInertia() * Maths::Vector3::Cross(r1, abn * jn));
-		m_pObj2->SetAngularVelocity(m_pObj2->GetAngularVelocity() - m_pObj2->GetInverseInertia() * Maths::Vector3::Cross(r2, abn * jn));
+		m_pObj1->SetAngularVelocity(m_pObj1->GetAngularVelocity() + m_pObj1->GetInverseInertia() * Maths::Vector3::Cross(m_R1, m_Normal * jn));
+		m_pObj2->SetAngularVelocity(m_pObj2->GetAngularVelocity() - m_pObj2->GetInverseInertia() * Maths::Vector3::Cross(m_R2, m_Normal * jn));
 	}
 
 	void DistanceConstraint::DebugDraw() const
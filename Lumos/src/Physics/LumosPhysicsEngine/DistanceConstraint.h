@@ -10,13 +10,14 @@ namespace Lumos
 
 	class RigidBody3D;
 
-	class LUMOS_EXPORT DistanceConstraint : public Constraint
+	class LUMOS_EXPORT DistanceConstraint final : public Constraint
 	{
 	public:
 		DistanceConstraint(RigidBody3D* obj1, RigidBody3D* obj2, const Maths::Vector3& globalOnA, const Maths::Vector3& globalOnB);
 
-		virtual void ApplyImpulse() override;
-		virtual void DebugDraw() const override;
+		void PreSolverStep(float dt) override;
+		void ApplyImpulse() override;
+		void DebugDraw() const override;
 
 	protected:
 		RigidBody3D* m_pObj1;
@@ -26,5 +27,12 @@ namespace Lumos
 
 		Maths::Vector3 m_LocalOnA;
 		Maths::Vector3 m_LocalOnB;
+
+		// Per step terms, positions do not change during the solver iterations
+		Maths::Vector3 m_R1;
+		Maths::Vector3 m_R2;
+		Maths::Vector3 m_Normal;
+		float m_ConstraintMass = 0.0f;
+		float m_Bias = 0.0f;
 	};
 }
\ No newline at end of file
@@ -6,6 +6,9 @@
 
 #include "Integration.h"
 #include "Constraint.h"
+#include "SpringConstraint.h"
+#include "DistanceConstraint.h"
+#include "WeldConstraint.h"
 #include "Utilities/TimeStep.h"
 #include "Core/JobSystem.h"
  
@@ -45,10 +48,28 @@ namespace Lumos
 		m_IntegrationType = IntegrationType::RUNGE_KUTTA_4;
 	}
 	
+	// Kept in the context of the registry the constraint signals are connected to. Its destructor runs when the
+	// registry is destroyed, so the engine never disconnects from a dangling registry or misses a new one at the same address
+	struct LumosPhysicsEngine::ConstraintRegistryLink
+	{
+		LumosPhysicsEngine* engine;
+
+		~ConstraintRegistryLink()
+		{
+			if(engine)
+				engine->OnConstraintRegistryDestroyed();
+		}
+	};
+
 	LumosPhysicsEngine::~LumosPhysicsEngine()
 	{
+		DisconnectConstraintRegistry();
+
 		m_RigidBodys.clear();
 		m_Constraints.clear();
+		m_SpringConstraints.clear();
+		m_DistanceConstraints.clear();
+		m_WeldConstraints.clear();
 		m_Manifolds.clear();
 		
 		CollisionDetection::Release();
@@ -76,43 +97,11 @@ namespace Lumos
             
             if(m_RigidBodys.empty())
             {
+                m_Constraints.clear();
                 return;
             }
 			
-			{
-				LUMOS_PROFILE_SCOPE("Physics::Get Spring Constraints");
-                m_Constraints.clear();
-                
-                auto viewSpring = registry.view<SpringConstraintComponent>();
-                
-                for(auto entity : viewSpring)
-                {
-                    const auto& constraint = viewSpring.get<SpringConstraintComponent>(entity).GetConstraint();
-                    m_Constraints.push_back(constraint.get());
-				}
-			}
-			
-			{
-				LUMOS_PROFILE_SCOPE("Physics::Get Distance Constraints");
-                auto viewDis = registry.view<DistanceConstraintComponent>();
-                
-                for(auto entity : viewDis)
-                {
-                    const auto& constraint = viewDis.get<DistanceConstraintComponent>(entity).GetConstraint();
-                    m_Constraints.push_back(constraint.get());
-                }
-			}
-			
-			{
-				LUMOS_PROFILE_SCOPE("Physics::Get Weld Constraints");
-                auto viewWeld = registry.view<WeldConstraintComponent>();
-                
-                for(auto entity : viewWeld)
-                {
-                    const auto& constraint = viewWeld.get<WeldConstraintComponent>(entity).GetConstraint();
-                    m_Constraints.push_back(constraint.get());
-				}
-			}
+			SyncConstraintPools(registry);
 			
 			{
 				LUMOS_PROFILE_SCOPE("Physics::UpdatePhysics");
@@ -155,6 +144,114 @@ namespace Lumos
         }
 	}
 	
+	void LumosPhysicsEngine::OnConstraintComponentChanged(entt::registry& registry, entt::entity entity)
+	{
+		m_ConstraintPoolsDirty = true;
+	}
+	
+	void LumosPhysicsEngine::OnConstraintRegistryDestroyed()
+	{
+		// The pools point into the destroyed registry's components
+		m_ConstraintRegistry = nullptr;
+		m_ConstraintPoolsDirty = true;
+		m_SpringConstraints.clear();
+		m_DistanceConstraints.clear();
+		m_WeldConstraints.clear();
+	}
+	
+	void LumosPhysicsEngine::ConnectConstraintRegistry(entt::registry& registry)
+	{
+		DisconnectConstraintRegistry();
+		
+		// Replacing a component swaps its constraint, so updates dirty the pools as well
+		registry.on_construct<SpringConstraintComponent>().connect<&LumosPhysicsEngine::OnConstraintComponentChanged>(*this);
+		registry.on_update<SpringConstraintComponent>().connect<&LumosPhysicsEngine::OnConstraintComponentChanged>(*this);
+		registry.on_destroy<SpringConstraintComponent>().connect<&LumosPhysicsEngine::OnConstraintComponentChanged>(*this);
+		registry.on_construct<DistanceConstraintComponent>().connect<&LumosPhysicsEngine::OnConstraintComponentChanged>(*this);
+		registry.on_update<DistanceConstraintComponent>().connect<&LumosPhysicsEngine::OnConstraintComponentChanged>(*this);
+		registry.on_destroy<DistanceConstraintComponent>().connect<&LumosPhysicsEngine::OnConstraintComponentChanged>(*this);
+		registry.on_construct<WeldConstraintComponent>().connect<&LumosPhysicsEngine::OnConstraintComponentChanged>(*this);
+		registry.on_update<WeldConstraintComponent>().connect<&LumosPhysicsEngine::OnConstraintComponentChanged>(*this);
+		registry.on_destroy<WeldConstraintComponent>().connect<&LumosPhysicsEngine::OnConstraintComponentChanged>(*this);
+		
+		registry.set<ConstraintRegistryLink>(this);
+		m_ConstraintRegistry = &registry;
+		m_ConstraintPoolsDirty = true;
+	}
+	
+	void LumosPhysicsEngine::DisconnectConstraintRegistry()
+	{
+		if(!m_ConstraintRegistry)
+			return;
+		
+		entt::registry& registry = *m_ConstraintRegistry;
+		m_ConstraintRegistry = nullptr;
+		
+		registry.on_construct<SpringConstraintComponent>().disconnect(*this);
+		registry.on_update<SpringConstraintComponent>().disconnect(*this);
+		registry.on_destroy<SpringConstraintComponent>().disconnect(*this);
+		registry.on_construct<DistanceConstraintComponent>().disconnect(*this);
+		registry.on_update<DistanceConstraintComponent>().disconnect(*this);
+		registry.on_destroy<DistanceConstraintComponent>().disconnect(*this);
+		registry.on_construct<WeldConstraintComponent>().disconnect(*this);
+		registry.on_update<WeldConstraintComponent>().disconnect(*this);
+		registry.on_destroy<WeldConstraintComponent>().disconnect(*this);
+		
+		// Detach the link first so removing it does not call back into the engine
+		if(auto* link = registry.try_ctx<ConstraintRegistryLink>())
+		{
+			link->engine = nullptr;
+			registry.unset<ConstraintRegistryLink>();
+		}
+	}
+	
+	void LumosPhysicsEngine::SyncConstraintPools(entt::registry& registry)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		
+		// Signals are connected once per registry, a registry destroyed in the meantime has already cleared the pointer
+		if(m_ConstraintRegistry != &registry)
+			ConnectConstraintRegistry(registry);
+		
+		if(!m_ConstraintPoolsDirty)
+			return;
+		
+		m_ConstraintPoolsDirty = false;
+		
+		m_SpringConstraints.clear();
+		m_SpringConstraints.reserve(registry.size<SpringConstraintComponent>());
+		registry.view<SpringConstraintComponent>().each([&](auto entity, const SpringConstraintComponent& component) {
+			m_SpringConstraints.push_back(component.GetConstraint().get());
+		});
+		
+		m_DistanceConstraints.clear();
+		m_DistanceConstraints.reserve(registry.size<DistanceConstraintComponent>());
+		registry.view<DistanceConstraintComponent>().each([&](auto entity, const DistanceConstraintComponent& component) {
+			m_DistanceConstraints.push_back(component.GetConstraint().get());
+		});
+		
+		m_WeldConstraints.clear();
+		m_WeldConstraints.reserve(registry.size<WeldConstraintComponent>());
+		registry.view<WeldConstraintComponent>().each([&](auto entity, const WeldConstraintComponent& component) {
+			m_WeldConstraints.push_back(component.GetConstraint().get());
+		});
+	}
+	
+	template<typename T>
+	static void PreSolveConstraintPool(const std::vector<T*>& pool, float dt)
+	{
+		for(T* c : pool)
+			c->PreSolverStep(dt);
+	}
+	
+	template<typename T>
+	static void SolveConstraintPool(const std::vector<T*>& pool)
+	{
+		// T is final, so these calls are resolved statically
+		for(T* c : pool)
+			c->ApplyImpulse();
+	}
+	
 	void LumosPhysicsEngine::UpdatePhysics(Scene* scene)
 	{
 		m_Manifolds.clear();
@@ -175,11 +272,12 @@ namespace Lumos
 #ifdef THREAD_RIGID_BODY_UPDATE
         LUMOS_PROFILE_SCOPE("Thread Update Rigid Body");
 
-		System::JobSystem::Dispatch(static_cast<u32>(m_RigidBodys.size()), 4, [&](JobDispatchArgs args) {
+		System::JobSystem::Context ctx;
+		System::JobSystem::Dispatch(ctx, static_cast<u32>(m_RigidBodys.size()), 4, [&](JobDispatchArgs args) {
 										UpdateRigidBody(m_RigidBodys[args.jobIndex]);
 									});
 		
-		System::JobSystem::Wait();
+		System::JobSystem::Wait(ctx);
 #else
         LUMOS_PROFILE_SCOPE("Update Rigid Body");
 
@@ -378,6 +476,10 @@ namespace Lumos
 
             for(Constraint* c : m_Constraints)
                 c->PreSolverStep(s_UpdateTimestep);
+            
+            PreSolveConstraintPool(m_SpringConstraints, s_UpdateTimestep);
+            PreSolveConstraintPool(m_DistanceConstraints, s_UpdateTimestep);
+            PreSolveConstraintPool(m_WeldConstraints, s_UpdateTimestep);
         }
 		
         {
@@ -394,6 +496,10 @@ namespace Lumos
                 {
                     c->ApplyImpulse();
                 }
+                
+                SolveConstraintPool(m_SpringConstraints);
+                SolveConstraintPool(m_DistanceConstraints);
+                SolveConstraintPool(m_WeldConstraints);
             }
         }
 	}
@@ -449,7 +555,7 @@ namespace Lumos
 		ImGui::TextUnformatted("Number Of Constraints");
 		ImGui::NextColumn();
 		ImGui::PushItemWidth(-1);
-		ImGui::Text("%5.2i", static_cast<int>(m_Constraints.size()));
+		ImGui::Text("%5.2i", GetNumberConstraints());
 		ImGui::PopItemWidth();
 		ImGui::NextColumn();
 		
@@ -524,6 +630,17 @@ namespace Lumos
 		{
 			for(Constraint* c : m_Constraints)
 				c->DebugDraw();
+			
+			// Pools may hold destroyed constraints until the next sync
+			if(!m_ConstraintPoolsDirty)
+			{
+				for(SpringConstraint* c : m_SpringConstraints)
+					c->DebugDraw();
+				for(DistanceConstraint* c : m_DistanceConstraints)
+					c->DebugDraw();
+				for(WeldConstraint* c : m_WeldConstraints)
+					c->DebugDraw();
+			}
 		}
 		
 		if(m_BroadphaseDetection && (m_DebugDrawFlags & PhysicsDebugFlags::BROADPHASE))
@@ -36,6 +36,9 @@ namespace Lumos
 	};
 
 	class Constraint;
+	class SpringConstraint;
+	class DistanceConstraint;
+	class WeldConstraint;
 	class TimeStep;
 
 	class LUMOS_EXPORT LumosPhysicsEngine : public ISystem
@@ -46,7 +49,7 @@ namespace Lumos
 
 		void SetDefaults();
 
-		//Add Constraints
+		//Add Constraints. Only kept for the next update, callers add them again every frame
 		void AddConstraint(Constraint* c)
 		{
 			m_Constraints.push_back(c);
@@ -106,6 +109,10 @@ namespace Lumos
 		{
 			return static_cast<int>(m_RigidBodys.size());
 		}
+		int GetNumberConstraints() const
+		{
+			return static_cast<int>(m_Constraints.size() + m_SpringConstraints.size() + m_DistanceConstraints.size() + m_WeldConstraints.size());
+		}
 
 		IntegrationType GetIntegrationType() const
 		{
@@ -147,6 +154,15 @@ namespace Lumos
 		//Solves all engine constraints (constraints and manifolds)
 		void SolveConstraints();
 
+		//Rebuilds the typed constraint pools when constraint components have been added, replaced or removed
+		void SyncConstraintPools(entt::registry& registry);
+		void ConnectConstraintRegistry(entt::registry& registry);
+		void DisconnectConstraintRegistry();
+		void OnConstraintComponentChanged(entt::registry& registry, entt::entity entity);
+		void OnConstraintRegistryDestroyed();
+
+		struct ConstraintRegistryLink;
+
 	protected:
 		bool m_IsPaused;
 		float m_UpdateAccum;
@@ -157,6 +173,13 @@ namespace Lumos
 		std::vector<CollisionPair> m_BroadphaseCollisionPairs;
 
 		std::vector<Constraint*> m_Constraints; // Misc constraints between pairs of objects
+
+		// Typed pools gathered from the constraint components. Solved per type without virtual dispatch
+		std::vector<SpringConstraint*> m_SpringConstraints;
+		std::vector<DistanceConstraint*> m_DistanceConstraints;
+		std::vector<WeldConstraint*> m_WeldConstraints;
+		entt::registry* m_ConstraintRegistry = nullptr;
+		bool m_ConstraintPoolsDirty = true;
 		std::vector<Manifold> m_Manifolds; // Contact constraints between pairs of objects
 		std::mutex m_ManifoldsMutex;
 
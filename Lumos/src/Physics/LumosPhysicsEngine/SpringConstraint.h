@@ -6,14 +6,15 @@ namespace Lumos
 {
 	class RigidBody3D;
 
-	class LUMOS_EXPORT SpringConstraint : public Constraint
+	class LUMOS_EXPORT SpringConstraint final : public Constraint
 	{
 	public:
 		SpringConstraint(const Ref<RigidBody3D>& obj1, const Ref<RigidBody3D>& obj2, float springConstant, float dampingFactor);
 		SpringConstraint(const Ref<RigidBody3D>& obj1, const Ref<RigidBody3D>& obj2, const Maths::Vector3& globalOnA, const Maths::Vector3& globalOnB, float springConstant, float dampingFactor);
 
-		virtual void ApplyImpulse() override;
-		virtual void DebugDraw() const override;
+		void PreSolverStep(float dt) override;
+		void ApplyImpulse() override;
+		void DebugDraw() const override;
 
 	protected:
 		Ref<RigidBody3D> m_pObj1;
@@ -26,5 +27,12 @@ namespace Lumos
 
 		Maths::Vector3 m_LocalOnA;
 		Maths::Vector3 m_LocalOnB;
+
+		// Per step terms, positions do not change during the solver iterations
+		Maths::Vector3 m_R1;
+		Maths::Vector3 m_R2;
+		Maths::Vector3 m_Normal;
+		float m_ConstraintMass = 0.0f;
+		float m_Bias = 0.0f;
 	};
 }
\ No newline at end of file
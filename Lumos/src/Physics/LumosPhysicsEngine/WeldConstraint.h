@@ -12,13 +12,13 @@ namespace Lumos
 	class Quaternion;
 	class RigidBody3D;
 
-	class LUMOS_EXPORT WeldConstraint : public Constraint
+	class LUMOS_EXPORT WeldConstraint final : public Constraint
 	{
 	public:
 		WeldConstraint(RigidBody3D* obj1, RigidBody3D* obj2);
 
-		virtual void ApplyImpulse() override;
-		virtual void DebugDraw() const override;
+		void ApplyImpulse() override;
+		void DebugDraw() const override;
 
 	protected:
 		RigidBody3D* m_pObj1;
@@ -12,6 +12,7 @@ namespace Lumos
 			~NoneCommandBuffer();
 
 			bool Init(bool primary) override;
+			bool Init(bool primary, u32 commandPoolIndex) override { return Init(primary); };
 			void Unload() override;
 			void BeginRecording() override;
 			void BeginRecordingSecondary(RenderPass* renderPass, Framebuffer* framebuffer) override;
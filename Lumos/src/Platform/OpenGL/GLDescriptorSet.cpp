@@ -126,6 +126,17 @@ namespace Lumos
                     //buffer->SetData(size, data);
                     auto bufferHandle = static_cast<GLUniformBuffer*>(buffer)->GetHandle();
                     auto slot = bufferInfo.binding;
+
+					if(bufferInfo.type == DescriptorType::STORAGE_BUFFER)
+					{
+						// Storage blocks have their own binding points, separate from uniform blocks
+						LUMOS_PROFILE_SCOPE("glShaderStorageBlockBinding");
+						const auto program = static_cast<GLShader*>(m_Shader)->GetHandleInternal();
+						GLCall(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, slot, bufferHandle, bufferInfo.offset, bufferInfo.size));
+						GLCall(glShaderStorageBlockBinding(program, glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, bufferInfo.name.c_str()), slot));
+						continue;
+					}
+
 					{
 						LUMOS_PROFILE_SCOPE("glBindBufferBase");
 						GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, slot, bufferHandle));
@@ -136,6 +147,12 @@ namespace Lumos
 						LUMOS_PROFILE_SCOPE("glBindBufferRange");
 						GLCall(glBindBufferRange(GL_UNIFORM_BUFFER, slot, bufferHandle, offset, size));
 					}
+					else if(bufferInfo.type == DescriptorType::UNIFORM_BUFFER_DYNAMIC)
+					{
+						// Sub allocated from a shared buffer such as the UniformRingBuffer
+						LUMOS_PROFILE_SCOPE("glBindBufferRange");
+						GLCall(glBindBufferRange(GL_UNIFORM_BUFFER, slot, bufferHandle, offset + m_DynamicOffset + bufferInfo.offset, bufferInfo.size));
+					}
 
 					if (bufferInfo.name != "")
 					{
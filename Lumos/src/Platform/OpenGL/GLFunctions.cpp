@@ -7,6 +7,7 @@
 #include "GLIMGUIRenderer.h"
 #include "GLIndexBuffer.h"
 #include "GLPipeline.h"
+#include "GLQuery.h"
 #include "GLRenderDevice.h"
 #include "GLRenderer.h"
 #include "GLRenderPass.h"
@@ -25,6 +26,7 @@ void Lumos::Graphics::GL::MakeDefault()
 	GLIMGUIRenderer::MakeDefault();
 	GLIndexBuffer::MakeDefault();
 	GLPipeline::MakeDefault();
+	GLQuery::MakeDefault();
 	GLRenderDevice::MakeDefault();
 	GLRenderer::MakeDefault();
 	GLRenderPass::MakeDefault();
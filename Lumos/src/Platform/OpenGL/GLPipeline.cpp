@@ -58,6 +58,7 @@ namespace Lumos
 
 			m_Shader = info.shader;
             m_VertexBufferLayout = pipelineCreateInfo.vertexBufferLayout;
+            m_InstanceBufferLayout = pipelineCreateInfo.instanceBufferLayout;
             return true;
         }
     
@@ -77,6 +78,21 @@ namespace Lumos
             }
         }
     
+        void GLPipeline::BindInstanceArray(u32 offset)
+        {
+            auto& instanceLayout = m_InstanceBufferLayout.GetLayout();
+            u32 count = u32(m_VertexBufferLayout.GetLayout().size());
+
+            for(auto& layout : instanceLayout)
+            {
+                GLCall(glEnableVertexAttribArray(count));
+                size_t attributeOffset = static_cast<size_t>(layout.offset + offset);
+                VertexAtrribPointer(layout.format, count, attributeOffset, m_InstanceBufferLayout.GetStride());
+                GLCall(glVertexAttribDivisor(count, 1));
+                count++;
+            }
+        }
+    
         void GLPipeline::Bind(Graphics::CommandBuffer* cmdBuffer)
         {
             if(m_TransparencyEnabled)
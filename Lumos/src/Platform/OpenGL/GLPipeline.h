@@ -20,6 +20,8 @@ namespace Lumos
             void Bind(Graphics::CommandBuffer* cmdBuffer) override;
             
             void BindVertexArray();
+            // Points the instance attributes at the bound array buffer, offset bytes in
+            void BindInstanceArray(u32 offset);
 			
 			DescriptorSet* GetDescriptorSet() const override { return m_DescriptorSet; }
 			Shader* GetShader() const override { return m_Shader; }
@@ -35,6 +37,7 @@ namespace Lumos
             bool m_TransparencyEnabled = false;
             u32 m_VertexArray = -1;
             BufferLayout m_VertexBufferLayout;
+            BufferLayout m_InstanceBufferLayout;
         };
     }
 }
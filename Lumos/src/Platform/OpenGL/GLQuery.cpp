@@ -13,27 +13,29 @@ namespace Lumos
 			{
 #ifndef LUMOS_PLATFORM_MOBILE
 			case QueryType::SAMPLES_PASSED:	    return GL_SAMPLES_PASSED;
+			case QueryType::TIMESTAMP:	        return GL_TIMESTAMP;
 #endif
 			case QueryType::ANY_SAMPLES_PASSED:	return GL_ANY_SAMPLES_PASSED;
 			}
 			return 0;
 		}
 
-		GLQuery::GLQuery(const QueryType type)
+		GLQuery::GLQuery(const QueryType type, u32 count)
 		{
-			GLCall(glGenQueries(1, &m_Handle));
+			m_Handles.resize(count);
+			GLCall(glGenQueries(count, m_Handles.data()));
 			m_QueryType = QueryTypeToGL(type);
 			m_InUse = false;
 		}
 
 		GLQuery::~GLQuery()
 		{
-			GLCall(glDeleteQueries(1, &m_Handle));
+			GLCall(glDeleteQueries(static_cast<GLsizei>(m_Handles.size()), m_Handles.data()));
 		}
 
 		void GLQuery::Begin()
 		{
-			GLCall(glBeginQuery(m_QueryType, m_Handle));
+			GLCall(glBeginQuery(m_QueryType, m_Handles[0]));
 			m_InUse = true;
 		}
 
@@ -47,15 +49,15 @@ namespace Lumos
 			CreateFunc = CreateFuncGL;
 		}
 
-		Query* GLQuery::CreateFuncGL(QueryType type)
+		Query* GLQuery::CreateFuncGL(QueryType type, u32 count)
 		{
-			return new GLQuery(type);
+			return new GLQuery(type, count);
 		}
 
 		u32 GLQuery::GetResult()
 		{
 			int SamplesPassed = 0;
-			GLCall(glGetQueryObjectiv(m_Handle, GL_QUERY_RESULT, &SamplesPassed));
+			GLCall(glGetQueryObjectiv(m_Handles[0], GL_QUERY_RESULT, &SamplesPassed));
 			m_InUse = false;
 			return static_cast<u32>(SamplesPassed);
 		}
@@ -63,8 +65,36 @@ namespace Lumos
 		bool GLQuery::GetResultReady()
 		{
 			int ResultReady = 0;
-			GLCall(glGetQueryObjectiv(m_Handle, GL_QUERY_RESULT_AVAILABLE, &ResultReady));
+			GLCall(glGetQueryObjectiv(m_Handles[0], GL_QUERY_RESULT_AVAILABLE, &ResultReady));
 			return ResultReady > 0;
 		}
+
+		void GLQuery::WriteTimestamp(CommandBuffer* commandBuffer, u32 index)
+		{
+#ifndef LUMOS_PLATFORM_MOBILE
+			GLCall(glQueryCounter(m_Handles[index], GL_TIMESTAMP));
+#endif
+		}
+
+		bool GLQuery::GetTimestamps(u32 first, u32 count, u64* nanoseconds)
+		{
+#ifndef LUMOS_PLATFORM_MOBILE
+			// Results become available in the order the queries were written
+			int ResultReady = 0;
+			GLCall(glGetQueryObjectiv(m_Handles[first + count - 1], GL_QUERY_RESULT_AVAILABLE, &ResultReady));
+			if(ResultReady == 0)
+				return false;
+
+			for(u32 i = 0; i < count; i++)
+			{
+				GLuint64 timestamp = 0;
+				GLCall(glGetQueryObjectui64v(m_Handles[first + i], GL_QUERY_RESULT, &timestamp));
+				nanoseconds[i] = static_cast<u64>(timestamp);
+			}
+			return true;
+#else
+			return false;
+#endif
+		}
 	}
 }
@@ -9,19 +9,22 @@ namespace Lumos
 		class GLQuery : public Query
 		{
 		public:
-			explicit GLQuery(QueryType type);
+			GLQuery(QueryType type, u32 count);
 			~GLQuery();
 
 			void Begin() override;
 			u32 GetResult() override;
 			bool GetResultReady() override;
 			void End() override;
+
+			void WriteTimestamp(CommandBuffer* commandBuffer, u32 index) override;
+			bool GetTimestamps(u32 first, u32 count, u64* nanoseconds) override;
             
             static void MakeDefault();
         protected:
-            static Query* CreateFuncGL(QueryType type);
+            static Query* CreateFuncGL(QueryType type, u32 count);
 		private:
-			u32 m_Handle;
+			std::vector<u32> m_Handles;
 			u32 m_QueryType;
 		};
 	}
@@ -9,6 +9,8 @@
 #include "GLTools.h"
 #include "Graphics/Mesh.h"
 #include "GLDescriptorSet.h"
+#include "GLShader.h"
+#include "Graphics/API/Pipeline.h"
 #include "Graphics/Material.h"
 
 namespace Lumos
@@ -33,6 +35,16 @@ namespace Lumos
 			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &caps.MaxAnisotropy);
 			glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &caps.MaxTextureUnits);
 			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &caps.UniformBufferOffsetAlignment);
+			glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &caps.MaxUniformBufferRange);
+
+			// The context is 4.1, storage blocks come from the extension
+			caps.SupportsStorageBuffers = GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_shader_storage_buffer_object;
+			if(caps.SupportsStorageBuffers)
+				glGetIntegerv(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &caps.MaxStorageBufferRange);
+
+#ifndef LUMOS_PLATFORM_MOBILE
+			caps.SupportsTimestampQueries = true;
+#endif
 		}
 
 		GLRenderer::~GLRenderer()
@@ -225,6 +237,12 @@ namespace Lumos
 			//GLCall(glDrawArrays(GLTools::DrawTypeToGL(type), start, count));
 		}
 
+		void GLRenderer::DrawIndexedInstancedInternal(CommandBuffer* commandBuffer, const DrawType type, u32 count, u32 instanceCount) const
+		{
+			LUMOS_PROFILE_FUNCTION();
+			GLCall(glDrawElementsInstanced(GLTools::DrawTypeToGL(type), count, GLTools::DataTypeToGL(DataType::UNSIGNED_INT), nullptr, instanceCount));
+		}
+
 		void GLRenderer::BindDescriptorSetsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, u32 dynamicOffset, std::vector<Graphics::DescriptorSet*>& descriptorSets)
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -234,6 +252,14 @@ namespace Lumos
 			}
 		}
 
+		void GLRenderer::PushConstantsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, std::vector<Graphics::PushConstant>& pushConstants)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			auto shader = static_cast<Graphics::GLShader*>(pipeline->GetShader());
+			for(auto& pc : pushConstants)
+				shader->SetUserUniformBuffer(pc.shaderStage, pc.data, pc.size);
+		}
+
 		void GLRenderer::MakeDefault()
 		{
 			CreateFunc = CreateFuncGL;
@@ -31,8 +31,10 @@ namespace Lumos
 			void InitInternal() override;
 
 			void BindDescriptorSetsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, u32 dynamicOffset, std::vector<Graphics::DescriptorSet*>& descriptorSets) override;
+			void PushConstantsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, std::vector<Graphics::PushConstant>& pushConstants) override;
 			void DrawInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, DataType dataType, void* indices) const override;
 			void DrawIndexedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 start) const override;
+			void DrawIndexedInstancedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 instanceCount) const override;
 			void SetRenderModeInternal(RenderMode mode);
 			void OnResize(u32 width, u32 height) override;
 			void PresentInternal() override;
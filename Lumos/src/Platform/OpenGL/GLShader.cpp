@@ -4,6 +4,7 @@
 #include "Platform/OpenGL/GL.h"
 #include "Core/VFS.h"
 #include "Core/OS/FileSystem.h"
+#include "Graphics/API/ShaderReflectionCache.h"
 
 enum root_signature_spaces
 {
@@ -16,10 +17,7 @@ namespace Lumos
 {
 	namespace Graphics
 	{
-		bool IGNORE_LINES = false;
-		static ShaderType s_Type = ShaderType::UNKNOWN;
-
-		GLShader::GLShader(const std::string& filePath, bool loadSPV)
+		GLShader::GLShader(const std::string& filePath, bool loadSPV, bool deferred)
 			: m_LoadSPV(loadSPV)
 		{
             m_Name = StringUtilities::GetFileName(filePath);
@@ -27,7 +25,9 @@ namespace Lumos
 
 			m_Source = VFS::Get()->ReadTextFile(filePath);
 
-			Init();
+			Load();
+			if(!deferred)
+				CompleteLoading();
 		}
 
 		GLShader::~GLShader()
@@ -58,85 +58,32 @@ namespace Lumos
 			}
 		}
 
-		void GLShader::Init()
+		void GLShader::Load()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			std::map<ShaderType, std::string>* sources = new std::map<ShaderType, std::string>();
+			std::map<ShaderType, std::string>* sources = &m_PendingSources;
 			PreProcess(m_Source, sources);
 
 			for(auto& file : *sources)
 			{
 				auto fileSize = FileSystem::GetFileSize(m_Path + file.second); //TODO: once process
 				u32* source = reinterpret_cast<u32*>(FileSystem::ReadFile(m_Path + file.second));
-				std::vector<unsigned int> spv(source, source + fileSize / sizeof(unsigned int));
-
-				spirv_cross::CompilerGLSL* glsl = new spirv_cross::CompilerGLSL(std::move(spv));
 
-				// The SPIR-V is now parsed, and we can perform reflection on it.
-				spirv_cross::ShaderResources resources = glsl->get_shader_resources();
+				// The GLSL and uniform block names are read from the cache, SPIRV-Cross only runs when the SPIR-V changed
+				const std::string cachePath = ShaderReflectionCache::GetFilePath(m_Path + file.second, ".glreflect");
+				const u64 hash = ShaderReflectionCache::HashSource(source, fileSize);
 
-				// Get all sampled images in the shader.
-				for(auto& resource : resources.sampled_images)
+				ShaderReflection reflection;
+				if(!ShaderReflectionCache::Load(cachePath, hash, reflection))
 				{
-					unsigned set = glsl->get_decoration(resource.id, spv::DecorationDescriptorSet);
-					unsigned binding = glsl->get_decoration(resource.id, spv::DecorationBinding);
-
-					// Modify the decoration to prepare it for GLSL.
-					glsl->unset_decoration(resource.id, spv::DecorationDescriptorSet);
-
-					// Some arbitrary remapping if we want.
-					glsl->set_decoration(resource.id, spv::DecorationBinding, set * 16 + binding);
+					CrossCompile(source, u32(fileSize), reflection);
+					ShaderReflectionCache::Save(cachePath, hash, reflection);
 				}
 
-				for(auto const& image : resources.separate_images)
-				{
-					auto set{glsl->get_decoration(image.id, spv::Decoration::DecorationDescriptorSet)};
-					glsl->set_decoration(image.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set);
-				}
-				for(auto const& input : resources.subpass_inputs)
-				{
-					auto set{glsl->get_decoration(input.id, spv::Decoration::DecorationDescriptorSet)};
-					glsl->set_decoration(input.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set);
-				}
-				for(auto const& uniform_buffer : resources.uniform_buffers)
-				{
-					auto set{glsl->get_decoration(uniform_buffer.id, spv::Decoration::DecorationDescriptorSet)};
-					glsl->set_decoration(uniform_buffer.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set);
-				}
-				for(auto const& storage_buffer : resources.storage_buffers)
-				{
-					auto set{glsl->get_decoration(storage_buffer.id, spv::Decoration::DecorationDescriptorSet)};
-					glsl->set_decoration(storage_buffer.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set);
-				}
-				for(auto const& storage_image : resources.storage_images)
-				{
-					auto set{glsl->get_decoration(storage_image.id, spv::Decoration::DecorationDescriptorSet)};
-					glsl->set_decoration(storage_image.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set);
-				}
-				for(auto const& image : resources.sampled_images)
-				{
-					auto set{glsl->get_decoration(image.id, spv::Decoration::DecorationDescriptorSet)};
-					glsl->set_decoration(image.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set); // Sampler offset done in spirv-cross
-				}
-				for(auto const& sampler : resources.separate_samplers)
-				{
-					auto set{glsl->get_decoration(sampler.id, spv::Decoration::DecorationDescriptorSet)};
-					glsl->set_decoration(sampler.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set + 1);
-				}
+				delete[] source;
 
-				spirv_cross::CompilerGLSL::Options options;
-				options.version = 410;
-				options.es = false;
-				options.vulkan_semantics = false;
-				options.separate_shader_objects = false;
-				options.enable_420pack_extension = false;
-				glsl->set_common_options(options);
-
-				// Compile to GLSL, ready to give to GL driver.
-				std::string glslSource = glsl->compile();
-				file.second = glslSource;
-                
-				m_pShaderCompilers.push_back(glsl);
+				file.second = reflection.glsl;
+				m_UniformBlockNames.insert(m_UniformBlockNames.end(), reflection.uniformBlocks.begin(), reflection.uniformBlocks.end());
 			}
 
 			Parse(sources);
@@ -145,9 +92,16 @@ namespace Lumos
 			{
 				m_ShaderTypes.push_back(source.first);
 			}
+		}
+
+		void GLShader::CompleteLoading()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			if(m_PendingSources.empty())
+				return;
 
 			GLShaderErrorInfo error;
-			m_Handle = Compile(sources, error);
+			m_Handle = Compile(&m_PendingSources, error);
 
 			if(!m_Handle)
 			{
@@ -164,7 +118,89 @@ namespace Lumos
 			ValidateUniforms();
 			CreateLocations();
 
-			delete sources;
+			m_PendingSources.clear();
+		}
+
+		void GLShader::CrossCompile(const u32* source, u32 fileSize, ShaderReflection& reflection)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			std::vector<unsigned int> spv(source, source + fileSize / sizeof(unsigned int));
+
+			spirv_cross::CompilerGLSL compiler(std::move(spv));
+			spirv_cross::CompilerGLSL* glsl = &compiler;
+
+			// The SPIR-V is now parsed, and we can perform reflection on it.
+			spirv_cross::ShaderResources resources = glsl->get_shader_resources();
+
+			// Get all sampled images in the shader.
+			for(auto& resource : resources.sampled_images)
+			{
+				unsigned set = glsl->get_decoration(resource.id, spv::DecorationDescriptorSet);
+				unsigned binding = glsl->get_decoration(resource.id, spv::DecorationBinding);
+
+				// Modify the decoration to prepare it for GLSL.
+				glsl->unset_decoration(resource.id, spv::DecorationDescriptorSet);
+
+				// Some arbitrary remapping if we want.
+				glsl->set_decoration(resource.id, spv::DecorationBinding, set * 16 + binding);
+			}
+
+			for(auto const& image : resources.separate_images)
+			{
+				auto set{glsl->get_decoration(image.id, spv::Decoration::DecorationDescriptorSet)};
+				glsl->set_decoration(image.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set);
+			}
+			for(auto const& input : resources.subpass_inputs)
+			{
+				auto set{glsl->get_decoration(input.id, spv::Decoration::DecorationDescriptorSet)};
+				glsl->set_decoration(input.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set);
+			}
+			for(auto const& uniform_buffer : resources.uniform_buffers)
+			{
+				auto set{glsl->get_decoration(uniform_buffer.id, spv::Decoration::DecorationDescriptorSet)};
+				glsl->set_decoration(uniform_buffer.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set);
+			}
+			for(auto const& storage_buffer : resources.storage_buffers)
+			{
+				auto set{glsl->get_decoration(storage_buffer.id, spv::Decoration::DecorationDescriptorSet)};
+				glsl->set_decoration(storage_buffer.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set);
+			}
+			for(auto const& storage_image : resources.storage_images)
+			{
+				auto set{glsl->get_decoration(storage_image.id, spv::Decoration::DecorationDescriptorSet)};
+				glsl->set_decoration(storage_image.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set);
+			}
+			for(auto const& image : resources.sampled_images)
+			{
+				auto set{glsl->get_decoration(image.id, spv::Decoration::DecorationDescriptorSet)};
+				glsl->set_decoration(image.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set); // Sampler offset done in spirv-cross
+			}
+			for(auto const& sampler : resources.separate_samplers)
+			{
+				auto set{glsl->get_decoration(sampler.id, spv::Decoration::DecorationDescriptorSet)};
+				glsl->set_decoration(sampler.id, spv::Decoration::DecorationDescriptorSet, DESCRIPTOR_TABLE_INITIAL_SPACE + 2 * set + 1);
+			}
+
+			spirv_cross::CompilerGLSL::Options options;
+			options.version = 410;
+			options.es = false;
+			options.vulkan_semantics = false;
+			options.separate_shader_objects = false;
+			options.enable_420pack_extension = false;
+			glsl->set_common_options(options);
+
+			// Storage blocks are not core in GLSL 410
+			if(!resources.storage_buffers.empty())
+				glsl->require_extension("GL_ARB_shader_storage_buffer_object");
+
+			// Compile to GLSL, ready to give to GL driver.
+			reflection.glsl = glsl->compile();
+
+			for(const auto& uniformBuffer : resources.uniform_buffers)
+			{
+				if(glsl->get_type(uniformBuffer.type_id).basetype == spirv_cross::SPIRType::Struct)
+					reflection.uniformBlocks.push_back(uniformBuffer.name);
+			}
 		}
 
 		void GLShader::Shutdown() const
@@ -176,18 +212,8 @@ namespace Lumos
 		bool GLShader::CreateLocations()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			for(auto& compiler : m_pShaderCompilers)
-			{
-				const spirv_cross::ShaderResources shaderResources = compiler->get_shader_resources();
-
-				for(const auto& itUniform : shaderResources.uniform_buffers)
-				{
-					if(compiler->get_type(itUniform.type_id).basetype == spirv_cross::SPIRType::Struct)
-					{
-						SetUniformLocation(itUniform.name.c_str());
-					}
-				}
-			}
+			for(auto& name : m_UniformBlockNames)
+				SetUniformLocation(name.c_str());
 			return true;
 		}
 
@@ -238,7 +264,6 @@ namespace Lumos
 		void GLShader::PreProcess(const std::string& source, std::map<ShaderType, std::string>* sources)
 		{
 			LUMOS_PROFILE_FUNCTION();
-			s_Type = ShaderType::UNKNOWN;
 			std::vector<std::string> lines = StringUtilities::GetLines(source);
 			ReadShaderFile(lines, sources);
 		}
@@ -246,59 +271,63 @@ namespace Lumos
 		void GLShader::ReadShaderFile(std::vector<std::string> lines, std::map<ShaderType, std::string>* shaders)
 		{
 			LUMOS_PROFILE_FUNCTION();
+			// Locals so shaders can be read on several threads at once
+			ShaderType type = ShaderType::UNKNOWN;
+			bool ignoreLines = false;
+
 			for(u32 i = 0; i < lines.size(); i++)
 			{
 				std::string str = std::string(lines[i]);
 				str = StringUtilities::StringReplace(str, '\t');
 
-				if(IGNORE_LINES)
+				if(ignoreLines)
 				{
 					if(StringUtilities::StartsWith(str, "#end"))
 					{
-						IGNORE_LINES = false;
+						ignoreLines = false;
 					}
 				}
 				else if(StringUtilities::StartsWith(str, "#shader"))
 				{
 					if(StringUtilities::StringContains(str, "vertex"))
 					{
-						s_Type = ShaderType::VERTEX;
+						type = ShaderType::VERTEX;
 						std::map<ShaderType, std::string>::iterator it = shaders->begin();
-						shaders->insert(it, std::pair<ShaderType, std::string>(s_Type, ""));
+						shaders->insert(it, std::pair<ShaderType, std::string>(type, ""));
 					}
 					else if(StringUtilities::StringContains(str, "geometry"))
 					{
-						s_Type = ShaderType::GEOMETRY;
+						type = ShaderType::GEOMETRY;
 						std::map<ShaderType, std::string>::iterator it = shaders->begin();
-						shaders->insert(it, std::pair<ShaderType, std::string>(s_Type, ""));
+						shaders->insert(it, std::pair<ShaderType, std::string>(type, ""));
 					}
 					else if(StringUtilities::StringContains(str, "fragment"))
 					{
-						s_Type = ShaderType::FRAGMENT;
+						type = ShaderType::FRAGMENT;
 						std::map<ShaderType, std::string>::iterator it = shaders->begin();
-						shaders->insert(it, std::pair<ShaderType, std::string>(s_Type, ""));
+						shaders->insert(it, std::pair<ShaderType, std::string>(type, ""));
 					}
 					else if(StringUtilities::StringContains(str, "tess_cont"))
 					{
-						s_Type = ShaderType::TESSELLATION_CONTROL;
+						type = ShaderType::TESSELLATION_CONTROL;
 						std::map<ShaderType, std::string>::iterator it = shaders->begin();
-						shaders->insert(it, std::pair<ShaderType, std::string>(s_Type, ""));
+						shaders->insert(it, std::pair<ShaderType, std::string>(type, ""));
 					}
 					else if(StringUtilities::StringContains(str, "tess_eval"))
 					{
-						s_Type = ShaderType::TESSELLATION_EVALUATION;
+						type = ShaderType::TESSELLATION_EVALUATION;
 						std::map<ShaderType, std::string>::iterator it = shaders->begin();
-						shaders->insert(it, std::pair<ShaderType, std::string>(s_Type, ""));
+						shaders->insert(it, std::pair<ShaderType, std::string>(type, ""));
 					}
 					else if(StringUtilities::StringContains(str, "compute"))
 					{
-						s_Type = ShaderType::COMPUTE;
+						type = ShaderType::COMPUTE;
 						std::map<ShaderType, std::string>::iterator it = shaders->begin();
-						shaders->insert(it, std::pair<ShaderType, std::string>(s_Type, ""));
+						shaders->insert(it, std::pair<ShaderType, std::string>(type, ""));
 					}
 					else if(StringUtilities::StringContains(str, "end"))
 					{
-						s_Type = ShaderType::UNKNOWN;
+						type = ShaderType::UNKNOWN;
 					}
 				}
 				else if(StringUtilities::StartsWith(str, "#include"))
@@ -329,14 +358,14 @@ namespace Lumos
 
 						if(def == "0")
 						{
-							IGNORE_LINES = true;
+							ignoreLines = true;
 						}
 					}
 				}
-				else if(s_Type != ShaderType::UNKNOWN)
+				else if(type != ShaderType::UNKNOWN)
 				{
-					shaders->at(s_Type).append(lines[i]);
-					///Shaders->at(s_Type).append("\n");
+					shaders->at(type).append(lines[i]);
+					///Shaders->at(type).append("\n");
 				}
 			}
 		}
@@ -1126,11 +1155,11 @@ namespace Lumos
 			GLCall(glUniformMatrix4fv(location, count, GL_FALSE /*GLTRUE*/, Maths::ValuePointer(matrix)));
 		}
 
-		Shader* GLShader::CreateFuncGL(const std::string& filePath)
+		Shader* GLShader::CreateFuncGL(const std::string& filePath, bool deferred)
 		{
 			std::string physicalPath;
 			Lumos::VFS::Get()->ResolvePhysicalPath(filePath, physicalPath, true);
-			GLShader* result = new GLShader(physicalPath);
+			GLShader* result = new GLShader(physicalPath, false, deferred);
 			result->m_Path = filePath;
 			return result;
 		}
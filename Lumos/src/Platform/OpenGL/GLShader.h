@@ -12,6 +12,8 @@ namespace Lumos
 {
 	namespace Graphics
 	{
+		struct ShaderReflection;
+
 		struct GLShaderErrorInfo
 		{
 			GLShaderErrorInfo()
@@ -28,7 +30,7 @@ namespace Lumos
 			friend class ShaderManager;
 
 		private:
-			u32 m_Handle;
+			u32 m_Handle = 0;
 			std::string m_Name, m_Path;
 			std::string m_Source;
 
@@ -41,13 +43,16 @@ namespace Lumos
 			ShaderStructList m_Structs;
 			bool m_LoadSPV = false;
 
+			static void CrossCompile(const u32* source, u32 fileSize, ShaderReflection& reflection);
 			bool CreateLocations();
 			bool SetUniformLocation(const char* szName);
 
 			std::map<uint32_t, std::string> m_names;
 			std::map<uint32_t, uint32_t> m_uniformBlockLocations;
 			std::map<uint32_t, uint32_t> m_sampledImageLocations;
-			std::vector<spirv_cross::CompilerGLSL*> m_pShaderCompilers;
+			std::vector<std::string> m_UniformBlockNames;
+			// Cross compiled sources waiting for CompleteLoading
+			std::map<ShaderType, std::string> m_PendingSources;
 
 			void* GetHandle() const override
 			{
@@ -55,11 +60,14 @@ namespace Lumos
 			}
 
 		public:
-			GLShader(const std::string& filePath, bool loadSPV = false);
+			GLShader(const std::string& filePath, bool loadSPV = false, bool deferred = false);
 
 			~GLShader();
 
-			void Init();
+			// Reads, cross compiles and parses the stages, none of which needs the context
+			void Load();
+			// Compiles and links the program, on the thread the context is current on
+			void CompleteLoading() override;
 			void Shutdown() const;
 			void Bind() const override;
 			void Unbind() const override;
@@ -142,7 +150,7 @@ namespace Lumos
 			static void MakeDefault();
 
 		protected:
-			static Shader* CreateFuncGL(const std::string& filePath);
+			static Shader* CreateFuncGL(const std::string& filePath, bool deferred);
 		};
 	}
 }
@@ -18,6 +18,7 @@ namespace Lumos
 			case TextureFormat::RG8:				return GL_RG8;
 			case TextureFormat::RGB8:				return srgb ? GL_SRGB8 : GL_RGB8;
             case TextureFormat::RGBA8:			    return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+			case TextureFormat::RG16:				return GL_RG16F;
             case TextureFormat::RGB16:              return GL_RGB16F;
 			case TextureFormat::RGBA16:             return GL_RGBA16F;
 			case TextureFormat::RGB32:              return GL_RGB32F;
@@ -60,6 +61,7 @@ namespace Lumos
 			case GL_RGBA8:				return GL_RGBA;
 			case GL_RGB16:              return GL_RGB;
 			case GL_RGBA16:             return GL_RGBA;
+            case GL_RG16F:              return GL_RG;
             case GL_RGBA16F:            return GL_RGBA;
             case GL_RGB32F:             return GL_RGB;
             case GL_RGBA32F:            return GL_RGBA;
@@ -18,6 +18,7 @@ namespace Lumos
 		{
 			LUMOS_PROFILE_FUNCTION();
 			GLCall(glDeleteBuffers(1, &m_Handle));
+			delete[] m_PersistentData;
 		}
 
 		void GLUniformBuffer::Init(uint32_t size, const void* data)
@@ -81,6 +82,27 @@ namespace Lumos
 			}
 		}
 
+		u8* GLUniformBuffer::MapPersistent()
+		{
+			// Buffers can not stay mapped while in use without glBufferStorage, so writes go to a CPU copy
+			if(!m_PersistentData)
+			{
+				m_PersistentData = new u8[m_Size];
+				memset(m_PersistentData, 0, m_Size);
+			}
+			return m_PersistentData;
+		}
+
+		void GLUniformBuffer::Flush(uint32_t offset, uint32_t size)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			if(!m_PersistentData)
+				return;
+
+			glBindBuffer(GL_UNIFORM_BUFFER, m_Handle);
+			GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, m_PersistentData + offset));
+		}
+
 		void GLUniformBuffer::Bind(u32 slot, GLShader* shader, std::string& name)
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -16,6 +16,8 @@ namespace Lumos
 			void Init(uint32_t size, const void* data) override;
 			void SetData(uint32_t size, const void* data) override;
 			void SetDynamicData(uint32_t size, uint32_t typeSize, const void* data) override;
+			u8* MapPersistent() override;
+			void Flush(uint32_t offset, uint32_t size) override;
 
 			void Bind(u32 slot, GLShader* shader, std::string& name);
 
@@ -49,6 +51,8 @@ namespace Lumos
 
 		private:
 			u8* m_Data = nullptr;
+			// CPU copy written through MapPersistent, uploaded by Flush
+			u8* m_PersistentData = nullptr;
 			uint32_t m_Size = 0;
 			uint32_t m_DynamicTypeSize = 0;
 			bool m_Dynamic = false;
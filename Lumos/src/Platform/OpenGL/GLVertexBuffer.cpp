@@ -90,6 +90,13 @@ namespace Lumos
             ((GLPipeline*)pipeline)->BindVertexArray();
 		}
 
+		void GLVertexBuffer::BindInstances(CommandBuffer* commandBuffer, Pipeline* pipeline, u32 offset)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_Handle));
+			((GLPipeline*)pipeline)->BindInstanceArray(offset);
+		}
+
 		void GLVertexBuffer::Unbind()
 		{
 			LUMOS_PROFILE_FUNCTION();
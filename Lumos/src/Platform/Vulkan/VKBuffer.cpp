@@ -19,6 +19,8 @@ namespace Lumos
 
 		VKBuffer::~VKBuffer()
 		{
+			UnMap();
+
 			if (m_Buffer)
 			{
 #ifdef USE_VMA_ALLOCATOR
@@ -62,6 +64,7 @@ namespace Lumos
 
 			vkBindBufferMemory(VKDevice::Device(), m_Buffer, m_Memory, 0);
 #endif
+			m_HandleID = VKTools::NewHandleID();
 
 			if(data != nullptr)
 				SetData(size, data);
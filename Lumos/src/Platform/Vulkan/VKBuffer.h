@@ -28,6 +28,9 @@ namespace Lumos
 			void UnMap();
 			void Flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 			void Invalidate(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+			void* GetMappedData() const { return m_Mapped; }
+			// Changes each time the buffer is created, see Texture::GetHandleID
+			u64 GetHandleID() const { return m_HandleID; }
 
 		protected:
 			VkBuffer m_Buffer{};
@@ -36,6 +39,7 @@ namespace Lumos
 			VkDeviceSize m_Size = 0;
 			VkDeviceSize m_Alignment = 0;
 			void* m_Mapped = nullptr;
+			u64 m_HandleID = 0;
 
 #ifdef USE_VMA_ALLOCATOR
             VmaAllocation m_Allocation{};
@@ -4,6 +4,7 @@
 #include "VKCommandPool.h"
 #include "VKFramebuffer.h"
 #include "VKTools.h"
+#include "Graphics/GPUProfiler.h"
 
 #include <Tracy/TracyVulkan.hpp>
 
@@ -11,7 +12,22 @@ namespace Lumos
 {
 	namespace Graphics
 	{
-		VKCommandBuffer::VKCommandBuffer(): m_CommandBuffer(nullptr), m_Fence(VK_NULL_HANDLE), m_Primary(false)
+#if LUMOS_PROFILE
+		// Tracy keeps a pointer to the source location of every zone, so each pass keeps one for the whole run
+		static const tracy::SourceLocationData* GetPassSourceLocation(const char* pass)
+		{
+			static std::unordered_map<std::string, tracy::SourceLocationData> locations;
+			auto location = locations.find(pass);
+			if(location == locations.end())
+			{
+				location = locations.emplace(pass, tracy::SourceLocationData()).first;
+				location->second = { location->first.c_str(), "RenderGraph", __FILE__, static_cast<uint32_t>(__LINE__), 0 };
+			}
+			return &location->second;
+		}
+#endif
+
+		VKCommandBuffer::VKCommandBuffer(): m_CommandBuffer(nullptr), m_CommandPool(VK_NULL_HANDLE), m_Fence(VK_NULL_HANDLE), m_Primary(false)
 		{
 		}
 
@@ -21,14 +37,25 @@ namespace Lumos
 		}
 
 		bool VKCommandBuffer::Init(bool primary)
+		{
+			return Init(primary, VKDevice::Get().GetCommandPool()->GetCommandPool());
+		}
+
+		bool VKCommandBuffer::Init(bool primary, u32 commandPoolIndex)
+		{
+			return Init(primary, VKDevice::Get().GetThreadCommandPool(commandPoolIndex)->GetCommandPool());
+		}
+
+		bool VKCommandBuffer::Init(bool primary, VkCommandPool commandPool)
 		{
 			LUMOS_PROFILE_FUNCTION();
 			m_Primary = primary;
+			m_CommandPool = commandPool;
 
 			VkCommandBufferAllocateInfo cmdBufferCI{};
 
 			cmdBufferCI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            cmdBufferCI.commandPool = VKDevice::Get().GetCommandPool()->GetCommandPool();
+            cmdBufferCI.commandPool = m_CommandPool;
 			cmdBufferCI.commandBufferCount = 1;
 			cmdBufferCI.level = primary ? VK_COMMAND_BUFFER_LEVEL_PRIMARY : VK_COMMAND_BUFFER_LEVEL_SECONDARY;
 
@@ -46,7 +73,7 @@ namespace Lumos
 		{
 			LUMOS_PROFILE_FUNCTION();
 			vkDestroyFence(VKDevice::Get().GetDevice(), m_Fence, nullptr);
-			vkFreeCommandBuffers(VKDevice::Get().GetDevice(), VKDevice::Get().GetCommandPool()->GetCommandPool(),1, &m_CommandBuffer);
+			vkFreeCommandBuffers(VKDevice::Get().GetDevice(), m_CommandPool, 1, &m_CommandBuffer);
 		}
 
 		void VKCommandBuffer::BeginRecording()
@@ -58,6 +85,14 @@ namespace Lumos
             beginCI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
             beginCI.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
             VK_CHECK_RESULT(vkBeginCommandBuffer(m_CommandBuffer, &beginCI));
+
+			// Every renderer submits its own primary command buffers, so they are what the GPU pass timings bracket
+			GPUProfiler::OnBeginRecording(this);
+#if LUMOS_PROFILE
+			const char* pass = GPUProfiler::GetCurrentPassName();
+			if(pass && VKDevice::Get().GetTracyContext())
+				m_TracyZone = new tracy::VkCtxScope(VKDevice::Get().GetTracyContext(), GetPassSourceLocation(pass), m_CommandBuffer, true);
+#endif
 		}
 
 		void VKCommandBuffer::BeginRecordingSecondary(RenderPass* renderPass, Framebuffer* framebuffer)
@@ -82,6 +117,14 @@ namespace Lumos
 		void VKCommandBuffer::EndRecording()
 		{
 			LUMOS_PROFILE_FUNCTION();
+			if(m_Primary)
+			{
+#if LUMOS_PROFILE
+				delete m_TracyZone;
+				m_TracyZone = nullptr;
+#endif
+				GPUProfiler::OnEndRecording(this);
+			}
 			VK_CHECK_RESULT(vkEndCommandBuffer(m_CommandBuffer));
 		}
 
@@ -95,6 +138,9 @@ namespace Lumos
 		{
 			LUMOS_PROFILE_FUNCTION();
             LUMOS_ASSERT(m_Primary, "Used Execute on secondary command buffer!");
+
+			// Resources uploaded since the last submission may be used by this command buffer
+			VKDevice::Get().GetUploadQueue()->Submit();
 		
             uint32_t waitSemaphoreCount = waitSemaphore ? 1 : 0, signalSemaphoreCount = signalSemaphore ? 1 : 0;
 
@@ -113,6 +159,7 @@ namespace Lumos
             {
                 {
                     LUMOS_PROFILE_SCOPE("vkQueueSubmit");
+                    std::lock_guard<std::mutex> lock(VKDevice::Get().GetQueueMutex());
                     VK_CHECK_RESULT(vkQueueSubmit(VKDevice::Get().GetGraphicsQueue(), 1, &submitInfo, m_Fence));
                 }
                 {
@@ -126,6 +173,7 @@ namespace Lumos
             }
             else
             {
+                std::lock_guard<std::mutex> lock(VKDevice::Get().GetQueueMutex());
                 {
                     LUMOS_PROFILE_SCOPE("vkQueueSubmit");
                     VK_CHECK_RESULT(vkQueueSubmit(VKDevice::Get().GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE));
@@ -2,6 +2,11 @@
 #include "VK.h"
 #include "Graphics/API/CommandBuffer.h"
 
+namespace tracy
+{
+	class VkCtxScope;
+}
+
 namespace Lumos
 {
 	namespace Graphics
@@ -13,6 +18,7 @@ namespace Lumos
 			~VKCommandBuffer();
 
 			bool Init(bool primary) override;
+			bool Init(bool primary, u32 commandPoolIndex) override;
 			void Unload() override;
 			void BeginRecording() override;
 			void BeginRecordingSecondary(RenderPass* renderPass, Framebuffer* framebuffer) override;
@@ -31,9 +37,16 @@ namespace Lumos
         protected:
             static CommandBuffer* CreateFuncVulkan();
 		private:
+			bool Init(bool primary, VkCommandPool commandPool);
+
 			VkCommandBuffer m_CommandBuffer;
+			VkCommandPool m_CommandPool;
 			VkFence m_Fence;
 			bool m_Primary;
+#if LUMOS_PROFILE
+			// GPU zone of the render graph pass this command buffer is recorded for
+			tracy::VkCtxScope* m_TracyZone = nullptr;
+#endif
 		};
 	}
 }
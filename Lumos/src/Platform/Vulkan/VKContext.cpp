@@ -337,6 +337,7 @@ namespace Lumos
 		
 		void VKContext::WaitIdle() const
 		{
+			std::lock_guard<std::mutex> lock(VKDevice::Get().GetQueueMutex());
 			vkDeviceWaitIdle(VKDevice::Get().GetDevice());
 		}
 		
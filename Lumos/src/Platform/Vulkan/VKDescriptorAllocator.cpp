@@ -0,0 +1,221 @@
+#include "Precompiled.h"
+#include "VKDescriptorAllocator.h"
+#include "VKDevice.h"
+#include "VKTools.h"
+#include "Core/Engine.h"
+#include "Utilities/CombineHash.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		static constexpr u32 DESCRIPTOR_POOL_MAX_SETS = 256;
+
+		VKDescriptorAllocator::VKDescriptorAllocator()
+		{
+		}
+
+		VKDescriptorAllocator::~VKDescriptorAllocator()
+		{
+			VkDevice device = VKDevice::Get().GetDevice();
+
+			for(auto pool : m_Pools)
+				vkDestroyDescriptorPool(device, pool, VK_NULL_HANDLE);
+			for(auto pool : m_FramePools)
+				vkDestroyDescriptorPool(device, pool, VK_NULL_HANDLE);
+			for(auto& retired : m_RetiredPools)
+			{
+				for(auto pool : retired.pools)
+					vkDestroyDescriptorPool(device, pool, VK_NULL_HANDLE);
+			}
+			for(auto pool : m_FreeTransientPools)
+				vkDestroyDescriptorPool(device, pool, VK_NULL_HANDLE);
+
+			for(auto& [hash, layout] : m_Layouts)
+				vkDestroyDescriptorSetLayout(device, layout, VK_NULL_HANDLE);
+		}
+
+		VkDescriptorSetLayout VKDescriptorAllocator::GetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			size_t hash = 0;
+			for(auto& binding : bindings)
+				HashCombine(hash, binding.binding, binding.descriptorType, binding.descriptorCount, binding.stageFlags);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			auto found = m_Layouts.find(hash);
+			if(found != m_Layouts.end())
+				return found->second;
+
+			VkDescriptorSetLayoutCreateInfo descriptorLayoutCI{};
+			descriptorLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			descriptorLayoutCI.bindingCount = static_cast<u32>(bindings.size());
+			descriptorLayoutCI.pBindings = bindings.data();
+
+			VkDescriptorSetLayout layout;
+			VK_CHECK_RESULT(vkCreateDescriptorSetLayout(VKDevice::Get().GetDevice(), &descriptorLayoutCI, VK_NULL_HANDLE, &layout));
+
+			m_Layouts[hash] = layout;
+			return layout;
+		}
+
+		VkDescriptorSet VKDescriptorAllocator::AcquireSet(size_t contentHash, VkDescriptorSetLayout layout, bool& created)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			auto found = m_SharedSets.find(contentHash);
+			if(found != m_SharedSets.end())
+			{
+				found->second.refCount++;
+				m_SharedHits++;
+				created = false;
+				return found->second.set;
+			}
+
+			// Try the pool that last had room, then the rest of the chain as freed sets leave gaps, then grow it
+			VkDescriptorSet set = VK_NULL_HANDLE;
+			bool allocated = !m_Pools.empty() && TryAllocate(m_Pools[m_CurrentPool], layout, set);
+
+			for(u32 i = 0; i < m_Pools.size() && !allocated; i++)
+			{
+				if(i != m_CurrentPool && TryAllocate(m_Pools[i], layout, set))
+				{
+					m_CurrentPool = i;
+					allocated = true;
+				}
+			}
+
+			if(!allocated)
+			{
+				m_Pools.push_back(CreatePool(true));
+				m_CurrentPool = static_cast<u32>(m_Pools.size() - 1);
+				if(!TryAllocate(m_Pools[m_CurrentPool], layout, set))
+					LUMOS_LOG_CRITICAL("[VULKAN] Failed to allocate descriptor set from a new pool");
+			}
+
+			m_SharedSets[contentHash] = { set, m_Pools[m_CurrentPool], 1 };
+			created = true;
+			return set;
+		}
+
+		void VKDescriptorAllocator::ReleaseSet(size_t contentHash)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			auto found = m_SharedSets.find(contentHash);
+			if(found == m_SharedSets.end())
+				return;
+
+			if(--found->second.refCount > 0)
+				return;
+
+			// Command buffers still in flight may reference the set
+			m_PendingFree.push_back({ m_Frame, found->second.set, found->second.pool });
+			m_SharedSets.erase(found);
+		}
+
+		VkDescriptorSet VKDescriptorAllocator::AllocateTransientSet(VkDescriptorSetLayout layout)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			VkDescriptorSet set = VK_NULL_HANDLE;
+			if(m_FramePools.empty() || !TryAllocate(m_FramePools.back(), layout, set))
+			{
+				if(m_FreeTransientPools.empty())
+					m_FramePools.push_back(CreatePool(false));
+				else
+				{
+					m_FramePools.push_back(m_FreeTransientPools.back());
+					m_FreeTransientPools.pop_back();
+				}
+
+				if(!TryAllocate(m_FramePools.back(), layout, set))
+					LUMOS_LOG_CRITICAL("[VULKAN] Failed to allocate transient descriptor set");
+			}
+
+			m_TransientSets++;
+			return set;
+		}
+
+		void VKDescriptorAllocator::BeginFrame(u32 releaseDelay)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			VkDevice device = VKDevice::Get().GetDevice();
+
+			auto& stats = Engine::Get().Statistics();
+			stats.NumDescriptorSetsShared = m_SharedHits;
+			stats.NumTransientDescriptorSets = m_TransientSets;
+			m_SharedHits = 0;
+			m_TransientSets = 0;
+
+			if(!m_FramePools.empty())
+				m_RetiredPools.push_back({ m_Frame, std::move(m_FramePools) });
+			m_FramePools.clear();
+
+			m_Frame++;
+
+			while(!m_RetiredPools.empty() && m_Frame - m_RetiredPools.front().frame >= releaseDelay)
+			{
+				for(auto pool : m_RetiredPools.front().pools)
+				{
+					vkResetDescriptorPool(device, pool, 0);
+					m_FreeTransientPools.push_back(pool);
+				}
+				m_RetiredPools.pop_front();
+			}
+
+			while(!m_PendingFree.empty() && m_Frame - m_PendingFree.front().frame >= releaseDelay)
+			{
+				vkFreeDescriptorSets(device, m_PendingFree.front().pool, 1, &m_PendingFree.front().set);
+				m_PendingFree.pop_front();
+			}
+
+			u32 transientPools = static_cast<u32>(m_FreeTransientPools.size());
+			for(auto& retired : m_RetiredPools)
+				transientPools += static_cast<u32>(retired.pools.size());
+
+			stats.NumDescriptorPools = static_cast<u32>(m_Pools.size());
+			stats.NumTransientDescriptorPools = transientPools;
+			stats.NumDescriptorSets = static_cast<u32>(m_SharedSets.size());
+		}
+
+		VkDescriptorPool VKDescriptorAllocator::CreatePool(bool freeSets) const
+		{
+			LUMOS_PROFILE_FUNCTION();
+			std::array<VkDescriptorPoolSize, 4> poolSizes =
+			{
+				VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,  DESCRIPTOR_POOL_MAX_SETS * 4 },
+				VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,          DESCRIPTOR_POOL_MAX_SETS * 2 },
+				VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,  DESCRIPTOR_POOL_MAX_SETS / 2 },
+				VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,          DESCRIPTOR_POOL_MAX_SETS / 2 }
+			};
+
+			VkDescriptorPoolCreateInfo poolCreateInfo = {};
+			poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			// Transient pools are only ever reset as a whole
+			poolCreateInfo.flags = freeSets ? VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT : 0;
+			poolCreateInfo.poolSizeCount = static_cast<u32>(poolSizes.size());
+			poolCreateInfo.pPoolSizes = poolSizes.data();
+			poolCreateInfo.maxSets = DESCRIPTOR_POOL_MAX_SETS;
+
+			VkDescriptorPool pool;
+			VK_CHECK_RESULT(vkCreateDescriptorPool(VKDevice::Get().GetDevice(), &poolCreateInfo, VK_NULL_HANDLE, &pool));
+			return pool;
+		}
+
+		bool VKDescriptorAllocator::TryAllocate(VkDescriptorPool pool, VkDescriptorSetLayout layout, VkDescriptorSet& set) const
+		{
+			VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
+			descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			descriptorSetAllocateInfo.descriptorPool = pool;
+			descriptorSetAllocateInfo.pSetLayouts = &layout;
+			descriptorSetAllocateInfo.descriptorSetCount = 1;
+
+			// Out of pool memory and fragmentation are both reported as failure, the caller moves on to another pool
+			return vkAllocateDescriptorSets(VKDevice::Get().GetDevice(), &descriptorSetAllocateInfo, &set) == VK_SUCCESS;
+		}
+	}
+}
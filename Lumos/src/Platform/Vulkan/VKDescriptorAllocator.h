@@ -0,0 +1,79 @@
+#pragma once
+#include "VK.h"
+
+#include <deque>
+#include <mutex>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// Owns the descriptor set layouts and descriptor pools behind VKDescriptorSet.
+		// Persistent sets come from a chain of pools that grows when the existing pools are full, and sets with the same
+		// layout and contents are allocated once and shared. Transient sets come from pools owned by the current frame,
+		// which are reset together once the GPU can no longer be using them
+		class VKDescriptorAllocator
+		{
+		public:
+			VKDescriptorAllocator();
+			~VKDescriptorAllocator();
+
+			// Layouts with identical bindings are shared and live as long as the allocator
+			VkDescriptorSetLayout GetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+			// Returns the shared set for contentHash, allocating it if nothing holds it yet.
+			// created is set when the set is new and the caller has to write its contents
+			VkDescriptorSet AcquireSet(size_t contentHash, VkDescriptorSetLayout layout, bool& created);
+			void ReleaseSet(size_t contentHash);
+
+			// Only valid for command buffers recorded this frame
+			VkDescriptorSet AllocateTransientSet(VkDescriptorSetLayout layout);
+
+			// Call once per frame before recording. releaseDelay is the number of frames the GPU may still be using a set
+			void BeginFrame(u32 releaseDelay);
+			u64 GetFrame() const { return m_Frame; }
+
+		private:
+			VkDescriptorPool CreatePool(bool freeSets) const;
+			bool TryAllocate(VkDescriptorPool pool, VkDescriptorSetLayout layout, VkDescriptorSet& set) const;
+
+			struct SharedSet
+			{
+				VkDescriptorSet set;
+				VkDescriptorPool pool;
+				u32 refCount;
+			};
+
+			struct PendingFree
+			{
+				u64 frame;
+				VkDescriptorSet set;
+				VkDescriptorPool pool;
+			};
+
+			struct RetiredPools
+			{
+				u64 frame;
+				std::vector<VkDescriptorPool> pools;
+			};
+
+			std::unordered_map<size_t, VkDescriptorSetLayout> m_Layouts;
+
+			std::vector<VkDescriptorPool> m_Pools;
+			u32 m_CurrentPool = 0;
+			std::unordered_map<size_t, SharedSet> m_SharedSets;
+			std::deque<PendingFree> m_PendingFree;
+
+			std::vector<VkDescriptorPool> m_FramePools;
+			std::deque<RetiredPools> m_RetiredPools;
+			std::vector<VkDescriptorPool> m_FreeTransientPools;
+
+			u64 m_Frame = 0;
+			u32 m_SharedHits = 0;
+			u32 m_TransientSets = 0;
+
+			// Sets are acquired while command buffers are recorded on worker threads
+			std::mutex m_Mutex;
+		};
+	}
+}
@@ -1,154 +1,214 @@
-#include "Precompiled.h"
-#include "VKDescriptorSet.h"
-#include "VKPipeline.h"
-#include "VKTools.h"
-#include "VKUniformBuffer.h"
-#include "VKTexture.h"
-#include "VKDevice.h"
-
-#define MAX_BUFFER_INFOS 32
-#define MAX_IMAGE_INFOS 32
-#define MAX_WRITE_DESCTIPTORS 32
-
-namespace Lumos
-{
-	namespace Graphics
-	{
-		VKDescriptorSet::VKDescriptorSet(const DescriptorInfo& info)
-		{
-			LUMOS_PROFILE_FUNCTION();
-			VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
-			descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-			descriptorSetAllocateInfo.descriptorPool = static_cast<Graphics::VKPipeline*>(info.pipeline)->GetDescriptorPool();
-			descriptorSetAllocateInfo.pSetLayouts = static_cast<Graphics::VKPipeline*>(info.pipeline)->GetDescriptorLayout(info.layoutIndex);
-			descriptorSetAllocateInfo.descriptorSetCount = info.count;
-			descriptorSetAllocateInfo.pNext = nullptr;
-
-			VK_CHECK_RESULT(vkAllocateDescriptorSets(VKDevice::Device(), &descriptorSetAllocateInfo, &m_DescriptorSet));
-
-			m_BufferInfoPool = new VkDescriptorBufferInfo[MAX_BUFFER_INFOS];
-			m_ImageInfoPool = new VkDescriptorImageInfo[MAX_IMAGE_INFOS];
-			m_WriteDescriptorSetPool = new VkWriteDescriptorSet[MAX_WRITE_DESCTIPTORS];
-		}
-
-		VKDescriptorSet::~VKDescriptorSet()
-		{
-			delete[] m_BufferInfoPool;
-			delete[] m_ImageInfoPool;
-			delete[] m_WriteDescriptorSetPool;
-		}
-
-		void VKDescriptorSet::Update(std::vector<BufferInfo>& bufferInfos)
-		{
-			LUMOS_PROFILE_FUNCTION();
-            UpdateInternal(nullptr, &bufferInfos);
-		}
-
-		void VKDescriptorSet::Update(std::vector<ImageInfo>& imageInfos)
-		{
-			LUMOS_PROFILE_FUNCTION();
-             UpdateInternal(&imageInfos, nullptr);
-		}
-
-		void VKDescriptorSet::Update(std::vector<ImageInfo>& imageInfos, std::vector<BufferInfo>& bufferInfos)
-		{
-			LUMOS_PROFILE_FUNCTION();
-            UpdateInternal(&imageInfos, &bufferInfos);
-		}
-
-		void VKDescriptorSet::SetPushConstants(std::vector<PushConstant>& pushConstants)
-		{
-			LUMOS_PROFILE_FUNCTION();
-			m_PushConstants.clear();
-			for (auto& pushConstant : pushConstants)
-			{
-				m_PushConstants.push_back(pushConstant);
-			}
-		}
-
-		void VKDescriptorSet::MakeDefault()
-		{
-			CreateFunc = CreateFuncVulkan;
-		}
-
-		DescriptorSet* VKDescriptorSet::CreateFuncVulkan(const DescriptorInfo& info)
-		{
-			return new VKDescriptorSet(info);
-		}
-    
-        void VKDescriptorSet::UpdateInternal(std::vector<ImageInfo>* imageInfos, std::vector<BufferInfo>* bufferInfos)
-        {
-			LUMOS_PROFILE_FUNCTION();
-            m_Dynamic = false;
-			int descriptorWritesCount = 0;
-
-            if(imageInfos != nullptr)
-            {
-				int imageIndex = 0;
-
-                for (auto& imageInfo : *imageInfos)
-                {
-                    if(imageInfo.count == 1)
-                    {
-                        VkDescriptorImageInfo& des = *static_cast<VkDescriptorImageInfo*>(imageInfo.texture->GetHandle());
-                        m_ImageInfoPool[imageIndex].imageLayout = des.imageLayout;
-                        m_ImageInfoPool[imageIndex].imageView = des.imageView;
-                        m_ImageInfoPool[imageIndex].sampler = des.sampler;
-                    }
-                    else
-                    {
-                        for (int i = 0; i < imageInfo.count; i++)
-                        {
-                            VkDescriptorImageInfo& des = *static_cast<VkDescriptorImageInfo*>(imageInfo.textures[i]->GetHandle());
-                            m_ImageInfoPool[i + imageIndex].imageLayout = des.imageLayout;
-                            m_ImageInfoPool[i + imageIndex].imageView = des.imageView;
-                            m_ImageInfoPool[i + imageIndex].sampler = des.sampler;
-                        }
-                    }
-
-					VkWriteDescriptorSet writeDescriptorSet{};
-					writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-					writeDescriptorSet.dstSet = m_DescriptorSet;
-					writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-					writeDescriptorSet.dstBinding = imageInfo.binding;
-					writeDescriptorSet.pImageInfo = &m_ImageInfoPool[imageIndex];
-					writeDescriptorSet.descriptorCount = imageInfo.count;
-
-					m_WriteDescriptorSetPool[descriptorWritesCount] = writeDescriptorSet;
-					imageIndex++;
-					descriptorWritesCount++;
-                }
-            }
-      
-            if(bufferInfos != nullptr)
-            {
-                int index = 0;
-                
-                for (auto& bufferInfo : *bufferInfos)
-                {
-					m_BufferInfoPool[index].buffer = *dynamic_cast<VKUniformBuffer*>(bufferInfo.buffer)->GetBuffer();
-					m_BufferInfoPool[index].offset = bufferInfo.offset;
-					m_BufferInfoPool[index].range = bufferInfo.size;
-    
-                    VkWriteDescriptorSet writeDescriptorSet{};
-					writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                    writeDescriptorSet.dstSet = m_DescriptorSet;
-                    writeDescriptorSet.descriptorType = VKTools::DescriptorTypeToVK(bufferInfo.type);
-                    writeDescriptorSet.dstBinding = bufferInfo.binding;
-                    writeDescriptorSet.pBufferInfo = &m_BufferInfoPool[index];
-                    writeDescriptorSet.descriptorCount = 1;
-    
-					m_WriteDescriptorSetPool[descriptorWritesCount] = writeDescriptorSet;
-                    index++;
-					descriptorWritesCount++;
-    
-                    if (bufferInfo.type == DescriptorType::UNIFORM_BUFFER_DYNAMIC)
-                        m_Dynamic = true;
-                }
-            }
-            
-			vkUpdateDescriptorSets(VKDevice::Get().GetDevice(), descriptorWritesCount,
-				m_WriteDescriptorSetPool, 0, nullptr);
-        }
-    }
-}
+#include "Precompiled.h"
+#include "VKDescriptorSet.h"
+#include "VKDescriptorAllocator.h"
+#include "VKPipeline.h"
+#include "VKTools.h"
+#include "VKUniformBuffer.h"
+#include "VKTexture.h"
+#include "VKDevice.h"
+#include "Utilities/CombineHash.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		VKDescriptorSet::VKDescriptorSet(const DescriptorInfo& info)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			m_Layout = *static_cast<Graphics::VKPipeline*>(info.pipeline)->GetDescriptorLayout(info.layoutIndex);
+			m_Transient = info.transient;
+
+			if(m_Transient)
+				AllocateTransient();
+			else
+			{
+				// Every set starts out sharing the empty set for its layout
+				bool created = false;
+				m_ContentHash = HashContents();
+				m_DescriptorSet = VKDevice::Get().GetDescriptorAllocator()->AcquireSet(m_ContentHash, m_Layout, created);
+			}
+		}
+
+		VKDescriptorSet::~VKDescriptorSet()
+		{
+			if(!m_Transient)
+				VKDevice::Get().GetDescriptorAllocator()->ReleaseSet(m_ContentHash);
+		}
+
+		VkDescriptorSet VKDescriptorSet::GetDescriptorSet()
+		{
+			if(m_Transient && m_TransientFrame != VKDevice::Get().GetDescriptorAllocator()->GetFrame())
+				AllocateTransient();
+
+			return m_DescriptorSet;
+		}
+
+		void VKDescriptorSet::Update(std::vector<BufferInfo>& bufferInfos)
+		{
+			LUMOS_PROFILE_FUNCTION();
+            UpdateInternal(nullptr, &bufferInfos);
+		}
+
+		void VKDescriptorSet::Update(std::vector<ImageInfo>& imageInfos)
+		{
+			LUMOS_PROFILE_FUNCTION();
+             UpdateInternal(&imageInfos, nullptr);
+		}
+
+		void VKDescriptorSet::Update(std::vector<ImageInfo>& imageInfos, std::vector<BufferInfo>& bufferInfos)
+		{
+			LUMOS_PROFILE_FUNCTION();
+            UpdateInternal(&imageInfos, &bufferInfos);
+		}
+
+		void VKDescriptorSet::SetPushConstants(std::vector<PushConstant>& pushConstants)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			m_PushConstants.clear();
+			for (auto& pushConstant : pushConstants)
+			{
+				m_PushConstants.push_back(pushConstant);
+			}
+		}
+
+		void VKDescriptorSet::MakeDefault()
+		{
+			CreateFunc = CreateFuncVulkan;
+		}
+
+		DescriptorSet* VKDescriptorSet::CreateFuncVulkan(const DescriptorInfo& info)
+		{
+			return new VKDescriptorSet(info);
+		}
+    
+        void VKDescriptorSet::UpdateInternal(std::vector<ImageInfo>* imageInfos, std::vector<BufferInfo>* bufferInfos)
+        {
+			LUMOS_PROFILE_FUNCTION();
+            if(imageInfos != nullptr)
+            {
+                for (auto& imageInfo : *imageInfos)
+                {
+					auto& images = m_ImageBindings[imageInfo.binding];
+					auto& handleIDs = m_ImageHandleIDs[imageInfo.binding];
+					images.resize(imageInfo.count);
+					handleIDs.resize(imageInfo.count);
+
+					for (int i = 0; i < imageInfo.count; i++)
+					{
+						Texture* texture = imageInfo.count == 1 ? imageInfo.texture : imageInfo.textures[i];
+						images[i] = *static_cast<VkDescriptorImageInfo*>(texture->GetHandle());
+						handleIDs[i] = texture->GetHandleID();
+					}
+                }
+            }
+      
+            if(bufferInfos != nullptr)
+            {
+                for (auto& bufferInfo : *bufferInfos)
+                {
+					BufferBinding& binding = m_BufferBindings[bufferInfo.binding];
+					binding.type = VKTools::DescriptorTypeToVK(bufferInfo.type);
+					auto buffer = dynamic_cast<VKUniformBuffer*>(bufferInfo.buffer);
+					binding.info.buffer = *buffer->GetBuffer();
+					binding.handleID = buffer->GetHandleID();
+					binding.info.offset = bufferInfo.offset;
+					binding.info.range = bufferInfo.size;
+                }
+            }
+
+			m_Dynamic = false;
+			for(auto& [index, binding] : m_BufferBindings)
+			{
+				if(binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+					m_Dynamic = true;
+			}
+
+			// The previous set may already be recorded into a command buffer, so new contents always go into another set
+			if(m_Transient)
+			{
+				AllocateTransient();
+				return;
+			}
+
+			const size_t contentHash = HashContents();
+			if(contentHash == m_ContentHash)
+				return;
+
+			auto allocator = VKDevice::Get().GetDescriptorAllocator();
+			bool created = false;
+			VkDescriptorSet set = allocator->AcquireSet(contentHash, m_Layout, created);
+			if(created)
+				WriteContents(set);
+
+			allocator->ReleaseSet(m_ContentHash);
+			m_DescriptorSet = set;
+			m_ContentHash = contentHash;
+        }
+
+		size_t VKDescriptorSet::HashContents() const
+		{
+			size_t hash = 0;
+			HashCombine(hash, m_Layout);
+
+			for(auto& [index, images] : m_ImageBindings)
+			{
+				HashCombine(hash, index, images.size());
+				for(auto& image : images)
+					HashCombine(hash, image.imageView, image.sampler, image.imageLayout);
+			}
+
+			for(auto& [index, handleIDs] : m_ImageHandleIDs)
+			{
+				for(auto handleID : handleIDs)
+					HashCombine(hash, handleID);
+			}
+
+			for(auto& [index, binding] : m_BufferBindings)
+				HashCombine(hash, index, binding.type, binding.info.buffer, binding.handleID, binding.info.offset, binding.info.range);
+
+			return hash;
+		}
+
+		void VKDescriptorSet::WriteContents(VkDescriptorSet set) const
+		{
+			LUMOS_PROFILE_FUNCTION();
+			std::vector<VkWriteDescriptorSet> descriptorWrites;
+			descriptorWrites.reserve(m_ImageBindings.size() + m_BufferBindings.size());
+
+			for(auto& [index, images] : m_ImageBindings)
+			{
+				VkWriteDescriptorSet writeDescriptorSet{};
+				writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeDescriptorSet.dstSet = set;
+				writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				writeDescriptorSet.dstBinding = index;
+				writeDescriptorSet.pImageInfo = images.data();
+				writeDescriptorSet.descriptorCount = static_cast<u32>(images.size());
+				descriptorWrites.push_back(writeDescriptorSet);
+			}
+
+			for(auto& [index, binding] : m_BufferBindings)
+			{
+				VkWriteDescriptorSet writeDescriptorSet{};
+				writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeDescriptorSet.dstSet = set;
+				writeDescriptorSet.descriptorType = binding.type;
+				writeDescriptorSet.dstBinding = index;
+				writeDescriptorSet.pBufferInfo = &binding.info;
+				writeDescriptorSet.descriptorCount = 1;
+				descriptorWrites.push_back(writeDescriptorSet);
+			}
+
+			if(!descriptorWrites.empty())
+				vkUpdateDescriptorSets(VKDevice::Get().GetDevice(), static_cast<u32>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+		}
+
+		void VKDescriptorSet::AllocateTransient()
+		{
+			auto allocator = VKDevice::Get().GetDescriptorAllocator();
+			m_DescriptorSet = allocator->AllocateTransientSet(m_Layout);
+			m_TransientFrame = allocator->GetFrame();
+			WriteContents(m_DescriptorSet);
+		}
+    }
+}
@@ -12,7 +12,8 @@ namespace Lumos
 			VKDescriptorSet(const DescriptorInfo& info);
 			~VKDescriptorSet();
 
-			VkDescriptorSet GetDescriptorSet() const { return m_DescriptorSet; }
+			// Transient sets are rewritten into a new set the first time they are used each frame
+			VkDescriptorSet GetDescriptorSet();
 
 			void Update(std::vector<ImageInfo>& imageInfos, std::vector<BufferInfo>& bufferInfos) override;
 			void Update(std::vector<BufferInfo>& bufferInfos) override;
@@ -33,14 +34,34 @@ namespace Lumos
             
 			static DescriptorSet* CreateFuncVulkan(const DescriptorInfo&);
 		private:
-			VkDescriptorSet m_DescriptorSet;
+			struct BufferBinding
+			{
+				VkDescriptorType type;
+				VkDescriptorBufferInfo info;
+				u64 handleID;
+			};
+
+			size_t HashContents() const;
+			void WriteContents(VkDescriptorSet set) const;
+			void AllocateTransient();
+
+			VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+			VkDescriptorSetLayout m_Layout = VK_NULL_HANDLE;
+			// Identifies the shared set held from VKDescriptorAllocator
+			size_t m_ContentHash = 0;
+			bool m_Transient = false;
+			u64 m_TransientFrame = 0;
+
+			// Everything written so far, sets are never modified once written so each Update writes a new one
+			std::map<u32, std::vector<VkDescriptorImageInfo>> m_ImageBindings;
+			// Handle values can be reused by new objects, these tell the contents apart in HashContents
+			std::map<u32, std::vector<u64>> m_ImageHandleIDs;
+			std::map<u32, BufferBinding> m_BufferBindings;
+
 			u32 m_DynamicOffset = 0;
 			Shader* m_Shader = nullptr;
 			bool m_Dynamic = false;
 			std::vector<PushConstant> m_PushConstants;
-			VkDescriptorBufferInfo* m_BufferInfoPool = nullptr;
-			VkDescriptorImageInfo* m_ImageInfoPool = nullptr;
-			VkWriteDescriptorSet* m_WriteDescriptorSetPool = nullptr;
 		};
 	}
 }
@@ -5,11 +5,24 @@
 #include "VKDevice.h"
 #include "VKRenderer.h"
 #include "VKCommandPool.h"
+#include "Core/OS/FileSystem.h"
+
+#include <fstream>
+#include <iomanip>
 
 namespace Lumos
 {
 	namespace Graphics
 	{
+		// Layout of the header at the start of vkGetPipelineCacheData output (VkPipelineCacheHeaderVersionOne in newer headers)
+		struct PipelineCacheHeader
+		{
+			uint32_t headerSize;
+			uint32_t headerVersion;
+			uint32_t vendorID;
+			uint32_t deviceID;
+			uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+		};
 		
 		const char* TranslateVkPhysicalDeviceTypeToString(VkPhysicalDeviceType type)
 		{
@@ -75,6 +88,9 @@ namespace Lumos
 			caps.MaxSamples = m_PhysicalDeviceProperties.limits.maxSamplerAllocationCount;
 			caps.MaxTextureUnits = m_PhysicalDeviceProperties.limits.maxDescriptorSetSamplers;
 			caps.UniformBufferOffsetAlignment = int(m_PhysicalDeviceProperties.limits.minUniformBufferOffsetAlignment);
+			caps.MaxUniformBufferRange = int(Maths::Min(m_PhysicalDeviceProperties.limits.maxUniformBufferRange, u32(INT32_MAX)));
+			caps.MaxStorageBufferRange = int(Maths::Min(m_PhysicalDeviceProperties.limits.maxStorageBufferRange, u32(INT32_MAX)));
+			caps.SupportsStorageBuffers = true;
 			///
 			
 			uint32_t queueFamilyCount;
@@ -162,6 +178,27 @@ namespace Lumos
 		{
 			return m_SupportedExtensions.find(extensionName) != m_SupportedExtensions.end();
 		}
+
+		bool VKPhysicalDevice::SupportsDescriptorIndexing() const
+		{
+			if(!IsExtensionSupported(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) || !IsExtensionSupported(VK_KHR_MAINTENANCE3_EXTENSION_NAME))
+				return false;
+
+			// Renderer2D binds this many textures in one set when indexing is available
+			const uint32_t requiredSamplers = 256;
+			if(m_PhysicalDeviceProperties.limits.maxPerStageDescriptorSamplers < requiredSamplers || m_PhysicalDeviceProperties.limits.maxDescriptorSetSamplers < requiredSamplers)
+				return false;
+
+			VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+			indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+			VkPhysicalDeviceFeatures2 features{};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features.pNext = &indexingFeatures;
+			vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features);
+
+			return indexingFeatures.shaderSampledImageArrayNonUniformIndexing == VK_TRUE;
+		}
 		
 		VKPhysicalDevice::QueueFamilyIndices VKPhysicalDevice::GetQueueFamilyIndices(int flags)
 		{
@@ -241,6 +278,8 @@ namespace Lumos
 		/////////////////////////
 		
         uint32_t VKDevice::s_GraphicsQueueFamilyIndex = 0;
+
+		static constexpr VkDeviceSize UPLOAD_STAGING_SIZE = 32 * 1024 * 1024;
     
 		VKDevice::VKDevice()
 		{
@@ -248,7 +287,11 @@ namespace Lumos
 
 		VKDevice::~VKDevice()
 		{
+			m_UploadQueue.reset();
+			m_ThreadCommandPools.clear();
 			m_CommandPool.reset();
+			m_DescriptorAllocator.reset();
+			SavePipelineCache();
 			vkDestroyPipelineCache(m_Device, m_PipelineCache, VK_NULL_HANDLE);
 			
 #ifdef USE_VMA_ALLOCATOR
@@ -283,6 +326,22 @@ namespace Lumos
 				deviceExtensions.push_back(VK_EXT_DEBUG_MARKER_EXTENSION_NAME);
 				m_EnableDebugMarkers = true;
 			}
+
+			VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+			indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+			const bool descriptorIndexing = m_PhysicalDevice->SupportsDescriptorIndexing();
+			if(descriptorIndexing)
+			{
+				deviceExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+				deviceExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+				indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+			}
+			Renderer::GetCapabilities().SupportsBindlessTextures = descriptorIndexing;
+
+			const u32 graphicsFamily = static_cast<u32>(m_PhysicalDevice->GetGraphicsQueueFamilyIndex());
+			Renderer::GetCapabilities().SupportsTimestampQueries = m_PhysicalDevice->m_PhysicalDeviceProperties.limits.timestampComputeAndGraphics
+				|| (graphicsFamily < m_PhysicalDevice->m_QueueFamilyProperties.size() && m_PhysicalDevice->m_QueueFamilyProperties[graphicsFamily].timestampValidBits > 0);
 			
 			// Device
 			VkDeviceCreateInfo deviceCI{};
@@ -292,6 +351,7 @@ namespace Lumos
             deviceCI.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
 			deviceCI.ppEnabledExtensionNames = deviceExtensions.data();
 			deviceCI.pEnabledFeatures = &deviceFeatures;
+			deviceCI.pNext = descriptorIndexing ? &indexingFeatures : nullptr;
             deviceCI.enabledLayerCount = 0;
 
 			auto result = vkCreateDevice(m_PhysicalDevice->GetVulkanPhysicalDevice(), &deviceCI, VK_NULL_HANDLE, &m_Device);
@@ -343,18 +403,99 @@ namespace Lumos
 			}
 #endif
             m_CommandPool = CreateRef<VKCommandPool>();
+			m_DescriptorAllocator = CreateUniqueRef<VKDescriptorAllocator>();
+			m_UploadQueue = CreateUniqueRef<VKUploadQueue>(UPLOAD_STAGING_SIZE);
             
 			CreateTracyContext();
             CreatePipelineCache();
 			return VK_SUCCESS;
 		}
 
+		const Ref<VKCommandPool>& VKDevice::GetThreadCommandPool(u32 index)
+		{
+			if(index >= m_ThreadCommandPools.size())
+				m_ThreadCommandPools.resize(index + 1);
+
+			if(!m_ThreadCommandPools[index])
+				m_ThreadCommandPools[index] = CreateRef<VKCommandPool>();
+
+			return m_ThreadCommandPools[index];
+		}
+
 		void VKDevice::CreatePipelineCache()
 		{
+			const VkPhysicalDeviceProperties properties = m_PhysicalDevice->GetProperties();
+
+			// Cache data is only valid for the device and driver that wrote it, so each gets its own file
+			std::stringstream path;
+			path << Application::Get().GetCachePath() << "PipelineCache_";
+			for(u32 i = 0; i < VK_UUID_SIZE; i++)
+				path << std::hex << std::setw(2) << std::setfill('0') << static_cast<u32>(properties.pipelineCacheUUID[i]);
+			path << ".bin";
+			m_PipelineCachePath = path.str();
+
+			std::vector<u8> data;
+			if(FileSystem::FileExists(m_PipelineCachePath))
+			{
+				const i64 size = FileSystem::GetFileSize(m_PipelineCachePath);
+				u8* fileData = FileSystem::ReadFile(m_PipelineCachePath);
+				if(fileData && size > 0)
+					data.assign(fileData, fileData + size);
+				delete[] fileData;
+			}
+
+			// Check the header against this device before handing the data to the driver
+			PipelineCacheHeader header{};
+			if(data.size() >= sizeof(header))
+			{
+				memcpy(&header, data.data(), sizeof(header));
+				const bool valid = header.headerSize >= sizeof(header)
+					&& header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+					&& header.vendorID == properties.vendorID
+					&& header.deviceID == properties.deviceID
+					&& memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+				if(!valid)
+				{
+					LUMOS_LOG_WARN("[VULKAN] Pipeline cache {0} was written by a different device or driver, ignoring it", m_PipelineCachePath);
+					data.clear();
+				}
+			}
+			else
+				data.clear();
+
 			VkPipelineCacheCreateInfo pipelineCacheCI{};
 			pipelineCacheCI.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
 			pipelineCacheCI.pNext = NULL;
-			vkCreatePipelineCache(m_Device, &pipelineCacheCI, VK_NULL_HANDLE, &m_PipelineCache);
+			pipelineCacheCI.initialDataSize = data.size();
+			pipelineCacheCI.pInitialData = data.empty() ? nullptr : data.data();
+
+			if(vkCreatePipelineCache(m_Device, &pipelineCacheCI, VK_NULL_HANDLE, &m_PipelineCache) != VK_SUCCESS && !data.empty())
+			{
+				// Drivers may still reject data that passed the header check
+				pipelineCacheCI.initialDataSize = 0;
+				pipelineCacheCI.pInitialData = nullptr;
+				vkCreatePipelineCache(m_Device, &pipelineCacheCI, VK_NULL_HANDLE, &m_PipelineCache);
+			}
+			else if(!data.empty())
+				LUMOS_LOG_INFO("[VULKAN] Loaded pipeline cache {0} ({1} bytes)", m_PipelineCachePath, data.size());
+		}
+
+		void VKDevice::SavePipelineCache()
+		{
+			if(m_PipelineCache == VK_NULL_HANDLE || m_PipelineCachePath.empty())
+				return;
+
+			size_t size = 0;
+			if(vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, nullptr) != VK_SUCCESS || size == 0)
+				return;
+
+			std::vector<u8> data(size);
+			if(vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, data.data()) != VK_SUCCESS)
+				return;
+
+			std::ofstream file(m_PipelineCachePath, std::ios::binary);
+			file.write(reinterpret_cast<const char*>(data.data()), size);
 		}
 		
 		void VKDevice::CreateTracyContext()
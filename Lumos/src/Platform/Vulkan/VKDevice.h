@@ -3,6 +3,8 @@
 #include "VK.h"
 #include "VKContext.h"
 #include "VKCommandPool.h"
+#include "VKDescriptorAllocator.h"
+#include "VKUploadQueue.h"
 
 #ifdef USE_VMA_ALLOCATOR
 #ifdef LUMOS_DEBUG
@@ -26,6 +28,7 @@ namespace Lumos
 			~VKPhysicalDevice();
 			
 			bool IsExtensionSupported(const std::string& extensionName) const;
+			bool SupportsDescriptorIndexing() const;
 			uint32_t GetMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properties) const;
 			
 			VkPhysicalDevice GetVulkanPhysicalDevice() const { return m_PhysicalDevice; }
@@ -66,6 +69,8 @@ namespace Lumos
 
 			bool Init();
 			void CreatePipelineCache();
+			// Writes the pipeline cache to disk so the next run can skip compiling pipelines it has seen before
+			void SavePipelineCache();
 			void CreateTracyContext();
 
 			VkDevice GetDevice() const { return m_Device; };
@@ -74,10 +79,18 @@ namespace Lumos
 			
 			VkQueue GetGraphicsQueue() const { return m_GraphicsQueue; };
 			VkQueue GetPresentQueue() const { return m_PresentQueue; };
+			// Queues need external synchronisation and uploads are submitted from worker threads, so every
+			// submit, present and wait on the graphics or present queue holds this lock
+			std::mutex& GetQueueMutex() { return m_QueueMutex; }
             
             const Ref<VKCommandPool>& GetCommandPool() const { return m_CommandPool; }
+            // Pools for command buffers recorded on worker threads, created on first use.
+            // A pool must only be recorded into from one thread at a time
+            const Ref<VKCommandPool>& GetThreadCommandPool(u32 index);
 
 			VkPipelineCache GetPipelineCache() const { return m_PipelineCache; }
+			VKDescriptorAllocator* GetDescriptorAllocator() const { return m_DescriptorAllocator.get(); }
+			VKUploadQueue* GetUploadQueue() const { return m_UploadQueue.get(); }
 			
 			tracy::VkCtx* GetTracyContext() { return m_TracyContext; }
             
@@ -92,11 +105,16 @@ namespace Lumos
 			
 			VkQueue m_GraphicsQueue;
 			VkQueue m_PresentQueue;
-			VkPipelineCache m_PipelineCache;
+			std::mutex m_QueueMutex;
+			VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+			std::string m_PipelineCachePath;
 			VkDescriptorPool m_DescriptorPool;
 			VkPhysicalDeviceFeatures m_EnabledFeatures;
             
             Ref<VKCommandPool> m_CommandPool;
+            std::vector<Ref<VKCommandPool>> m_ThreadCommandPools;
+			UniqueRef<VKDescriptorAllocator> m_DescriptorAllocator;
+			UniqueRef<VKUploadQueue> m_UploadQueue;
 			Ref<VKPhysicalDevice> m_PhysicalDevice;
 
 			bool m_EnableDebugMarkers = false;
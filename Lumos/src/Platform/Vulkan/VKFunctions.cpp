@@ -7,6 +7,7 @@
 #include "VKIMGUIRenderer.h"
 #include "VKIndexBuffer.h"
 #include "VKPipeline.h"
+#include "VKQuery.h"
 #include "VKRenderDevice.h"
 #include "VKRenderer.h"
 #include "VKRenderpass.h"
@@ -25,6 +26,7 @@ void Lumos::Graphics::Vulkan::MakeDefault()
 	VKIMGUIRenderer::MakeDefault();
 	VKIndexBuffer::MakeDefault();
 	VKPipeline::MakeDefault();
+	VKQuery::MakeDefault();
 	VKRenderDevice::MakeDefault();
 	VKRenderer::MakeDefault();
 	VKRenderpass::MakeDefault();
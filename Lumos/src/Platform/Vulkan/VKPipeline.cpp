@@ -1,6 +1,7 @@
 #include "Precompiled.h"
 #include "VKPipeline.h"
 #include "VKDevice.h"
+#include "VKDescriptorAllocator.h"
 #include "VKCommandBuffer.h"
 #include "VKRenderpass.h"
 #include "VKShader.h"
@@ -10,8 +11,6 @@
 
 namespace Lumos
 {
-    static constexpr uint32_t MAX_DESCRIPTOR_SET_COUNT = 1500;
-
 	namespace Graphics
 	{
 		VKPipeline::VKPipeline(const PipelineInfo& pipelineCreateInfo)
@@ -29,6 +28,7 @@ namespace Lumos
 		bool VKPipeline::Init(const PipelineInfo& pipelineCreateInfo)
 		{
 			m_Shader = pipelineCreateInfo.shader;
+			m_RenderPass = pipelineCreateInfo.renderpass;
 
             std::vector<std::vector<Graphics::DescriptorLayoutInfo>> layouts;
             
@@ -61,15 +61,7 @@ namespace Lumos
                 }
 
                 // Pipeline layout
-                VkDescriptorSetLayoutCreateInfo descriptorLayoutCI{};
-                descriptorLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-                descriptorLayoutCI.bindingCount = static_cast<u32>(setLayoutBindings.size());
-                descriptorLayoutCI.pBindings = setLayoutBindings.data();
-
-                VkDescriptorSetLayout layout;
-                vkCreateDescriptorSetLayout(VKDevice::Get().GetDevice(), &descriptorLayoutCI, VK_NULL_HANDLE, &layout);
-
-                m_DescriptorLayouts.push_back(layout);
+                m_DescriptorLayouts.push_back(VKDevice::Get().GetDescriptorAllocator()->GetLayout(setLayoutBindings));
             }
             
             const auto& pushConsts = m_Shader.As<VKShader>()->GetPushConstant();
@@ -90,27 +82,6 @@ namespace Lumos
 
 			VK_CHECK_RESULT(vkCreatePipelineLayout(VKDevice::Get().GetDevice(), &pipelineLayoutCreateInfo, VK_NULL_HANDLE, &m_PipelineLayout));
 
-            // Pool sizes
-            std::array<VkDescriptorPoolSize, 5> pool_sizes =
-            {
-                VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_SAMPLER,                   10 },
-                VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,             10 },
-                VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,             10 },
-                VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,            10 },
-                VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,    10 }
-            };
-
-            // Create info
-            VkDescriptorPoolCreateInfo pool_create_info = {};
-            pool_create_info.sType          = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-            pool_create_info.flags          = 0;
-            pool_create_info.poolSizeCount  = static_cast<uint32_t>(pool_sizes.size());
-            pool_create_info.pPoolSizes     = pool_sizes.data();
-            pool_create_info.maxSets        = MAX_DESCRIPTOR_SET_COUNT;
-
-            // Pool
-            VK_CHECK_RESULT(vkCreateDescriptorPool(VKDevice::Get().GetDevice(), &pool_create_info, nullptr, &m_DescriptorPool));
-
 			DescriptorInfo info;
 			info.pipeline = this;
 			info.layoutIndex = 0;
@@ -128,9 +99,13 @@ namespace Lumos
 			std::vector<VkVertexInputAttributeDescription> vertexInputDescription;
             
             // Vertex layout
-            m_VertexBindingDescription.binding = 0;
-            m_VertexBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-            m_VertexBindingDescription.stride = pipelineCreateInfo.vertexBufferLayout.GetStride();
+            m_VertexBindingDescriptions.clear();
+
+            VkVertexInputBindingDescription vertexBindingDescription;
+            vertexBindingDescription.binding = 0;
+            vertexBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+            vertexBindingDescription.stride = pipelineCreateInfo.vertexBufferLayout.GetStride();
+            m_VertexBindingDescriptions.push_back(vertexBindingDescription);
             
             auto& vertexLayout = pipelineCreateInfo.vertexBufferLayout.GetLayout();
             int count = 0;
@@ -143,13 +118,33 @@ namespace Lumos
                 vInputAttribDescription.offset = layout.offset;
                 vertexInputDescription.push_back(vInputAttribDescription);
             }
+
+            // Instance layout
+            if(pipelineCreateInfo.instanceBufferLayout.GetStride() > 0)
+            {
+                VkVertexInputBindingDescription instanceBindingDescription;
+                instanceBindingDescription.binding = 1;
+                instanceBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+                instanceBindingDescription.stride = pipelineCreateInfo.instanceBufferLayout.GetStride();
+                m_VertexBindingDescriptions.push_back(instanceBindingDescription);
+
+                for(auto& layout : pipelineCreateInfo.instanceBufferLayout.GetLayout())
+                {
+                    VkVertexInputAttributeDescription vInputAttribDescription;
+                    vInputAttribDescription.location = count++;
+                    vInputAttribDescription.binding = 1;
+                    vInputAttribDescription.format = VKTools::FormatToVK(layout.format);
+                    vInputAttribDescription.offset = layout.offset;
+                    vertexInputDescription.push_back(vInputAttribDescription);
+                }
+            }
             
 			VkPipelineVertexInputStateCreateInfo vi{};
 			memset(&vi, 0, sizeof(vi));
             vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 			vi.pNext = NULL;
-			vi.vertexBindingDescriptionCount = 1;
-			vi.pVertexBindingDescriptions = &m_VertexBindingDescription;
+			vi.vertexBindingDescriptionCount = u32(m_VertexBindingDescriptions.size());
+			vi.pVertexBindingDescriptions = m_VertexBindingDescriptions.data();
 			vi.vertexAttributeDescriptionCount = u32(vertexInputDescription.size());
 			vi.pVertexAttributeDescriptions = vertexInputDescription.data();
 
@@ -288,12 +283,7 @@ namespace Lumos
 
 		void VKPipeline::Unload() const
 		{
-			vkDestroyDescriptorPool(VKDevice::Get().GetDevice(), m_DescriptorPool, VK_NULL_HANDLE);
 			vkDestroyPipelineLayout(VKDevice::Get().GetDevice(), m_PipelineLayout, VK_NULL_HANDLE);
-
-			for (auto& descriptorLayout : m_DescriptorLayouts)
-				vkDestroyDescriptorSetLayout(VKDevice::Get().GetDevice(), descriptorLayout, VK_NULL_HANDLE);
-
 			vkDestroyPipeline(VKDevice::Get().GetDevice(), m_Pipeline, VK_NULL_HANDLE);
 		}
 
@@ -302,19 +292,6 @@ namespace Lumos
 			vkCmdBindPipeline(static_cast<VKCommandBuffer*>(cmdBuffer)->GetCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
 		}
 
-		VkDescriptorSet VKPipeline::CreateDescriptorSet()
-		{
-			VkDescriptorSet set;
-			VkDescriptorSetAllocateInfo descSetAllocInfo[1];
-			descSetAllocInfo[0].sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-			descSetAllocInfo[0].pNext = NULL;
-			descSetAllocInfo[0].descriptorPool = m_DescriptorPool;
-			descSetAllocInfo[0].descriptorSetCount = 1;
-			descSetAllocInfo[0].pSetLayouts = m_DescriptorLayouts.data();
-			VK_CHECK_RESULT(vkAllocateDescriptorSets(VKDevice::Get().GetDevice(), descSetAllocInfo, &set));
-			return set;
-		}
-        
         void VKPipeline::MakeDefault()
         {
             CreateFunc = CreateFuncVulkan;
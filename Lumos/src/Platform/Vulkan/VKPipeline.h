@@ -22,17 +22,12 @@ namespace Lumos
 			void Unload() const;
             void Bind(CommandBuffer* cmdBuffer) override;
 
-            VkDescriptorSet CreateDescriptorSet();
-
+			// Layouts are shared between pipelines and owned by VKDescriptorAllocator
 			VkDescriptorSetLayout* GetDescriptorLayout(int id)
 			{
 				return &m_DescriptorLayouts[id];
 			};
 
-			const VkDescriptorPool& GetDescriptorPool() const
-			{
-				return m_DescriptorPool;
-			};
 			const VkPipelineLayout& GetPipelineLayout() const
 			{
 				return m_PipelineLayout;
@@ -58,11 +53,12 @@ namespace Lumos
 
 		private:
 			
-			VkVertexInputBindingDescription m_VertexBindingDescription;
+			std::vector<VkVertexInputBindingDescription> m_VertexBindingDescriptions;
 			std::vector<VkDescriptorSetLayout> m_DescriptorLayouts;
-			VkDescriptorPool m_DescriptorPool;
 			DescriptorSet* m_DescriptorSet = nullptr;
 			Ref<Shader> m_Shader;
+			// Pipelines are cached by renderpass address, holding it stops another renderpass reusing the address
+			Ref<RenderPass> m_RenderPass;
 			
 			VkPipelineLayout m_PipelineLayout;
 			VkPipeline m_Pipeline;
@@ -0,0 +1,85 @@
+#include "Precompiled.h"
+#include "VKQuery.h"
+#include "VKDevice.h"
+#include "VKCommandBuffer.h"
+#include "VKTools.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		VKQuery::VKQuery(QueryType type, u32 count)
+		{
+			m_InUse = false;
+
+			VkQueryPoolCreateInfo queryPoolCI{};
+			queryPoolCI.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolCI.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolCI.queryCount = count;
+			VK_CHECK_RESULT(vkCreateQueryPool(VKDevice::Get().GetDevice(), &queryPoolCI, nullptr, &m_QueryPool));
+
+			m_TimestampPeriod = VKDevice::Get().GetPhysicalDevice()->GetProperties().limits.timestampPeriod;
+		}
+
+		VKQuery::~VKQuery()
+		{
+			vkDestroyQueryPool(VKDevice::Get().GetDevice(), m_QueryPool, nullptr);
+		}
+
+		void VKQuery::Begin()
+		{
+			LUMOS_ASSERT(false, "Occlusion queries are not supported by the Vulkan backend");
+		}
+
+		void VKQuery::End()
+		{
+		}
+
+		u32 VKQuery::GetResult()
+		{
+			return 0;
+		}
+
+		bool VKQuery::GetResultReady()
+		{
+			return false;
+		}
+
+		void VKQuery::WriteTimestamp(CommandBuffer* commandBuffer, u32 index)
+		{
+			VkCommandBuffer vkCommandBuffer = static_cast<VKCommandBuffer*>(commandBuffer)->GetCommandBuffer();
+
+			// Queries have to be reset before every write, which keeps each timestamp self contained
+			vkCmdResetQueryPool(vkCommandBuffer, m_QueryPool, index, 1);
+			vkCmdWriteTimestamp(vkCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_QueryPool, index);
+		}
+
+		bool VKQuery::GetTimestamps(u32 first, u32 count, u64* nanoseconds)
+		{
+			const VkResult result = vkGetQueryPoolResults(VKDevice::Get().GetDevice(), m_QueryPool, first, count, count * sizeof(u64), nanoseconds, sizeof(u64), VK_QUERY_RESULT_64_BIT);
+			if(result != VK_SUCCESS)
+				return false;
+
+			for(u32 i = 0; i < count; i++)
+				nanoseconds[i] = static_cast<u64>(static_cast<double>(nanoseconds[i]) * m_TimestampPeriod);
+			return true;
+		}
+
+		void VKQuery::MakeDefault()
+		{
+			CreateFunc = CreateFuncVulkan;
+		}
+
+		Query* VKQuery::CreateFuncVulkan(QueryType type, u32 count)
+		{
+			// Only timestamps are implemented, an occlusion query would silently never report any samples
+			if(type != QueryType::TIMESTAMP)
+			{
+				LUMOS_LOG_ERROR("Vulkan only supports timestamp queries, occlusion queries are not implemented");
+				return nullptr;
+			}
+
+			return new VKQuery(type, count);
+		}
+	}
+}
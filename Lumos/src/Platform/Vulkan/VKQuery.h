@@ -0,0 +1,33 @@
+#pragma once
+#include "VK.h"
+#include "Graphics/API/Query.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class VKQuery : public Query
+		{
+		public:
+			VKQuery(QueryType type, u32 count);
+			~VKQuery();
+
+			// Occlusion queries have to be recorded into a command buffer, which these do not take
+			void Begin() override;
+			u32 GetResult() override;
+			bool GetResultReady() override;
+			void End() override;
+
+			void WriteTimestamp(CommandBuffer* commandBuffer, u32 index) override;
+			bool GetTimestamps(u32 first, u32 count, u64* nanoseconds) override;
+
+			static void MakeDefault();
+		protected:
+			static Query* CreateFuncVulkan(QueryType type, u32 count);
+		private:
+			VkQueryPool m_QueryPool = VK_NULL_HANDLE;
+			// Nanoseconds per timestamp tick
+			float m_TimestampPeriod = 1.0f;
+		};
+	}
+}
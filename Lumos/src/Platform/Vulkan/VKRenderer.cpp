@@ -6,6 +6,7 @@
 #include "VKTools.h"
 #include "VKPipeline.h"
 #include "Core/Engine.h"
+#include "Graphics/API/ResourceCache.h"
  
 namespace Lumos
 {
@@ -103,6 +104,9 @@ namespace Lumos
 		{
 			LUMOS_PROFILE_FUNCTION();
 			m_CurrentSemaphoreIndex = 0;
+			VKDevice::Get().GetDescriptorAllocator()->BeginFrame(GetResourceReleaseDelay());
+			VKDevice::Get().GetUploadQueue()->Update();
+
             auto m_Swapchain = VKContext::Get()->GetSwapchain();
 			auto result = m_Swapchain->AcquireNextImage(m_ImageAvailableSemaphore[m_CurrentSemaphoreIndex]);
 			if(result == VK_ERROR_OUT_OF_DATE_KHR)
@@ -130,14 +134,18 @@ namespace Lumos
 			LUMOS_PROFILE_FUNCTION();
 			u32 numDynamicDescriptorSets = 0;
 			u32 numDesciptorSets = 0;
+			// Local so descriptor sets can be bound from several recording threads
+			VkDescriptorSet descriptorSetPool[16];
+			u32 dynamicOffsets[16];
 
 			for(auto descriptorSet : descriptorSets)
 			{
 				auto vkDesSet = static_cast<Graphics::VKDescriptorSet*>(descriptorSet);
+				// Each set's own offset, usually into the UniformRingBuffer, on top of the one passed in
 				if(vkDesSet->GetIsDynamic())
-					numDynamicDescriptorSets++;
+					dynamicOffsets[numDynamicDescriptorSets++] = dynamicOffset + vkDesSet->GetDynamicOffset();
 
-				m_DescriptorSetPool[numDesciptorSets] = vkDesSet->GetDescriptorSet();
+				descriptorSetPool[numDesciptorSets] = vkDesSet->GetDescriptorSet();
 
 				u32 index = 0;
 				for(auto& pc : vkDesSet->GetPushConstants())
@@ -148,7 +156,16 @@ namespace Lumos
 				numDesciptorSets++;
 			}
 
-			vkCmdBindDescriptorSets(static_cast<Graphics::VKCommandBuffer*>(cmdBuffer)->GetCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, static_cast<Graphics::VKPipeline*>(pipeline)->GetPipelineLayout(), 0, numDesciptorSets, m_DescriptorSetPool, numDynamicDescriptorSets, &dynamicOffset);
+			vkCmdBindDescriptorSets(static_cast<Graphics::VKCommandBuffer*>(cmdBuffer)->GetCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, static_cast<Graphics::VKPipeline*>(pipeline)->GetPipelineLayout(), 0, numDesciptorSets, descriptorSetPool, numDynamicDescriptorSets, dynamicOffsets);
+		}
+
+		void VKRenderer::PushConstantsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, std::vector<Graphics::PushConstant>& pushConstants)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			for(auto& pc : pushConstants)
+			{
+				vkCmdPushConstants(static_cast<Graphics::VKCommandBuffer*>(cmdBuffer)->GetCommandBuffer(), static_cast<Graphics::VKPipeline*>(pipeline)->GetPipelineLayout(), VKTools::ShaderTypeToVK(pc.shaderStage), pc.offset, pc.size, pc.data);
+			}
 		}
 
 		void VKRenderer::DrawIndexedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 start) const
@@ -158,6 +175,12 @@ namespace Lumos
 			vkCmdDrawIndexed(static_cast<VKCommandBuffer*>(commandBuffer)->GetCommandBuffer(), count, 1, 0, 0, 0);
 		}
 
+		void VKRenderer::DrawIndexedInstancedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 instanceCount) const
+		{
+			LUMOS_PROFILE_FUNCTION();
+			vkCmdDrawIndexed(static_cast<VKCommandBuffer*>(commandBuffer)->GetCommandBuffer(), count, instanceCount, 0, 0, 0);
+		}
+
 		void VKRenderer::DrawInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, DataType datayType, void* indices) const
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -45,7 +45,9 @@ namespace Lumos
 			const std::string& GetTitleInternal() const override;
 
 			void BindDescriptorSetsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, u32 dynamicOffset, std::vector<Graphics::DescriptorSet*>& descriptorSets) override;
+			void PushConstantsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, std::vector<Graphics::PushConstant>& pushConstants) override;
 			void DrawIndexedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 start) const override;
+			void DrawIndexedInstancedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 instanceCount) const override;
 			void DrawInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, DataType datayType, void* indices) const override;
 
 			void CreateSemaphores();
@@ -64,7 +66,6 @@ namespace Lumos
 			std::string m_RendererTitle;
 			u32 m_Width, m_Height;
 
-			VkDescriptorSet m_DescriptorSetPool[16];
 		};
 	}
 }
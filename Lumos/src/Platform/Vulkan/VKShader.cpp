@@ -5,6 +5,7 @@
 #include "Core/OS/FileSystem.h"
 #include "Core/VFS.h"
 #include "VKDescriptorSet.h"
+#include "Graphics/API/ShaderReflectionCache.h"
 
 #include <spirv_cross.hpp>
 
@@ -20,8 +21,6 @@ namespace Lumos
 {
 	namespace Graphics
 	{
-		static ShaderType type = ShaderType::UNKNOWN;
-
 		VKShader::VKShader(const std::string& filePath)
 			: m_StageCount(0)
 		{
@@ -72,58 +71,20 @@ namespace Lumos
                 shaderCreateInfo.pCode = source;
                 shaderCreateInfo.pNext = VK_NULL_HANDLE;
                 
-                std::vector<u32> spv(source, source + fileSize / sizeof(u32));
-
-                spirv_cross::Compiler comp(std::move(spv));
-                // The SPIR-V is now parsed, and we can perform reflection on it.
-                spirv_cross::ShaderResources resources = comp.get_shader_resources();
-                
-                for (auto &u : resources.uniform_buffers)
-                {
-                    uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
-                    uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
-                    auto& type = comp.get_type(u.type_id);
+                // Reflection is read from the cache, SPIRV-Cross only runs when the SPIR-V changed
+                const std::string cachePath = ShaderReflectionCache::GetFilePath(m_FilePath + file.second, ".vkreflect");
+                const u64 hash = ShaderReflectionCache::HashSource(source, fileSize);
 
-                    SHADER_LOG(LUMOS_LOG_INFO("Found UBO {0} at set = {1}, binding = {2}", u.name.c_str(), set, binding));
-                    m_DescriptorLayoutInfo.push_back({Graphics::DescriptorType::UNIFORM_BUFFER, file.first, binding, set, type.array.size() ? u32(type.array[0]) : 1});
-
-                }
-                
-                for (auto &u : resources.push_constant_buffers)
+                ShaderReflection reflection;
+                if(!ShaderReflectionCache::Load(cachePath, hash, reflection))
                 {
-                    uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
-                    uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
-                    
-                    uint32_t binding3 = comp.get_decoration(u.id, spv::DecorationOffset);
-
-                    auto& type = comp.get_type(u.type_id);
-                    
-                    auto ranges = comp.get_active_buffer_ranges(u.id);
-                    
-                    u32 size = 0;
-                    for(auto& range : ranges)
-                    {
-                        SHADER_LOG(LUMOS_LOG_INFO("Accessing Member {0} offset {1}, size {2}", range.index, range.offset, range.range));
-                        size += u32(range.range);
-                    }
-
-                    SHADER_LOG(LUMOS_LOG_INFO("Found Push Constant {0} at set = {1}, binding = {2}", u.name.c_str(), set, binding, type.array.size() ? u32(type.array[0]) : 1));
-                    
-                    m_PushConstants.push_back({size, file.first});
+                    Reflect(source, fileSize, file.first, reflection);
+                    ShaderReflectionCache::Save(cachePath, hash, reflection);
                 }
-                
-                for (auto &u : resources.sampled_images)
-                {
-                    uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
-                    uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
-                    
-                    auto& type = comp.get_type(u.type_id);
-                    SHADER_LOG(LUMOS_LOG_INFO("Found Sampled Image {0} at set = {1}, binding = {2}", u.name.c_str(), set, binding));
-                    
-                    m_DescriptorLayoutInfo.push_back({Graphics::DescriptorType::IMAGE_SAMPLER, file.first, binding, set, type.array.size() ? u32(type.array[0]) : 1});
 
-                }
-                
+                m_DescriptorLayoutInfo.insert(m_DescriptorLayoutInfo.end(), reflection.descriptorLayout.begin(), reflection.descriptorLayout.end());
+                m_PushConstants.insert(m_PushConstants.end(), reflection.pushConstants.begin(), reflection.pushConstants.end());
+
 				m_ShaderStages[currentShaderStage].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 				m_ShaderStages[currentShaderStage].stage = VKTools::ShaderTypeToVK(file.first);
 				m_ShaderStages[currentShaderStage].pName = "main";
@@ -139,6 +100,75 @@ namespace Lumos
 			return true;
 		}
 
+		void VKShader::Reflect(const u32* source, u32 fileSize, ShaderType stage, ShaderReflection& reflection)
+		{
+			LUMOS_PROFILE_FUNCTION();
+            std::vector<u32> spv(source, source + fileSize / sizeof(u32));
+
+            spirv_cross::Compiler comp(std::move(spv));
+            // The SPIR-V is now parsed, and we can perform reflection on it.
+            spirv_cross::ShaderResources resources = comp.get_shader_resources();
+            
+            for (auto &u : resources.uniform_buffers)
+            {
+                uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
+                uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
+                auto& type = comp.get_type(u.type_id);
+
+                SHADER_LOG(LUMOS_LOG_INFO("Found UBO {0} at set = {1}, binding = {2}", u.name.c_str(), set, binding));
+
+                // Per frame system uniforms live in the renderer's UniformRingBuffer and are bound with a dynamic offset
+                const bool dynamic = stage == ShaderType::VERTEX && set == SHADER_SYSTEM_UNIFORM_SET && binding == SHADER_SYSTEM_UNIFORM_BINDING;
+                reflection.descriptorLayout.push_back({dynamic ? Graphics::DescriptorType::UNIFORM_BUFFER_DYNAMIC : Graphics::DescriptorType::UNIFORM_BUFFER, stage, binding, set, type.array.size() ? u32(type.array[0]) : 1});
+
+            }
+
+            for (auto &u : resources.storage_buffers)
+            {
+                uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
+                uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
+                auto& type = comp.get_type(u.type_id);
+
+                SHADER_LOG(LUMOS_LOG_INFO("Found SSBO {0} at set = {1}, binding = {2}", u.name.c_str(), set, binding));
+                reflection.descriptorLayout.push_back({Graphics::DescriptorType::STORAGE_BUFFER, stage, binding, set, type.array.size() ? u32(type.array[0]) : 1});
+            }
+            
+            for (auto &u : resources.push_constant_buffers)
+            {
+                uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
+                uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
+                
+                uint32_t binding3 = comp.get_decoration(u.id, spv::DecorationOffset);
+
+                auto& type = comp.get_type(u.type_id);
+                
+                auto ranges = comp.get_active_buffer_ranges(u.id);
+                
+                u32 size = 0;
+                for(auto& range : ranges)
+                {
+                    SHADER_LOG(LUMOS_LOG_INFO("Accessing Member {0} offset {1}, size {2}", range.index, range.offset, range.range));
+                    size += u32(range.range);
+                }
+
+                SHADER_LOG(LUMOS_LOG_INFO("Found Push Constant {0} at set = {1}, binding = {2}", u.name.c_str(), set, binding, type.array.size() ? u32(type.array[0]) : 1));
+                
+                reflection.pushConstants.push_back({size, stage});
+            }
+            
+            for (auto &u : resources.sampled_images)
+            {
+                uint32_t set = comp.get_decoration(u.id, spv::DecorationDescriptorSet);
+                uint32_t binding = comp.get_decoration(u.id, spv::DecorationBinding);
+                
+                auto& type = comp.get_type(u.type_id);
+                SHADER_LOG(LUMOS_LOG_INFO("Found Sampled Image {0} at set = {1}, binding = {2}", u.name.c_str(), set, binding));
+                
+                reflection.descriptorLayout.push_back({Graphics::DescriptorType::IMAGE_SAMPLER, stage, binding, set, type.array.size() ? u32(type.array[0]) : 1});
+
+            }
+		}
+
 		void VKShader::Unload() const
 		{
 			for(uint32_t i = 0; i < m_StageCount; i++)
@@ -159,13 +189,15 @@ namespace Lumos
 
 		void VKShader::PreProcess(const std::string& source, std::map<ShaderType, std::string>* sources)
 		{
-			type = ShaderType::UNKNOWN;
 			std::vector<std::string> lines = StringUtilities::GetLines(source);
 			ReadShaderFile(lines, sources);
 		}
 
 		void VKShader::ReadShaderFile(std::vector<std::string> lines, std::map<ShaderType, std::string>* shaders)
 		{
+			// A local so shaders can be read on several threads at once
+			ShaderType type = ShaderType::UNKNOWN;
+
 			for(u32 i = 0; i < lines.size(); i++)
 			{
 				std::string str = std::string(lines[i]);
@@ -226,8 +258,9 @@ namespace Lumos
 			CreateFunc = CreateFuncVulkan;
 		}
 
-		Shader* VKShader::CreateFuncVulkan(const std::string& filepath)
+		Shader* VKShader::CreateFuncVulkan(const std::string& filepath, bool deferred)
 		{
+			// Shader modules can be created on any thread, so there is nothing to defer
 			std::string physicalPath;
 			Lumos::VFS::Get()->ResolvePhysicalPath(filepath, physicalPath, false);
 			return new VKShader(physicalPath);
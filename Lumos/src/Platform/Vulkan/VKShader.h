@@ -8,6 +8,8 @@ namespace Lumos
 {
 	namespace Graphics
 	{
+		struct ShaderReflection;
+
 		class VKShader : public Shader
 		{
 		public:
@@ -51,9 +53,11 @@ namespace Lumos
 			}
 
 		protected:
-			static Shader* CreateFuncVulkan(const std::string&);
+			static Shader* CreateFuncVulkan(const std::string&, bool);
 
 		private:
+			static void Reflect(const u32* source, u32 fileSize, ShaderType stage, ShaderReflection& reflection);
+
 			VkPipelineShaderStageCreateInfo* m_ShaderStages;
 			uint32_t m_StageCount;
 			std::string m_Name;
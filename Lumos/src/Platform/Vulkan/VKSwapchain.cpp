@@ -167,7 +167,11 @@ namespace Lumos
 			present.waitSemaphoreCount = 1;
 			present.pWaitSemaphores = &waitSemaphore;
 			present.pResults = VK_NULL_HANDLE;
-			auto error = vkQueuePresentKHR(VKDevice::Get().GetPresentQueue(), &present);
+			VkResult error;
+			{
+				std::lock_guard<std::mutex> lock(VKDevice::Get().GetQueueMutex());
+				error = vkQueuePresentKHR(VKDevice::Get().GetPresentQueue(), &present);
+			}
             
             if (error == VK_ERROR_OUT_OF_DATE_KHR)
             {
@@ -3,7 +3,6 @@
 #include "VKDevice.h"
 #include "Utilities/LoadImage.h"
 #include "VKTools.h"
-#include "VKBuffer.h"
 
 namespace Lumos
 {
@@ -187,25 +186,43 @@ namespace Lumos
 
 		VKTexture2D::~VKTexture2D()
 		{
-			if(m_TextureSampler)
-				vkDestroySampler(VKDevice::Device(), m_TextureSampler, nullptr);
-
-			if(m_TextureImageView)
-				vkDestroyImageView(VKDevice::Device(), m_TextureImageView, nullptr);
+			VkSampler sampler = m_TextureSampler;
+			VkImageView imageView = m_TextureImageView;
+			VkImage image = m_DeleteImage ? m_TextureImage : VK_NULL_HANDLE;
+#ifdef USE_VMA_ALLOCATOR
+			VmaAllocation allocation = m_Allocation;
+#else
+			VkDeviceMemory imageMemory = m_TextureImageMemory;
+#endif
 
-			if(m_DeleteImage)
+			auto destroy = [=]()
 			{
+				if(sampler)
+					vkDestroySampler(VKDevice::Device(), sampler, nullptr);
+
+				if(imageView)
+					vkDestroyImageView(VKDevice::Device(), imageView, nullptr);
+
+				if(image)
+				{
 #ifdef USE_VMA_ALLOCATOR
-				vmaDestroyImage(VKDevice::Get().GetAllocator(), m_TextureImage, m_Allocation);
+					vmaDestroyImage(VKDevice::Get().GetAllocator(), image, allocation);
 #else
-				vkDestroyImage(VKDevice::Get().GetDevice(), m_TextureImage, nullptr);
+					vkDestroyImage(VKDevice::Get().GetDevice(), image, nullptr);
 
-				if(m_TextureImageMemory)
-				{
-					vkFreeMemory(VKDevice::Get().GetDevice(), m_TextureImageMemory, nullptr);
-				}
+					if(imageMemory)
+					{
+						vkFreeMemory(VKDevice::Get().GetDevice(), imageMemory, nullptr);
+					}
 #endif
-			}
+				}
+			};
+
+			// An upload recorded for the image may not have executed yet
+			if(auto uploadQueue = VKDevice::Get().GetUploadQueue())
+				uploadQueue->DeferDestroy(destroy);
+			else
+				destroy();
 		}
 
 		void VKTexture2D::BuildTexture(TextureFormat internalformat, u32 width, u32 height, bool srgb, bool depth, bool samplerShadow)
@@ -254,9 +271,11 @@ namespace Lumos
 			m_Descriptor.sampler = m_TextureSampler;
 			m_Descriptor.imageView = m_TextureImageView;
 			m_Descriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			m_HandleID = VKTools::NewHandleID();
 		}
 
-		void GenerateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
+		// Expects every level in TRANSFER_DST_OPTIMAL with level 0 filled, leaves them all in SHADER_READ_ONLY_OPTIMAL
+		void GenerateMipmaps(VkCommandBuffer commandBuffer, VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
 		{
 			VkFormatProperties formatProperties;
 			vkGetPhysicalDeviceFormatProperties(VKDevice::Get().GetGPU(), imageFormat, &formatProperties);
@@ -266,8 +285,6 @@ namespace Lumos
 				LUMOS_LOG_ERROR("Texture image format does not support linear blitting!");
 			}
 
-			VkCommandBuffer commandBuffer = VKTools::BeginSingleTimeCommands();
-
 			VkImageMemoryBarrier barrier{};
 			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 			barrier.image = image;
@@ -361,8 +378,6 @@ namespace Lumos
 				nullptr,
 				1,
 				&barrier);
-
-			VKTools::EndSingleTimeCommands(commandBuffer);
 		}
 
 		bool VKTexture2D::Load()
@@ -392,27 +407,52 @@ namespace Lumos
 
 			m_MipLevels = static_cast<uint32_t>(std::floor(std::log2(Maths::Max(m_Width, m_Height)))) + 1;
 
-			VKBuffer* stagingBuffer = new VKBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, static_cast<u32>(imageSize), pixels);
-
-			if(m_Data == nullptr)
-				delete[] pixels;
 #ifdef USE_VMA_ALLOCATOR
 			Graphics::CreateImage(m_Width, m_Height, m_MipLevels, VKTools::TextureFormatToVK(m_Parameters.format, m_Parameters.srgb), VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_TextureImage, m_TextureImageMemory, 1, 0, m_Allocation);
 #else
 			Graphics::CreateImage(m_Width, m_Height, m_MipLevels, VKTools::TextureFormatToVK(m_Parameters.format, m_Parameters.srgb), VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_TextureImage, m_TextureImageMemory, 1, 0);
 #endif
 
-			VKTools::TransitionImageLayout(m_TextureImage, VKTools::TextureFormatToVK(m_Parameters.format, m_Parameters.srgb), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_MipLevels);
-			VKTools::CopyBufferToImage(stagingBuffer->GetBuffer(), m_TextureImage, static_cast<uint32_t>(m_Width), static_cast<uint32_t>(m_Height));
-			VKTools::TransitionImageLayout(m_TextureImage, VKTools::TextureFormatToVK(m_Parameters.format), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_MipLevels);
+			// Recorded into the upload batch, which is submitted ahead of any command buffer that can sample the image
+			VkImage image = m_TextureImage;
+			VkFormat format = VKTools::TextureFormatToVK(m_Parameters.format, m_Parameters.srgb);
+			u32 width = m_Width;
+			u32 height = m_Height;
+			u32 mipLevels = m_MipLevels;
 
-			delete stagingBuffer;
+			VKDevice::Get().GetUploadQueue()->Upload(pixels, imageSize, [=](VkCommandBuffer commandBuffer, VkBuffer stagingBuffer, VkDeviceSize stagingOffset)
+			{
+				VKTools::TransitionImageLayout(commandBuffer, image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+				VKTools::CopyBufferToImage(commandBuffer, stagingBuffer, stagingOffset, image, width, height);
+				GenerateMipmaps(commandBuffer, image, format, width, height, mipLevels);
+			});
 
-			GenerateMipmaps(m_TextureImage, VKTools::TextureFormatToVK(m_Parameters.format, m_Parameters.srgb), m_Width, m_Height, m_MipLevels);
+			if(m_Data == nullptr)
+				delete[] pixels;
 
 			return true;
 		}
 
+		void VKTexture2D::SetData(const void* pixels)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			VkImage image = m_TextureImage;
+			VkFormat format = VKTools::TextureFormatToVK(m_Parameters.format, m_Parameters.srgb);
+			u32 width = m_Width;
+			u32 height = m_Height;
+			u32 mipLevels = m_MipLevels;
+
+			const VkDeviceSize imageSize = VkDeviceSize(m_Width) * m_Height * GetStrideFromFormat(m_Parameters.format);
+
+			// Every texel is overwritten, so the previous contents can be discarded
+			VKDevice::Get().GetUploadQueue()->Upload(pixels, imageSize, [=](VkCommandBuffer commandBuffer, VkBuffer stagingBuffer, VkDeviceSize stagingOffset)
+			{
+				VKTools::TransitionImageLayout(commandBuffer, image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+				VKTools::CopyBufferToImage(commandBuffer, stagingBuffer, stagingOffset, image, width, height);
+				GenerateMipmaps(commandBuffer, image, format, width, height, mipLevels);
+			});
+		}
+
 		VKTextureCube::VKTextureCube(u32 size)
 			: m_ImageLayout()
 		{
@@ -474,6 +514,7 @@ namespace Lumos
 			m_Descriptor.sampler = m_TextureSampler;
 			m_Descriptor.imageView = m_TextureImageView;
 			m_Descriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			m_HandleID = VKTools::NewHandleID();
 		}
 
 		void VKTextureCube::Load(u32 mips)
@@ -553,21 +594,12 @@ namespace Lumos
 				}
 			}
 
-			VKBuffer* stagingBuffer = new VKBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, static_cast<u32>(size), allData);
-
-			if(m_Data == nullptr)
-			{
-				delete[] allData;
-				allData = nullptr;
-			}
 #ifdef USE_VMA_ALLOCATOR
 			Graphics::CreateImage(faceWidths[0], faceHeights[0], m_NumMips, VKTools::TextureFormatToVK(m_Parameters.format,m_Parameters.srgb), VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_TextureImage, m_TextureImageMemory, 6, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT, m_Allocation);
 #else
 			Graphics::CreateImage(faceWidths[0], faceHeights[0], m_NumMips, VKTools::TextureFormatToVK(m_Parameters.format,m_Parameters.srgb), VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_TextureImage, m_TextureImageMemory, 6, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT);
 #endif
 
-			VkCommandBuffer cmdBuffer = VKTools::BeginSingleTimeCommands();
-
 			//// Setup buffer copy regions for each face including all of it's miplevels
 			std::vector<VkBufferImageCopy> bufferCopyRegions;
 			uint32_t offset = 0;
@@ -601,39 +633,50 @@ namespace Lumos
 			subresourceRange.levelCount = m_NumMips;
 			subresourceRange.layerCount = 6;
 
-			VKTools::SetImageLayout(
-				cmdBuffer,
-				m_TextureImage,
-				VK_IMAGE_LAYOUT_UNDEFINED,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				subresourceRange);
-
-			// Copy the cube map faces from the staging buffer to the optimal tiled image
-			vkCmdCopyBufferToImage(
-				cmdBuffer,
-				stagingBuffer->GetBuffer(),
-				m_TextureImage,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				static_cast<uint32_t>(bufferCopyRegions.size()),
-				bufferCopyRegions.data());
-
 			// Change texture image layout to shader read after all faces have been copied
 			m_ImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-			VKTools::SetImageLayout(
-				cmdBuffer,
-				m_TextureImage,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				m_ImageLayout,
-				subresourceRange);
+			VkImage image = m_TextureImage;
+			VkImageLayout imageLayout = m_ImageLayout;
 
-			VKTools::EndSingleTimeCommands(cmdBuffer);
+			VKDevice::Get().GetUploadQueue()->Upload(allData, size, [=](VkCommandBuffer cmdBuffer, VkBuffer stagingBuffer, VkDeviceSize stagingOffset) mutable
+			{
+				VKTools::SetImageLayout(
+					cmdBuffer,
+					image,
+					VK_IMAGE_LAYOUT_UNDEFINED,
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					subresourceRange);
+
+				for(auto& region : bufferCopyRegions)
+					region.bufferOffset += stagingOffset;
+
+				// Copy the cube map faces from the staging buffer to the optimal tiled image
+				vkCmdCopyBufferToImage(
+					cmdBuffer,
+					stagingBuffer,
+					image,
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					static_cast<uint32_t>(bufferCopyRegions.size()),
+					bufferCopyRegions.data());
+
+				VKTools::SetImageLayout(
+					cmdBuffer,
+					image,
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					imageLayout,
+					subresourceRange);
+			});
+
+			if(m_Data == nullptr)
+			{
+				delete[] allData;
+				allData = nullptr;
+			}
 
 			m_TextureSampler = Graphics::CreateTextureSampler(VK_FILTER_LINEAR, VK_FILTER_LINEAR, 0.0f, static_cast<float>(m_NumMips), true, VKDevice::Get().GetPhysicalDevice()->GetProperties().limits.maxSamplerAnisotropy, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT);
 			m_TextureImageView = Graphics::CreateImageView(m_TextureImage, VKTools::TextureFormatToVK(m_Parameters.format, m_Parameters.srgb), m_NumMips, VK_IMAGE_VIEW_TYPE_CUBE, VK_IMAGE_ASPECT_COLOR_BIT, 6);
 
-			delete stagingBuffer;
-
 			for(u32 m = 0; m < mips; m++)
 			{
 				for(u32 f = 0; f < 6; f++)
@@ -693,6 +736,7 @@ namespace Lumos
 			m_Descriptor.sampler = m_TextureSampler;
 			m_Descriptor.imageView = m_TextureImageView;
 			m_Descriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			m_HandleID = VKTools::NewHandleID();
 		}
 
 		void VKTextureDepth::Resize(u32 width, u32 height)
@@ -768,6 +812,7 @@ namespace Lumos
 			m_Descriptor.sampler = m_TextureSampler;
 			m_Descriptor.imageView = m_TextureImageView;
 			m_Descriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			m_HandleID = VKTools::NewHandleID();
 		}
 
 		void* VKTextureDepthArray::GetHandleArray(u32 index)
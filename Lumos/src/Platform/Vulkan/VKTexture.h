@@ -24,13 +24,19 @@ namespace Lumos
 			void Bind(u32 slot = 0) const override{};
 			void Unbind(u32 slot = 0) const override{};
 
-			virtual void SetData(const void* pixels) override{};
+			// Replaces the whole image. The caller makes sure the GPU is no longer reading it
+			virtual void SetData(const void* pixels) override;
 
 			virtual void* GetHandle() const override
 			{
 				return (void*)&m_Descriptor;
 			}
 
+			u64 GetHandleID() const override
+			{
+				return m_HandleID;
+			}
+
 			_FORCE_INLINE_ u32 GetWidth() const override
 			{
 				return m_Width;
@@ -111,6 +117,7 @@ namespace Lumos
 			VkImageView m_TextureImageView;
 			VkSampler m_TextureSampler{};
 			VkDescriptorImageInfo m_Descriptor{};
+			u64 m_HandleID = 0;
 
 #ifdef USE_VMA_ALLOCATOR
 			VmaAllocation m_Allocation{};
@@ -133,6 +140,11 @@ namespace Lumos
 				return (void*)&m_Descriptor;
 			}
 
+			u64 GetHandleID() const override
+			{
+				return m_HandleID;
+			}
+
 			void Bind(u32 slot = 0) const override{};
 			void Unbind(u32 slot = 0) const override{};
 
@@ -205,6 +217,7 @@ namespace Lumos
 			VkImageView m_TextureImageView{};
 			VkSampler m_TextureSampler{};
 			VkDescriptorImageInfo m_Descriptor{};
+			u64 m_HandleID = 0;
 
 #ifdef USE_VMA_ALLOCATOR
 			VmaAllocation m_Allocation{};
@@ -228,6 +241,11 @@ namespace Lumos
 				return (void*)&m_Descriptor;
 			}
 
+			u64 GetHandleID() const override
+			{
+				return m_HandleID;
+			}
+
 			_FORCE_INLINE_ const std::string& GetName() const override
 			{
 				return m_Name;
@@ -275,6 +293,7 @@ namespace Lumos
 			VkImageView m_TextureImageView{};
 			VkSampler m_TextureSampler{};
 			VkDescriptorImageInfo m_Descriptor{};
+			u64 m_HandleID = 0;
 
 #ifdef USE_VMA_ALLOCATOR
 			VmaAllocation m_Allocation{};
@@ -296,6 +315,11 @@ namespace Lumos
 				return (void*)&m_Descriptor;
 			}
 
+			u64 GetHandleID() const override
+			{
+				return m_HandleID;
+			}
+
 			_FORCE_INLINE_ const std::string& GetName() const override
 			{
 				return m_Name;
@@ -351,6 +375,7 @@ namespace Lumos
 			VkImageView m_TextureImageView{};
 			VkSampler m_TextureSampler{};
 			VkDescriptorImageInfo m_Descriptor{};
+			u64 m_HandleID = 0;
 
 			std::vector<VkImageView> m_IndividualImageViews;
 
@@ -101,8 +101,11 @@ namespace Lumos
 			submitInfo.signalSemaphoreCount = 0;
 			submitInfo.waitSemaphoreCount = 0;
 
-			VK_CHECK_RESULT(vkQueueSubmit(VKDevice::Get().GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE));
-			VK_CHECK_RESULT(vkQueueWaitIdle(VKDevice::Get().GetGraphicsQueue()));
+			{
+				std::lock_guard<std::mutex> lock(VKDevice::Get().GetQueueMutex());
+				VK_CHECK_RESULT(vkQueueSubmit(VKDevice::Get().GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE));
+				VK_CHECK_RESULT(vkQueueWaitIdle(VKDevice::Get().GetGraphicsQueue()));
+			}
 
 			vkFreeCommandBuffers(VKDevice::Get().GetDevice(),
 				VKDevice::Get().GetCommandPool()->GetCommandPool(), 1, &commandBuffer);
@@ -111,9 +114,14 @@ namespace Lumos
         void VKTools::CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
         {
             VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+            CopyBufferToImage(commandBuffer, buffer, 0, image, width, height);
+            VKTools::EndSingleTimeCommands(commandBuffer);
+        }
 
+        void VKTools::CopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize bufferOffset, VkImage image, uint32_t width, uint32_t height)
+        {
             VkBufferImageCopy region;
-            region.bufferOffset = 0;
+            region.bufferOffset = bufferOffset;
             region.bufferRowLength = 0;
             region.bufferImageHeight = 0;
             region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -128,8 +136,6 @@ namespace Lumos
 			};
 
 			vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-            VKTools::EndSingleTimeCommands(commandBuffer);
         }
 
         void VKTools::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
@@ -152,7 +158,13 @@ namespace Lumos
             uint32_t mipLevels)
         {
             VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+            TransitionImageLayout(commandBuffer, image, format, oldLayout, newLayout, mipLevels);
+            EndSingleTimeCommands(commandBuffer);
+        }
 
+        void VKTools::TransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
+            uint32_t mipLevels)
+        {
             VkImageMemoryBarrier barrier = {};
 			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
             barrier.oldLayout = oldLayout;
@@ -220,10 +232,14 @@ namespace Lumos
 				0, nullptr,
 				1, &barrier
 			);
-
-            EndSingleTimeCommands(commandBuffer);
         }
 
+		u64 VKTools::NewHandleID()
+		{
+			static std::atomic<u64> nextID = 1;
+			return nextID++;
+		}
+
         VkFormat VKTools::FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling,
                                         VkFormatFeatureFlags features)
         {
@@ -330,6 +346,7 @@ namespace Lumos
             case DescriptorType::UNIFORM_BUFFER		    : return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
             case DescriptorType::UNIFORM_BUFFER_DYNAMIC : return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
             case DescriptorType::IMAGE_SAMPLER			: return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            case DescriptorType::STORAGE_BUFFER			: return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
             }
 
             return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -517,6 +534,7 @@ namespace Lumos
                     case TextureFormat::RG8:                return VK_FORMAT_R8G8_SRGB;
                     case TextureFormat::RGB8:               return VK_FORMAT_R8G8B8A8_SRGB;
                     case TextureFormat::RGBA8:              return VK_FORMAT_R8G8B8A8_SRGB;
+                    case TextureFormat::RG16:               return VK_FORMAT_R16G16_SFLOAT;
                     case TextureFormat::RGB16:              return VK_FORMAT_R16G16B16_SFLOAT;
                     case TextureFormat::RGBA16:             return VK_FORMAT_R16G16B16A16_SFLOAT;
                     case TextureFormat::RGB32:              return VK_FORMAT_R32G32B32_SFLOAT;
@@ -534,6 +552,7 @@ namespace Lumos
                     case TextureFormat::RG8:                return VK_FORMAT_R8G8_UNORM;
                     case TextureFormat::RGB8:               return VK_FORMAT_R8G8B8A8_UNORM;
                     case TextureFormat::RGBA8:              return VK_FORMAT_R8G8B8A8_UNORM;
+                    case TextureFormat::RG16:               return VK_FORMAT_R16G16_SFLOAT;
                     case TextureFormat::RGB16:              return VK_FORMAT_R16G16B16_SFLOAT;
                     case TextureFormat::RGBA16:             return VK_FORMAT_R16G16B16A16_SFLOAT;
                     case TextureFormat::RGB32:              return VK_FORMAT_R32G32B32_SFLOAT;
@@ -35,11 +35,13 @@ namespace Lumos
 			void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
 
 			void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+			void CopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize bufferOffset, VkImage image, uint32_t width, uint32_t height);
 			void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
 
 			bool HasStencilComponent(VkFormat format);
 
 			void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
+			void TransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
 
 			uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 			VkFormat FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
@@ -47,6 +49,9 @@ namespace Lumos
 
 			std::string ErrorString(VkResult errorCode);
 
+			// Unique for the lifetime of the process, given to objects each time they create their handles
+			u64 NewHandleID();
+
 			VkVertexInputAttributeDescription VertexInputDescriptionToVK(VertexInputDescription description);
 			VkCullModeFlags CullModeToVK(CullMode mode);
 			VkDescriptorType DescriptorTypeToVK(DescriptorType type);
@@ -9,7 +9,7 @@ namespace Lumos
 	{
 		VKUniformBuffer::VKUniformBuffer(uint32_t size, const void* data)
 		{
-			VKBuffer::Init(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, size, data);
+			VKBuffer::Init(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, size, data);
 		}
 
 		VKUniformBuffer::VKUniformBuffer()
@@ -25,7 +25,7 @@ namespace Lumos
 
 		void VKUniformBuffer::Init(uint32_t size, const void* data)
 		{
-			VKBuffer::Init(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, size, data);
+			VKBuffer::Init(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, size, data);
 		}
 
 		void VKUniformBuffer::SetData(uint32_t size, const void* data)
@@ -42,6 +42,18 @@ namespace Lumos
 			VKBuffer::Flush(size);
 			VKBuffer::UnMap();
 		}
+
+		u8* VKUniformBuffer::MapPersistent()
+		{
+			if(!m_Mapped)
+				VKBuffer::Map();
+			return static_cast<u8*>(m_Mapped);
+		}
+
+		void VKUniformBuffer::Flush(uint32_t offset, uint32_t size)
+		{
+			// Uniform buffers are allocated host coherent, writes are visible without flushing
+		}
         
         void VKUniformBuffer::MakeDefault()
         {
@@ -0,0 +1,271 @@
+#include "Precompiled.h"
+#include "VKUploadQueue.h"
+#include "VKBuffer.h"
+#include "VKDevice.h"
+#include "VKTools.h"
+#include "Core/Engine.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// Satisfies the bufferOffset alignment of buffer to image copies for every texel size in use
+		static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+		VKUploadQueue::VKUploadQueue(VkDeviceSize stagingSize)
+			: m_StagingSize(stagingSize)
+		{
+			VkCommandPoolCreateInfo cmdPoolCI{};
+			cmdPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			cmdPoolCI.queueFamilyIndex = VKDevice::Get().GetPhysicalDevice()->GetGraphicsQueueFamilyIndex();
+			cmdPoolCI.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+			VK_CHECK_RESULT(vkCreateCommandPool(VKDevice::Get().GetDevice(), &cmdPoolCI, nullptr, &m_CommandPool));
+
+			m_StagingBuffer = new VKBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, static_cast<u32>(m_StagingSize), nullptr);
+			m_StagingBuffer->Map();
+			m_StagingData = static_cast<u8*>(m_StagingBuffer->GetMappedData());
+		}
+
+		VKUploadQueue::~VKUploadQueue()
+		{
+			SubmitBatch();
+			while(!m_InFlight.empty())
+				RetireBatches(true);
+
+			// Nothing is left for the callbacks to hand the resources to
+			m_CompletedCallbacks.clear();
+
+			for(auto& destroy : m_CompletedDestroys)
+				destroy();
+			m_CompletedDestroys.clear();
+
+			VkDevice device = VKDevice::Get().GetDevice();
+			for(auto batch : m_FreeBatches)
+			{
+				vkDestroyFence(device, batch->fence, nullptr);
+				delete batch;
+			}
+
+			vkDestroyCommandPool(device, m_CommandPool, nullptr);
+			delete m_StagingBuffer;
+		}
+
+		void VKUploadQueue::Upload(const void* data, VkDeviceSize size, const RecordFunc& record, std::function<void()> onComplete)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			VkBuffer srcBuffer;
+			VkDeviceSize srcOffset = 0;
+			VKBuffer* dedicatedBuffer = nullptr;
+
+			// Large uploads would stall behind everything else in the ring, they get a buffer of their own
+			if(size > m_StagingSize / 4)
+			{
+				dedicatedBuffer = new VKBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, static_cast<u32>(size), data);
+				srcBuffer = dedicatedBuffer->GetBuffer();
+			}
+			else
+			{
+				RetireBatches(false);
+				while(!AllocateStaging(size, srcOffset))
+				{
+					// The ring is full of uploads the GPU has not finished yet
+					if(m_InFlight.empty())
+						SubmitBatch();
+					RetireBatches(true);
+				}
+
+				memcpy(m_StagingData + srcOffset, data, size);
+				srcBuffer = m_StagingBuffer->GetBuffer();
+			}
+
+			Batch* batch = GetRecordingBatch();
+			record(batch->commandBuffer, srcBuffer, srcOffset);
+
+			if(dedicatedBuffer)
+				batch->dedicatedBuffers.push_back(dedicatedBuffer);
+			if(onComplete)
+				batch->callbacks.push_back(std::move(onComplete));
+
+			m_UploadedBytes += static_cast<u32>(size);
+		}
+
+		void VKUploadQueue::Submit()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			SubmitBatch();
+		}
+
+		void VKUploadQueue::Update()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				RetireBatches(false);
+
+				auto& stats = Engine::Get().Statistics();
+				stats.NumUploadBatchesInFlight = static_cast<u32>(m_InFlight.size());
+				stats.UploadedBytes = m_UploadedBytes;
+				m_UploadedBytes = 0;
+			}
+
+			RunCallbacks();
+		}
+
+		void VKUploadQueue::Flush()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				SubmitBatch();
+				while(!m_InFlight.empty())
+					RetireBatches(true);
+			}
+
+			RunCallbacks();
+		}
+
+		void VKUploadQueue::DeferDestroy(std::function<void()> destroy)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			// Batches retire in submission order, so the newest one finishing covers every upload that came before it
+			if(m_Recording)
+				m_Recording->destroys.push_back(std::move(destroy));
+			else if(!m_InFlight.empty())
+				m_InFlight.back()->destroys.push_back(std::move(destroy));
+			else
+				m_CompletedDestroys.push_back(std::move(destroy));
+		}
+
+		VKUploadQueue::Batch* VKUploadQueue::GetRecordingBatch()
+		{
+			if(m_Recording)
+				return m_Recording;
+
+			if(m_FreeBatches.empty())
+			{
+				m_Recording = new Batch();
+
+				VkCommandBufferAllocateInfo allocInfo = {};
+				allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+				allocInfo.commandPool = m_CommandPool;
+				allocInfo.commandBufferCount = 1;
+				VK_CHECK_RESULT(vkAllocateCommandBuffers(VKDevice::Get().GetDevice(), &allocInfo, &m_Recording->commandBuffer));
+
+				VkFenceCreateInfo fenceCI{};
+				fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+				VK_CHECK_RESULT(vkCreateFence(VKDevice::Get().GetDevice(), &fenceCI, nullptr, &m_Recording->fence));
+			}
+			else
+			{
+				m_Recording = m_FreeBatches.back();
+				m_FreeBatches.pop_back();
+			}
+
+			VkCommandBufferBeginInfo beginInfo = {};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			VK_CHECK_RESULT(vkBeginCommandBuffer(m_Recording->commandBuffer, &beginInfo));
+
+			return m_Recording;
+		}
+
+		bool VKUploadQueue::AllocateStaging(VkDeviceSize size, VkDeviceSize& offset)
+		{
+			u64 start = (m_StagingHead + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+
+			// Allocations never straddle the end of the ring, the remainder is skipped
+			if(start % m_StagingSize + size > m_StagingSize)
+				start = (start / m_StagingSize + 1) * m_StagingSize;
+
+			if(start + size - m_StagingTail > m_StagingSize)
+				return false;
+
+			m_StagingHead = start + size;
+			offset = start % m_StagingSize;
+			return true;
+		}
+
+		void VKUploadQueue::SubmitBatch()
+		{
+			if(!m_Recording)
+				return;
+
+			LUMOS_PROFILE_FUNCTION();
+			VK_CHECK_RESULT(vkEndCommandBuffer(m_Recording->commandBuffer));
+			m_Recording->stagingEnd = m_StagingHead;
+
+			VkSubmitInfo submitInfo = {};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &m_Recording->commandBuffer;
+
+			{
+				std::lock_guard<std::mutex> queueLock(VKDevice::Get().GetQueueMutex());
+				VK_CHECK_RESULT(vkQueueSubmit(VKDevice::Get().GetGraphicsQueue(), 1, &submitInfo, m_Recording->fence));
+			}
+
+			m_InFlight.push_back(m_Recording);
+			m_Recording = nullptr;
+		}
+
+		void VKUploadQueue::RetireBatches(bool waitOldest)
+		{
+			VkDevice device = VKDevice::Get().GetDevice();
+
+			while(!m_InFlight.empty())
+			{
+				Batch* batch = m_InFlight.front();
+				if(waitOldest)
+				{
+					LUMOS_PROFILE_SCOPE("vkWaitForFences");
+					VK_CHECK_RESULT(vkWaitForFences(device, 1, &batch->fence, VK_TRUE, UINT64_MAX));
+					waitOldest = false;
+				}
+				else if(vkGetFenceStatus(device, batch->fence) != VK_SUCCESS)
+					break;
+
+				VK_CHECK_RESULT(vkResetFences(device, 1, &batch->fence));
+				vkResetCommandBuffer(batch->commandBuffer, 0);
+
+				m_StagingTail = batch->stagingEnd;
+
+				for(auto buffer : batch->dedicatedBuffers)
+					delete buffer;
+				batch->dedicatedBuffers.clear();
+
+				for(auto& callback : batch->callbacks)
+					m_CompletedCallbacks.push_back(std::move(callback));
+				batch->callbacks.clear();
+
+				for(auto& destroy : batch->destroys)
+					m_CompletedDestroys.push_back(std::move(destroy));
+				batch->destroys.clear();
+
+				m_InFlight.pop_front();
+				m_FreeBatches.push_back(batch);
+			}
+		}
+
+		void VKUploadQueue::RunCallbacks()
+		{
+			std::vector<std::function<void()>> callbacks;
+			std::vector<std::function<void()>> destroys;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				callbacks.swap(m_CompletedCallbacks);
+				destroys.swap(m_CompletedDestroys);
+			}
+
+			// Run unlocked, a callback may start another upload
+			for(auto& callback : callbacks)
+				callback();
+
+			for(auto& destroy : destroys)
+				destroy();
+		}
+	}
+}
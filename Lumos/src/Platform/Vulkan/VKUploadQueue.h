@@ -0,0 +1,82 @@
+#pragma once
+#include "VK.h"
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class VKBuffer;
+
+		// Records staging copies for textures and buffers into one command buffer that is submitted ahead of the next
+		// graphics queue submission, rather than a command buffer and a queue wait per upload.
+		// Staging memory comes from a persistently mapped ring and is reclaimed, and completion callbacks run,
+		// once the fence of the batch it was recorded in has signalled
+		class VKUploadQueue
+		{
+		public:
+			// Records the commands for one upload, the data is in srcBuffer at srcOffset
+			typedef std::function<void(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkDeviceSize srcOffset)> RecordFunc;
+
+			explicit VKUploadQueue(VkDeviceSize stagingSize);
+			~VKUploadQueue();
+
+			// Copies data to staging memory and records the upload into the current batch. Can be called from any thread.
+			// onComplete is called from Update once the GPU has finished the upload
+			void Upload(const void* data, VkDeviceSize size, const RecordFunc& record, std::function<void()> onComplete = nullptr);
+
+			// Submits the current batch. Called before every other graphics queue submission so uploads are executed first
+			void Submit();
+
+			// Reclaims the staging memory of finished batches and runs their callbacks. Call once per frame
+			void Update();
+
+			// Submits the current batch and waits for every batch to finish
+			void Flush();
+
+			// Runs destroy from Update once every batch recorded so far has finished, for resources that an
+			// upload may still be writing to
+			void DeferDestroy(std::function<void()> destroy);
+
+		private:
+			struct Batch
+			{
+				VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+				VkFence fence = VK_NULL_HANDLE;
+				u64 stagingEnd = 0;
+				std::vector<VKBuffer*> dedicatedBuffers;
+				std::vector<std::function<void()>> callbacks;
+				std::vector<std::function<void()>> destroys;
+			};
+
+			Batch* GetRecordingBatch();
+			bool AllocateStaging(VkDeviceSize size, VkDeviceSize& offset);
+			void SubmitBatch();
+			// Retires finished batches in submission order, waiting for the oldest first if waitOldest is set
+			void RetireBatches(bool waitOldest);
+			void RunCallbacks();
+
+			VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+
+			VKBuffer* m_StagingBuffer = nullptr;
+			u8* m_StagingData = nullptr;
+			VkDeviceSize m_StagingSize;
+			// Running byte counts, their difference is the part of the ring still in use
+			u64 m_StagingHead = 0;
+			u64 m_StagingTail = 0;
+
+			Batch* m_Recording = nullptr;
+			std::deque<Batch*> m_InFlight;
+			std::vector<Batch*> m_FreeBatches;
+			std::vector<std::function<void()>> m_CompletedCallbacks;
+			std::vector<std::function<void()>> m_CompletedDestroys;
+			u32 m_UploadedBytes = 0;
+
+			// Uploads are recorded from whichever thread loads the resource
+			std::mutex m_Mutex;
+		};
+	}
+}
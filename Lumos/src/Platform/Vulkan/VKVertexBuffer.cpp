@@ -41,7 +41,12 @@ namespace Lumos
 		void VKVertexBuffer::SetDataSub(u32 size, const void* data, u32 offset)
 		{
 			LUMOS_PROFILE_FUNCTION();
-			VKBuffer::Init(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, size, data);
+			if(size + offset > m_Size)
+				Resize(size + offset);
+
+			VKBuffer::Map();
+			memcpy(static_cast<u8*>(m_Mapped) + offset, data, size);
+			VKBuffer::UnMap();
 		}
 
 		void* VKVertexBuffer::GetPointerInternal()
@@ -75,6 +80,14 @@ namespace Lumos
                 vkCmdBindVertexBuffers(static_cast<VKCommandBuffer*>(commandBuffer)->GetCommandBuffer(), 0, 1, &m_Buffer, offsets);
 		}
 
+		void VKVertexBuffer::BindInstances(CommandBuffer* commandBuffer, Pipeline* pipeline, u32 offset)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			VkDeviceSize offsets[1] = { offset };
+			if(commandBuffer)
+				vkCmdBindVertexBuffers(static_cast<VKCommandBuffer*>(commandBuffer)->GetCommandBuffer(), 1, 1, &m_Buffer, offsets);
+		}
+
 		void VKVertexBuffer::Unbind()
 		{
 		}
@@ -19,6 +19,7 @@ namespace Lumos
 			void ReleasePointer() override;
 
 			void Bind(CommandBuffer* commandBuffer, Pipeline* pipeline) override;
+			void BindInstances(CommandBuffer* commandBuffer, Pipeline* pipeline, u32 offset) override;
 			void Unbind() override;
             
             static void MakeDefault();
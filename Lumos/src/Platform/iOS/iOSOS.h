@@ -16,6 +16,7 @@ namespace Lumos
 		}
 		std::string GetExecutablePath() override;
 		std::string GetAssetPath() override;
+		std::string GetCachePath() override;
 		void Vibrate() const override;
 
 		void* GetIOSView() const
@@ -79,6 +79,13 @@ static iOSOS* os = nullptr;
     {
         return [NSBundle.mainBundle.resourcePath stringByAppendingString: @"/"].UTF8String;
     }
+
+    std::string iOSOS::GetCachePath()
+    {
+        // The bundle is read only
+        NSString* caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+        return [caches stringByAppendingString: @"/"].UTF8String;
+    }
     
     void iOSOS::OnKeyPressed(char keycode, bool down)
     {
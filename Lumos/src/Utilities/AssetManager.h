@@ -1,10 +1,13 @@
 #pragma once
 
 #include "Core/VFS.h"
+#include "Core/JobSystem.h"
 #include "Audio/Sound.h"
 #include "Graphics/API/Shader.h"
 #include "Utilities/TSingleton.h"
 
+#include <future>
+
 namespace Lumos
 {
 	template<typename T>
@@ -117,6 +120,20 @@ namespace Lumos
             typename MapType::iterator itr = m_nameResourceMap.find(name);
             return itr != m_nameResourceMap.end();
         }
+
+        // Name a loaded resource was requested by, linear in the number of resources
+        bool GetName(const ResourceHandle& data, IDType& name) const
+        {
+            for(auto& [id, resource] : m_nameResourceMap)
+            {
+                if(resource.data == data)
+                {
+                    name = id;
+                    return true;
+                }
+            }
+            return false;
+        }
         
         ResourceHandle operator[](const IDType& name)
         {
@@ -141,11 +158,14 @@ namespace Lumos
         public:
         ShaderLibrary()
         {
-            m_loadFunc = Load;
+            m_loadFunc = [this](const std::string& filePath, Ref<Graphics::Shader>& shader) { return LoadPending(filePath, shader); };
         }
         
         ~ShaderLibrary()
         {
+            // Jobs still running write to the promises, so they are waited for
+            for(auto& [filePath, pending] : m_Pending)
+                delete pending.get();
         }
         
         static bool Load(const std::string& filePath, Ref<Graphics::Shader>& shader)
@@ -153,5 +173,37 @@ namespace Lumos
             shader = Ref<Graphics::Shader>(Graphics::Shader::CreateFromFile(filePath));
             return true;
         }
+
+        // Starts loading the shaders on JobSystem workers. GetResource waits for one that is still loading and
+        // completes it on the calling thread, so it has to be the main thread
+        void LoadAsync(const std::vector<std::string>& filePaths)
+        {
+            LUMOS_PROFILE_FUNCTION();
+            for(auto& filePath : filePaths)
+            {
+                if(ResourceExists(filePath) || m_Pending.find(filePath) != m_Pending.end())
+                    continue;
+
+                auto promise = std::make_shared<std::promise<Graphics::Shader*>>();
+                m_Pending[filePath] = promise->get_future();
+                System::JobSystem::Execute([promise, filePath]() { promise->set_value(Graphics::Shader::CreateFromFile(filePath, true)); });
+            }
+        }
+
+        private:
+        bool LoadPending(const std::string& filePath, Ref<Graphics::Shader>& shader)
+        {
+            auto pending = m_Pending.find(filePath);
+            if(pending == m_Pending.end())
+                return Load(filePath, shader);
+
+            LUMOS_PROFILE_SCOPE("Wait For Shader");
+            shader = Ref<Graphics::Shader>(pending->second.get());
+            m_Pending.erase(pending);
+            shader->CompleteLoading();
+            return true;
+        }
+
+        std::unordered_map<std::string, std::future<Graphics::Shader*>> m_Pending;
     };
 }
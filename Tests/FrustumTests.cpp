@@ -0,0 +1,137 @@
+#include "Precompiled.h"
+#include "Tests.h"
+#include "Maths/Frustum.h"
+#include "Maths/Sphere.h"
+
+#include <chrono>
+#include <random>
+
+using namespace Lumos;
+using namespace Lumos::Maths;
+
+#define FRUSTUM_TEST_COUNT 4099 // Not a multiple of 4 or 32, so the scalar tail and a partial mask word are covered
+#define FRUSTUM_BENCH_ITERATIONS 200
+
+struct SoABoxes
+{
+	std::vector<float> centreX, centreY, centreZ;
+	std::vector<float> extentX, extentY, extentZ;
+	std::vector<float> radius;
+};
+
+static Frustum MakeFrustum()
+{
+	Frustum frustum;
+	frustum.Define(Matrix4::Perspective(0.1f, 200.0f, 16.0f / 9.0f, 60.0f));
+	return frustum;
+}
+
+// Spread around the frustum so roughly half are culled
+static void MakeBoxes(std::vector<BoundingBox>& boxes, SoABoxes& soa)
+{
+	std::mt19937 generator(1234);
+	std::uniform_real_distribution<float> position(-150.0f, 150.0f);
+	std::uniform_real_distribution<float> size(0.1f, 4.0f);
+
+	for(u32 i = 0; i < FRUSTUM_TEST_COUNT; i++)
+	{
+		const Vector3 centre(position(generator), position(generator), position(generator));
+		const Vector3 extent(size(generator), size(generator), size(generator));
+		boxes.emplace_back(centre - extent, centre + extent);
+
+		soa.centreX.push_back(centre.x);
+		soa.centreY.push_back(centre.y);
+		soa.centreZ.push_back(centre.z);
+		soa.extentX.push_back(extent.x);
+		soa.extentY.push_back(extent.y);
+		soa.extentZ.push_back(extent.z);
+		soa.radius.push_back(extent.Length());
+	}
+}
+
+static bool IsVisible(const std::vector<unsigned>& visibility, u32 index)
+{
+	return (visibility[index >> 5] & (1u << (index & 31))) != 0;
+}
+
+static void TestBoxesMatchScalar(const Frustum& frustum, const std::vector<BoundingBox>& boxes, const SoABoxes& soa)
+{
+	std::vector<unsigned> visibility((FRUSTUM_TEST_COUNT + 31) / 32, ~0u);
+	frustum.IsInsideFast(soa.centreX.data(), soa.centreY.data(), soa.centreZ.data(), soa.extentX.data(), soa.extentY.data(), soa.extentZ.data(), FRUSTUM_TEST_COUNT, visibility.data());
+
+	u32 mismatches = 0;
+	u32 visible = 0;
+	for(u32 i = 0; i < FRUSTUM_TEST_COUNT; i++)
+	{
+		const bool scalar = frustum.IsInsideFast(boxes[i]) != OUTSIDE;
+		mismatches += scalar != IsVisible(visibility, i) ? 1 : 0;
+		visible += scalar ? 1 : 0;
+	}
+
+	CHECK(mismatches == 0);
+	// Both outcomes have to be exercised for the comparison to mean anything
+	CHECK(visible > 0 && visible < FRUSTUM_TEST_COUNT);
+	// Bits past count are left clear
+	CHECK((visibility.back() >> (FRUSTUM_TEST_COUNT & 31)) == 0);
+}
+
+static void TestSpheresMatchScalar(const Frustum& frustum, const SoABoxes& soa)
+{
+	std::vector<unsigned> visibility((FRUSTUM_TEST_COUNT + 31) / 32, ~0u);
+	frustum.IsInsideFast(soa.centreX.data(), soa.centreY.data(), soa.centreZ.data(), soa.radius.data(), FRUSTUM_TEST_COUNT, visibility.data());
+
+	u32 mismatches = 0;
+	for(u32 i = 0; i < FRUSTUM_TEST_COUNT; i++)
+	{
+		const Sphere sphere(Vector3(soa.centreX[i], soa.centreY[i], soa.centreZ[i]), soa.radius[i]);
+		const bool scalar = frustum.IsInsideFast(sphere) != OUTSIDE;
+		mismatches += scalar != IsVisible(visibility, i) ? 1 : 0;
+	}
+
+	CHECK(mismatches == 0);
+}
+
+// Timings are printed, not checked, they depend on the machine running the tests
+static void BenchmarkBoxes(const Frustum& frustum, const std::vector<BoundingBox>& boxes, const SoABoxes& soa)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	std::vector<unsigned> visibility((FRUSTUM_TEST_COUNT + 31) / 32);
+	u32 scalarVisible = 0;
+	u32 soaVisible = 0;
+
+	const auto scalarStart = Clock::now();
+	for(u32 iteration = 0; iteration < FRUSTUM_BENCH_ITERATIONS; iteration++)
+	{
+		for(const auto& box : boxes)
+			scalarVisible += frustum.IsInsideFast(box) != OUTSIDE ? 1 : 0;
+	}
+	const auto scalarEnd = Clock::now();
+
+	for(u32 iteration = 0; iteration < FRUSTUM_BENCH_ITERATIONS; iteration++)
+	{
+		frustum.IsInsideFast(soa.centreX.data(), soa.centreY.data(), soa.centreZ.data(), soa.extentX.data(), soa.extentY.data(), soa.extentZ.data(), FRUSTUM_TEST_COUNT, visibility.data());
+		soaVisible += visibility[iteration % visibility.size()] & 1u;
+	}
+	const auto soaEnd = Clock::now();
+
+	const double tests = double(FRUSTUM_TEST_COUNT) * FRUSTUM_BENCH_ITERATIONS;
+	const double scalarNs = std::chrono::duration<double, std::nano>(scalarEnd - scalarStart).count() / tests;
+	const double soaNs = std::chrono::duration<double, std::nano>(soaEnd - scalarEnd).count() / tests;
+
+	// The visible counts are printed so neither loop can be optimised away
+	std::cout << "Frustum box test : scalar " << scalarNs << " ns | SoA " << soaNs << " ns | speedup " << (soaNs > 0.0 ? scalarNs / soaNs : 0.0)
+			  << "x (" << scalarVisible << ", " << soaVisible << ")" << std::endl;
+}
+
+void Lumos::Tests::RunFrustumTests()
+{
+	const Frustum frustum = MakeFrustum();
+
+	std::vector<BoundingBox> boxes;
+	SoABoxes soa;
+	MakeBoxes(boxes, soa);
+
+	TestBoxesMatchScalar(frustum, boxes, soa);
+	TestSpheresMatchScalar(frustum, soa);
+	BenchmarkBoxes(frustum, boxes, soa);
+}
@@ -0,0 +1,27 @@
+#include "Precompiled.h"
+#include "Tests.h"
+
+namespace Lumos
+{
+	namespace Tests
+	{
+		u32 Failures = 0;
+	}
+}
+
+int main()
+{
+	Lumos::Debug::Log::OnInit();
+
+	Lumos::Tests::RunRenderGraphBuilderTests();
+	Lumos::Tests::RunFrustumTests();
+
+	if(Lumos::Tests::Failures > 0)
+	{
+		std::cerr << Lumos::Tests::Failures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All tests passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,119 @@
+#include "Precompiled.h"
+#include "Tests.h"
+#include "Graphics/Renderers/RenderGraphBuilder.h"
+
+using namespace Lumos;
+using namespace Lumos::Graphics;
+
+static u32 Position(const RenderGraphBuilder& builder, u32 pass)
+{
+	const auto& order = builder.GetOrder();
+	return static_cast<u32>(std::find(order.begin(), order.end(), pass) - order.begin());
+}
+
+// Mirrors the frame the render graph declares: a deferred pass reading the shadow map, a skybox and 2D drawn over it
+static void TestSortOrder()
+{
+	RenderGraphBuilder builder;
+
+	const u32 screen = builder.AddResource("Screen");
+	const u32 depth = builder.AddResource("Depth");
+	const u32 shadowMap = builder.AddResource("ShadowMap");
+	builder.MarkOutput(screen);
+
+	const u32 deferred = builder.AddPass("Deferred", 0);
+	builder.Read(deferred, shadowMap);
+	builder.Write(deferred, depth);
+	builder.Write(deferred, screen);
+
+	const u32 renderer2D = builder.AddPass("2D", 20);
+	builder.Write(renderer2D, screen);
+
+	const u32 skybox = builder.AddPass("Skybox", 10);
+	builder.Write(skybox, depth);
+	builder.Write(skybox, screen);
+
+	// Added last with the highest priority, but the deferred pass reads what it writes
+	const u32 shadow = builder.AddPass("Shadow", 30);
+	builder.Write(shadow, shadowMap);
+
+	CHECK(builder.Compile());
+	CHECK(builder.GetOrder().size() == 4);
+	CHECK(Position(builder, shadow) < Position(builder, deferred));
+	CHECK(Position(builder, deferred) < Position(builder, skybox));
+	CHECK(Position(builder, skybox) < Position(builder, renderer2D));
+}
+
+static void TestCulling()
+{
+	RenderGraphBuilder builder;
+
+	const u32 screen = builder.AddResource("Screen");
+	const u32 unused = builder.AddResource("Unused");
+	const u32 intermediate = builder.AddResource("Intermediate");
+	builder.MarkOutput(screen);
+
+	const u32 main = builder.AddPass("Main");
+	builder.Write(main, screen);
+
+	// Only read by a pass that is culled itself
+	const u32 producer = builder.AddPass("Producer");
+	builder.Write(producer, intermediate);
+
+	const u32 consumer = builder.AddPass("Consumer");
+	builder.Read(consumer, intermediate);
+	builder.Write(consumer, unused);
+
+	const u32 readback = builder.AddPass("Readback");
+	builder.Write(readback, unused);
+	builder.MarkSideEffect(readback);
+
+	CHECK(builder.Compile());
+	CHECK(!builder.IsCulled(main));
+	CHECK(builder.IsCulled(producer));
+	CHECK(builder.IsCulled(consumer));
+	CHECK(!builder.IsCulled(readback));
+	CHECK(builder.GetOrder().size() == 2);
+
+	// Making the intermediate an output keeps its writer, but not the pass reading it
+	builder.MarkOutput(intermediate);
+	CHECK(builder.Compile());
+	CHECK(!builder.IsCulled(producer));
+	CHECK(builder.IsCulled(consumer));
+}
+
+static void TestCycle()
+{
+	RenderGraphBuilder builder;
+
+	const u32 a = builder.AddResource("A");
+	const u32 b = builder.AddResource("B");
+	builder.MarkOutput(a);
+	builder.MarkOutput(b);
+
+	const u32 first = builder.AddPass("First");
+	builder.Read(first, b);
+	builder.Write(first, a);
+
+	const u32 second = builder.AddPass("Second");
+	builder.Read(second, a);
+	builder.Write(second, b);
+
+	CHECK(!builder.Compile());
+	CHECK(builder.GetOrder().size() == 2);
+	CHECK(Position(builder, first) < Position(builder, second));
+
+	// Recompiling after clearing starts from nothing
+	builder.Clear();
+	CHECK(builder.Compile());
+	CHECK(builder.GetOrder().empty());
+	CHECK(builder.GetPassCount() == 0);
+	CHECK(builder.GetResourceCount() == 0);
+}
+
+void Lumos::Tests::RunRenderGraphBuilderTests()
+{
+	TestSortOrder();
+	TestCulling();
+	TestCycle();
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "Core/Core.h"
+
+#include <iostream>
+
+namespace Lumos
+{
+	namespace Tests
+	{
+		// Failed checks across every test, main returns non zero when any failed
+		extern u32 Failures;
+
+		void RunRenderGraphBuilderTests();
+		void RunFrustumTests();
+	}
+}
+
+#define CHECK(condition)                                                                 \
+	if(!(condition))                                                                     \
+	{                                                                                    \
+		std::cerr << __FILE__ << "(" << __LINE__ << ") Failed : " #condition << std::endl; \
+		Lumos::Tests::Failures++;                                                        \
+	}
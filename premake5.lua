@@ -63,6 +63,10 @@ workspace "Lumos"
 	include "Lumos/premake5"
 	include "Sandbox/premake5"
 
+	if _OPTIONS["os"] ~= "ios" then
+		include "Tests/premake5"
+	end
+
 	filter()
 
 newaction